@@ -0,0 +1,389 @@
+#include "cfg.h"
+#include "../obfuscator/ast_utils.h"
+#include "../parser/parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Blocks
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int new_block(CFG* cfg) {
+    if (cfg->count == cfg->capacity) {
+        int capacity = cfg->capacity ? cfg->capacity * 2 : 16;
+        CFGBlock* blocks = realloc(cfg->blocks, capacity * sizeof(CFGBlock));
+        if (!blocks) return -1;
+        
+        cfg->blocks = blocks;
+        cfg->capacity = capacity;
+    }
+    
+    CFGBlock* block = &cfg->blocks[cfg->count];
+    block->statements = NULL;
+    block->condition = NULL;
+    block->next = CFG_EXIT;
+    block->other = CFG_EXIT;
+    block->predecessors = 0;
+    block->returns = false;
+    return cfg->count++;
+}
+
+static void append(CFG* cfg, int block, ASTNode* stmt) {
+    cfg->blocks[block].statements = ast_link(cfg->blocks[block].statements, stmt);
+}
+
+static void end_block(CFG* cfg, int block, ASTNode* condition, int next, int other) {
+    cfg->blocks[block].condition = condition;
+    cfg->blocks[block].next = next;
+    cfg->blocks[block].other = other;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Feasibility
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* A `break` that would bind to an enclosing switch once its loop is lowered */
+static bool contains_break(const ASTNode* node) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_BREAK:
+                return true;
+            case NODE_IF:
+                if (contains_break(node->data.if_stmt.then_stmt) ||
+                    contains_break(node->data.if_stmt.else_stmt)) {
+                    return true;
+                }
+                break;
+            case NODE_BLOCK:
+                if (contains_break(node->data.block.statements)) return true;
+                break;
+            default:
+                // Nested loops and switches own their breaks
+                break;
+        }
+    }
+    return false;
+}
+
+/* Bodies with their own declarations keep their scope intact */
+static bool body_lowerable(const ASTNode* body) {
+    if (!body) return true;
+    if (body->type != NODE_BLOCK) return body->type != NODE_VARIABLE;
+    
+    for (const ASTNode* stmt = body->data.block.statements; stmt; stmt = stmt->next) {
+        if (stmt->type == NODE_VARIABLE) return false;
+    }
+    return true;
+}
+
+bool cfg_can_lower(const ASTNode* stmt) {
+    // Protected loops stay whole so they can still be vectorized
+    if (!stmt || (stmt->flags & AST_FLAG_PROTECTED)) return false;
+    
+    switch (stmt->type) {
+        case NODE_IF:
+            return stmt->data.if_stmt.condition &&
+                   body_lowerable(stmt->data.if_stmt.then_stmt) &&
+                   body_lowerable(stmt->data.if_stmt.else_stmt);
+        case NODE_WHILE:
+            return stmt->data.while_stmt.condition &&
+                   body_lowerable(stmt->data.while_stmt.body) &&
+                   !contains_break(stmt->data.while_stmt.body);
+        case NODE_FOR: {
+            const ASTNode* init = stmt->data.for_stmt.init;
+            return (!init || init->type != NODE_VARIABLE) &&
+                   body_lowerable(stmt->data.for_stmt.body) &&
+                   !contains_break(stmt->data.for_stmt.body);
+        }
+        default:
+            return false;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Construction
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int lower_statement(CFG* cfg, ASTNode* stmt, int current);
+
+static int lower_list(CFG* cfg, ASTNode* list, int current) {
+    while (list && current >= 0) {
+        ASTNode* next = list->next;
+        list->next = NULL;
+        current = lower_statement(cfg, list, current);
+        list = next;
+    }
+    
+    // Whatever was not lowered (out of memory) is released here
+    ast_tree_destroy(list);
+    return current;
+}
+
+/* Takes ownership of `body`; a block's statements join the current one */
+static int lower_body(CFG* cfg, ASTNode* body, int current) {
+    if (!body) return current;
+    if (body->type != NODE_BLOCK) return lower_statement(cfg, body, current);
+    
+    ASTNode* statements = body->data.block.statements;
+    body->data.block.statements = NULL;
+    ast_node_destroy(body);
+    return lower_list(cfg, statements, current);
+}
+
+static int lower_statement(CFG* cfg, ASTNode* stmt, int current) {
+    if (stmt->type == NODE_RETURN) {
+        // Code after a return only runs if something jumps to it
+        append(cfg, current, stmt);
+        cfg->blocks[current].returns = true;
+        return new_block(cfg);
+    }
+    
+    if (!cfg_can_lower(stmt)) {
+        append(cfg, current, stmt);
+        return current;
+    }
+    
+    switch (stmt->type) {
+        case NODE_IF: {
+            ASTNode* condition = stmt->data.if_stmt.condition;
+            ASTNode* then_stmt = stmt->data.if_stmt.then_stmt;
+            ASTNode* else_stmt = stmt->data.if_stmt.else_stmt;
+            stmt->data.if_stmt.condition = NULL;
+            stmt->data.if_stmt.then_stmt = NULL;
+            stmt->data.if_stmt.else_stmt = NULL;
+            ast_node_destroy(stmt);
+            
+            int then_block = new_block(cfg);
+            int else_block = else_stmt ? new_block(cfg) : -1;
+            int join = new_block(cfg);
+            if (then_block < 0 || join < 0 || (else_stmt && else_block < 0)) {
+                ast_node_destroy(condition);
+                ast_node_destroy(then_stmt);
+                ast_node_destroy(else_stmt);
+                return -1;
+            }
+            
+            end_block(cfg, current, condition, then_block, else_stmt ? else_block : join);
+            
+            int then_end = lower_body(cfg, then_stmt, then_block);
+            if (then_end < 0) {
+                ast_node_destroy(else_stmt);
+                return -1;
+            }
+            end_block(cfg, then_end, NULL, join, join);
+            
+            if (else_stmt) {
+                int else_end = lower_body(cfg, else_stmt, else_block);
+                if (else_end < 0) return -1;
+                end_block(cfg, else_end, NULL, join, join);
+            }
+            return join;
+        }
+        
+        case NODE_WHILE: {
+            ASTNode* condition = stmt->data.while_stmt.condition;
+            ASTNode* body = stmt->data.while_stmt.body;
+            stmt->data.while_stmt.condition = NULL;
+            stmt->data.while_stmt.body = NULL;
+            ast_node_destroy(stmt);
+            
+            int head = new_block(cfg);
+            int body_block = new_block(cfg);
+            int exit = new_block(cfg);
+            if (head < 0 || body_block < 0 || exit < 0) {
+                ast_node_destroy(condition);
+                ast_node_destroy(body);
+                return -1;
+            }
+            
+            end_block(cfg, current, NULL, head, head);
+            end_block(cfg, head, condition, body_block, exit);
+            
+            int body_end = lower_body(cfg, body, body_block);
+            if (body_end < 0) return -1;
+            end_block(cfg, body_end, NULL, head, head);
+            return exit;
+        }
+        
+        case NODE_FOR: {
+            ASTNode* init = stmt->data.for_stmt.init;
+            ASTNode* condition = stmt->data.for_stmt.condition;
+            ASTNode* update = stmt->data.for_stmt.update;
+            ASTNode* body = stmt->data.for_stmt.body;
+            stmt->data.for_stmt.init = NULL;
+            stmt->data.for_stmt.condition = NULL;
+            stmt->data.for_stmt.update = NULL;
+            stmt->data.for_stmt.body = NULL;
+            ast_node_destroy(stmt);
+            
+            if (init) append(cfg, current, init);
+            
+            int head = new_block(cfg);
+            int body_block = new_block(cfg);
+            int step = new_block(cfg);
+            int exit = new_block(cfg);
+            if (head < 0 || body_block < 0 || step < 0 || exit < 0) {
+                ast_node_destroy(condition);
+                ast_node_destroy(update);
+                ast_node_destroy(body);
+                return -1;
+            }
+            
+            end_block(cfg, current, NULL, head, head);
+            if (condition) {
+                end_block(cfg, head, condition, body_block, exit);
+            } else {
+                end_block(cfg, head, NULL, body_block, body_block);
+            }
+            
+            if (update) append(cfg, step, update);
+            end_block(cfg, step, NULL, head, head);
+            
+            int body_end = lower_body(cfg, body, body_block);
+            if (body_end < 0) return -1;
+            end_block(cfg, body_end, NULL, step, step);
+            return exit;
+        }
+        
+        default:
+            append(cfg, current, stmt);
+            return current;
+    }
+}
+
+CFG* cfg_build(ASTNode* statements) {
+    CFG* cfg = calloc(1, sizeof(CFG));
+    if (!cfg) {
+        ast_tree_destroy(statements);
+        return NULL;
+    }
+    
+    cfg->entry = new_block(cfg);
+    if (cfg->entry < 0 || lower_list(cfg, statements, cfg->entry) < 0) {
+        if (cfg->entry < 0) ast_tree_destroy(statements);
+        cfg_destroy(cfg);
+        return NULL;
+    }
+    return cfg;
+}
+
+void cfg_destroy(CFG* cfg) {
+    if (!cfg) return;
+    
+    for (int i = 0; i < cfg->count; i++) {
+        ast_tree_destroy(cfg->blocks[i].statements);
+        ast_node_destroy(cfg->blocks[i].condition);
+    }
+    free(cfg->blocks);
+    free(cfg);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Simplification
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Follows chains of empty unconditional blocks */
+static int resolve(const CFG* cfg, int block) {
+    for (int steps = 0; block != CFG_EXIT && steps < cfg->count; steps++) {
+        const CFGBlock* b = &cfg->blocks[block];
+        if (b->statements || b->condition || b->returns) break;
+        block = b->next;
+    }
+    return block;
+}
+
+static void count_predecessors(CFG* cfg) {
+    for (int i = 0; i < cfg->count; i++) {
+        cfg->blocks[i].predecessors = 0;
+    }
+    
+    // Empty blocks have been threaded through; their edges are not real
+    for (int i = 0; i < cfg->count; i++) {
+        const CFGBlock* b = &cfg->blocks[i];
+        if (b->returns || (!b->statements && !b->condition)) continue;
+        
+        if (b->next != CFG_EXIT) cfg->blocks[b->next].predecessors++;
+        if (b->condition && b->other != CFG_EXIT) cfg->blocks[b->other].predecessors++;
+    }
+}
+
+int cfg_simplify(CFG* cfg, bool merge) {
+    if (!cfg) return 0;
+    
+    for (int i = 0; i < cfg->count; i++) {
+        CFGBlock* b = &cfg->blocks[i];
+        b->next = resolve(cfg, b->next);
+        b->other = resolve(cfg, b->other);
+    }
+    cfg->entry = resolve(cfg, cfg->entry);
+    count_predecessors(cfg);
+    if (!merge) return 0;
+    
+    // Fold straight-line chains: A -> B where A is B's only way in
+    int merged = 0;
+    for (int i = 0; i < cfg->count; i++) {
+        CFGBlock* a = &cfg->blocks[i];
+        
+        // Empty blocks are only left on dead paths and in endless loops
+        while (a->statements && !a->condition && !a->returns && a->next != CFG_EXIT) {
+            int target = a->next;
+            CFGBlock* b = &cfg->blocks[target];
+            if (target == i || target == cfg->entry || b->predecessors != 1) break;
+            if (!b->statements && !b->condition && !b->returns) break;
+            
+            a->statements = ast_link(a->statements, b->statements);
+            a->condition = b->condition;
+            a->next = b->next;
+            a->other = b->other;
+            a->returns = b->returns;
+            
+            b->statements = NULL;
+            b->condition = NULL;
+            b->next = CFG_EXIT;
+            b->other = CFG_EXIT;
+            b->predecessors = 0;
+            b->returns = false;
+            merged++;
+        }
+    }
+    return merged;
+}
+
+int cfg_order(const CFG* cfg, int* order) {
+    if (!cfg || !order) return 0;
+    
+    bool* seen = calloc(cfg->count ? cfg->count : 1, sizeof(bool));
+    if (!seen) return 0;
+    
+    int head = 0;
+    int tail = 0;
+    if (cfg->entry != CFG_EXIT) {
+        seen[cfg->entry] = true;
+        order[tail++] = cfg->entry;
+    }
+    
+    for (int seed = 0; seed <= cfg->count; seed++) {
+        while (head < tail) {
+            const CFGBlock* b = &cfg->blocks[order[head++]];
+            if (b->returns) continue;
+            
+            int successors[2] = { b->next, b->condition ? b->other : CFG_EXIT };
+            for (int i = 0; i < 2; i++) {
+                int s = successors[i];
+                if (s != CFG_EXIT && !seen[s]) {
+                    seen[s] = true;
+                    order[tail++] = s;
+                }
+            }
+        }
+        
+        // Code after an endless loop or a return stays: a goto may reach it
+        if (seed < cfg->count && !seen[seed] && cfg->blocks[seed].statements) {
+            seen[seed] = true;
+            order[tail++] = seed;
+        }
+    }
+    
+    free(seen);
+    return tail;
+}
@@ -0,0 +1,55 @@
+#ifndef ANALYSIS_CFG_H
+#define ANALYSIS_CFG_H
+
+#include "../common/types.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Control-Flow Graph
+ *
+ * A statement list is split into maximal basic blocks: a block ends where
+ * control can leave it, at the condition of a lowered `if`, `while` or
+ * `for`, or at a `return`. Each block ends in at most one condition with
+ * two successors; CFG_EXIT stands for falling off the end of the list.
+ *
+ * Structured statements are only lowered when that is safe: a loop whose
+ * body contains a `break`, a body with its own declarations, or a loop
+ * protected for vectorization stays intact inside a block as an ordinary
+ * statement.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define CFG_EXIT -1
+
+typedef struct {
+    ASTNode* statements;       /* Straight-line code, in order */
+    ASTNode* condition;        /* NULL = unconditional transition */
+    int next;                  /* Successor when the condition holds */
+    int other;                 /* Successor when it fails */
+    int predecessors;          /* Incoming edges, counted by cfg_simplify */
+    bool returns;              /* Ends in `return`; no successors */
+} CFGBlock;
+
+typedef struct {
+    CFGBlock* blocks;
+    int count;
+    int capacity;
+    int entry;                 /* CFG_EXIT when there is nothing to run */
+} CFG;
+
+/* Whether cfg_build splits `stmt` into blocks rather than keeping it whole */
+bool cfg_can_lower(const ASTNode* stmt);
+
+/* Takes ownership of the list; NULL when out of memory */
+CFG* cfg_build(ASTNode* statements);
+void cfg_destroy(CFG* cfg);
+
+/* Threads edges through empty blocks and recounts predecessors. With
+ * `merge`, a block whose only predecessor falls straight into it is folded
+ * into that predecessor. Returns the number of blocks merged away. */
+int cfg_simplify(CFG* cfg, bool merge);
+
+/* Fills `order` (room for cfg->count entries) with the blocks reachable
+ * from the entry in breadth-first order, followed by unreachable blocks
+ * that still hold code; returns how many were written */
+int cfg_order(const CFG* cfg, int* order);
+
+#endif /* ANALYSIS_CFG_H */
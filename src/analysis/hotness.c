@@ -0,0 +1,287 @@
+#include "hotness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Frequency Walk
+ *
+ * One walk serves both phases: while building the call graph it records
+ * call sites with their weight relative to the caller's entry; once
+ * function frequencies are known it stamps absolute estimates on each node.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    CallGraph* graph;
+    CallGraphFunction* current;
+    bool stamp;
+    double scale;            /* Frequency of the enclosing function */
+} HotnessWalk;
+
+static void walk_node(HotnessWalk* walk, ASTNode* node, double weight, int depth);
+
+static void walk_list(HotnessWalk* walk, ASTNode* list, double weight, int depth) {
+    for (; list; list = list->next) {
+        walk_node(walk, list, weight, depth);
+    }
+}
+
+static CallGraphFunction* add_function(CallGraph* graph, ASTNode* node) {
+    CallGraphFunction* function = call_graph_find(graph, node->data.function.name);
+    if (function) return function;
+    
+    function = calloc(1, sizeof(CallGraphFunction));
+    if (!function) return NULL;
+    
+    function->name = strdup(node->data.function.name ? node->data.function.name : "");
+    function->node = node;
+    function->index = graph->function_count;
+    function->next = graph->functions;
+    graph->functions = function;
+    graph->function_count++;
+    return function;
+}
+
+static void add_call_site(CallGraphFunction* caller, const char* callee, double weight, int depth) {
+    CallSite* site = malloc(sizeof(CallSite));
+    if (!site) return;
+    
+    site->callee = strdup(callee);
+    site->target = NULL;
+    site->weight = weight;
+    site->loop_depth = depth;
+    site->next = caller->calls;
+    caller->calls = site;
+}
+
+static void walk_node(HotnessWalk* walk, ASTNode* node, double weight, int depth) {
+    if (!node) return;
+    
+    if (walk->stamp) {
+        double hotness = walk->scale * weight;
+        node->hotness = (float)(hotness > HOTNESS_MAX ? HOTNESS_MAX : hotness);
+    }
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            walk_list(walk, node->data.program.declarations, weight, depth);
+            break;
+        
+        case NODE_FUNCTION: {
+            CallGraphFunction* outer = walk->current;
+            double outer_scale = walk->scale;
+            
+            if (walk->stamp) {
+                CallGraphFunction* function = call_graph_find(walk->graph, node->data.function.name);
+                walk->scale = function ? function->frequency : 1.0;
+                node->hotness = (float)walk->scale;
+            } else {
+                walk->current = add_function(walk->graph, node);
+            }
+            
+            walk_list(walk, node->data.function.parameters, 1.0, 0);
+            walk_node(walk, node->data.function.body, 1.0, 0);
+            
+            walk->current = outer;
+            walk->scale = outer_scale;
+            break;
+        }
+        
+        case NODE_VARIABLE:
+            walk_node(walk, node->data.variable.initializer, weight, depth);
+            break;
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS: {
+            const char* op = node->data.binary.operator;
+            bool conditional = op && (strcmp(op, "&&") == 0 || strcmp(op, "||") == 0 ||
+                                      strcmp(op, "?:") == 0);
+            
+            walk_node(walk, node->data.binary.left, weight, depth);
+            walk_list(walk, node->data.binary.right,
+                      conditional ? weight * HOTNESS_BRANCH_WEIGHT : weight, depth);
+            break;
+        }
+        
+        case NODE_UNARY_OP:
+            walk_node(walk, node->data.unary.operand, weight, depth);
+            break;
+        
+        case NODE_CALL: {
+            ASTNode* callee = node->data.call.function;
+            if (!walk->stamp && walk->current && callee && callee->type == NODE_IDENTIFIER) {
+                add_call_site(walk->current, callee->data.identifier.name, weight, depth);
+            }
+            walk_node(walk, callee, weight, depth);
+            walk_list(walk, node->data.call.arguments, weight, depth);
+            break;
+        }
+        
+        case NODE_IF:
+            walk_node(walk, node->data.if_stmt.condition, weight, depth);
+            walk_node(walk, node->data.if_stmt.then_stmt, weight * HOTNESS_BRANCH_WEIGHT, depth);
+            walk_node(walk, node->data.if_stmt.else_stmt, weight * HOTNESS_BRANCH_WEIGHT, depth);
+            break;
+        
+        case NODE_WHILE:
+        case NODE_FOR: {
+            double body_weight = weight * HOTNESS_LOOP_WEIGHT;
+            if (body_weight > HOTNESS_MAX) body_weight = HOTNESS_MAX;
+            
+            if (!walk->stamp && walk->current && depth + 1 > walk->current->max_loop_depth) {
+                walk->current->max_loop_depth = depth + 1;
+            }
+            
+            if (node->type == NODE_WHILE) {
+                walk_node(walk, node->data.while_stmt.condition, body_weight, depth + 1);
+                walk_node(walk, node->data.while_stmt.body, body_weight, depth + 1);
+            } else {
+                walk_node(walk, node->data.for_stmt.init, weight, depth);
+                walk_node(walk, node->data.for_stmt.condition, body_weight, depth + 1);
+                walk_node(walk, node->data.for_stmt.update, body_weight, depth + 1);
+                walk_node(walk, node->data.for_stmt.body, body_weight, depth + 1);
+            }
+            break;
+        }
+        
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            walk_list(walk, node->data.block.statements, weight, depth);
+            break;
+        
+        default:
+            break;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Call Graph
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+CallGraphFunction* call_graph_find(const CallGraph* graph, const char* name) {
+    if (!graph || !name) return NULL;
+    
+    for (CallGraphFunction* function = graph->functions; function; function = function->next) {
+        if (strcmp(function->name, name) == 0) return function;
+    }
+    return NULL;
+}
+
+bool call_graph_is_leaf(const CallGraphFunction* function) {
+    return function && !function->calls;
+}
+
+CallGraph* call_graph_build(ASTNode* ast) {
+    CallGraph* graph = malloc(sizeof(CallGraph));
+    if (!graph) return NULL;
+    
+    graph->functions = NULL;
+    graph->function_count = 0;
+    
+    HotnessWalk walk = { graph, NULL, false, 1.0 };
+    walk_list(&walk, ast, 1.0, 0);
+    
+    // Only calls to functions defined in this unit form edges
+    for (CallGraphFunction* caller = graph->functions; caller; caller = caller->next) {
+        for (CallSite* site = caller->calls; site; site = site->next) {
+            site->target = call_graph_find(graph, site->callee);
+            if (site->target) site->target->caller_count++;
+        }
+    }
+    
+    return graph;
+}
+
+void call_graph_destroy(CallGraph* graph) {
+    if (!graph) return;
+    
+    CallGraphFunction* function = graph->functions;
+    while (function) {
+        CallGraphFunction* next = function->next;
+        
+        CallSite* site = function->calls;
+        while (site) {
+            CallSite* next_site = site->next;
+            free(site->callee);
+            free(site);
+            site = next_site;
+        }
+        
+        free(function->name);
+        free(function);
+        function = next;
+    }
+    
+    free(graph);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Frequency Estimation
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Entry points (main and functions nothing here calls) run once; every
+ * other function runs as often as its call sites. Acyclic graphs settle
+ * within function_count rounds; recursion is cut off there and clamped. */
+static bool is_entry_point(const CallGraphFunction* function) {
+    return function->caller_count == 0 || strcmp(function->name, "main") == 0;
+}
+
+static void estimate_frequencies(CallGraph* graph) {
+    double* incoming = malloc(graph->function_count * sizeof(double));
+    if (!incoming) return;
+    
+    for (CallGraphFunction* function = graph->functions; function; function = function->next) {
+        function->frequency = is_entry_point(function) ? 1.0 : 0.0;
+    }
+    
+    for (int round = 0; round < graph->function_count; round++) {
+        for (int i = 0; i < graph->function_count; i++) {
+            incoming[i] = 0.0;
+        }
+        
+        for (CallGraphFunction* caller = graph->functions; caller; caller = caller->next) {
+            for (CallSite* site = caller->calls; site; site = site->next) {
+                if (site->target) {
+                    incoming[site->target->index] += caller->frequency * site->weight;
+                }
+            }
+        }
+        
+        for (CallGraphFunction* function = graph->functions; function; function = function->next) {
+            double frequency = (is_entry_point(function) ? 1.0 : 0.0) + incoming[function->index];
+            function->frequency = frequency > HOTNESS_MAX ? HOTNESS_MAX : frequency;
+        }
+    }
+    
+    // Functions only reachable through recursion still run when called
+    for (CallGraphFunction* function = graph->functions; function; function = function->next) {
+        if (function->frequency < 1.0) function->frequency = 1.0;
+    }
+    
+    free(incoming);
+}
+
+void hotness_annotate(ASTNode* ast) {
+    if (!ast) return;
+    
+    CallGraph* graph = call_graph_build(ast);
+    if (!graph) return;
+    
+    estimate_frequencies(graph);
+    
+    HotnessWalk walk = { graph, NULL, true, 1.0 };
+    walk_list(&walk, ast, 1.0, 0);
+    
+    call_graph_destroy(graph);
+}
+
+int hotness_scale_percent(int percent, float hotness) {
+    // Every factor of two beyond once per run takes another share off:
+    // a single loop (x8) keeps a quarter, a nested one (x64) a seventh
+    int doublings = 0;
+    for (float h = hotness; h >= 2.0f; h /= 2.0f) {
+        doublings++;
+    }
+    return percent / (1 + doublings);
+}
@@ -0,0 +1,58 @@
+#ifndef ANALYSIS_HOTNESS_H
+#define ANALYSIS_HOTNESS_H
+
+#include "../common/types.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Static Hotness Estimation
+ *
+ * Without a profile, execution frequency is estimated from the source: each
+ * enclosing loop multiplies it by HOTNESS_LOOP_WEIGHT, each conditional
+ * branch halves it, and a function runs as often as all of its call sites
+ * together. Estimates are stored in ASTNode.hotness (1.0 = once per entry
+ * into the program).
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define HOTNESS_LOOP_WEIGHT   8.0
+#define HOTNESS_BRANCH_WEIGHT 0.5
+#define HOTNESS_MAX           1.0e9
+
+/* A call from one function to another, weighted by where it sits */
+typedef struct CallSite {
+    char* callee;
+    struct CallGraphFunction* target;   /* NULL when defined elsewhere */
+    double weight;           /* Executions per execution of the caller */
+    int loop_depth;
+    struct CallSite* next;
+} CallSite;
+
+/* Call graph node */
+typedef struct CallGraphFunction {
+    char* name;
+    ASTNode* node;
+    int index;
+    CallSite* calls;
+    int caller_count;        /* Call sites targeting this function */
+    int max_loop_depth;
+    double frequency;
+    struct CallGraphFunction* next;
+} CallGraphFunction;
+
+typedef struct {
+    CallGraphFunction* functions;
+    int function_count;
+} CallGraph;
+
+/* Call Graph */
+CallGraph* call_graph_build(ASTNode* ast);
+void call_graph_destroy(CallGraph* graph);
+CallGraphFunction* call_graph_find(const CallGraph* graph, const char* name);
+bool call_graph_is_leaf(const CallGraphFunction* function);
+
+/* Estimates function frequencies and stamps every node's hotness */
+void hotness_annotate(ASTNode* ast);
+
+/* Scales a transformation probability down for frequently executed code */
+int hotness_scale_percent(int percent, float hotness);
+
+#endif /* ANALYSIS_HOTNESS_H */
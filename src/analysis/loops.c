@@ -0,0 +1,398 @@
+#include "loops.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Tree Queries
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define LOOP_MAX_CHILDREN 4
+
+/* Child lists of a node; each is walked through `next` */
+static int child_lists(const ASTNode* node, const ASTNode** lists) {
+    switch (node->type) {
+        case NODE_PROGRAM:
+            lists[0] = node->data.program.declarations;
+            return 1;
+        case NODE_FUNCTION:
+            lists[0] = node->data.function.body;
+            return 1;
+        case NODE_VARIABLE:
+        case NODE_PARAMETER:
+            lists[0] = node->data.variable.initializer;
+            return 1;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            lists[0] = node->data.binary.left;
+            lists[1] = node->data.binary.right;
+            return 2;
+        case NODE_UNARY_OP:
+            lists[0] = node->data.unary.operand;
+            return 1;
+        case NODE_CALL:
+            lists[0] = node->data.call.function;
+            lists[1] = node->data.call.arguments;
+            return 2;
+        case NODE_IF:
+            lists[0] = node->data.if_stmt.condition;
+            lists[1] = node->data.if_stmt.then_stmt;
+            lists[2] = node->data.if_stmt.else_stmt;
+            return 3;
+        case NODE_WHILE:
+            lists[0] = node->data.while_stmt.condition;
+            lists[1] = node->data.while_stmt.body;
+            return 2;
+        case NODE_FOR:
+            lists[0] = node->data.for_stmt.init;
+            lists[1] = node->data.for_stmt.condition;
+            lists[2] = node->data.for_stmt.update;
+            lists[3] = node->data.for_stmt.body;
+            return 4;
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            lists[0] = node->data.block.statements;
+            return 1;
+        case NODE_SWITCH:
+            lists[0] = node->data.switch_stmt.expression;
+            lists[1] = node->data.switch_stmt.cases;
+            return 2;
+        case NODE_CASE:
+            lists[0] = node->data.case_stmt.value;
+            lists[1] = node->data.case_stmt.statements;
+            return 2;
+        case NODE_GOTO:
+            lists[0] = node->data.jump.target;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static bool is_name(const ASTNode* node, const char* name) {
+    return node && node->type == NODE_IDENTIFIER && node->data.identifier.name &&
+           strcmp(node->data.identifier.name, name) == 0;
+}
+
+static bool is_operator(const ASTNode* node, const char* op) {
+    return node->data.binary.operator && strcmp(node->data.binary.operator, op) == 0;
+}
+
+static bool assigns(const char* op) {
+    size_t length = op ? strlen(op) : 0;
+    if (length == 0 || op[length - 1] != '=') return false;
+    return strcmp(op, "==") != 0 && strcmp(op, "!=") != 0 &&
+           strcmp(op, "<=") != 0 && strcmp(op, ">=") != 0;
+}
+
+static bool references(const ASTNode* list, const char* name) {
+    for (const ASTNode* node = list; node; node = node->next) {
+        if (is_name(node, name)) return true;
+        
+        const ASTNode* lists[LOOP_MAX_CHILDREN];
+        int count = child_lists(node, lists);
+        for (int i = 0; i < count; i++) {
+            if (references(lists[i], name)) return true;
+        }
+    }
+    return false;
+}
+
+/* Assignments, ++/--, address-taking, or a shadowing declaration */
+static bool writes(const ASTNode* list, const char* name) {
+    for (const ASTNode* node = list; node; node = node->next) {
+        switch (node->type) {
+            case NODE_ASSIGNMENT:
+            case NODE_BINARY_OP:
+                if (assigns(node->data.binary.operator) && is_name(node->data.binary.left, name)) {
+                    return true;
+                }
+                break;
+            case NODE_UNARY_OP: {
+                const char* op = node->data.unary.operator;
+                if (op && (strcmp(op, "++") == 0 || strcmp(op, "--") == 0 || strcmp(op, "&") == 0) &&
+                    is_name(node->data.unary.operand, name)) {
+                    return true;
+                }
+                break;
+            }
+            case NODE_VARIABLE:
+                if (node->data.variable.name && strcmp(node->data.variable.name, name) == 0) {
+                    return true;
+                }
+                break;
+            default:
+                break;
+        }
+        
+        const ASTNode* lists[LOOP_MAX_CHILDREN];
+        int count = child_lists(node, lists);
+        for (int i = 0; i < count; i++) {
+            if (writes(lists[i], name)) return true;
+        }
+    }
+    return false;
+}
+
+/* A break out of this loop, a return, or a jump in or out */
+static bool exits_early(const ASTNode* list, bool nested) {
+    for (const ASTNode* node = list; node; node = node->next) {
+        switch (node->type) {
+            case NODE_BREAK:
+                if (!nested) return true;
+                break;
+            case NODE_RETURN:
+            case NODE_GOTO:
+            case NODE_LABEL:
+                return true;
+            default:
+                break;
+        }
+        
+        // Inner loops and switches own their breaks
+        bool inner = nested || node->type == NODE_WHILE || node->type == NODE_FOR ||
+                     node->type == NODE_SWITCH;
+        const ASTNode* lists[LOOP_MAX_CHILDREN];
+        int count = child_lists(node, lists);
+        for (int i = 0; i < count; i++) {
+            if (exits_early(lists[i], inner)) return true;
+        }
+    }
+    return false;
+}
+
+/* Subscripts whose index uses `name`; flagged when `mark` is set */
+static int subscripts(ASTNode* list, const char* name, bool mark) {
+    int found = 0;
+    for (ASTNode* node = list; node; node = node->next) {
+        if (node->type == NODE_ARRAY_ACCESS && references(node->data.binary.right, name)) {
+            if (mark) node->flags |= AST_FLAG_PROTECTED;
+            found++;
+        }
+        
+        const ASTNode* lists[LOOP_MAX_CHILDREN];
+        int count = child_lists(node, lists);
+        for (int i = 0; i < count; i++) {
+            found += subscripts((ASTNode*)lists[i], name, mark);
+        }
+    }
+    return found;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Recognition
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool is_integer_type(const char* type) {
+    if (!type || strchr(type, '*') || strchr(type, '[')) return false;
+    if (strstr(type, "float") || strstr(type, "double")) return false;
+    
+    static const char* integers[] = {
+        "int", "long", "short", "char", "size_t", "ptrdiff_t", "unsigned", "signed"
+    };
+    for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+        if (strstr(type, integers[i])) return true;
+    }
+    return false;
+}
+
+static const char* induction_variable(const ASTNode* init) {
+    if (!init) return NULL;
+    
+    if (init->type == NODE_VARIABLE) {
+        if (!init->data.variable.initializer || !is_integer_type(init->data.variable.type)) {
+            return NULL;
+        }
+        return init->data.variable.name;
+    }
+    
+    if ((init->type == NODE_ASSIGNMENT || init->type == NODE_BINARY_OP) && is_operator(init, "=") &&
+        init->data.binary.left && init->data.binary.left->type == NODE_IDENTIFIER) {
+        return init->data.binary.left->data.identifier.name;
+    }
+    return NULL;
+}
+
+/* i++, ++i, i--, --i, i += c, i -= c */
+static bool constant_step(const ASTNode* update, const char* name) {
+    if (update->type == NODE_UNARY_OP) {
+        const char* op = update->data.unary.operator;
+        return op && (strcmp(op, "++") == 0 || strcmp(op, "--") == 0) &&
+               is_name(update->data.unary.operand, name);
+    }
+    
+    if (update->type == NODE_BINARY_OP && (is_operator(update, "+=") || is_operator(update, "-="))) {
+        const ASTNode* step = update->data.binary.right;
+        return is_name(update->data.binary.left, name) && step && step->type == NODE_LITERAL;
+    }
+    return false;
+}
+
+/* Side-effect free, and nothing it reads is written by the loop */
+static bool invariant(const ASTNode* bound, const ASTNode* loop, const char* induction) {
+    if (!bound) return false;
+    
+    switch (bound->type) {
+        case NODE_LITERAL:
+        case NODE_SIZEOF:
+            return true;
+        
+        case NODE_IDENTIFIER: {
+            const char* name = bound->data.identifier.name;
+            return name && strcmp(name, induction) != 0 &&
+                   !writes(loop->data.for_stmt.body, name) &&
+                   !writes(loop->data.for_stmt.update, name);
+        }
+        
+        case NODE_BINARY_OP:
+            if (assigns(bound->data.binary.operator) || is_operator(bound, "?:")) return false;
+            return invariant(bound->data.binary.left, loop, induction) &&
+                   invariant(bound->data.binary.right, loop, induction);
+        
+        case NODE_UNARY_OP: {
+            const char* op = bound->data.unary.operator;
+            if (!op || strcmp(op, "++") == 0 || strcmp(op, "--") == 0 || strcmp(op, "*") == 0) {
+                return false;
+            }
+            return invariant(bound->data.unary.operand, loop, induction);
+        }
+        
+        default:
+            // Loads and calls may see stores made by the body
+            return false;
+    }
+}
+
+static const ASTNode* loop_bound(const ASTNode* condition, const char* name) {
+    if (!condition || condition->type != NODE_BINARY_OP) return NULL;
+    
+    static const char* comparisons[] = { "<", "<=", ">", ">=", "!=" };
+    bool compares = false;
+    for (size_t i = 0; i < sizeof(comparisons) / sizeof(comparisons[0]); i++) {
+        if (is_operator(condition, comparisons[i])) compares = true;
+    }
+    if (!compares) return NULL;
+    
+    if (is_name(condition->data.binary.left, name)) return condition->data.binary.right;
+    if (is_name(condition->data.binary.right, name)) return condition->data.binary.left;
+    return NULL;
+}
+
+bool loop_is_counted(const ASTNode* loop, const char** induction) {
+    if (!loop || loop->type != NODE_FOR) return false;
+    
+    const char* name = induction_variable(loop->data.for_stmt.init);
+    const ASTNode* update = loop->data.for_stmt.update;
+    ASTNode* body = loop->data.for_stmt.body;
+    if (!name || !update || !body || !constant_step(update, name)) return false;
+    
+    const ASTNode* bound = loop_bound(loop->data.for_stmt.condition, name);
+    if (!invariant(bound, loop, name)) return false;
+    
+    if (writes(body, name) || exits_early(body, false)) return false;
+    if (subscripts(body, name, false) == 0) return false;
+    
+    if (induction) *induction = name;
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Protection Pass
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    LoopReport* report;
+    ProtectedLoop* tail;
+    const char* function;
+    bool failed;
+} LoopWalk;
+
+static void protect(LoopWalk* walk, ASTNode* loop, const char* induction) {
+    ASTNode* init = loop->data.for_stmt.init;
+    init->flags |= AST_FLAG_PROTECTED;
+    if (init->type == NODE_VARIABLE) {
+        init->data.variable.initializer->flags |= AST_FLAG_PROTECTED;
+    }
+    loop->data.for_stmt.condition->flags |= AST_FLAG_PROTECTED;
+    loop->data.for_stmt.update->flags |= AST_FLAG_PROTECTED;
+    loop->flags |= AST_FLAG_PROTECTED;
+    
+    ProtectedLoop* entry = calloc(1, sizeof(ProtectedLoop));
+    if (!entry) {
+        walk->failed = true;
+        return;
+    }
+    entry->function = walk->function ? strdup(walk->function) : NULL;
+    entry->induction = strdup(induction);
+    entry->line = loop->location.line;
+    entry->subscripts = subscripts(loop->data.for_stmt.body, induction, true);
+    
+    if (walk->tail) {
+        walk->tail->next = entry;
+    } else {
+        walk->report->loops = entry;
+    }
+    walk->tail = entry;
+    walk->report->count++;
+}
+
+static void protect_list(LoopWalk* walk, ASTNode* list) {
+    for (ASTNode* node = list; node && !walk->failed; node = node->next) {
+        const char* outer = walk->function;
+        if (node->type == NODE_FUNCTION) {
+            walk->function = node->data.function.name;
+        }
+        
+        const char* induction = NULL;
+        if (loop_is_counted(node, &induction)) {
+            protect(walk, node, induction);
+        }
+        
+        // Inner loops are checked on their own
+        const ASTNode* lists[LOOP_MAX_CHILDREN];
+        int count = child_lists(node, lists);
+        for (int i = 0; i < count; i++) {
+            protect_list(walk, (ASTNode*)lists[i]);
+        }
+        walk->function = outer;
+    }
+}
+
+LoopReport* loop_protect(ASTNode* ast) {
+    LoopReport* report = calloc(1, sizeof(LoopReport));
+    if (!report) return NULL;
+    
+    LoopWalk walk = { report, NULL, NULL, false };
+    protect_list(&walk, ast);
+    if (walk.failed) {
+        loop_report_destroy(report);
+        return NULL;
+    }
+    return report;
+}
+
+void loop_report_destroy(LoopReport* report) {
+    if (!report) return;
+    
+    ProtectedLoop* loop = report->loops;
+    while (loop) {
+        ProtectedLoop* next = loop->next;
+        free(loop->function);
+        free(loop->induction);
+        free(loop);
+        loop = next;
+    }
+    free(report);
+}
+
+void loop_report_print(const LoopReport* report, FILE* out) {
+    if (!report || !out || report->count == 0) return;
+    
+    fprintf(out, "Protected %d loop%s for vectorization:\n", report->count,
+            report->count == 1 ? "" : "s");
+    for (const ProtectedLoop* loop = report->loops; loop; loop = loop->next) {
+        fprintf(out, "  %s:%d  induction '%s', %d subscript%s\n",
+                loop->function ? loop->function : "<file scope>", loop->line,
+                loop->induction, loop->subscripts, loop->subscripts == 1 ? "" : "s");
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef ANALYSIS_LOOPS_H
+#define ANALYSIS_LOOPS_H
+
+#include "../common/types.h"
+#include <stdio.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Counted Loop Analysis
+ *
+ * Finds the loops auto-vectorizers handle: a `for` with one integer
+ * induction variable stepped by a constant, compared against a bound the
+ * loop never writes, without an early exit, and indexing at least one
+ * array by the induction variable.
+ *
+ * Such a loop is marked AST_FLAG_PROTECTED, as are its init, condition
+ * and update expressions and every subscript that uses the induction
+ * variable. Passes do not descend into protected nodes and do not
+ * restructure a protected loop; identifier renaming still applies.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct ProtectedLoop {
+    char* function;            /* Enclosing function; NULL at file scope */
+    char* induction;           /* As written, before renaming */
+    int line;
+    int subscripts;            /* Array accesses using the induction variable */
+    struct ProtectedLoop* next;
+} ProtectedLoop;
+
+typedef struct {
+    ProtectedLoop* loops;      /* In source order */
+    int count;
+} LoopReport;
+
+/* Whether `loop` is a counted loop over arrays; `induction` receives the
+ * variable's name (owned by the tree) when it is */
+bool loop_is_counted(const ASTNode* loop, const char** induction);
+
+/* Marks every counted loop in `ast`; NULL when out of memory */
+LoopReport* loop_protect(ASTNode* ast);
+void loop_report_destroy(LoopReport* report);
+
+/* One line per protected loop */
+void loop_report_print(const LoopReport* report, FILE* out);
+
+#endif /* ANALYSIS_LOOPS_H */
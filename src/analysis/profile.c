@@ -0,0 +1,337 @@
+#include "profile.h"
+#include "../obfuscator/ast_utils.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Profile Management
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+Profile* profile_create(void) {
+    Profile* profile = malloc(sizeof(Profile));
+    if (!profile) return NULL;
+    
+    profile->entries = NULL;
+    profile->max_count = 0;
+    profile->entry_count = 0;
+    return profile;
+}
+
+void profile_destroy(Profile* profile) {
+    if (!profile) return;
+    
+    ProfileEntry* entry = profile->entries;
+    while (entry) {
+        ProfileEntry* next = entry->next;
+        free(entry->function);
+        free(entry);
+        entry = next;
+    }
+    
+    free(profile);
+}
+
+void profile_add(Profile* profile, const char* function, int line, unsigned long long count) {
+    if (!profile) return;
+    
+    ProfileEntry* entry = malloc(sizeof(ProfileEntry));
+    if (!entry) return;
+    
+    entry->function = strdup(function ? function : "");
+    entry->line = line;
+    entry->count = count;
+    entry->next = profile->entries;
+    profile->entries = entry;
+    profile->entry_count++;
+    
+    if (count > profile->max_count) {
+        profile->max_count = count;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Parsing
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static char* trim(char* str) {
+    while (isspace((unsigned char)*str)) str++;
+    
+    char* end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    
+    return str;
+}
+
+/* Splits off the next line of `*cursor` in place; NULL at the end */
+static char* next_line(char** cursor) {
+    char* line = *cursor;
+    if (!line || *line == '\0') return NULL;
+    
+    char* newline = strchr(line, '\n');
+    if (newline) {
+        *newline = '\0';
+        *cursor = newline + 1;
+    } else {
+        *cursor = line + strlen(line);
+    }
+    return line;
+}
+
+static bool parse_count(const char* text, unsigned long long* count) {
+    if (!text || !isdigit((unsigned char)*text)) return false;
+    
+    char* end = NULL;
+    *count = strtoull(text, &end, 10);
+    return end && (*end == '\0' || *end == '*');
+}
+
+static bool parse_line_number(const char* text, int* line) {
+    if (!text || !isdigit((unsigned char)*text)) return false;
+    
+    char* end = NULL;
+    long value = strtol(text, &end, 10);
+    if (!end || *end != '\0' || value < 0) return false;
+    
+    *line = (int)value;
+    return true;
+}
+
+bool profile_parse_text(Profile* profile, const char* text) {
+    if (!profile || !text) return false;
+    
+    char* copy = strdup(text);
+    if (!copy) return false;
+    
+    bool ok = true;
+    char* cursor = copy;
+    
+    for (char* raw = next_line(&cursor); raw; raw = next_line(&cursor)) {
+        char* record = trim(raw);
+        if (*record == '\0' || *record == '#') continue;
+        
+        // function:line:count, split from the right
+        char* count_sep = strrchr(record, ':');
+        if (!count_sep) { ok = false; break; }
+        *count_sep = '\0';
+        
+        char* line_sep = strrchr(record, ':');
+        if (!line_sep) { ok = false; break; }
+        *line_sep = '\0';
+        
+        int line;
+        unsigned long long count;
+        if (!parse_line_number(trim(line_sep + 1), &line) ||
+            !parse_count(trim(count_sep + 1), &count)) {
+            ok = false;
+            break;
+        }
+        
+        profile_add(profile, trim(record), line, count);
+    }
+    
+    free(copy);
+    return ok;
+}
+
+bool profile_parse_gcov(Profile* profile, const char* text) {
+    if (!profile || !text) return false;
+    
+    char* copy = strdup(text);
+    if (!copy) return false;
+    
+    char function[256] = "";
+    char* cursor = copy;
+    
+    for (char* raw = next_line(&cursor); raw; raw = next_line(&cursor)) {
+        // "function NAME called N returned ..." opens a function
+        if (strncmp(raw, "function ", 9) == 0) {
+            unsigned long long calls = 0;
+            if (sscanf(raw, "function %255s called %llu", function, &calls) >= 1) {
+                profile_add(profile, function, 0, calls);
+            }
+            continue;
+        }
+        
+        // "    COUNT:  LINE: source"
+        char* count_sep = strchr(raw, ':');
+        if (!count_sep) continue;
+        char* line_sep = strchr(count_sep + 1, ':');
+        if (!line_sep) continue;
+        
+        *count_sep = '\0';
+        *line_sep = '\0';
+        
+        int line;
+        if (!parse_line_number(trim(count_sep + 1), &line) || line == 0) continue;
+        
+        char* count_text = trim(raw);
+        unsigned long long count;
+        if (strcmp(count_text, "-") == 0) {
+            continue; // Not executable
+        } else if (count_text[0] == '#' || count_text[0] == '=') {
+            count = 0; // ##### / ===== mark lines that never ran
+        } else if (!parse_count(count_text, &count)) {
+            continue;
+        }
+        
+        profile_add(profile, function, line, count);
+    }
+    
+    free(copy);
+    return true;
+}
+
+static bool has_suffix(const char* str, const char* suffix) {
+    size_t len = strlen(str);
+    size_t suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+bool profile_load(Profile* profile, const char* filename) {
+    if (!profile || !filename) return false;
+    
+    // Raw coverage data must be turned into a report by gcov first
+    if (has_suffix(filename, ".gcda")) return false;
+    
+    FILE* file = fopen(filename, "r");
+    if (!file) return false;
+    
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return false;
+    }
+    
+    char* text = malloc(size + 1);
+    if (!text) {
+        fclose(file);
+        return false;
+    }
+    
+    size_t bytes_read = fread(text, 1, size, file);
+    text[bytes_read] = '\0';
+    fclose(file);
+    
+    bool ok = has_suffix(filename, ".gcov") ? profile_parse_gcov(profile, text)
+                                            : profile_parse_text(profile, text);
+    free(text);
+    return ok;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Queries
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Entries without a function name (gcov reports lacking function records)
+ * match by line alone */
+static bool entry_matches(const ProfileEntry* entry, const char* function, int line) {
+    if (entry->line != line) return false;
+    if (!function || entry->function[0] == '\0') return true;
+    return strcmp(entry->function, function) == 0;
+}
+
+unsigned long long profile_line_count(const Profile* profile, const char* function, int line) {
+    if (!profile || line <= 0) return 0;
+    
+    unsigned long long count = 0;
+    for (const ProfileEntry* entry = profile->entries; entry; entry = entry->next) {
+        if (entry_matches(entry, function, line)) {
+            count += entry->count;
+        }
+    }
+    return count;
+}
+
+unsigned long long profile_function_count(const Profile* profile, const char* function, int line) {
+    if (!profile || !function) return 0;
+    
+    // Prefer the recorded entry count; fall back to the declaration line
+    for (const ProfileEntry* entry = profile->entries; entry; entry = entry->next) {
+        if (entry->line == 0 && strcmp(entry->function, function) == 0) {
+            return entry->count;
+        }
+    }
+    return profile_line_count(profile, function, line);
+}
+
+ProfileHotness profile_classify(const Profile* profile, unsigned long long count,
+                                const ObfuscationConfig* config) {
+    if (!profile || !config || profile->max_count == 0 || count == 0) return PROFILE_COLD;
+    
+    double percent = (double)count * 100.0 / (double)profile->max_count;
+    if (percent >= config->profile_hot_percent) return PROFILE_HOT;
+    if (percent >= config->profile_warm_percent) return PROFILE_WARM;
+    return PROFILE_COLD;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * AST Annotation
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int cap_for_hotness(ProfileHotness hotness) {
+    switch (hotness) {
+        case PROFILE_HOT:
+            return OBF_BASIC;          // Identifier renaming only
+        case PROFILE_WARM:
+            return OBF_INTERMEDIATE;   // No flattening or dead code
+        default:
+            return 0;                  // Full configured level
+    }
+}
+
+static void annotate_recursive(const Profile* profile, const ObfuscationConfig* config,
+                               const char* function, ASTNode* node) {
+    for (; node; node = node->next) {
+        unsigned long long count;
+        
+        switch (node->type) {
+            case NODE_PROGRAM:
+                annotate_recursive(profile, config, function, node->data.program.declarations);
+                break;
+            
+            case NODE_FUNCTION:
+                count = profile_function_count(profile, node->data.function.name,
+                                               node->location.line);
+                ast_apply_level_cap(node, cap_for_hotness(profile_classify(profile, count, config)));
+                annotate_recursive(profile, config, node->data.function.name,
+                                   node->data.function.body);
+                break;
+            
+            case NODE_WHILE:
+                count = profile_line_count(profile, function, node->location.line);
+                ast_apply_level_cap(node, cap_for_hotness(profile_classify(profile, count, config)));
+                annotate_recursive(profile, config, function, node->data.while_stmt.body);
+                break;
+            
+            case NODE_FOR:
+                count = profile_line_count(profile, function, node->location.line);
+                ast_apply_level_cap(node, cap_for_hotness(profile_classify(profile, count, config)));
+                annotate_recursive(profile, config, function, node->data.for_stmt.body);
+                break;
+            
+            case NODE_IF:
+                annotate_recursive(profile, config, function, node->data.if_stmt.then_stmt);
+                annotate_recursive(profile, config, function, node->data.if_stmt.else_stmt);
+                break;
+            
+            case NODE_BLOCK:
+                annotate_recursive(profile, config, function, node->data.block.statements);
+                break;
+            
+            default:
+                break;
+        }
+    }
+}
+
+void profile_annotate(const Profile* profile, const ObfuscationConfig* config, ASTNode* ast) {
+    if (!profile || !config || !ast) return;
+    
+    annotate_recursive(profile, config, NULL, ast);
+    ast_propagate_level_caps(ast);
+}
@@ -0,0 +1,55 @@
+#ifndef ANALYSIS_PROFILE_H
+#define ANALYSIS_PROFILE_H
+
+#include "../common/types.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Execution Profiles for Profile-Guided Obfuscation
+ *
+ * Two text formats are accepted:
+ *   - `function:line:count` records, one per line (e.g. aggregated from
+ *     `perf script`); line 0 carries the function's entry count
+ *   - `.gcov` reports as written by `gcov` from `.gcda` coverage data
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Execution count for one source line of a function */
+typedef struct ProfileEntry {
+    char* function;
+    int line;
+    unsigned long long count;
+    struct ProfileEntry* next;
+} ProfileEntry;
+
+typedef struct {
+    ProfileEntry* entries;
+    unsigned long long max_count;
+    int entry_count;
+} Profile;
+
+/* Hotness classes */
+typedef enum {
+    PROFILE_COLD,
+    PROFILE_WARM,
+    PROFILE_HOT
+} ProfileHotness;
+
+/* Profile Management */
+Profile* profile_create(void);
+void profile_destroy(Profile* profile);
+void profile_add(Profile* profile, const char* function, int line, unsigned long long count);
+
+/* Loading */
+bool profile_load(Profile* profile, const char* filename);
+bool profile_parse_text(Profile* profile, const char* text);
+bool profile_parse_gcov(Profile* profile, const char* text);
+
+/* Queries */
+unsigned long long profile_line_count(const Profile* profile, const char* function, int line);
+unsigned long long profile_function_count(const Profile* profile, const char* function, int line);
+ProfileHotness profile_classify(const Profile* profile, unsigned long long count,
+                                const ObfuscationConfig* config);
+
+/* Caps function bodies and loops by their hotness */
+void profile_annotate(const Profile* profile, const ObfuscationConfig* config, ASTNode* ast);
+
+#endif /* ANALYSIS_PROFILE_H */
@@ -0,0 +1,405 @@
+#include "typing.h"
+#include "../obfuscator/ast_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Declared Types
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const char* const int_types[] = {
+    "int", "signed", "signed int",
+    "short", "short int", "signed short", "signed short int",
+    "unsigned short", "unsigned short int",
+    "char", "signed char", "unsigned char",
+    "_Bool", "bool",
+};
+
+/* Qualifiers and storage classes that don't change the value's type */
+static const char* const ignored_words[] = {
+    "const", "volatile", "static", "register", "extern", "auto", "inline",
+};
+
+static bool is_ignored_word(const char* word, size_t length) {
+    for (size_t i = 0; i < sizeof(ignored_words) / sizeof(ignored_words[0]); i++) {
+        if (strlen(ignored_words[i]) == length && strncmp(word, ignored_words[i], length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Copies `type` into `out` with qualifiers dropped and words single-spaced */
+static bool normalize_type(const char* type, char* out, size_t size) {
+    if (!type) return false;
+    
+    size_t used = 0;
+    const char* p = type;
+    while (*p) {
+        if (*p == ' ' || *p == '\t') {
+            p++;
+            continue;
+        }
+        
+        const char* word = p;
+        if (*p == '*') {
+            p++;
+        } else {
+            while (*p && *p != ' ' && *p != '\t' && *p != '*') p++;
+        }
+        size_t length = (size_t)(p - word);
+        if (is_ignored_word(word, length)) continue;
+        
+        bool space = used > 0 && *word != '*';
+        if (used + length + (space ? 1 : 0) + 1 > size) return false;
+        if (space) out[used++] = ' ';
+        memcpy(out + used, word, length);
+        used += length;
+    }
+    
+    out[used] = '\0';
+    return used > 0;
+}
+
+static bool is_int_name(const char* name) {
+    for (size_t i = 0; i < sizeof(int_types) / sizeof(int_types[0]); i++) {
+        if (strcmp(name, int_types[i]) == 0) return true;
+    }
+    return false;
+}
+
+bool typing_is_int_type(const char* type) {
+    char name[64];
+    return normalize_type(type, name, sizeof(name)) && is_int_name(name);
+}
+
+/* `int*` and the like: subscripting yields an int */
+static bool is_int_pointer_type(const char* type) {
+    char name[64];
+    if (!normalize_type(type, name, sizeof(name))) return false;
+    
+    size_t length = strlen(name);
+    if (length < 2 || name[length - 1] != '*') return false;
+    name[length - 1] = '\0';
+    return is_int_name(name);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Scopes
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    const char* name;
+    const char* type;        /* NULL = unknown (e.g. __auto_type of a non-int) */
+    bool is_function;
+    int depth;
+} Binding;
+
+typedef struct {
+    Binding* bindings;
+    int count;
+    int capacity;
+    int depth;
+} TypingWalk;
+
+static void bind(TypingWalk* walk, const char* name, const char* type, bool is_function) {
+    if (!name) return;
+    
+    if (walk->count == walk->capacity) {
+        int capacity = walk->capacity ? walk->capacity * 2 : 32;
+        Binding* bindings = realloc(walk->bindings, (size_t)capacity * sizeof(Binding));
+        if (!bindings) return;
+        walk->bindings = bindings;
+        walk->capacity = capacity;
+    }
+    
+    walk->bindings[walk->count++] = (Binding){ name, type, is_function, walk->depth };
+}
+
+static const Binding* lookup(const TypingWalk* walk, const char* name) {
+    if (!name) return NULL;
+    
+    // Innermost declaration wins
+    for (int i = walk->count - 1; i >= 0; i--) {
+        if (strcmp(walk->bindings[i].name, name) == 0) return &walk->bindings[i];
+    }
+    return NULL;
+}
+
+static void enter_scope(TypingWalk* walk) {
+    walk->depth++;
+}
+
+static void leave_scope(TypingWalk* walk) {
+    while (walk->count > 0 && walk->bindings[walk->count - 1].depth == walk->depth) {
+        walk->count--;
+    }
+    walk->depth--;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Expressions
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void walk_statement(TypingWalk* walk, ASTNode* node);
+static bool walk_expression(TypingWalk* walk, ASTNode* node);
+
+static bool op_is(const char* op, const char* expected) {
+    return op && strcmp(op, expected) == 0;
+}
+
+static bool is_assignment_operator(const char* op) {
+    if (!op) return false;
+    
+    size_t length = strlen(op);
+    if (length == 0 || op[length - 1] != '=') return false;
+    return !op_is(op, "==") && !op_is(op, "!=") && !op_is(op, "<=") && !op_is(op, ">=");
+}
+
+/* Comparisons and logical operators yield int whatever their operands */
+static bool yields_int(const char* op) {
+    return op_is(op, "==") || op_is(op, "!=") || op_is(op, "<") || op_is(op, ">") ||
+           op_is(op, "<=") || op_is(op, ">=") || op_is(op, "&&") || op_is(op, "||");
+}
+
+static bool subscript_is_int(const TypingWalk* walk, const ASTNode* base) {
+    if (!base || base->type != NODE_IDENTIFIER) return false;
+    
+    const Binding* binding = lookup(walk, base->data.identifier.name);
+    return binding && !binding->is_function && is_int_pointer_type(binding->type);
+}
+
+static bool type_binary(TypingWalk* walk, ASTNode* node) {
+    const char* op = node->data.binary.operator;
+    ASTNode* left = node->data.binary.left;
+    ASTNode* right = node->data.binary.right;
+    
+    bool left_int = walk_expression(walk, left);
+    bool right_int = walk_expression(walk, right);
+    
+    if (node->type == NODE_ARRAY_ACCESS || op_is(op, "[]")) {
+        return subscript_is_int(walk, left);
+    }
+    if (op_is(op, "?:")) {
+        // The else branch follows the then branch
+        bool else_int = right && walk_expression(walk, right->next);
+        return right_int && else_int;
+    }
+    if (op_is(op, ",")) return right_int;
+    if (node->type == NODE_ASSIGNMENT || is_assignment_operator(op)) return left_int;
+    if (yields_int(op)) return true;
+    if (op_is(op, "<<") || op_is(op, ">>")) return left_int;
+    if (op_is(op, "+") || op_is(op, "-") || op_is(op, "*") || op_is(op, "/") ||
+        op_is(op, "%") || op_is(op, "&") || op_is(op, "|") || op_is(op, "^")) {
+        return left_int && right_int;
+    }
+    return false;
+}
+
+static bool type_unary(TypingWalk* walk, ASTNode* node) {
+    const char* op = node->data.unary.operator;
+    bool operand_int = walk_expression(walk, node->data.unary.operand);
+    
+    if (!op) return false;
+    if (op[0] == '(') {
+        // Cast: "(type)"
+        char type[64];
+        size_t length = strlen(op);
+        if (length < 3 || length - 2 >= sizeof(type)) return false;
+        memcpy(type, op + 1, length - 2);
+        type[length - 2] = '\0';
+        return typing_is_int_type(type);
+    }
+    if (op_is(op, "!")) return true;
+    if (op_is(op, "-") || op_is(op, "+") || op_is(op, "~") ||
+        op_is(op, "++") || op_is(op, "--")) {
+        return operand_int;
+    }
+    
+    // Address-of and dereference produce or consume pointers
+    return false;
+}
+
+static bool type_call(TypingWalk* walk, ASTNode* node) {
+    ASTNode* callee = node->data.call.function;
+    
+    walk_expression(walk, callee);
+    for (ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+        walk_expression(walk, arg);
+    }
+    
+    if (!callee || callee->type != NODE_IDENTIFIER) return false;
+    
+    const Binding* binding = lookup(walk, callee->data.identifier.name);
+    return binding && binding->is_function && typing_is_int_type(binding->type);
+}
+
+static bool type_stmt_expr(TypingWalk* walk, ASTNode* node) {
+    ASTNode* last = NULL;
+    
+    enter_scope(walk);
+    for (ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+        walk_statement(walk, stmt);
+        last = stmt;
+    }
+    leave_scope(walk);
+    
+    // The value is the last statement's
+    return last && (last->flags & AST_FLAG_INT);
+}
+
+static bool walk_expression(TypingWalk* walk, ASTNode* node) {
+    if (!node) return false;
+    
+    bool is_int = false;
+    switch (node->type) {
+        case NODE_LITERAL:
+            is_int = ast_is_int_literal(node);
+            break;
+        
+        case NODE_IDENTIFIER: {
+            const Binding* binding = lookup(walk, node->data.identifier.name);
+            is_int = binding && !binding->is_function && typing_is_int_type(binding->type);
+            break;
+        }
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            is_int = type_binary(walk, node);
+            break;
+        
+        case NODE_UNARY_OP:
+            is_int = type_unary(walk, node);
+            break;
+        
+        case NODE_CALL:
+            is_int = type_call(walk, node);
+            break;
+        
+        case NODE_STMT_EXPR:
+            is_int = type_stmt_expr(walk, node);
+            break;
+        
+        default:
+            // sizeof yields size_t; member access needs struct layouts
+            break;
+    }
+    
+    if (is_int) {
+        node->flags |= AST_FLAG_INT;
+    } else {
+        node->flags &= ~AST_FLAG_INT;
+    }
+    return is_int;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Statements
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void walk_statements(TypingWalk* walk, ASTNode* list) {
+    for (; list; list = list->next) {
+        walk_statement(walk, list);
+    }
+}
+
+static void walk_variable(TypingWalk* walk, ASTNode* node) {
+    const char* type = node->data.variable.type;
+    
+    // __auto_type takes the initializer's type, known only once it is typed
+    if (type && strcmp(type, "__auto_type") == 0) {
+        bool is_int = walk_expression(walk, node->data.variable.initializer);
+        bind(walk, node->data.variable.name, is_int ? "int" : NULL, false);
+        return;
+    }
+    
+    bind(walk, node->data.variable.name, type, false);
+    walk_expression(walk, node->data.variable.initializer);
+}
+
+static void walk_function(TypingWalk* walk, ASTNode* node) {
+    // Bound first so recursive calls see the return type
+    bind(walk, node->data.function.name, node->data.function.return_type, true);
+    
+    enter_scope(walk);
+    for (ASTNode* param = node->data.function.parameters; param; param = param->next) {
+        bind(walk, param->data.variable.name, param->data.variable.type, false);
+    }
+    walk_statement(walk, node->data.function.body);
+    leave_scope(walk);
+}
+
+static void walk_statement(TypingWalk* walk, ASTNode* node) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            walk_statements(walk, node->data.program.declarations);
+            break;
+        
+        case NODE_FUNCTION:
+            walk_function(walk, node);
+            break;
+        
+        case NODE_VARIABLE:
+            walk_variable(walk, node);
+            break;
+        
+        case NODE_BLOCK:
+            enter_scope(walk);
+            walk_statements(walk, node->data.block.statements);
+            leave_scope(walk);
+            break;
+        
+        case NODE_IF:
+            walk_expression(walk, node->data.if_stmt.condition);
+            walk_statement(walk, node->data.if_stmt.then_stmt);
+            walk_statement(walk, node->data.if_stmt.else_stmt);
+            break;
+        
+        case NODE_WHILE:
+            walk_expression(walk, node->data.while_stmt.condition);
+            walk_statement(walk, node->data.while_stmt.body);
+            break;
+        
+        case NODE_FOR:
+            enter_scope(walk);
+            walk_statement(walk, node->data.for_stmt.init);
+            walk_expression(walk, node->data.for_stmt.condition);
+            walk_expression(walk, node->data.for_stmt.update);
+            walk_statement(walk, node->data.for_stmt.body);
+            leave_scope(walk);
+            break;
+        
+        case NODE_SWITCH:
+            walk_expression(walk, node->data.switch_stmt.expression);
+            enter_scope(walk);
+            for (ASTNode* c = node->data.switch_stmt.cases; c; c = c->next) {
+                walk_expression(walk, c->data.case_stmt.value);
+                walk_statements(walk, c->data.case_stmt.statements);
+            }
+            leave_scope(walk);
+            break;
+        
+        case NODE_GOTO:
+            walk_expression(walk, node->data.jump.target);
+            break;
+        
+        default:
+            // Expression statements
+            walk_expression(walk, node);
+            break;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Entry Point
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void typing_annotate(ASTNode* ast) {
+    TypingWalk walk = { NULL, 0, 0, 0 };
+    
+    walk_statements(&walk, ast);
+    free(walk.bindings);
+}
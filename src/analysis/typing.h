@@ -0,0 +1,22 @@
+#ifndef ANALYSIS_TYPING_H
+#define ANALYSIS_TYPING_H
+
+#include "../common/types.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Integer Typing
+ *
+ * Marks every expression whose type after the integer promotions is int with
+ * AST_FLAG_INT, working from the declared types of the variables, parameters
+ * and functions in scope. An identifier without a visible declaration, or a
+ * call to a function without one, has an unknown type and is never marked,
+ * so rewrites that rely on int arithmetic leave it alone.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Clears and recomputes AST_FLAG_INT over a program or fragment */
+void typing_annotate(ASTNode* ast);
+
+/* Declared types that promote to int: char, short, int and _Bool */
+bool typing_is_int_type(const char* type);
+
+#endif /* ANALYSIS_TYPING_H */
@@ -1,4 +1,6 @@
 #include "codegen.h"
+#include <errno.h>
+#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,7 +9,7 @@
  * ASCII Art and Aesthetic Elements
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static const char* ascii_art_header = 
+static const char ascii_art_header[] = 
 "/* ═══════════════════════════════════════════════════════════════════════════\n"
 " *     ╔═══════════════════════════════════════════════════════════════╗\n"
 " *     ║                    OBFUSCATED C CODE                         ║\n"
@@ -15,7 +17,7 @@ static const char* ascii_art_header =
 " *     ╚═══════════════════════════════════════════════════════════════╝\n"
 " * ═══════════════════════════════════════════════════════════════════════════ */\n\n";
 
-static const char* separator_line = 
+static const char separator_line[] = 
 "/* ═══════════════════════════════════════════════════════════════════════════ */\n";
 
 static const char* aesthetic_comments[] = {
@@ -35,18 +37,20 @@ CodeGenState* codegen_create(CodeGenConfig* config) {
     if (!gen) return NULL;
     
     gen->config = config;
-    gen->buffer_size = 65536; // Start with 64KB
-    gen->output_buffer = malloc(gen->buffer_size);
+    gen->output_buffer = NULL; // Allocated on the first write
+    gen->buffer_size = 0;
     gen->buffer_pos = 0;
+    gen->sink = NULL;
+    gen->sink_user = NULL;
+    gen->flushed = 0;
+    gen->sink_failed = false;
+    gen->failed = false;
     gen->indent_level = 0;
     gen->errors = NULL;
+    gen->prologue = NULL;
+    gen->comment_index = 0;
+    random_seed(&gen->random, config ? config->seed : 0);
     
-    if (!gen->output_buffer) {
-        free(gen);
-        return NULL;
-    }
-    
-    gen->output_buffer[0] = '\0';
     return gen;
 }
 
@@ -54,6 +58,7 @@ void codegen_destroy(CodeGenState* gen) {
     if (!gen) return;
     
     free(gen->output_buffer);
+    free(gen->prologue);
     // TODO: Free error list
     free(gen);
 }
@@ -70,37 +75,83 @@ Error* codegen_get_errors(const CodeGenState* gen) {
  * Output Buffer Management
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static void ensure_buffer_capacity(CodeGenState* gen, size_t additional_size) {
-    if (gen->buffer_pos + additional_size >= gen->buffer_size) {
-        size_t new_size = gen->buffer_size * 2;
-        while (new_size < gen->buffer_pos + additional_size) {
-            new_size *= 2;
+/* Hands the buffered output to the sink and empties the buffer */
+static bool flush_buffer(CodeGenState* gen) {
+    if (gen->sink_failed) return false;
+    if (gen->buffer_pos == 0) return true;
+    
+    if (!gen->sink(gen->output_buffer, gen->buffer_pos, gen->sink_user)) {
+        gen->sink_failed = true;
+        return false;
+    }
+    gen->flushed += gen->buffer_pos;
+    gen->buffer_pos = 0;
+    return true;
+}
+
+/* Room for `additional` more bytes; false (and nothing written) when the
+ * buffer can neither be flushed nor grow. A failure sticks for the rest
+ * of the run, so later small writes can't leave a gap in the output. */
+static bool ensure_buffer_capacity(CodeGenState* gen, size_t additional_size) {
+    if (gen->failed) return false;
+    if (gen->buffer_pos + additional_size <= gen->buffer_size) return true;
+    
+    // While streaming, a full chunk goes out instead of the buffer growing
+    if (gen->sink) {
+        if (!flush_buffer(gen)) {
+            gen->failed = true;
+            return false;
         }
-        
-        char* new_buffer = realloc(gen->output_buffer, new_size);
-        if (new_buffer) {
-            gen->output_buffer = new_buffer;
-            gen->buffer_size = new_size;
+        if (additional_size <= gen->buffer_size) return true;
+    }
+    
+    size_t new_size = gen->buffer_size ? gen->buffer_size * 2 : CODEGEN_CHUNK_SIZE;
+    while (new_size < gen->buffer_pos + additional_size) {
+        new_size *= 2;
+    }
+    
+    char* new_buffer = realloc(gen->output_buffer, new_size);
+    if (!new_buffer) {
+        gen->failed = true;
+        return false;
+    }
+    
+    gen->output_buffer = new_buffer;
+    gen->buffer_size = new_size;
+    return true;
+}
+
+/* The buffer is only NUL-terminated once generate_code hands it out */
+void codegen_write_n(CodeGenState* gen, const char* str, size_t length) {
+    if (!gen || !str || gen->failed) return;
+    
+    // Streaming, a fragment as large as a chunk skips the buffer
+    if (gen->sink && length >= CODEGEN_CHUNK_SIZE) {
+        if (!flush_buffer(gen)) return;
+        if (!gen->sink(str, length, gen->sink_user)) {
+            gen->sink_failed = true;
+            return;
         }
+        gen->flushed += length;
+        return;
     }
+    
+    if (!ensure_buffer_capacity(gen, length)) return;
+    
+    memcpy(gen->output_buffer + gen->buffer_pos, str, length);
+    gen->buffer_pos += length;
 }
 
 void codegen_write(CodeGenState* gen, const char* str) {
-    if (!gen || !str) return;
-    
-    size_t len = strlen(str);
-    ensure_buffer_capacity(gen, len + 1);
+    if (!str) return;
     
-    strcpy(gen->output_buffer + gen->buffer_pos, str);
-    gen->buffer_pos += len;
+    codegen_write_n(gen, str, strlen(str));
 }
 
 void codegen_write_char(CodeGenState* gen, char c) {
-    if (!gen) return;
+    if (!gen || !ensure_buffer_capacity(gen, 1)) return;
     
-    ensure_buffer_capacity(gen, 2);
     gen->output_buffer[gen->buffer_pos++] = c;
-    gen->output_buffer[gen->buffer_pos] = '\0';
 }
 
 void codegen_write_line(CodeGenState* gen, const char* str) {
@@ -112,17 +163,22 @@ void codegen_newline(CodeGenState* gen) {
     codegen_write_char(gen, '\n');
 }
 
+#define INDENT_RUN 64
+
 void codegen_indent(CodeGenState* gen) {
     if (!gen) return;
     
-    for (int i = 0; i < gen->indent_level; i++) {
-        if (gen->config && gen->config->indent_size > 0) {
-            for (int j = 0; j < gen->config->indent_size; j++) {
-                codegen_write_char(gen, ' ');
-            }
-        } else {
-            codegen_write(gen, "    "); // Default 4 spaces
-        }
+    static const char spaces[INDENT_RUN + 1] =
+        "                                                                ";
+    
+    int indent_size = gen->config && gen->config->indent_size > 0 ? gen->config->indent_size : 4;
+    size_t width = (size_t)gen->indent_level * (size_t)indent_size;
+    
+    // One copy per run; only nesting past INDENT_RUN columns takes more
+    while (width > 0) {
+        size_t run = width < INDENT_RUN ? width : INDENT_RUN;
+        codegen_write_n(gen, spaces, run);
+        width -= run;
     }
 }
 
@@ -134,24 +190,23 @@ void generate_ascii_art_header(CodeGenState* gen, const char* title) {
     if (!gen) return;
     
     if (gen->config && gen->config->add_comments) {
-        codegen_write(gen, ascii_art_header);
+        codegen_write_literal(gen, ascii_art_header);
     }
 }
 
 void generate_aesthetic_comment(CodeGenState* gen, const char* text) {
     if (!gen || !gen->config || !gen->config->add_comments) return;
     
-    static int comment_index = 0;
     int aesthetic_count = 0;
     while (aesthetic_comments[aesthetic_count]) aesthetic_count++;
     
     if (text) {
-        codegen_write(gen, "/* ");
+        codegen_write_literal(gen, "/* ");
         codegen_write(gen, text);
-        codegen_write(gen, " */");
+        codegen_write_literal(gen, " */");
     } else {
-        codegen_write(gen, aesthetic_comments[comment_index % aesthetic_count]);
-        comment_index++;
+        codegen_write(gen, aesthetic_comments[gen->comment_index % aesthetic_count]);
+        gen->comment_index++;
     }
     codegen_newline(gen);
 }
@@ -159,7 +214,7 @@ void generate_aesthetic_comment(CodeGenState* gen, const char* text) {
 void add_visual_separators(CodeGenState* gen) {
     if (!gen || !gen->config || !gen->config->add_comments) return;
     
-    codegen_write(gen, separator_line);
+    codegen_write_literal(gen, separator_line);
 }
 
 void apply_creative_formatting(CodeGenState* gen, ASTNode* node) {
@@ -171,15 +226,15 @@ void apply_creative_formatting(CodeGenState* gen, ASTNode* node) {
                 generate_aesthetic_comment(gen, NULL);
             }
             break;
-            
+        
         case AESTHETIC_CHAOTIC:
             // Add random spacing and comments
-            if (rand() % 3 == 0) {
+            if (random_below(&gen->random, 3) == 0) {
                 codegen_newline(gen);
                 generate_aesthetic_comment(gen, "/* chaos */");
             }
             break;
-            
+        
         default:
             break;
     }
@@ -189,6 +244,18 @@ void apply_creative_formatting(CodeGenState* gen, ASTNode* node) {
  * AST Node Code Generation
  * ═══════════════════════════════════════════════════════════════════════════ */
 
+/* Operands that are themselves operations are always parenthesized so the
+ * emitted text keeps the tree's grouping regardless of C precedence */
+static void generate_operand(CodeGenState* gen, ASTNode* node) {
+    if (!node) return;
+    
+    bool needs_parens = (node->type == NODE_BINARY_OP || node->type == NODE_ASSIGNMENT);
+    
+    if (needs_parens) codegen_write_char(gen, '(');
+    generate_expression(gen, node);
+    if (needs_parens) codegen_write_char(gen, ')');
+}
+
 void generate_expression(CodeGenState* gen, ASTNode* node) {
     if (!gen || !node) return;
     
@@ -196,17 +263,23 @@ void generate_expression(CodeGenState* gen, ASTNode* node) {
         case NODE_LITERAL:
             codegen_write(gen, node->data.literal.value);
             break;
-            
+        
         case NODE_IDENTIFIER:
             codegen_write(gen, node->data.identifier.name);
             break;
-            
+        
         case NODE_BINARY_OP: {
-            bool needs_parens = (node->data.binary.left->type == NODE_BINARY_OP ||
-                               node->data.binary.right->type == NODE_BINARY_OP);
+            // Ternaries chain the else branch after the then branch
+            if (strcmp(node->data.binary.operator, "?:") == 0 && node->data.binary.right) {
+                generate_operand(gen, node->data.binary.left);
+                codegen_write_literal(gen, " ? ");
+                generate_operand(gen, node->data.binary.right);
+                codegen_write_literal(gen, " : ");
+                generate_operand(gen, node->data.binary.right->next);
+                break;
+            }
             
-            if (needs_parens) codegen_write_char(gen, '(');
-            generate_expression(gen, node->data.binary.left);
+            generate_operand(gen, node->data.binary.left);
             
             // Add spacing around operators for readability
             if (gen->config && gen->config->pretty_print) {
@@ -219,21 +292,20 @@ void generate_expression(CodeGenState* gen, ASTNode* node) {
                 codegen_write_char(gen, ' ');
             }
             
-            generate_expression(gen, node->data.binary.right);
-            if (needs_parens) codegen_write_char(gen, ')');
+            generate_operand(gen, node->data.binary.right);
             break;
         }
         
         case NODE_UNARY_OP:
             if (node->data.unary.is_prefix) {
                 codegen_write(gen, node->data.unary.operator);
-                generate_expression(gen, node->data.unary.operand);
+                generate_operand(gen, node->data.unary.operand);
             } else {
-                generate_expression(gen, node->data.unary.operand);
+                generate_operand(gen, node->data.unary.operand);
                 codegen_write(gen, node->data.unary.operator);
             }
             break;
-            
+        
         case NODE_CALL:
             generate_expression(gen, node->data.call.function);
             codegen_write_char(gen, '(');
@@ -242,35 +314,69 @@ void generate_expression(CodeGenState* gen, ASTNode* node) {
             while (arg) {
                 generate_expression(gen, arg);
                 if (arg->next) {
-                    codegen_write(gen, ", ");
+                    codegen_write_literal(gen, ", ");
                 }
                 arg = arg->next;
             }
             
             codegen_write_char(gen, ')');
             break;
-            
+        
         case NODE_ASSIGNMENT:
             generate_expression(gen, node->data.binary.left);
-            codegen_write(gen, " = ");
+            codegen_write_literal(gen, " = ");
+            generate_expression(gen, node->data.binary.right);
+            break;
+        
+        case NODE_ARRAY_ACCESS:
+            generate_operand(gen, node->data.binary.left);
+            codegen_write_char(gen, '[');
             generate_expression(gen, node->data.binary.right);
+            codegen_write_char(gen, ']');
             break;
+        
+        case NODE_STMT_EXPR: {
+            // GNU statement expression: the last statement is the value
+            codegen_write_literal(gen, "({ ");
+            
+            ASTNode* stmt = node->data.block.statements;
+            while (stmt) {
+                if (stmt->type == NODE_VARIABLE) {
+                    codegen_write(gen, stmt->data.variable.type);
+                    codegen_write_char(gen, ' ');
+                    codegen_write(gen, stmt->data.variable.name);
+                    if (stmt->data.variable.initializer) {
+                        codegen_write_literal(gen, " = ");
+                        generate_expression(gen, stmt->data.variable.initializer);
+                    }
+                } else {
+                    generate_expression(gen, stmt);
+                }
+                codegen_write_literal(gen, "; ");
+                stmt = stmt->next;
+            }
             
+            codegen_write_literal(gen, "})");
+            break;
+        }
+        
         default:
             // Handle other expression types
             break;
     }
 }
 
+static void generate_declarator(CodeGenState* gen, ASTNode* node);
+
 void generate_statement(CodeGenState* gen, ASTNode* node) {
     if (!gen || !node) return;
     
     switch (node->type) {
         case NODE_IF:
             codegen_indent(gen);
-            codegen_write(gen, "if (");
+            codegen_write_literal(gen, "if (");
             generate_expression(gen, node->data.if_stmt.condition);
-            codegen_write(gen, ")");
+            codegen_write_literal(gen, ")");
             
             if (gen->config && gen->config->pretty_print) {
                 codegen_write_char(gen, ' ');
@@ -279,16 +385,16 @@ void generate_statement(CodeGenState* gen, ASTNode* node) {
             generate_statement(gen, node->data.if_stmt.then_stmt);
             
             if (node->data.if_stmt.else_stmt) {
-                codegen_write(gen, " else ");
+                codegen_write_literal(gen, " else ");
                 generate_statement(gen, node->data.if_stmt.else_stmt);
             }
             break;
-            
+        
         case NODE_WHILE:
             codegen_indent(gen);
-            codegen_write(gen, "while (");
+            codegen_write_literal(gen, "while (");
             generate_expression(gen, node->data.while_stmt.condition);
-            codegen_write(gen, ")");
+            codegen_write_literal(gen, ")");
             
             if (gen->config && gen->config->pretty_print) {
                 codegen_write_char(gen, ' ');
@@ -296,26 +402,29 @@ void generate_statement(CodeGenState* gen, ASTNode* node) {
             
             generate_statement(gen, node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
             codegen_indent(gen);
-            codegen_write(gen, "for (");
+            codegen_write_literal(gen, "for (");
             
-            if (node->data.for_stmt.init) {
-                generate_statement(gen, node->data.for_stmt.init);
+            // The header supplies the semicolon and stays on one line
+            if (node->data.for_stmt.init && node->data.for_stmt.init->type == NODE_VARIABLE) {
+                generate_declarator(gen, node->data.for_stmt.init);
+            } else if (node->data.for_stmt.init) {
+                generate_expression(gen, node->data.for_stmt.init);
             }
-            codegen_write(gen, "; ");
+            codegen_write_literal(gen, "; ");
             
             if (node->data.for_stmt.condition) {
                 generate_expression(gen, node->data.for_stmt.condition);
             }
-            codegen_write(gen, "; ");
+            codegen_write_literal(gen, "; ");
             
             if (node->data.for_stmt.update) {
                 generate_expression(gen, node->data.for_stmt.update);
             }
             
-            codegen_write(gen, ")");
+            codegen_write_literal(gen, ")");
             
             if (gen->config && gen->config->pretty_print) {
                 codegen_write_char(gen, ' ');
@@ -323,7 +432,7 @@ void generate_statement(CodeGenState* gen, ASTNode* node) {
             
             generate_statement(gen, node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
             codegen_write_char(gen, '{');
             codegen_newline(gen);
@@ -336,16 +445,77 @@ void generate_statement(CodeGenState* gen, ASTNode* node) {
             codegen_write_char(gen, '}');
             codegen_newline(gen);
             break;
+        
+        case NODE_VARIABLE:
+            generate_variable(gen, node);
+            break;
+        
+        case NODE_SWITCH: {
+            codegen_indent(gen);
+            codegen_write_literal(gen, "switch (");
+            generate_expression(gen, node->data.switch_stmt.expression);
+            codegen_write_literal(gen, ") {");
+            codegen_newline(gen);
+            
+            for (ASTNode* c = node->data.switch_stmt.cases; c; c = c->next) {
+                codegen_indent(gen);
+                if (c->data.case_stmt.value) {
+                    codegen_write_literal(gen, "case ");
+                    generate_expression(gen, c->data.case_stmt.value);
+                    codegen_write_char(gen, ':');
+                } else {
+                    codegen_write_literal(gen, "default:");
+                }
+                codegen_newline(gen);
+                
+                gen->indent_level++;
+                for (ASTNode* stmt = c->data.case_stmt.statements; stmt; stmt = stmt->next) {
+                    generate_statement(gen, stmt);
+                }
+                gen->indent_level--;
+            }
             
+            codegen_indent(gen);
+            codegen_write_char(gen, '}');
+            codegen_newline(gen);
+            break;
+        }
+        
+        case NODE_BREAK:
+            codegen_indent(gen);
+            codegen_write_literal(gen, "break;");
+            codegen_newline(gen);
+            break;
+        
+        case NODE_GOTO:
+            codegen_indent(gen);
+            if (node->data.jump.name) {
+                codegen_write_literal(gen, "goto ");
+                codegen_write(gen, node->data.jump.name);
+            } else {
+                codegen_write_literal(gen, "goto *");
+                generate_operand(gen, node->data.jump.target);
+            }
+            codegen_write_char(gen, ';');
+            codegen_newline(gen);
+            break;
+        
+        case NODE_LABEL:
+            // The empty statement lets a label end a block or precede a declaration
+            codegen_write(gen, node->data.jump.name);
+            codegen_write_literal(gen, ": ;");
+            codegen_newline(gen);
+            break;
+        
         case NODE_RETURN:
             codegen_indent(gen);
-            codegen_write(gen, "return");
+            codegen_write_literal(gen, "return");
             
             // TODO: Handle return expression
             codegen_write_char(gen, ';');
             codegen_newline(gen);
             break;
-            
+        
         default:
             // Handle expression statements
             codegen_indent(gen);
@@ -356,18 +526,15 @@ void generate_statement(CodeGenState* gen, ASTNode* node) {
     }
 }
 
-void generate_variable(CodeGenState* gen, ASTNode* node) {
-    if (!gen || !node) return;
-    
-    codegen_indent(gen);
-    
+/* A declaration without indentation or the closing semicolon */
+static void generate_declarator(CodeGenState* gen, ASTNode* node) {
     // Add storage class specifiers
     if (node->data.variable.is_static) {
-        codegen_write(gen, "static ");
+        codegen_write_literal(gen, "static ");
     }
     
     if (node->data.variable.is_const) {
-        codegen_write(gen, "const ");
+        codegen_write_literal(gen, "const ");
     }
     
     // Type
@@ -381,10 +548,16 @@ void generate_variable(CodeGenState* gen, ASTNode* node) {
     
     // Initializer
     if (node->data.variable.initializer) {
-        codegen_write(gen, " = ");
+        codegen_write_literal(gen, " = ");
         generate_expression(gen, node->data.variable.initializer);
     }
+}
+
+void generate_variable(CodeGenState* gen, ASTNode* node) {
+    if (!gen || !node) return;
     
+    codegen_indent(gen);
+    generate_declarator(gen, node);
     codegen_write_char(gen, ';');
     codegen_newline(gen);
 }
@@ -399,7 +572,7 @@ void generate_function(CodeGenState* gen, ASTNode* node) {
     
     // Storage class
     if (node->data.function.is_static) {
-        codegen_write(gen, "static ");
+        codegen_write_literal(gen, "static ");
     }
     
     // Return type
@@ -415,9 +588,9 @@ void generate_function(CodeGenState* gen, ASTNode* node) {
     // Parameters
     ASTNode* param = node->data.function.parameters;
     while (param) {
-        // TODO: Generate parameter
+        generate_declarator(gen, param);
         if (param->next) {
-            codegen_write(gen, ", ");
+            codegen_write_literal(gen, ", ");
         }
         param = param->next;
     }
@@ -462,11 +635,11 @@ void generate_program(CodeGenState* gen, ASTNode* node) {
             case NODE_FUNCTION:
                 generate_function(gen, decl);
                 break;
-                
+            
             case NODE_VARIABLE:
                 generate_variable(gen, decl);
                 break;
-                
+            
             default:
                 generate_statement(gen, decl);
                 break;
@@ -477,33 +650,311 @@ void generate_program(CodeGenState* gen, ASTNode* node) {
 }
 
 /* ═══════════════════════════════════════════════════════════════════════════
- * Main Code Generation Interface
+ * Output Size Estimation
+ *
+ * Mirrors the generators above, counting the longest text each node can
+ * produce rather than producing it, so the estimate is an upper bound
+ * that is reached when every optional space and parenthesis is emitted.
+ * It is still an estimate: a node kind the generators learn to print
+ * counts as nothing until it is added here, and generate_code then grows
+ * its buffer past the estimate instead of failing.
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-char* generate_code(CodeGenState* gen, ASTNode* ast) {
-    if (!gen || !ast) return NULL;
+static size_t text_length(const char* text) {
+    return text ? strlen(text) : 0;
+}
+
+static size_t estimate_expression(const ASTNode* node);
+
+/* Operands may be parenthesized */
+static size_t estimate_operand(const ASTNode* node) {
+    return node ? estimate_expression(node) + 2 : 0;
+}
+
+static size_t estimate_expression(const ASTNode* node) {
+    if (!node) return 0;
+    
+    switch (node->type) {
+        case NODE_LITERAL:
+            return text_length(node->data.literal.value);
+        
+        case NODE_IDENTIFIER:
+            return text_length(node->data.identifier.name);
+        
+        case NODE_BINARY_OP:
+            if (strcmp(node->data.binary.operator, "?:") == 0 && node->data.binary.right) {
+                return estimate_operand(node->data.binary.left) + 3 +
+                       estimate_operand(node->data.binary.right) + 3 +
+                       estimate_operand(node->data.binary.right->next);
+            }
+            return estimate_operand(node->data.binary.left) + 2 +
+                   text_length(node->data.binary.operator) +
+                   estimate_operand(node->data.binary.right);
+        
+        case NODE_UNARY_OP:
+            return text_length(node->data.unary.operator) +
+                   estimate_operand(node->data.unary.operand);
+        
+        case NODE_CALL: {
+            size_t size = estimate_expression(node->data.call.function) + 2;
+            for (const ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                size += estimate_expression(arg) + 2;
+            }
+            return size;
+        }
+        
+        case NODE_ASSIGNMENT:
+            return estimate_expression(node->data.binary.left) + 3 +
+                   estimate_expression(node->data.binary.right);
+        
+        case NODE_ARRAY_ACCESS:
+            return estimate_operand(node->data.binary.left) + 2 +
+                   estimate_expression(node->data.binary.right);
+        
+        case NODE_STMT_EXPR: {
+            size_t size = 5;
+            for (const ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+                if (stmt->type == NODE_VARIABLE) {
+                    size += text_length(stmt->data.variable.type) + 1 +
+                            text_length(stmt->data.variable.name) + 3 +
+                            estimate_expression(stmt->data.variable.initializer);
+                } else {
+                    size += estimate_expression(stmt);
+                }
+                size += 2;
+            }
+            return size;
+        }
+        
+        // Casts are unary nodes ("(type)" operator) and counted above; the
+        // generator prints nothing for these yet
+        case NODE_CAST:
+        case NODE_MEMBER_ACCESS:
+        case NODE_SIZEOF:
+            return 0;
+        
+        default:
+            return 0;
+    }
+}
+
+static size_t estimate_statement(const CodeGenState* gen, const ASTNode* node, int depth);
+
+static size_t estimate_statements(const CodeGenState* gen, const ASTNode* node, int depth) {
+    size_t size = 0;
+    for (; node; node = node->next) {
+        size += estimate_statement(gen, node, depth);
+    }
+    return size;
+}
+
+static size_t estimate_statement(const CodeGenState* gen, const ASTNode* node, int depth) {
+    if (!node) return 0;
+    
+    int indent_size = gen->config && gen->config->indent_size > 0 ? gen->config->indent_size : 4;
+    size_t indent = (size_t)depth * (size_t)indent_size;
+    
+    switch (node->type) {
+        case NODE_IF:
+            return indent + 6 + estimate_expression(node->data.if_stmt.condition) +
+                   estimate_statement(gen, node->data.if_stmt.then_stmt, depth) +
+                   (node->data.if_stmt.else_stmt
+                        ? 6 + estimate_statement(gen, node->data.if_stmt.else_stmt, depth) : 0);
+        
+        case NODE_WHILE:
+            return indent + 9 + estimate_expression(node->data.while_stmt.condition) +
+                   estimate_statement(gen, node->data.while_stmt.body, depth);
+        
+        case NODE_FOR:
+            return indent + 11 + estimate_statement(gen, node->data.for_stmt.init, depth) +
+                   estimate_expression(node->data.for_stmt.condition) +
+                   estimate_expression(node->data.for_stmt.update) +
+                   estimate_statement(gen, node->data.for_stmt.body, depth);
+        
+        case NODE_BLOCK:
+            return 2 + estimate_statements(gen, node->data.block.statements, depth + 1) +
+                   indent + 2;
+        
+        case NODE_VARIABLE:
+            return indent + 13 + text_length(node->data.variable.type) + 1 +
+                   text_length(node->data.variable.name) + 3 +
+                   estimate_expression(node->data.variable.initializer) + 2;
+        
+        case NODE_SWITCH: {
+            size_t size = indent + 12 + estimate_expression(node->data.switch_stmt.expression);
+            for (const ASTNode* c = node->data.switch_stmt.cases; c; c = c->next) {
+                size_t label = c->data.case_stmt.value
+                    ? 6 + estimate_expression(c->data.case_stmt.value) : 8;
+                size += indent + label + 1 +
+                        estimate_statements(gen, c->data.case_stmt.statements, depth + 1);
+            }
+            return size + indent + 2;
+        }
+        
+        case NODE_BREAK:
+            return indent + 7;
+        
+        case NODE_GOTO:
+            return indent + 8 + (node->data.jump.name
+                                     ? text_length(node->data.jump.name)
+                                     : estimate_operand(node->data.jump.target));
+        
+        case NODE_LABEL:
+            return text_length(node->data.jump.name) + 4;
+        
+        case NODE_RETURN:
+            return indent + 8;
+        
+        default:
+            return indent + estimate_expression(node) + 2;
+    }
+}
+
+static size_t longest_aesthetic_comment(void) {
+    // The chaotic style wraps "/* chaos */" in a comment of its own
+    size_t longest = strlen("/* /* chaos */ */");
+    for (int i = 0; aesthetic_comments[i]; i++) {
+        size_t length = strlen(aesthetic_comments[i]);
+        if (length > longest) longest = length;
+    }
+    return longest;
+}
+
+static size_t estimate_function(const CodeGenState* gen, const ASTNode* node, int depth) {
+    int indent_size = gen->config && gen->config->indent_size > 0 ? gen->config->indent_size : 4;
+    size_t size = (size_t)depth * (size_t)indent_size + 7 +
+                  text_length(node->data.function.return_type) + 1 +
+                  text_length(node->data.function.name) + 3;
+    
+    // Creative formatting: a blank line, then a comment on a line of its own
+    size += 1;
+    if (gen->config && gen->config->add_comments) {
+        size += longest_aesthetic_comment() + 1;
+    }
+    for (const ASTNode* param = node->data.function.parameters; param; param = param->next) {
+        size += 2 + 13 + text_length(param->data.variable.type) + 1 +
+                text_length(param->data.variable.name);
+    }
+    
+    size += node->data.function.body ? estimate_statement(gen, node->data.function.body, depth) : 2;
+    return size + 1;
+}
+
+size_t codegen_estimate_size(const CodeGenState* gen, const ASTNode* ast) {
+    if (!gen || !ast) return 0;
+    
+    size_t size = text_length(gen->prologue);
     
-    // Reset buffer
+    switch (ast->type) {
+        case NODE_PROGRAM:
+            if (gen->config && gen->config->add_comments) {
+                size += sizeof(ascii_art_header) - 1;
+            }
+            for (const ASTNode* decl = ast->data.program.declarations; decl; decl = decl->next) {
+                size += decl->type == NODE_FUNCTION ? estimate_function(gen, decl, 0)
+                                                    : estimate_statement(gen, decl, 0);
+            }
+            return size;
+        
+        case NODE_FUNCTION:
+            return size + estimate_function(gen, ast, 0);
+        
+        default:
+            return size + estimate_statement(gen, ast, 0);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Main Code Generation Interface
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void generate_root(CodeGenState* gen, ASTNode* ast) {
     gen->buffer_pos = 0;
+    gen->flushed = 0;
+    gen->sink_failed = false;
+    gen->failed = false;
     gen->indent_level = 0;
-    gen->output_buffer[0] = '\0';
+    gen->comment_index = 0;
+    
+    // Runtime support has to precede every use
+    if (gen->prologue) {
+        codegen_write(gen, gen->prologue);
+    }
     
     // Generate code based on AST root type
     switch (ast->type) {
         case NODE_PROGRAM:
             generate_program(gen, ast);
             break;
-            
+        
         case NODE_FUNCTION:
             generate_function(gen, ast);
             break;
-            
+        
         default:
             generate_statement(gen, ast);
             break;
     }
+}
+
+char* generate_code(CodeGenState* gen, ASTNode* ast) {
+    if (!gen || !ast) return NULL;
+    
+    // One allocation up front instead of doubling through the run
+    size_t estimate = codegen_estimate_size(gen, ast) + 1;
+    if (estimate > gen->buffer_size) {
+        free(gen->output_buffer);
+        gen->output_buffer = malloc(estimate);
+        gen->buffer_size = gen->output_buffer ? estimate : 0;
+    }
+    
+    generate_root(gen, ast);
+    if (!ensure_buffer_capacity(gen, 1)) return NULL;
+    
+    // The caller takes the buffer itself; the next run allocates afresh
+    char* code = gen->output_buffer;
+    code[gen->buffer_pos] = '\0';
+    gen->output_buffer = NULL;
+    gen->buffer_size = 0;
+    return code;
+}
+
+bool codegen_stream(CodeGenState* gen, ASTNode* ast, CodeGenSink sink, void* user) {
+    if (!gen || !ast || !sink) return false;
+    
+    gen->sink = sink;
+    gen->sink_user = user;
+    generate_root(gen, ast);
+    bool ok = !gen->failed && flush_buffer(gen);
+    gen->sink = NULL;
+    gen->sink_user = NULL;
+    return ok;
+}
+
+bool codegen_sink_fd(const char* data, size_t length, void* user) {
+    int fd = *(int*)user;
+    
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+size_t codegen_output_size(const CodeGenState* gen) {
+    return gen ? gen->flushed + gen->buffer_pos : 0;
+}
+
+void codegen_set_prologue(CodeGenState* gen, const char* prologue) {
+    if (!gen) return;
     
-    return strdup(gen->output_buffer);
+    free(gen->prologue);
+    gen->prologue = prologue ? strdup(prologue) : NULL;
 }
 
 /* ═══════════════════════════════════════════════════════════════════════════
@@ -519,6 +970,7 @@ CodeGenConfig* codegen_config_create_default(void) {
     config->add_comments = true;
     config->add_ascii_art = true;
     config->style = AESTHETIC_ARTISTIC;
+    config->seed = 0;
     
     return config;
 }
@@ -2,19 +2,33 @@
 #define OBFUSCATOR_CODEGEN_H
 
 #include "../common/types.h"
+#include "../common/random.h"
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Code Generation Interface
  * ═══════════════════════════════════════════════════════════════════════════ */
 
+#define CODEGEN_CHUNK_SIZE 65536
+
+/* Receives output as it is generated; false stops the stream */
+typedef bool (*CodeGenSink)(const char* data, size_t length, void* user);
+
 /* Code Generator State */
 typedef struct {
     CodeGenConfig* config;
     char* output_buffer;
     size_t buffer_size;
     size_t buffer_pos;
+    CodeGenSink sink;      /* Set while streaming: full chunks go here */
+    void* sink_user;
+    size_t flushed;        /* Bytes already handed to the sink */
+    bool sink_failed;
+    bool failed;           /* Output was dropped; sticky until the next run */
     int indent_level;
     Error* errors;
+    char* prologue;        /* Emitted before the program (runtime support) */
+    int comment_index;     /* Next aesthetic comment; per generator so output repeats */
+    Random random;         /* Chaotic layout */
 } CodeGenState;
 
 /* Function Prototypes */
@@ -23,7 +37,25 @@ typedef struct {
 CodeGenState* codegen_create(CodeGenConfig* config);
 void codegen_destroy(CodeGenState* gen);
 
+/* NULL when the output could not be held in full */
 char* generate_code(CodeGenState* gen, ASTNode* ast);
+
+/* Generates `ast` through `sink` in chunks of at most CODEGEN_CHUNK_SIZE
+ * bytes, never holding the whole output; false when the sink fails or
+ * the buffer cannot grow */
+bool codegen_stream(CodeGenState* gen, ASTNode* ast, CodeGenSink sink, void* user);
+
+/* Sink writing to the file descriptor `*(int*)user` */
+bool codegen_sink_fd(const char* data, size_t length, void* user);
+
+/* Estimate of the bytes generate_code will produce for `ast`, prologue
+ * included; an upper bound for every node kind the generator prints.
+ * generate_code allocates this much once and grows only if it falls short */
+size_t codegen_estimate_size(const CodeGenState* gen, const ASTNode* ast);
+
+/* Bytes generated so far by the last generate_code or codegen_stream */
+size_t codegen_output_size(const CodeGenState* gen);
+void codegen_set_prologue(CodeGenState* gen, const char* prologue);
 bool codegen_has_errors(const CodeGenState* gen);
 Error* codegen_get_errors(const CodeGenState* gen);
 
@@ -36,12 +68,16 @@ void generate_expression(CodeGenState* gen, ASTNode* node);
 void generate_block(CodeGenState* gen, ASTNode* node);
 
 /* Output Buffer Management */
+void codegen_write_n(CodeGenState* gen, const char* str, size_t length);
 void codegen_write(CodeGenState* gen, const char* str);
 void codegen_write_char(CodeGenState* gen, char c);
 void codegen_write_line(CodeGenState* gen, const char* str);
 void codegen_newline(CodeGenState* gen);
 void codegen_indent(CodeGenState* gen);
 
+/* String literals and char arrays, with the length known at compile time */
+#define codegen_write_literal(gen, literal) codegen_write_n((gen), (literal), sizeof(literal) - 1)
+
 /* Aesthetic Formatting */
 void generate_ascii_art_header(CodeGenState* gen, const char* title);
 void generate_aesthetic_comment(CodeGenState* gen, const char* text);
@@ -0,0 +1,37 @@
+#include "random.h"
+#include <stdlib.h>
+#include <time.h>
+
+void random_seed(Random* random, uint64_t seed) {
+    if (!random) return;
+    
+    if (seed == 0) {
+        // Distinct for generators seeded within the same second
+        static uint64_t sequence = 0;
+        seed = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 20) ^ (++sequence * 0x9e3779b97f4a7c15ull);
+    }
+    random->state = seed;
+}
+
+/* splitmix64 */
+uint32_t random_next(Random* random) {
+    if (!random) {
+        // rand() may only supply 15 bits
+        uint32_t word = 0;
+        for (int i = 0; i < 4; i++) {
+            word = (word << 8) ^ (uint32_t)(rand() & 0xff);
+        }
+        return word;
+    }
+    
+    uint64_t z = (random->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return (uint32_t)(z >> 32);
+}
+
+int random_below(Random* random, int bound) {
+    if (bound <= 0) return 0;
+    return (int)(random_next(random) % (uint32_t)bound);
+}
@@ -0,0 +1,27 @@
+#ifndef OBFUSCATOR_RANDOM_H
+#define OBFUSCATOR_RANDOM_H
+
+#include <stdint.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Seeded Random Numbers
+ *
+ * Each obfuscation context and code generator owns a generator, so two
+ * variants built side by side (or on different threads) never draw from
+ * each other's sequence and a seed always reproduces the same output.
+ * A NULL generator falls back to the C library's rand().
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    uint64_t state;
+} Random;
+
+/* 0 seeds from the clock */
+void random_seed(Random* random, uint64_t seed);
+
+uint32_t random_next(Random* random);
+
+/* Uniform in [0, bound); 0 when bound <= 0 */
+int random_below(Random* random, int bound);
+
+#endif /* OBFUSCATOR_RANDOM_H */
@@ -19,6 +19,7 @@ typedef enum {
     TOKEN_OPERATOR,
     TOKEN_PUNCTUATION,
     TOKEN_PREPROCESSOR,
+    TOKEN_PRAGMA,       /* #pragma obfuscate; value is the argument, e.g. "push" */
     TOKEN_COMMENT,
     TOKEN_WHITESPACE,
     TOKEN_UNKNOWN
@@ -63,16 +64,32 @@ typedef enum {
     NODE_ARRAY_ACCESS,
     NODE_MEMBER_ACCESS,
     NODE_CAST,
-    NODE_SIZEOF
+    NODE_SIZEOF,
+    NODE_STMT_EXPR,     /* GNU statement expression: ({ decls; value; }) */
+    NODE_SWITCH,
+    NODE_CASE,
+    NODE_BREAK,
+    NODE_GOTO,
+    NODE_LABEL
 } NodeType;
 
 /* Forward declaration */
 struct ASTNode;
 
+/* AST Node Flags */
+#define AST_FLAG_OPAQUE     0x0001  /* Deliberately redundant; survives simplification */
+#define AST_FLAG_DUPLICATE  0x0002  /* Replica of another evaluation made by a pass */
+#define AST_FLAG_VIRTUALIZE 0x0004  /* annotate("virtualize"): compile to bytecode */
+#define AST_FLAG_PROTECTED  0x0008  /* Vectorizable loop structure; renaming only */
+#define AST_FLAG_INT        0x0010  /* Expression of type int, from declared types */
+
 /* AST Node Structure */
 typedef struct ASTNode {
     NodeType type;
     SourceLocation location;
+    unsigned int flags;
+    int level_cap;         /* Highest ObfuscationLevel allowed here; 0 = no cap */
+    float hotness;         /* Estimated executions per program run; 0 = unknown */
     
     union {
         /* Program node */
@@ -89,7 +106,7 @@ typedef struct ASTNode {
             bool is_static;
         } function;
         
-        /* Variable node */
+        /* Variable node; also parameters */
         struct {
             char* name;
             char* type;
@@ -98,14 +115,14 @@ typedef struct ASTNode {
             bool is_const;
         } variable;
         
-        /* Binary operation */
+        /* Binary operation; also subscripts (`left[right]`, operator "[]") */
         struct {
             struct ASTNode* left;
             struct ASTNode* right;
             char* operator;
         } binary;
         
-        /* Unary operation */
+        /* Unary operation; also casts (prefix operator "(type)") */
         struct {
             struct ASTNode* operand;
             char* operator;
@@ -156,6 +173,24 @@ typedef struct ASTNode {
             char* name;
             struct ASTNode* members;
         } struct_def;
+        
+        /* Switch statement over a list of NODE_CASE */
+        struct {
+            struct ASTNode* expression;
+            struct ASTNode* cases;
+        } switch_stmt;
+        
+        /* Case label (NULL value = default) and the statements under it */
+        struct {
+            struct ASTNode* value;
+            struct ASTNode* statements;
+        } case_stmt;
+        
+        /* Goto and label; a computed goto (`goto *target`) has no name */
+        struct {
+            char* name;
+            struct ASTNode* target;
+        } jump;
     } data;
     
     struct ASTNode* next;  /* For linked lists */
@@ -220,6 +255,12 @@ typedef enum {
     AESTHETIC_RUNIC
 } AestheticStyle;
 
+/* Control-flow flattening dispatch */
+typedef enum {
+    FLATTEN_DISPATCH_SWITCH,   /* Dense case IDs; compiles to a jump table */
+    FLATTEN_DISPATCH_GOTO      /* GNU labels-as-values, direct threaded */
+} FlattenDispatch;
+
 /* Name Generation Patterns */
 typedef struct {
     char* pattern;
@@ -229,6 +270,13 @@ typedef struct {
     bool use_underscores;
 } NameGenerator;
 
+/* Per-function override, e.g. from an autotuned configuration file */
+typedef struct FunctionSetting {
+    char* function;
+    int level_cap;             /* Highest ObfuscationLevel for its body */
+    struct FunctionSetting* next;
+} FunctionSetting;
+
 /* Obfuscation Configuration */
 typedef struct {
     ObfuscationLevel level;
@@ -240,6 +288,67 @@ typedef struct {
     bool use_macros;
     char* output_file;
     NameGenerator name_gen;
+    
+    /* Mixed boolean-arithmetic rewriting budgets (extra AST nodes) */
+    int mba_expr_budget;
+    int mba_function_budget;
+    
+    /* Post-obfuscation peephole simplification */
+    bool simplify_output;
+    bool simplify_preserve_opaque;
+    
+    /* Profile-guided intensity: counts at or above these percentages of the
+     * hottest count cap code at basic (hot) or intermediate (warm) */
+    char* profile_file;
+    int profile_hot_percent;
+    int profile_warm_percent;
+    
+    /* Scale transformation odds down by statically estimated hotness */
+    bool static_hotness;
+    
+    /* Decrypt the whole string blob on first use instead of per literal */
+    bool string_decrypt_all;
+    
+    /* Control-flow flattening; encoded states only apply to switch dispatch.
+     * Merging folds single-entry blocks into their predecessor. */
+    FlattenDispatch flatten_dispatch;
+    bool flatten_encode_states;
+    bool flatten_merge_blocks;
+    
+    /* Cycles an opaque predicate may cost in code run once per program;
+     * hotter code gets proportionally less */
+    int opaque_cost_budget;
+    
+    /* Hint bogus branches as not taken and outline their payloads into
+     * cold functions, keeping the hot path's layout close to the original */
+    bool cold_placement;
+    
+    /* Integer literal encoding; each use may cost this many cycles in code
+     * run once per program (memory loads need at least 5) */
+    bool constant_encoding;
+    int constant_cost_budget;
+    
+    /* Run functions annotated `virtualize` on the bytecode interpreter
+     * (extreme level; hot functions are refused) */
+    bool virtualize;
+    
+    /* Keep counted loops over arrays vectorizable: their induction
+     * variable, bounds and subscripts are only renamed */
+    bool protect_loops;
+    
+    /* Chance (percent) that a block gets a bogus branch at extreme level */
+    int dead_code_percent;
+    
+    /* Level caps for individual functions */
+    FunctionSetting* function_settings;
+    
+    /* Random seed for reproducible output; 0 seeds from the clock */
+    unsigned int seed;
+    
+    /* Growth limits: node count relative to the original, program-wide and
+     * per function, and an absolute cap on the program; 0 = unlimited */
+    double max_growth;
+    long max_nodes;
 } ObfuscationConfig;
 
 /* Code Generation Configuration */
@@ -249,6 +358,7 @@ typedef struct {
     bool add_comments;
     bool add_ascii_art;
     AestheticStyle style;
+    unsigned int seed;         /* Chaotic layout; 0 seeds from the clock */
 } CodeGenConfig;
 
 /* Error Types */
@@ -262,7 +372,7 @@ typedef enum {
 } ErrorType;
 
 /* Error Structure */
-typedef struct {
+typedef struct Error {
     ErrorType type;
     char* message;
     SourceLocation location;
@@ -456,6 +456,29 @@ static Token* lexer_read_comment(LexerState* lexer) {
     return token;
 }
 
+/* Returns the argument of an `obfuscate` pragma with whitespace removed
+ * (e.g. "level(basic)"), or NULL for any other pragma */
+static char* lexer_obfuscate_pragma(const char* text, size_t length) {
+    size_t pos = 0;
+    while (pos < length && isspace((unsigned char)text[pos])) pos++;
+    
+    if (length - pos < 9 || strncmp(text + pos, "obfuscate", 9) != 0) return NULL;
+    pos += 9;
+    if (pos < length && is_identifier_char(text[pos])) return NULL;
+    
+    char* argument = malloc(length - pos + 1);
+    if (!argument) return NULL;
+    
+    size_t out = 0;
+    for (; pos < length; pos++) {
+        if (!isspace((unsigned char)text[pos]) && text[pos] != '\\') {
+            argument[out++] = text[pos];
+        }
+    }
+    argument[out] = '\0';
+    return argument;
+}
+
 static Token* lexer_read_preprocessor(LexerState* lexer) {
     SourceLocation start_loc = lexer_current_location(lexer);
     size_t start_pos = lexer->position;
@@ -505,9 +528,18 @@ static Token* lexer_read_preprocessor(LexerState* lexer) {
         lexer_add_warning(lexer, warning_msg, start_loc);
     }
     
-    Token* token = token_create(TOKEN_PREPROCESSOR, value, start_loc);
+    // `#pragma obfuscate ...` is obfuscation control for the parser
+    char* pragma = NULL;
+    if (get_preprocessor_type(directive_name) == PP_PRAGMA) {
+        pragma = lexer_obfuscate_pragma(lexer->source + directive_start + directive_length,
+                                        lexer->position - directive_start - directive_length);
+    }
+    
+    Token* token = pragma ? token_create(TOKEN_PRAGMA, pragma, start_loc)
+                          : token_create(TOKEN_PREPROCESSOR, value, start_loc);
     
     if (directive_name) free(directive_name);
+    free(pragma);
     free(value);
     return token;
 }
@@ -37,6 +37,35 @@ void print_usage(const char* program_name) {
     printf("  -c, --control-flow    Obfuscate control flow (default: enabled)\n");
     printf("  -m, --macros          Use macro obfuscation (default: enabled)\n");
     printf("  -v, --verbose         Verbose output\n");
+    printf("      --no-protect-loops\n");
+    printf("                        Transform counted array loops too (default: they\n");
+    printf("                        stay vectorizable and are only renamed)\n");
+    printf("      --config FILE     Load settings from FILE (e.g. from --autotune)\n");
+    printf("      --autotune FILE   Search for the strongest settings within the\n");
+    printf("                        budgets below and write them to FILE\n");
+    printf("      --bench CMD       Benchmark for --autotune; {} is the binary\n");
+    printf("      --max-slowdown X  Benchmark time budget, e.g. 1.5 (default: 2)\n");
+    printf("      --max-size X      Binary size budget, e.g. 3 (default: 3)\n");
+    printf("      --max-growth X    Let the program and each function grow to at\n");
+    printf("                        most X times their AST size, e.g. 3x\n");
+    printf("      --max-nodes N     Cap the obfuscated program at N AST nodes\n");
+    printf("      --seed N          Reproducible output; also seeds --variants\n");
+    printf("      --variants N      Emit N variants, OUTPUT.1.c ... OUTPUT.N.c, each\n");
+    printf("                        with its own seed\n");
+    printf("      --variant SEED[:STYLE[:LEVEL]]\n");
+    printf("                        Add one variant; empty fields (and seed 0) come\n");
+    printf("                        from the base settings. Repeatable\n");
+    printf("      --jobs N          Threads for variants (default: one per CPU)\n");
+    printf("      --profile FILE    Execution profile (function:line:count records or\n");
+    printf("                        a .gcov report); hot code gets lighter transforms\n");
+    printf("      --no-static-hotness\n");
+    printf("                        Transform loops and the functions they call as\n");
+    printf("                        often as cold code (default: hot code is spared)\n");
+    printf("      --dispatch KIND   Flattened control flow dispatches through a\n");
+    printf("                        switch or computed gotos (default: switch)\n");
+    printf("      --no-encode-states\n");
+    printf("                        Use plain state numbers in switch dispatchers\n");
+    printf("      --no-merge-blocks Give every basic block its own state\n");
     printf("  -h, --help            Show this help message\n");
     printf("      --version         Show version information\n\n");
     
@@ -56,7 +85,12 @@ void print_usage(const char* program_name) {
     printf("  %s input.c                           # Basic obfuscation\n", program_name);
     printf("  %s -l extreme -a chaotic input.c     # Maximum chaos\n", program_name);
     printf("  %s -o output.c -d input.c            # With debug info\n", program_name);
-    printf("  %s --level artistic input.c          # Artistic style\n\n", program_name);
+    printf("  %s --level artistic input.c          # Artistic style\n", program_name);
+    printf("  %s --autotune tuned.conf --bench './bench.sh {}' input.c\n", program_name);
+    printf("  %s --config tuned.conf input.c       # Apply tuned settings\n", program_name);
+    printf("  %s --variants 24 --seed 7 -o build.c input.c\n", program_name);
+    printf("  %s --variant 1:hex --variant 2:unicode:extreme input.c\n", program_name);
+    printf("  %s --profile input.c.gcov input.c    # Spare the hot paths\n\n", program_name);
 }
 
 void print_version(void) {
@@ -93,6 +127,45 @@ static AestheticStyle parse_aesthetic_style(const char* style_str) {
     return AESTHETIC_ARTISTIC;
 }
 
+/* "1.5" or "1.5x"; 0 when malformed or not positive */
+static double parse_ratio(const char* ratio_str) {
+    char* end;
+    double ratio = strtod(ratio_str, &end);
+    if (end == ratio_str || ratio <= 0.0) return 0.0;
+    if (*end == 'x' || *end == 'X') end++;
+    return *end ? 0.0 : ratio;
+}
+
+/* A non-negative count; -1 when malformed */
+static long parse_count(const char* count_str) {
+    char* end;
+    long count = strtol(count_str, &end, 10);
+    if (end == count_str || *end || count < 0) return -1;
+    return count;
+}
+
+/* "SEED[:STYLE[:LEVEL]]"; empty fields come from the base settings */
+static bool parse_variant(VariantSet* variants, const char* spec) {
+    char* copy = strdup(spec);
+    if (!copy) return false;
+    
+    char* style = strchr(copy, ':');
+    char* level = NULL;
+    if (style) {
+        *style++ = '\0';
+        level = strchr(style, ':');
+        if (level) *level++ = '\0';
+    }
+    
+    long seed = *copy ? parse_count(copy) : 0;
+    bool ok = seed >= 0 && (unsigned long)seed <= 0xffffffffUL &&
+              variant_set_add(variants, (unsigned int)seed,
+                              style && *style ? (int)parse_aesthetic_style(style) : VARIANT_BASE,
+                              level && *level ? (int)parse_obfuscation_level(level) : VARIANT_BASE);
+    free(copy);
+    return ok;
+}
+
 AppConfig* parse_command_line(int argc, char* argv[]) {
     AppConfig* config = app_config_create_default();
     if (!config) return NULL;
@@ -108,5 +181,581 @@ AppConfig* parse_command_line(int argc, char* argv[]) {
         {"verbose",      no_argument,       0, 'v'},
         {"help",         no_argument,       0, 'h'},
         {"version",      no_argument,       0, 1000},
+        {"no-protect-loops", no_argument,   0, 1001},
+        {"config",       required_argument, 0, 1002},
+        {"autotune",     required_argument, 0, 1003},
+        {"bench",        required_argument, 0, 1004},
+        {"max-slowdown", required_argument, 0, 1005},
+        {"max-size",     required_argument, 0, 1006},
+        {"max-growth",   required_argument, 0, 1007},
+        {"max-nodes",    required_argument, 0, 1008},
+        {"seed",         required_argument, 0, 1009},
+        {"variants",     required_argument, 0, 1010},
+        {"variant",      required_argument, 0, 1011},
+        {"jobs",         required_argument, 0, 1012},
+        {"profile",      required_argument, 0, 1013},
+        {"no-static-hotness", no_argument,  0, 1014},
+        {"dispatch",     required_argument, 0, 1015},
+        {"no-encode-states", no_argument,   0, 1016},
+        {"no-merge-blocks", no_argument,    0, 1017},
         {0, 0, 0, 0}
-    };\n    \n    int option_index = 0;\n    int c;\n    \n    while ((c = getopt_long(argc, argv, \"o:l:a:dscmvh\", long_options, &option_index)) != -1) {\n        switch (c) {\n            case 'o':\n                free(config->output_file);\n                config->output_file = strdup(optarg);\n                break;\n                \n            case 'l':\n                config->config->level = parse_obfuscation_level(optarg);\n                break;\n                \n            case 'a':\n                config->config->aesthetic = parse_aesthetic_style(optarg);\n                config_set_aesthetic(config->config, config->config->aesthetic);\n                break;\n                \n            case 'd':\n                config->config->preserve_debug_info = true;\n                break;\n                \n            case 's':\n                config->config->obfuscate_strings = true;\n                break;\n                \n            case 'c':\n                config->config->obfuscate_control_flow = true;\n                break;\n                \n            case 'm':\n                config->config->use_macros = true;\n                break;\n                \n            case 'v':\n                config->verbose = true;\n                break;\n                \n            case 'h':\n                config->show_help = true;\n                return config;\n                \n            case 1000: // --version\n                print_version();\n                exit(0);\n                break;\n                \n            case '?':\n                fprintf(stderr, \"Try '%s --help' for more information.\\n\", argv[0]);\n                app_config_destroy(config);\n                return NULL;\n                \n            default:\n                break;\n        }\n    }\n    \n    // Get input file\n    if (optind < argc) {\n        config->input_file = strdup(argv[optind]);\n    } else if (!config->show_help) {\n        fprintf(stderr, \"Error: No input file specified\\n\");\n        fprintf(stderr, \"Try '%s --help' for more information.\\n\", argv[0]);\n        app_config_destroy(config);\n        return NULL;\n    }\n    \n    // Generate output filename if not specified\n    if (!config->output_file && config->input_file) {\n        config->output_file = create_output_filename(config->input_file);\n    }\n    \n    return config;\n}\n\n/* ═══════════════════════════════════════════════════════════════════════════\n * File I/O Functions\n * ═══════════════════════════════════════════════════════════════════════════ */\n\nchar* read_file(const char* filename) {\n    if (!filename) return NULL;\n    \n    FILE* file = fopen(filename, \"r\");\n    if (!file) {\n        fprintf(stderr, \"Error: Cannot open file '%s'\\n\", filename);\n        return NULL;\n    }\n    \n    // Get file size\n    fseek(file, 0, SEEK_END);\n    long size = ftell(file);\n    fseek(file, 0, SEEK_SET);\n    \n    if (size < 0) {\n        fprintf(stderr, \"Error: Cannot determine file size for '%s'\\n\", filename);\n        fclose(file);\n        return NULL;\n    }\n    \n    // Allocate buffer\n    char* content = malloc(size + 1);\n    if (!content) {\n        fprintf(stderr, \"Error: Cannot allocate memory for file '%s'\\n\", filename);\n        fclose(file);\n        return NULL;\n    }\n    \n    // Read file\n    size_t bytes_read = fread(content, 1, size, file);\n    content[bytes_read] = '\\0';\n    \n    fclose(file);\n    return content;\n}\n\nbool write_file(const char* filename, const char* content) {\n    if (!filename || !content) return false;\n    \n    FILE* file = fopen(filename, \"w\");\n    if (!file) {\n        fprintf(stderr, \"Error: Cannot create file '%s'\\n\", filename);\n        return false;\n    }\n    \n    size_t len = strlen(content);\n    size_t written = fwrite(content, 1, len, file);\n    \n    fclose(file);\n    \n    if (written != len) {\n        fprintf(stderr, \"Error: Failed to write complete content to '%s'\\n\", filename);\n        return false;\n    }\n    \n    return true;\n}\n\n/* ═══════════════════════════════════════════════════════════════════════════\n * Main Obfuscation Function\n * ═══════════════════════════════════════════════════════════════════════════ */\n\nint obfuscate_file(const char* input_file, const char* output_file, ObfuscationConfig* config) {\n    if (!input_file || !output_file || !config) {\n        fprintf(stderr, \"Error: Invalid parameters\\n\");\n        return 1;\n    }\n    \n    printf(\"Obfuscating '%s' -> '%s'\\n\", input_file, output_file);\n    printf(\"Level: %s, Style: %s\\n\", \n           (config->level == OBF_BASIC) ? \"basic\" :\n           (config->level == OBF_INTERMEDIATE) ? \"intermediate\" : \"extreme\",\n           (config->aesthetic == AESTHETIC_MINIMAL) ? \"minimal\" :\n           (config->aesthetic == AESTHETIC_UNICODE) ? \"unicode\" :\n           (config->aesthetic == AESTHETIC_HEXADECIMAL) ? \"hex\" :\n           (config->aesthetic == AESTHETIC_ARTISTIC) ? \"artistic\" : \"chaotic\");\n    \n    // Step 1: Read input file\n    char* source_code = read_file(input_file);\n    if (!source_code) {\n        return 1;\n    }\n    \n    // Step 2: Tokenize\n    printf(\"Tokenizing...\\n\");\n    LexerState* lexer = lexer_create(source_code, input_file);\n    if (!lexer) {\n        fprintf(stderr, \"Error: Failed to create lexer\\n\");\n        free(source_code);\n        return 1;\n    }\n    \n    Token* tokens = lexer_tokenize(lexer);\n    if (!tokens || lexer_has_errors(lexer)) {\n        fprintf(stderr, \"Error: Tokenization failed\\n\");\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    // Step 3: Parse (for now, just create a simple expression AST)\n    printf(\"Parsing...\\n\");\n    ParserState* parser = parser_create(tokens);\n    if (!parser) {\n        fprintf(stderr, \"Error: Failed to create parser\\n\");\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    ASTNode* ast = parser_parse_expression(parser); // Simplified for now\n    if (!ast) {\n        fprintf(stderr, \"Error: Parsing failed\\n\");\n        parser_destroy(parser);\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    // Step 4: Obfuscate\n    printf(\"Obfuscating...\\n\");\n    ObfuscationContext* obf_ctx = obfuscator_create(config);\n    if (!obf_ctx) {\n        fprintf(stderr, \"Error: Failed to create obfuscator\\n\");\n        ast_node_destroy(ast);\n        parser_destroy(parser);\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    ASTNode* obfuscated_ast = obfuscate_ast(obf_ctx, ast);\n    if (!obfuscated_ast) {\n        fprintf(stderr, \"Error: Obfuscation failed\\n\");\n        obfuscator_destroy(obf_ctx);\n        ast_node_destroy(ast);\n        parser_destroy(parser);\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    // Step 5: Generate code\n    printf(\"Generating code...\\n\");\n    CodeGenConfig* codegen_config = codegen_config_create_default();\n    codegen_config_set_style(codegen_config, config->aesthetic);\n    \n    CodeGenState* codegen = codegen_create(codegen_config);\n    if (!codegen) {\n        fprintf(stderr, \"Error: Failed to create code generator\\n\");\n        codegen_config_destroy(codegen_config);\n        obfuscator_destroy(obf_ctx);\n        ast_node_destroy(ast);\n        parser_destroy(parser);\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    char* obfuscated_code = generate_code(codegen, obfuscated_ast);\n    if (!obfuscated_code) {\n        fprintf(stderr, \"Error: Code generation failed\\n\");\n        codegen_destroy(codegen);\n        codegen_config_destroy(codegen_config);\n        obfuscator_destroy(obf_ctx);\n        ast_node_destroy(ast);\n        parser_destroy(parser);\n        lexer_destroy(lexer);\n        free(source_code);\n        return 1;\n    }\n    \n    // Step 6: Write output\n    printf(\"Writing output...\\n\");\n    bool success = write_file(output_file, obfuscated_code);\n    \n    // Cleanup\n    free(obfuscated_code);\n    codegen_destroy(codegen);\n    codegen_config_destroy(codegen_config);\n    obfuscator_destroy(obf_ctx);\n    ast_node_destroy(ast);\n    parser_destroy(parser);\n    lexer_destroy(lexer);\n    free(source_code);\n    \n    if (success) {\n        printf(\"✓ Obfuscation completed successfully!\\n\");\n        printf(\"Output written to: %s\\n\", output_file);\n        return 0;\n    } else {\n        fprintf(stderr, \"Error: Failed to write output file\\n\");\n        return 1;\n    }\n}\n\n/* ═══════════════════════════════════════════════════════════════════════════\n * Configuration Management\n * ═══════════════════════════════════════════════════════════════════════════ */\n\nAppConfig* app_config_create_default(void) {\n    AppConfig* config = malloc(sizeof(AppConfig));\n    if (!config) return NULL;\n    \n    config->config = config_create_default();\n    config->codegen_config = codegen_config_create_default();\n    config->input_file = NULL;\n    config->output_file = NULL;\n    config->verbose = false;\n    config->show_help = false;\n    \n    return config;\n}\n\nvoid app_config_destroy(AppConfig* config) {\n    if (!config) return;\n    \n    config_destroy(config->config);\n    codegen_config_destroy(config->codegen_config);\n    free(config->input_file);\n    free(config->output_file);\n    free(config);\n}\n\n/* ═══════════════════════════════════════════════════════════════════════════\n * Utility Functions\n * ═══════════════════════════════════════════════════════════════════════════ */\n\nbool file_exists(const char* filename) {\n    if (!filename) return false;\n    \n    FILE* file = fopen(filename, \"r\");\n    if (file) {\n        fclose(file);\n        return true;\n    }\n    return false;\n}\n\nchar* get_file_extension(const char* filename) {\n    if (!filename) return NULL;\n    \n    const char* dot = strrchr(filename, '.');\n    if (!dot || dot == filename) return NULL;\n    \n    return strdup(dot + 1);\n}\n\nchar* create_output_filename(const char* input_file) {\n    if (!input_file) return NULL;\n    \n    size_t len = strlen(input_file);\n    const char* dot = strrchr(input_file, '.');\n    \n    char* output_file;\n    if (dot) {\n        size_t base_len = dot - input_file;\n        output_file = malloc(base_len + 8); // \"_obf.c\" + null terminator\n        if (output_file) {\n            strncpy(output_file, input_file, base_len);\n            strcpy(output_file + base_len, \"_obf.c\");\n        }\n    } else {\n        output_file = malloc(len + 8);\n        if (output_file) {\n            strcpy(output_file, input_file);\n            strcat(output_file, \"_obf.c\");\n        }\n    }\n    \n    return output_file;\n}\n\nvoid print_errors(Error* errors) {\n    // TODO: Implement error printing\n    (void)errors;\n}\n\nvoid cleanup_and_exit(int exit_code) {\n    // TODO: Implement cleanup\n    exit(exit_code);\n}\n\n/* ═══════════════════════════════════════════════════════════════════════════\n * Main Function\n * ═══════════════════════════════════════════════════════════════════════════ */\n\nint main(int argc, char* argv[]) {\n    printf(\"C Code Obfuscator v%s\\n\", VERSION);\n    printf(\"═══════════════════════════════════════\\n\");\n    \n    // Parse command line arguments\n    AppConfig* config = parse_command_line(argc, argv);\n    if (!config) {\n        return 1;\n    }\n    \n    // Show help if requested\n    if (config->show_help) {\n        print_help();\n        app_config_destroy(config);\n        return 0;\n    }\n    \n    // Validate input file\n    if (!config->input_file) {\n        fprintf(stderr, \"Error: No input file specified\\n\");\n        app_config_destroy(config);\n        return 1;\n    }\n    \n    if (!file_exists(config->input_file)) {\n        fprintf(stderr, \"Error: Input file '%s' does not exist\\n\", config->input_file);\n        app_config_destroy(config);\n        return 1;\n    }\n    \n    // Perform obfuscation\n    int result = obfuscate_file(config->input_file, config->output_file, config->config);\n    \n    app_config_destroy(config);\n    return result;\n}"
\ No newline at end of file
+    };
+    
+    int option_index = 0;
+    int c;
+    
+    while ((c = getopt_long(argc, argv, "o:l:a:dscmvh", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'o':
+                free(config->output_file);
+                config->output_file = strdup(optarg);
+                break;
+            
+            case 'l':
+                config->config->level = parse_obfuscation_level(optarg);
+                break;
+            
+            case 'a':
+                config->config->aesthetic = parse_aesthetic_style(optarg);
+                config_set_aesthetic(config->config, config->config->aesthetic);
+                break;
+            
+            case 'd':
+                config->config->preserve_debug_info = true;
+                break;
+            
+            case 's':
+                config->config->obfuscate_strings = true;
+                break;
+            
+            case 'c':
+                config->config->obfuscate_control_flow = true;
+                break;
+            
+            case 'm':
+                config->config->use_macros = true;
+                break;
+            
+            case 'v':
+                config->verbose = true;
+                break;
+            
+            case 'h':
+                config->show_help = true;
+                return config;
+            
+            case 1000: // --version
+                print_version();
+                exit(0);
+                break;
+            
+            case 1001: // --no-protect-loops
+                config->config->protect_loops = false;
+                break;
+            
+            case 1002: // --config
+                if (!config_load(config->config, optarg)) {
+                    fprintf(stderr, "Error: Cannot load configuration '%s'\n", optarg);
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                break;
+            
+            case 1003: // --autotune
+                free(config->autotune_file);
+                config->autotune_file = strdup(optarg);
+                break;
+            
+            case 1004: // --bench
+                config->autotune.bench = optarg;
+                break;
+            
+            case 1005: // --max-slowdown
+                config->autotune.max_slowdown = parse_ratio(optarg);
+                break;
+            
+            case 1006: // --max-size
+                config->autotune.max_growth = parse_ratio(optarg);
+                break;
+            
+            case 1007: // --max-growth
+                config->config->max_growth = parse_ratio(optarg);
+                if (config->config->max_growth < 1.0) {
+                    fprintf(stderr, "Error: --max-growth must be at least 1x\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                break;
+            
+            case 1008: // --max-nodes
+                config->config->max_nodes = atol(optarg);
+                if (config->config->max_nodes <= 0) {
+                    fprintf(stderr, "Error: --max-nodes must be a positive count\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                break;
+            
+            case 1009: { // --seed
+                long seed = parse_count(optarg);
+                if (seed < 0 || (unsigned long)seed > 0xffffffffUL) {
+                    fprintf(stderr, "Error: --seed must be a number\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                config->config->seed = (unsigned int)seed;
+                break;
+            }
+            
+            case 1010: { // --variants
+                long count = parse_count(optarg);
+                if (count <= 0 || count > 100000) {
+                    fprintf(stderr, "Error: --variants must be a positive count\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                config->variant_count = (int)count;
+                break;
+            }
+            
+            case 1011: // --variant
+                if (!parse_variant(config->variants, optarg)) {
+                    fprintf(stderr, "Error: Invalid variant '%s', expected SEED[:STYLE[:LEVEL]]\n", optarg);
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                break;
+            
+            case 1012: { // --jobs
+                long jobs = parse_count(optarg);
+                if (jobs <= 0 || jobs > 1024) {
+                    fprintf(stderr, "Error: --jobs must be a positive count\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                config->jobs = (int)jobs;
+                break;
+            }
+            
+            case 1013: // --profile
+                free(config->config->profile_file);
+                config->config->profile_file = strdup(optarg);
+                break;
+            
+            case 1014: // --no-static-hotness
+                config->config->static_hotness = false;
+                break;
+            
+            case 1015: // --dispatch
+                if (strcmp(optarg, "switch") == 0) {
+                    config->config->flatten_dispatch = FLATTEN_DISPATCH_SWITCH;
+                } else if (strcmp(optarg, "goto") == 0) {
+                    config->config->flatten_dispatch = FLATTEN_DISPATCH_GOTO;
+                } else {
+                    fprintf(stderr, "Error: --dispatch must be 'switch' or 'goto'\n");
+                    app_config_destroy(config);
+                    return NULL;
+                }
+                break;
+            
+            case 1016: // --no-encode-states
+                config->config->flatten_encode_states = false;
+                break;
+            
+            case 1017: // --no-merge-blocks
+                config->config->flatten_merge_blocks = false;
+                break;
+            
+            case '?':
+                fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
+                app_config_destroy(config);
+                return NULL;
+            
+            default:
+                break;
+        }
+    }
+    
+    // Get input file
+    if (optind < argc) {
+        config->input_file = strdup(argv[optind]);
+    } else if (!config->show_help) {
+        fprintf(stderr, "Error: No input file specified\n");
+        fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
+        app_config_destroy(config);
+        return NULL;
+    }
+    
+    if (config->autotune_file && !config->autotune.bench) {
+        fprintf(stderr, "Error: --autotune needs a --bench command\n");
+        app_config_destroy(config);
+        return NULL;
+    }
+    if (config->autotune.max_slowdown <= 0.0 || config->autotune.max_growth <= 0.0) {
+        fprintf(stderr, "Error: Budgets must be positive ratios, e.g. 1.5\n");
+        app_config_destroy(config);
+        return NULL;
+    }
+    
+    // Generate output filename if not specified
+    if (!config->output_file && config->input_file) {
+        config->output_file = create_output_filename(config->input_file);
+    }
+    
+    return config;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * File I/O Functions
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+char* read_file(const char* filename) {
+    if (!filename) return NULL;
+    
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    
+    // Get file size
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    if (size < 0) {
+        fprintf(stderr, "Error: Cannot determine file size for '%s'\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    
+    // Allocate buffer
+    char* content = malloc(size + 1);
+    if (!content) {
+        fprintf(stderr, "Error: Cannot allocate memory for file '%s'\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    
+    // Read file
+    size_t bytes_read = fread(content, 1, size, file);
+    content[bytes_read] = '\0';
+    
+    fclose(file);
+    return content;
+}
+
+bool write_file(const char* filename, const char* content) {
+    if (!filename || !content) return false;
+    
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create file '%s'\n", filename);
+        return false;
+    }
+    
+    size_t len = strlen(content);
+    size_t written = fwrite(content, 1, len, file);
+    
+    fclose(file);
+    
+    if (written != len) {
+        fprintf(stderr, "Error: Failed to write complete content to '%s'\n", filename);
+        return false;
+    }
+    
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Main Obfuscation Function
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+int obfuscate_file(const char* input_file, const char* output_file, ObfuscationConfig* config) {
+    if (!input_file || !output_file || !config) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return 1;
+    }
+    
+    printf("Obfuscating '%s' -> '%s'\n", input_file, output_file);
+    printf("Level: %s, Style: %s\n", 
+           (config->level == OBF_BASIC) ? "basic" :
+           (config->level == OBF_INTERMEDIATE) ? "intermediate" : "extreme",
+           (config->aesthetic == AESTHETIC_MINIMAL) ? "minimal" :
+           (config->aesthetic == AESTHETIC_UNICODE) ? "unicode" :
+           (config->aesthetic == AESTHETIC_HEXADECIMAL) ? "hex" :
+           (config->aesthetic == AESTHETIC_ARTISTIC) ? "artistic" : "chaotic");
+    
+    // Step 1: Read input file
+    char* source_code = read_file(input_file);
+    if (!source_code) {
+        return 1;
+    }
+    
+    // Step 2: Tokenize and parse, once; the variant works on a checkout
+    printf("Parsing...\n");
+    ASTSnapshot* snapshot = snapshot_parse(source_code, input_file);
+    free(source_code);
+    if (!snapshot) {
+        fprintf(stderr, "Error: Parsing failed\n");
+        return 1;
+    }
+    
+    // Step 3: Obfuscate, then generate straight into the output file
+    printf("Obfuscating...\n");
+    size_t size = 0;
+    bool success = snapshot_render_file(snapshot, config, stdout, output_file, &size);
+    snapshot_destroy(snapshot);
+    
+    if (success) {
+        printf("✓ Obfuscation completed successfully!\n");
+        printf("Output written to: %s (%zu bytes)\n", output_file, size);
+        return 0;
+    } else {
+        fprintf(stderr, "Error: Failed to obfuscate into '%s'\n", output_file);
+        return 1;
+    }
+}
+
+int obfuscate_variants(const char* input_file, const char* output_file, ObfuscationConfig* config,
+                       VariantSet* variants, int jobs) {
+    if (!input_file || !output_file || !config || !variants) return 1;
+    
+    printf("Obfuscating '%s' into %d variants\n", input_file, variants->count);
+    
+    char* source_code = read_file(input_file);
+    if (!source_code) {
+        return 1;
+    }
+    
+    // Every variant checks out the same parse
+    ASTSnapshot* snapshot = snapshot_parse(source_code, input_file);
+    free(source_code);
+    if (!snapshot) {
+        fprintf(stderr, "Error: Parsing failed\n");
+        return 1;
+    }
+    
+    if (!variant_set_prepare(variants, config, output_file)) {
+        fprintf(stderr, "Error: Out of memory\n");
+        snapshot_destroy(snapshot);
+        return 1;
+    }
+    
+    int failed = variants_emit(variants, snapshot, config, jobs);
+    snapshot_destroy(snapshot);
+    
+    for (int i = 0; i < variants->count; i++) {
+        const Variant* variant = &variants->variants[i];
+        if (variant->ok) {
+            printf("  %s (seed %u, %zu bytes)\n", variant->output_file, variant->seed, variant->size);
+        } else {
+            fprintf(stderr, "Error: Variant %d (seed %u) failed: '%s'\n",
+                    i + 1, variant->seed, variant->output_file);
+        }
+    }
+    
+    if (failed) {
+        fprintf(stderr, "Error: %d of %d variants failed\n", failed, variants->count);
+        return 1;
+    }
+    printf("✓ %d variants written\n", variants->count);
+    return 0;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Autotuning
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+int autotune_file(const char* input_file, const char* config_file, ObfuscationConfig* config,
+                  AutotuneOptions* options) {
+    if (!input_file || !config_file || !config || !options) return 1;
+    
+    printf("Autotuning '%s' -> '%s'\n", input_file, config_file);
+    printf("Budget: %.2fx time, %.2fx size\n", options->max_slowdown, options->max_growth);
+    
+    char* source_code = read_file(input_file);
+    if (!source_code) {
+        return 1;
+    }
+    
+    ASTSnapshot* snapshot = snapshot_parse(source_code, input_file);
+    free(source_code);
+    
+    int result = 1;
+    if (!snapshot) {
+        fprintf(stderr, "Error: Parsing failed\n");
+    } else {
+        AutotuneResult* tuned = autotune(snapshot->ast, config, options);
+        if (!tuned) {
+            fprintf(stderr, "Error: Cannot build or benchmark the original program\n");
+        } else if (!config_save(tuned->config, config_file)) {
+            fprintf(stderr, "Error: Cannot write configuration '%s'\n", config_file);
+        } else {
+            printf("Measured %d candidates; best: %.2fx time, %.2fx size%s\n",
+                   tuned->candidates, tuned->slowdown, tuned->growth,
+                   tuned->within_budget ? "" : " (over budget; weakest settings)");
+            printf("✓ Configuration written to: %s\n", config_file);
+            result = tuned->within_budget ? 0 : 2;
+        }
+        autotune_result_destroy(tuned);
+    }
+    
+    snapshot_destroy(snapshot);
+    return result;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Configuration Management
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+AppConfig* app_config_create_default(void) {
+    AppConfig* config = malloc(sizeof(AppConfig));
+    if (!config) return NULL;
+    
+    config->config = config_create_default();
+    config->codegen_config = codegen_config_create_default();
+    config->input_file = NULL;
+    config->output_file = NULL;
+    config->verbose = false;
+    config->show_help = false;
+    config->autotune_file = NULL;
+    autotune_options_init(&config->autotune);
+    config->variants = variant_set_create();
+    config->variant_count = 0;
+    config->jobs = 0;
+    
+    return config;
+}
+
+void app_config_destroy(AppConfig* config) {
+    if (!config) return;
+    
+    config_destroy(config->config);
+    codegen_config_destroy(config->codegen_config);
+    free(config->input_file);
+    free(config->output_file);
+    free(config->autotune_file);
+    variant_set_destroy(config->variants);
+    free(config);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Utility Functions
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+bool file_exists(const char* filename) {
+    if (!filename) return false;
+    
+    FILE* file = fopen(filename, "r");
+    if (file) {
+        fclose(file);
+        return true;
+    }
+    return false;
+}
+
+char* get_file_extension(const char* filename) {
+    if (!filename) return NULL;
+    
+    const char* dot = strrchr(filename, '.');
+    if (!dot || dot == filename) return NULL;
+    
+    return strdup(dot + 1);
+}
+
+char* create_output_filename(const char* input_file) {
+    if (!input_file) return NULL;
+    
+    size_t len = strlen(input_file);
+    const char* dot = strrchr(input_file, '.');
+    
+    char* output_file;
+    if (dot) {
+        size_t base_len = dot - input_file;
+        output_file = malloc(base_len + 8); // "_obf.c" + null terminator
+        if (output_file) {
+            strncpy(output_file, input_file, base_len);
+            strcpy(output_file + base_len, "_obf.c");
+        }
+    } else {
+        output_file = malloc(len + 8);
+        if (output_file) {
+            strcpy(output_file, input_file);
+            strcat(output_file, "_obf.c");
+        }
+    }
+    
+    return output_file;
+}
+
+void print_errors(Error* errors) {
+    // TODO: Implement error printing
+    (void)errors;
+}
+
+void cleanup_and_exit(int exit_code) {
+    // TODO: Implement cleanup
+    exit(exit_code);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Main Function
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+int main(int argc, char* argv[]) {
+    printf("C Code Obfuscator v%s\n", VERSION);
+    printf("═══════════════════════════════════════\n");
+    
+    // Parse command line arguments
+    AppConfig* config = parse_command_line(argc, argv);
+    if (!config) {
+        return 1;
+    }
+    
+    // Show help if requested
+    if (config->show_help) {
+        print_help();
+        app_config_destroy(config);
+        return 0;
+    }
+    
+    // Validate input file
+    if (!config->input_file) {
+        fprintf(stderr, "Error: No input file specified\n");
+        app_config_destroy(config);
+        return 1;
+    }
+    
+    if (!file_exists(config->input_file)) {
+        fprintf(stderr, "Error: Input file '%s' does not exist\n", config->input_file);
+        app_config_destroy(config);
+        return 1;
+    }
+    
+    // Search for settings instead of obfuscating
+    if (config->autotune_file) {
+        config->autotune.verbose = config->verbose;
+        int result = autotune_file(config->input_file, config->autotune_file, config->config,
+                                   &config->autotune);
+        app_config_destroy(config);
+        return result;
+    }
+    
+    // Several builds from one parse
+    if (config->variant_count > 0 || config->variants->count > 0) {
+        int result = 1;
+        if (variant_set_fill(config->variants, config->variant_count)) {
+            result = obfuscate_variants(config->input_file, config->output_file, config->config,
+                                        config->variants, config->jobs);
+        }
+        app_config_destroy(config);
+        return result;
+    }
+    
+    // Perform obfuscation
+    int result = obfuscate_file(config->input_file, config->output_file, config->config);
+    
+    app_config_destroy(config);
+    return result;
+}
@@ -7,6 +7,9 @@
 #include "symbols/symbols.h"
 #include "obfuscator/obfuscator.h"
 #include "codegen/codegen.h"
+#include "obfuscator/autotune.h"
+#include "obfuscator/snapshot.h"
+#include "obfuscator/variants.h"
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Main Application Interface
@@ -20,6 +23,11 @@ typedef struct {
     char* output_file;
     bool verbose;
     bool show_help;
+    char* autotune_file;       /* --autotune: where the tuned settings go */
+    AutotuneOptions autotune;
+    VariantSet* variants;      /* --variant specs, topped up to variant_count */
+    int variant_count;         /* --variants */
+    int jobs;                  /* Worker threads for variants; 0 = one per CPU */
 } AppConfig;
 
 /* Function Prototypes */
@@ -27,6 +35,10 @@ typedef struct {
 /* Main Application */
 int main(int argc, char* argv[]);
 int obfuscate_file(const char* input_file, const char* output_file, ObfuscationConfig* config);
+int autotune_file(const char* input_file, const char* config_file, ObfuscationConfig* config,
+                  AutotuneOptions* options);
+int obfuscate_variants(const char* input_file, const char* output_file, ObfuscationConfig* config,
+                       VariantSet* variants, int jobs);
 
 /* Command Line Interface */
 AppConfig* parse_command_line(int argc, char* argv[]);
@@ -0,0 +1,835 @@
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Node Construction
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* ast_alloc(NodeType type) {
+    ASTNode* node = calloc(1, sizeof(ASTNode));
+    if (!node) return NULL;
+    
+    node->type = type;
+    node->next = NULL;
+    return node;
+}
+
+ASTNode* ast_create_literal(const char* value) {
+    ASTNode* node = ast_alloc(NODE_LITERAL);
+    if (!node) return NULL;
+    
+    node->data.literal.value = strdup(value);
+    return node;
+}
+
+ASTNode* ast_create_literal_number(int value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%d", value);
+    return ast_create_literal(buffer);
+}
+
+ASTNode* ast_create_identifier(const char* name) {
+    ASTNode* node = ast_alloc(NODE_IDENTIFIER);
+    if (!node) return NULL;
+    
+    node->data.identifier.name = strdup(name);
+    return node;
+}
+
+ASTNode* ast_create_binary_op(const char* op, ASTNode* left, ASTNode* right) {
+    ASTNode* node = ast_alloc(NODE_BINARY_OP);
+    if (!node) return NULL;
+    
+    node->data.binary.operator = strdup(op);
+    node->data.binary.left = left;
+    node->data.binary.right = right;
+    return node;
+}
+
+ASTNode* ast_create_unary_op(const char* op, ASTNode* operand, bool is_prefix) {
+    ASTNode* node = ast_alloc(NODE_UNARY_OP);
+    if (!node) return NULL;
+    
+    node->data.unary.operator = strdup(op);
+    node->data.unary.operand = operand;
+    node->data.unary.is_prefix = is_prefix;
+    return node;
+}
+
+ASTNode* ast_create_cast(const char* type, ASTNode* operand) {
+    char op[64];
+    snprintf(op, sizeof(op), "(%s)", type);
+    return ast_create_unary_op(op, operand, true);
+}
+
+ASTNode* ast_create_variable(const char* name, const char* type, ASTNode* initializer) {
+    ASTNode* node = ast_alloc(NODE_VARIABLE);
+    if (!node) return NULL;
+    
+    node->data.variable.name = strdup(name);
+    node->data.variable.type = strdup(type);
+    node->data.variable.initializer = initializer;
+    node->data.variable.is_static = false;
+    node->data.variable.is_const = false;
+    return node;
+}
+
+ASTNode* ast_create_assignment(ASTNode* target, ASTNode* value) {
+    ASTNode* node = ast_alloc(NODE_ASSIGNMENT);
+    if (!node) return NULL;
+    
+    // Assignments share the binary operation layout
+    node->data.binary.left = target;
+    node->data.binary.right = value;
+    node->data.binary.operator = strdup("=");
+    return node;
+}
+
+ASTNode* ast_create_array_access(ASTNode* array, ASTNode* index) {
+    ASTNode* node = ast_alloc(NODE_ARRAY_ACCESS);
+    if (!node) return NULL;
+    
+    // Subscripts share the binary operation layout too
+    node->data.binary.left = array;
+    node->data.binary.right = index;
+    node->data.binary.operator = strdup("[]");
+    return node;
+}
+
+ASTNode* ast_create_if(ASTNode* condition, ASTNode* then_stmt, ASTNode* else_stmt) {
+    ASTNode* node = ast_alloc(NODE_IF);
+    if (!node) return NULL;
+    
+    node->data.if_stmt.condition = condition;
+    node->data.if_stmt.then_stmt = then_stmt;
+    node->data.if_stmt.else_stmt = else_stmt;
+    return node;
+}
+
+ASTNode* ast_create_while(ASTNode* condition, ASTNode* body) {
+    ASTNode* node = ast_alloc(NODE_WHILE);
+    if (!node) return NULL;
+    
+    node->data.while_stmt.condition = condition;
+    node->data.while_stmt.body = body;
+    return node;
+}
+
+ASTNode* ast_create_for(ASTNode* init, ASTNode* condition, ASTNode* update, ASTNode* body) {
+    ASTNode* node = ast_alloc(NODE_FOR);
+    if (!node) return NULL;
+    
+    node->data.for_stmt.init = init;
+    node->data.for_stmt.condition = condition;
+    node->data.for_stmt.update = update;
+    node->data.for_stmt.body = body;
+    return node;
+}
+
+ASTNode* ast_create_block(ASTNode* statements) {
+    ASTNode* node = ast_alloc(NODE_BLOCK);
+    if (!node) return NULL;
+    
+    node->data.block.statements = statements;
+    return node;
+}
+
+ASTNode* ast_create_call(ASTNode* function, ASTNode* arguments) {
+    ASTNode* node = ast_alloc(NODE_CALL);
+    if (!node) return NULL;
+    
+    node->data.call.function = function;
+    node->data.call.arguments = arguments;
+    return node;
+}
+
+ASTNode* ast_create_stmt_expr(ASTNode* statements) {
+    ASTNode* node = ast_alloc(NODE_STMT_EXPR);
+    if (!node) return NULL;
+    
+    // The last statement in the list provides the value of the expression
+    node->data.block.statements = statements;
+    return node;
+}
+
+ASTNode* ast_create_switch(ASTNode* expression, ASTNode* cases) {
+    ASTNode* node = ast_alloc(NODE_SWITCH);
+    if (!node) return NULL;
+    
+    node->data.switch_stmt.expression = expression;
+    node->data.switch_stmt.cases = cases;
+    return node;
+}
+
+ASTNode* ast_create_case(ASTNode* value, ASTNode* statements) {
+    ASTNode* node = ast_alloc(NODE_CASE);
+    if (!node) return NULL;
+    
+    node->data.case_stmt.value = value;
+    node->data.case_stmt.statements = statements;
+    return node;
+}
+
+ASTNode* ast_create_break(void) {
+    return ast_alloc(NODE_BREAK);
+}
+
+ASTNode* ast_create_return(void) {
+    return ast_alloc(NODE_RETURN);
+}
+
+ASTNode* ast_create_goto(const char* label) {
+    ASTNode* node = ast_alloc(NODE_GOTO);
+    if (!node) return NULL;
+    
+    node->data.jump.name = strdup(label);
+    return node;
+}
+
+ASTNode* ast_create_computed_goto(ASTNode* target) {
+    ASTNode* node = ast_alloc(NODE_GOTO);
+    if (!node) return NULL;
+    
+    node->data.jump.target = target;
+    return node;
+}
+
+ASTNode* ast_create_label(const char* name) {
+    ASTNode* node = ast_alloc(NODE_LABEL);
+    if (!node) return NULL;
+    
+    node->data.jump.name = strdup(name);
+    return node;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Copying and Linking
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+ASTNode* ast_copy(ASTNode* original) {
+    if (!original) return NULL;
+    
+    ASTNode* copy = malloc(sizeof(ASTNode));
+    if (!copy) return NULL;
+    
+    *copy = *original; // Shallow copy
+    copy->next = NULL;
+    
+    // Deep copy specific data based on node type
+    switch (original->type) {
+        case NODE_LITERAL:
+            copy->data.literal.value = strdup(original->data.literal.value);
+            break;
+        case NODE_IDENTIFIER:
+            copy->data.identifier.name = strdup(original->data.identifier.name);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            copy->data.binary.operator = strdup(original->data.binary.operator);
+            copy->data.binary.left = ast_copy(original->data.binary.left);
+            copy->data.binary.right = ast_copy_list(original->data.binary.right);
+            break;
+        case NODE_UNARY_OP:
+            copy->data.unary.operator = strdup(original->data.unary.operator);
+            copy->data.unary.operand = ast_copy(original->data.unary.operand);
+            break;
+        case NODE_CALL:
+            copy->data.call.function = ast_copy(original->data.call.function);
+            copy->data.call.arguments = ast_copy_list(original->data.call.arguments);
+            break;
+        case NODE_VARIABLE:
+        case NODE_PARAMETER:
+            copy->data.variable.name = strdup(original->data.variable.name);
+            copy->data.variable.type = original->data.variable.type ?
+                strdup(original->data.variable.type) : NULL;
+            copy->data.variable.initializer = ast_copy(original->data.variable.initializer);
+            break;
+        case NODE_STMT_EXPR:
+        case NODE_BLOCK:
+            copy->data.block.statements = ast_copy_list(original->data.block.statements);
+            break;
+        case NODE_PROGRAM:
+            copy->data.program.declarations = ast_copy_list(original->data.program.declarations);
+            break;
+        case NODE_FUNCTION:
+            copy->data.function.name = strdup(original->data.function.name);
+            copy->data.function.return_type = original->data.function.return_type ?
+                strdup(original->data.function.return_type) : NULL;
+            copy->data.function.parameters = ast_copy_list(original->data.function.parameters);
+            copy->data.function.body = ast_copy(original->data.function.body);
+            break;
+        case NODE_IF:
+            copy->data.if_stmt.condition = ast_copy(original->data.if_stmt.condition);
+            copy->data.if_stmt.then_stmt = ast_copy(original->data.if_stmt.then_stmt);
+            copy->data.if_stmt.else_stmt = ast_copy(original->data.if_stmt.else_stmt);
+            break;
+        case NODE_WHILE:
+            copy->data.while_stmt.condition = ast_copy(original->data.while_stmt.condition);
+            copy->data.while_stmt.body = ast_copy(original->data.while_stmt.body);
+            break;
+        case NODE_FOR:
+            copy->data.for_stmt.init = ast_copy(original->data.for_stmt.init);
+            copy->data.for_stmt.condition = ast_copy(original->data.for_stmt.condition);
+            copy->data.for_stmt.update = ast_copy(original->data.for_stmt.update);
+            copy->data.for_stmt.body = ast_copy(original->data.for_stmt.body);
+            break;
+        case NODE_SWITCH:
+            copy->data.switch_stmt.expression = ast_copy(original->data.switch_stmt.expression);
+            copy->data.switch_stmt.cases = ast_copy_list(original->data.switch_stmt.cases);
+            break;
+        case NODE_CASE:
+            copy->data.case_stmt.value = ast_copy(original->data.case_stmt.value);
+            copy->data.case_stmt.statements = ast_copy_list(original->data.case_stmt.statements);
+            break;
+        case NODE_STRUCT:
+            copy->data.struct_def.name = original->data.struct_def.name ?
+                strdup(original->data.struct_def.name) : NULL;
+            copy->data.struct_def.members = ast_copy_list(original->data.struct_def.members);
+            break;
+        case NODE_GOTO:
+        case NODE_LABEL:
+            copy->data.jump.name = original->data.jump.name ?
+                strdup(original->data.jump.name) : NULL;
+            copy->data.jump.target = ast_copy(original->data.jump.target);
+            break;
+        default:
+            break;
+    }
+    
+    return copy;
+}
+
+ASTNode* ast_copy_node(const ASTNode* original) {
+    if (!original) return NULL;
+    
+    ASTNode* copy = malloc(sizeof(ASTNode));
+    if (!copy) return NULL;
+    
+    *copy = *original;
+    copy->next = NULL;
+    
+    // Own strings, shared children
+    switch (original->type) {
+        case NODE_LITERAL:
+            copy->data.literal.value = strdup(original->data.literal.value);
+            break;
+        case NODE_IDENTIFIER:
+            copy->data.identifier.name = strdup(original->data.identifier.name);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            copy->data.binary.operator = strdup(original->data.binary.operator);
+            break;
+        case NODE_UNARY_OP:
+            copy->data.unary.operator = strdup(original->data.unary.operator);
+            break;
+        case NODE_VARIABLE:
+        case NODE_PARAMETER:
+            copy->data.variable.name = strdup(original->data.variable.name);
+            copy->data.variable.type = original->data.variable.type ?
+                strdup(original->data.variable.type) : NULL;
+            break;
+        case NODE_FUNCTION:
+            copy->data.function.name = strdup(original->data.function.name);
+            copy->data.function.return_type = original->data.function.return_type ?
+                strdup(original->data.function.return_type) : NULL;
+            break;
+        case NODE_STRUCT:
+            copy->data.struct_def.name = original->data.struct_def.name ?
+                strdup(original->data.struct_def.name) : NULL;
+            break;
+        case NODE_GOTO:
+        case NODE_LABEL:
+            copy->data.jump.name = original->data.jump.name ?
+                strdup(original->data.jump.name) : NULL;
+            break;
+        default:
+            break;
+    }
+    
+    return copy;
+}
+
+ASTNode* ast_copy_list(ASTNode* original) {
+    ASTNode* head = NULL;
+    ASTNode* tail = NULL;
+    
+    for (ASTNode* node = original; node; node = node->next) {
+        ASTNode* copy = ast_copy(node);
+        if (!copy) break;
+        
+        if (!head) {
+            head = copy;
+        } else {
+            tail->next = copy;
+        }
+        tail = copy;
+    }
+    
+    return head;
+}
+
+ASTNode* ast_duplicate(ASTNode* original) {
+    ASTNode* copy = ast_copy(original);
+    if (!copy) return NULL;
+    
+    // Marks the copy as a second evaluation of the same value, which lets
+    // common-subexpression hoisting merge it even when it has side effects
+    copy->flags |= AST_FLAG_DUPLICATE;
+    return copy;
+}
+
+ASTNode* ast_link(ASTNode* first, ASTNode* second) {
+    if (!first) return second;
+    if (!second) return first;
+    
+    ASTNode* current = first;
+    while (current->next) {
+        current = current->next;
+    }
+    current->next = second;
+    return first;
+}
+
+void ast_overwrite(ASTNode* node, const ASTNode* replacement) {
+    // Keep list linkage, source location, hotness and cap of the node being
+    // replaced; markings already on it carry over to its replacement
+    ASTNode* next = node->next;
+    SourceLocation location = node->location;
+    unsigned int flags = node->flags;
+    int level_cap = node->level_cap;
+    float hotness = node->hotness;
+    
+    *node = *replacement;
+    node->next = next;
+    node->location = location;
+    node->flags |= flags;
+    node->level_cap = level_cap;
+    node->hotness = hotness;
+}
+
+void ast_replace_in_place(ASTNode* node, ASTNode* replacement) {
+    if (!node || !replacement || node == replacement) return;
+    
+    // Release the strings owned by the old payload; children are either
+    // reused by the replacement or owned by the caller
+    switch (node->type) {
+        case NODE_LITERAL:
+            free(node->data.literal.value);
+            break;
+        case NODE_IDENTIFIER:
+            free(node->data.identifier.name);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            free(node->data.binary.operator);
+            break;
+        case NODE_UNARY_OP:
+            free(node->data.unary.operator);
+            break;
+        default:
+            break;
+    }
+    
+    ast_overwrite(node, replacement);
+    
+    free(replacement);
+}
+
+void ast_replace_subtree(ASTNode* node, ASTNode* replacement) {
+    if (!node || !replacement || node == replacement) return;
+    
+    // Move the old payload into a detached shell so its children are freed;
+    // callers detach any child they want to keep before calling
+    ASTNode* old = malloc(sizeof(ASTNode));
+    if (!old) return;
+    
+    *old = *node;
+    old->next = NULL;
+    
+    ast_overwrite(node, replacement);
+    
+    free(replacement);
+    ast_node_destroy(old);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Inspection
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static size_t ast_count_list(const ASTNode* node) {
+    size_t count = 0;
+    for (; node; node = node->next) {
+        count += ast_count_nodes(node);
+    }
+    return count;
+}
+
+size_t ast_count_nodes(const ASTNode* node) {
+    if (!node) return 0;
+    
+    size_t count = 1;
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            count += ast_count_list(node->data.program.declarations);
+            break;
+        case NODE_FUNCTION:
+            count += ast_count_list(node->data.function.parameters);
+            count += ast_count_nodes(node->data.function.body);
+            break;
+        case NODE_VARIABLE:
+            count += ast_count_nodes(node->data.variable.initializer);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            count += ast_count_nodes(node->data.binary.left);
+            count += ast_count_list(node->data.binary.right);
+            break;
+        case NODE_UNARY_OP:
+            count += ast_count_nodes(node->data.unary.operand);
+            break;
+        case NODE_CALL:
+            count += ast_count_nodes(node->data.call.function);
+            count += ast_count_list(node->data.call.arguments);
+            break;
+        case NODE_IF:
+            count += ast_count_nodes(node->data.if_stmt.condition);
+            count += ast_count_nodes(node->data.if_stmt.then_stmt);
+            count += ast_count_nodes(node->data.if_stmt.else_stmt);
+            break;
+        case NODE_WHILE:
+            count += ast_count_nodes(node->data.while_stmt.condition);
+            count += ast_count_nodes(node->data.while_stmt.body);
+            break;
+        case NODE_FOR:
+            count += ast_count_nodes(node->data.for_stmt.init);
+            count += ast_count_nodes(node->data.for_stmt.condition);
+            count += ast_count_nodes(node->data.for_stmt.update);
+            count += ast_count_nodes(node->data.for_stmt.body);
+            break;
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            count += ast_count_list(node->data.block.statements);
+            break;
+        case NODE_SWITCH:
+            count += ast_count_nodes(node->data.switch_stmt.expression);
+            count += ast_count_list(node->data.switch_stmt.cases);
+            break;
+        case NODE_CASE:
+            count += ast_count_nodes(node->data.case_stmt.value);
+            count += ast_count_list(node->data.case_stmt.statements);
+            break;
+        case NODE_GOTO:
+            count += ast_count_nodes(node->data.jump.target);
+            break;
+        default:
+            break;
+    }
+    
+    return count;
+}
+
+bool ast_is_trivial_operand(const ASTNode* node) {
+    if (!node) return false;
+    return node->type == NODE_IDENTIFIER || node->type == NODE_LITERAL;
+}
+
+/* Unsuffixed literals of type int only, so a rewrite keeps the type */
+bool ast_literal_int_value(const ASTNode* node, int* value) {
+    if (!node || node->type != NODE_LITERAL) return false;
+    
+    const char* text = node->data.literal.value;
+    if (!text || !isdigit((unsigned char)text[0])) return false;
+    
+    char* end = NULL;
+    errno = 0;
+    unsigned long long parsed = strtoull(text, &end, 0);
+    if (errno != 0 || !end || *end != '\0' || parsed > INT_MAX) return false;
+    
+    *value = (int)parsed;
+    return true;
+}
+
+/* Character constants and unsuffixed decimal, octal or hex literals up to
+ * INT_MAX have type int */
+bool ast_is_int_literal(const ASTNode* node) {
+    if (!node || node->type != NODE_LITERAL) return false;
+    
+    int value;
+    const char* text = node->data.literal.value;
+    return (text && text[0] == '\'') || ast_literal_int_value(node, &value);
+}
+
+/* Int literals, and expressions typing_annotate() found to be int */
+bool ast_is_integer_operand(const ASTNode* node) {
+    if (!node) return false;
+    return (node->flags & AST_FLAG_INT) || ast_is_int_literal(node);
+}
+
+static bool operator_assigns(const char* op) {
+    if (!op) return false;
+    
+    size_t len = strlen(op);
+    if (len == 0 || op[len - 1] != '=') return false;
+    
+    // Comparisons end in '=' too
+    return strcmp(op, "==") != 0 && strcmp(op, "!=") != 0 &&
+           strcmp(op, "<=") != 0 && strcmp(op, ">=") != 0;
+}
+
+bool ast_has_side_effects(const ASTNode* node) {
+    if (!node) return false;
+    
+    switch (node->type) {
+        case NODE_LITERAL:
+        case NODE_IDENTIFIER:
+            return false;
+        case NODE_CALL:
+        case NODE_ASSIGNMENT:
+        case NODE_STMT_EXPR:
+            return true;
+        case NODE_BINARY_OP:
+        case NODE_ARRAY_ACCESS:
+            if (operator_assigns(node->data.binary.operator)) return true;
+            if (ast_has_side_effects(node->data.binary.left)) return true;
+            for (const ASTNode* r = node->data.binary.right; r; r = r->next) {
+                if (ast_has_side_effects(r)) return true;
+            }
+            return false;
+        case NODE_UNARY_OP:
+            if (strcmp(node->data.unary.operator, "++") == 0 ||
+                strcmp(node->data.unary.operator, "--") == 0) {
+                return true;
+            }
+            return ast_has_side_effects(node->data.unary.operand);
+        default:
+            // Unknown constructs are treated conservatively
+            return true;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Level Caps
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int tighter_cap(int a, int b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    return a < b ? a : b;
+}
+
+void ast_apply_level_cap(ASTNode* node, int cap) {
+    if (!node) return;
+    node->level_cap = tighter_cap(node->level_cap, cap);
+}
+
+static void propagate_list(ASTNode* list, int cap);
+
+static void propagate_node(ASTNode* node, int inherited) {
+    if (!node) return;
+    
+    node->level_cap = tighter_cap(node->level_cap, inherited);
+    int cap = node->level_cap;
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            propagate_list(node->data.program.declarations, cap);
+            break;
+        case NODE_FUNCTION:
+            propagate_list(node->data.function.parameters, cap);
+            propagate_node(node->data.function.body, cap);
+            break;
+        case NODE_VARIABLE:
+            propagate_node(node->data.variable.initializer, cap);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            propagate_node(node->data.binary.left, cap);
+            propagate_list(node->data.binary.right, cap);
+            break;
+        case NODE_UNARY_OP:
+            propagate_node(node->data.unary.operand, cap);
+            break;
+        case NODE_CALL:
+            propagate_node(node->data.call.function, cap);
+            propagate_list(node->data.call.arguments, cap);
+            break;
+        case NODE_IF:
+            propagate_node(node->data.if_stmt.condition, cap);
+            propagate_node(node->data.if_stmt.then_stmt, cap);
+            propagate_node(node->data.if_stmt.else_stmt, cap);
+            break;
+        case NODE_WHILE:
+            propagate_node(node->data.while_stmt.condition, cap);
+            propagate_node(node->data.while_stmt.body, cap);
+            break;
+        case NODE_FOR:
+            propagate_node(node->data.for_stmt.init, cap);
+            propagate_node(node->data.for_stmt.condition, cap);
+            propagate_node(node->data.for_stmt.update, cap);
+            propagate_node(node->data.for_stmt.body, cap);
+            break;
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            propagate_list(node->data.block.statements, cap);
+            break;
+        case NODE_SWITCH:
+            propagate_node(node->data.switch_stmt.expression, cap);
+            propagate_list(node->data.switch_stmt.cases, cap);
+            break;
+        case NODE_CASE:
+            propagate_list(node->data.case_stmt.statements, cap);
+            break;
+        default:
+            break;
+    }
+}
+
+static void propagate_list(ASTNode* list, int cap) {
+    for (; list; list = list->next) {
+        propagate_node(list, cap);
+    }
+}
+
+void ast_propagate_level_caps(ASTNode* root) {
+    // Siblings of the root keep their own caps
+    propagate_list(root, 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Structural Comparison
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME        1099511628211ULL
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t hash_string(uint64_t hash, const char* str) {
+    if (!str) return hash_bytes(hash, "", 1);
+    return hash_bytes(hash, str, strlen(str) + 1);
+}
+
+static uint64_t hash_child(uint64_t hash, const ASTNode* child) {
+    uint64_t child_hash = ast_hash(child);
+    return hash_bytes(hash, &child_hash, sizeof(child_hash));
+}
+
+static uint64_t hash_list(uint64_t hash, const ASTNode* list) {
+    for (; list; list = list->next) {
+        hash = hash_child(hash, list);
+    }
+    return hash_bytes(hash, "", 1);
+}
+
+uint64_t ast_hash(const ASTNode* node) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    if (!node) return hash;
+    
+    hash = hash_bytes(hash, &node->type, sizeof(node->type));
+    
+    switch (node->type) {
+        case NODE_LITERAL:
+            hash = hash_string(hash, node->data.literal.value);
+            break;
+        case NODE_IDENTIFIER:
+            hash = hash_string(hash, node->data.identifier.name);
+            break;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            hash = hash_string(hash, node->data.binary.operator);
+            hash = hash_child(hash, node->data.binary.left);
+            hash = hash_list(hash, node->data.binary.right);
+            break;
+        case NODE_UNARY_OP:
+            hash = hash_string(hash, node->data.unary.operator);
+            hash = hash_bytes(hash, &node->data.unary.is_prefix, sizeof(bool));
+            hash = hash_child(hash, node->data.unary.operand);
+            break;
+        case NODE_CALL:
+            hash = hash_child(hash, node->data.call.function);
+            hash = hash_list(hash, node->data.call.arguments);
+            break;
+        case NODE_VARIABLE:
+            hash = hash_string(hash, node->data.variable.type);
+            hash = hash_string(hash, node->data.variable.name);
+            hash = hash_child(hash, node->data.variable.initializer);
+            break;
+        case NODE_STMT_EXPR:
+            hash = hash_list(hash, node->data.block.statements);
+            break;
+        default:
+            // Other constructs hash by identity so they never compare equal
+            hash = hash_bytes(hash, &node, sizeof(node));
+            break;
+    }
+    
+    return hash;
+}
+
+static bool strings_equal(const char* a, const char* b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static bool lists_equal(const ASTNode* a, const ASTNode* b) {
+    while (a && b) {
+        if (!ast_equal(a, b)) return false;
+        a = a->next;
+        b = b->next;
+    }
+    return a == b;
+}
+
+bool ast_equal(const ASTNode* a, const ASTNode* b) {
+    if (a == b) return true;
+    if (!a || !b || a->type != b->type) return false;
+    
+    switch (a->type) {
+        case NODE_LITERAL:
+            return strings_equal(a->data.literal.value, b->data.literal.value);
+        case NODE_IDENTIFIER:
+            return strings_equal(a->data.identifier.name, b->data.identifier.name);
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            return strings_equal(a->data.binary.operator, b->data.binary.operator) &&
+                   ast_equal(a->data.binary.left, b->data.binary.left) &&
+                   lists_equal(a->data.binary.right, b->data.binary.right);
+        case NODE_UNARY_OP:
+            return strings_equal(a->data.unary.operator, b->data.unary.operator) &&
+                   a->data.unary.is_prefix == b->data.unary.is_prefix &&
+                   ast_equal(a->data.unary.operand, b->data.unary.operand);
+        case NODE_CALL:
+            return ast_equal(a->data.call.function, b->data.call.function) &&
+                   lists_equal(a->data.call.arguments, b->data.call.arguments);
+        case NODE_VARIABLE:
+            return strings_equal(a->data.variable.type, b->data.variable.type) &&
+                   strings_equal(a->data.variable.name, b->data.variable.name) &&
+                   ast_equal(a->data.variable.initializer, b->data.variable.initializer);
+        case NODE_STMT_EXPR:
+            return lists_equal(a->data.block.statements, b->data.block.statements);
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef OBFUSCATOR_AST_UTILS_H
+#define OBFUSCATOR_AST_UTILS_H
+
+#include "../common/types.h"
+#include <stdint.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * AST Construction and Inspection Helpers (shared by obfuscation passes)
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Node Construction */
+ASTNode* ast_create_literal(const char* value);
+ASTNode* ast_create_literal_number(int value);
+ASTNode* ast_create_identifier(const char* name);
+ASTNode* ast_create_binary_op(const char* op, ASTNode* left, ASTNode* right);
+ASTNode* ast_create_unary_op(const char* op, ASTNode* operand, bool is_prefix);
+ASTNode* ast_create_cast(const char* type, ASTNode* operand);
+ASTNode* ast_create_variable(const char* name, const char* type, ASTNode* initializer);
+ASTNode* ast_create_assignment(ASTNode* target, ASTNode* value);
+ASTNode* ast_create_array_access(ASTNode* array, ASTNode* index);
+ASTNode* ast_create_if(ASTNode* condition, ASTNode* then_stmt, ASTNode* else_stmt);
+ASTNode* ast_create_while(ASTNode* condition, ASTNode* body);
+ASTNode* ast_create_for(ASTNode* init, ASTNode* condition, ASTNode* update, ASTNode* body);
+ASTNode* ast_create_block(ASTNode* statements);
+ASTNode* ast_create_call(ASTNode* function, ASTNode* arguments);
+ASTNode* ast_create_stmt_expr(ASTNode* statements);
+ASTNode* ast_create_switch(ASTNode* expression, ASTNode* cases);
+ASTNode* ast_create_case(ASTNode* value, ASTNode* statements);
+ASTNode* ast_create_break(void);
+ASTNode* ast_create_return(void);
+ASTNode* ast_create_goto(const char* label);
+ASTNode* ast_create_computed_goto(ASTNode* target);
+ASTNode* ast_create_label(const char* name);
+
+/* Copying and Linking */
+ASTNode* ast_copy(ASTNode* original);
+ASTNode* ast_copy_list(ASTNode* original);
+ASTNode* ast_copy_node(const ASTNode* original);   /* Shares the children */
+ASTNode* ast_duplicate(ASTNode* original);
+ASTNode* ast_link(ASTNode* first, ASTNode* second);
+void ast_overwrite(ASTNode* node, const ASTNode* replacement);   /* Frees nothing */
+void ast_replace_in_place(ASTNode* node, ASTNode* replacement);
+void ast_replace_subtree(ASTNode* node, ASTNode* replacement);
+
+/* Inspection */
+size_t ast_count_nodes(const ASTNode* node);
+bool ast_is_trivial_operand(const ASTNode* node);
+bool ast_is_int_literal(const ASTNode* node);
+bool ast_is_integer_operand(const ASTNode* node);
+bool ast_literal_int_value(const ASTNode* node, int* value);
+bool ast_has_side_effects(const ASTNode* node);
+
+/* Level Caps */
+void ast_apply_level_cap(ASTNode* node, int cap);
+void ast_propagate_level_caps(ASTNode* root);
+
+/* Structural Comparison */
+uint64_t ast_hash(const ASTNode* node);
+bool ast_equal(const ASTNode* a, const ASTNode* b);
+
+#endif /* OBFUSCATOR_AST_UTILS_H */
@@ -0,0 +1,429 @@
+#include "autotune.h"
+#include "ast_utils.h"
+#include "../codegen/codegen.h"
+#include "../parser/parser.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Rendering
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+char* autotune_render(const ASTNode* ast, const ObfuscationConfig* config) {
+    if (!ast) return NULL;
+    
+    ASTNode* copy = ast_copy_list((ASTNode*)ast);
+    if (!copy) return NULL;
+    
+    ObfuscationContext* ctx = NULL;
+    char* prologue = NULL;
+    if (config) {
+        ctx = obfuscator_create((ObfuscationConfig*)config);
+        if (!ctx || !obfuscate_ast(ctx, copy)) {
+            obfuscator_destroy(ctx);
+            ast_tree_destroy(copy);
+            return NULL;
+        }
+        prologue = obfuscator_runtime_prologue(ctx);
+    }
+    
+    CodeGenConfig* codegen_config = codegen_config_create_default();
+    if (!codegen_config) {
+        free(prologue);
+        obfuscator_destroy(ctx);
+        ast_tree_destroy(copy);
+        return NULL;
+    }
+    codegen_config->seed = config && config->seed ? config->seed : 1;
+    if (config) codegen_config_set_style(codegen_config, config->aesthetic);
+    CodeGenState* codegen = codegen_create(codegen_config);
+    
+    char* code = NULL;
+    if (codegen) {
+        codegen_set_prologue(codegen, prologue);
+        code = generate_code(codegen, copy);
+    }
+    
+    codegen_destroy(codegen);
+    codegen_config_destroy(codegen_config);
+    free(prologue);
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(copy);
+    return code;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Default Measurement: Local Compiler and Benchmark Command
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* `bench` with every `{}` replaced by `binary`, or `binary` appended */
+static char* bench_command(const char* bench, const char* binary) {
+    size_t binary_length = strlen(binary);
+    size_t length = strlen(bench) + binary_length + 2;
+    for (const char* p = strstr(bench, "{}"); p; p = strstr(p + 2, "{}")) {
+        length += binary_length;
+    }
+    
+    char* command = malloc(length);
+    if (!command) return NULL;
+    
+    char* out = command;
+    bool substituted = false;
+    for (const char* p = bench; *p; ) {
+        if (p[0] == '{' && p[1] == '}') {
+            memcpy(out, binary, binary_length);
+            out += binary_length;
+            p += 2;
+            substituted = true;
+        } else {
+            *out++ = *p++;
+        }
+    }
+    if (!substituted) {
+        *out++ = ' ';
+        memcpy(out, binary, binary_length);
+        out += binary_length;
+    }
+    *out = '\0';
+    return command;
+}
+
+bool autotune_measure_command(const char* code, void* user, AutotuneSample* sample) {
+    const AutotuneOptions* options = user;
+    if (!code || !options || !options->bench || !sample) return false;
+    
+    char dir[] = "/tmp/obf-tune-XXXXXX";
+    if (!mkdtemp(dir)) return false;
+    
+    char source[64], binary[64], command[512];
+    snprintf(source, sizeof(source), "%s/candidate.c", dir);
+    snprintf(binary, sizeof(binary), "%s/candidate", dir);
+    
+    bool ok = false;
+    FILE* file = fopen(source, "w");
+    if (file) {
+        ok = fputs(code, file) >= 0;
+        ok = fclose(file) == 0 && ok;
+    }
+    
+    if (ok) {
+        snprintf(command, sizeof(command), "%s -O2 -o %s %s >/dev/null 2>&1",
+                 options->compiler ? options->compiler : "cc", binary, source);
+        ok = system(command) == 0;
+    }
+    
+    struct stat info;
+    if (ok && stat(binary, &info) == 0) {
+        sample->size = (size_t)info.st_size;
+    } else {
+        ok = false;
+    }
+    
+    char* bench = ok ? bench_command(options->bench, binary) : NULL;
+    if (ok && !bench) ok = false;
+    
+    // The fastest run is the one least disturbed by the rest of the machine
+    int runs = options->runs > 0 ? options->runs : 1;
+    for (int i = 0; ok && i < runs; i++) {
+        double start = now_seconds();
+        ok = system(bench) == 0;
+        double elapsed = now_seconds() - start;
+        if (i == 0 || elapsed < sample->seconds) sample->seconds = elapsed;
+    }
+    
+    free(bench);
+    remove(binary);
+    remove(source);
+    rmdir(dir);
+    return ok;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Search
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const int mba_steps[] = AUTOTUNE_MBA_STEPS;
+static const int dead_code_steps[] = AUTOTUNE_DEAD_CODE_STEPS;
+
+#define MBA_STEP_COUNT       ((int)(sizeof(mba_steps) / sizeof(mba_steps[0])))
+#define DEAD_CODE_STEP_COUNT ((int)(sizeof(dead_code_steps) / sizeof(dead_code_steps[0])))
+
+/* Knob positions; 0 is the strongest setting of each */
+typedef struct {
+    int* levels;               /* Per function, an ObfuscationLevel */
+    int mba_step;
+    bool decrypt_all;
+    bool flatten;
+    int dead_code_step;
+} Candidate;
+
+typedef struct {
+    const char** functions;
+    int function_count;
+    const ObfuscationConfig* base;
+    const AutotuneOptions* options;
+    AutotuneSample baseline;
+    int measured;
+} Tuner;
+
+static int collect_functions(const ASTNode* node, const char** names, int count) {
+    for (; node; node = node->next) {
+        if (node->type == NODE_PROGRAM) {
+            count = collect_functions(node->data.program.declarations, names, count);
+        } else if (node->type == NODE_FUNCTION && node->data.function.name) {
+            if (names) names[count] = node->data.function.name;
+            count++;
+        }
+    }
+    return count;
+}
+
+static ObfuscationConfig* candidate_config(const Tuner* tuner, const Candidate* candidate) {
+    ObfuscationConfig* config = config_clone(tuner->base);
+    if (!config) return NULL;
+    
+    config->seed = tuner->options->seed;
+    config->level = OBF_EXTREME;
+    config->mba_expr_budget = mba_steps[candidate->mba_step];
+    config->string_decrypt_all = candidate->decrypt_all;
+    config->obfuscate_control_flow = candidate->flatten;
+    config->dead_code_percent = dead_code_steps[candidate->dead_code_step];
+    
+    for (int i = 0; i < tuner->function_count; i++) {
+        if (!config_set_function_level(config, tuner->functions[i], candidate->levels[i])) {
+            config_destroy(config);
+            return NULL;
+        }
+    }
+    return config;
+}
+
+/* How far over budget a sample is; at most 1.0 when within it */
+static double overshoot(const Tuner* tuner, const AutotuneSample* sample,
+                        double* slowdown, double* growth) {
+    const AutotuneOptions* options = tuner->options;
+    double base_seconds = tuner->baseline.seconds > 1e-9 ? tuner->baseline.seconds : 1e-9;
+    double base_size = tuner->baseline.size > 0 ? (double)tuner->baseline.size : 1.0;
+    
+    *slowdown = sample->seconds / base_seconds;
+    *growth = (double)sample->size / base_size;
+    
+    double time_ratio = *slowdown / options->max_slowdown;
+    double size_ratio = *growth / options->max_growth;
+    return time_ratio > size_ratio ? time_ratio : size_ratio;
+}
+
+static bool measure(Tuner* tuner, const ASTNode* ast, const ObfuscationConfig* config,
+                    AutotuneSample* sample) {
+    const AutotuneOptions* options = tuner->options;
+    char* code = autotune_render(ast, config);
+    if (!code) return false;
+    
+    AutotuneMeasure measure_code = options->measure ? options->measure : autotune_measure_command;
+    void* user = options->measure ? options->user : (void*)options;
+    
+    sample->seconds = 0.0;
+    sample->size = 0;
+    bool ok = measure_code(code, user, sample);
+    free(code);
+    
+    if (config) tuner->measured++;
+    return ok;
+}
+
+/* Weakens one knob; false when it is already at its weakest */
+static bool apply_move(const Tuner* tuner, Candidate* candidate, int move) {
+    if (move < tuner->function_count) {
+        if (candidate->levels[move] <= OBF_BASIC) return false;
+        candidate->levels[move]--;
+        return true;
+    }
+    
+    switch (move - tuner->function_count) {
+        case 0:
+            if (candidate->mba_step + 1 >= MBA_STEP_COUNT) return false;
+            candidate->mba_step++;
+            return true;
+        case 1:
+            if (candidate->decrypt_all) return false;
+            candidate->decrypt_all = true;
+            return true;
+        case 2:
+            if (!candidate->flatten) return false;
+            candidate->flatten = false;
+            return true;
+        case 3:
+            if (candidate->dead_code_step + 1 >= DEAD_CODE_STEP_COUNT) return false;
+            candidate->dead_code_step++;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void report(const Tuner* tuner, const char* what, double slowdown, double growth) {
+    if (!tuner->options->verbose) return;
+    if (isinf(slowdown)) {
+        printf("  autotune #%d %s: failed to build or run\n", tuner->measured, what);
+    } else {
+        printf("  autotune #%d %s: %.2fx time, %.2fx size\n", tuner->measured, what, slowdown, growth);
+    }
+}
+
+/* Overshoot of a candidate; infinite when it cannot be built or measured,
+ * so any candidate that can beats it but the descent goes on */
+static double evaluate(Tuner* tuner, const ASTNode* ast, const ObfuscationConfig* config,
+                       const char* what, AutotuneSample* sample, double* slowdown, double* growth) {
+    double score;
+    if (measure(tuner, ast, config, sample)) {
+        score = overshoot(tuner, sample, slowdown, growth);
+    } else {
+        sample->seconds = 0.0;
+        sample->size = 0;
+        *slowdown = *growth = score = HUGE_VAL;
+    }
+    report(tuner, what, *slowdown, *growth);
+    return score;
+}
+
+void autotune_options_init(AutotuneOptions* options) {
+    if (!options) return;
+    
+    options->max_slowdown = 2.0;
+    options->max_growth = 3.0;
+    options->compiler = "cc";
+    options->bench = NULL;
+    options->runs = 3;
+    options->seed = 1;
+    options->measure = NULL;
+    options->user = NULL;
+    options->verbose = false;
+}
+
+/* Greedy descent from the strongest candidate; false when the original
+ * program cannot be measured */
+static bool search(Tuner* tuner, const ASTNode* ast, Candidate* current, Candidate* trial,
+                   AutotuneResult* result) {
+    int slots = tuner->function_count > 0 ? tuner->function_count : 1;
+    for (int i = 0; i < tuner->function_count; i++) current->levels[i] = OBF_EXTREME;
+    current->mba_step = 0;
+    current->decrypt_all = false;
+    current->flatten = true;
+    current->dead_code_step = 0;
+    
+    if (!measure(tuner, ast, NULL, &tuner->baseline)) return false;
+    
+    result->config = candidate_config(tuner, current);
+    if (!result->config) return false;
+    double score = evaluate(tuner, ast, result->config, "strongest", &result->best,
+                            &result->slowdown, &result->growth);
+    
+    // Take the single weakening that helps most until the budget is met;
+    // every round weakens something, so the search ends
+    int move_count = tuner->function_count + 4;
+    while (score > 1.0) {
+        int best_move = -1;
+        double best_score = score;
+        ObfuscationConfig* best_config = NULL;
+        AutotuneSample best_sample = {0};
+        double best_slowdown = 0.0, best_growth = 0.0;
+        
+        for (int move = 0; move < move_count; move++) {
+            memcpy(trial->levels, current->levels, sizeof(int) * slots);
+            trial->mba_step = current->mba_step;
+            trial->decrypt_all = current->decrypt_all;
+            trial->flatten = current->flatten;
+            trial->dead_code_step = current->dead_code_step;
+            if (!apply_move(tuner, trial, move)) continue;
+            
+            ObfuscationConfig* config = candidate_config(tuner, trial);
+            if (!config) continue;
+            
+            AutotuneSample sample;
+            double slowdown, growth;
+            double trial_score = evaluate(tuner, ast, config,
+                                          move < tuner->function_count ? tuner->functions[move] : "global",
+                                          &sample, &slowdown, &growth);
+            
+            // Ties go to the earlier move, which keeps knobs in a stable order
+            if (best_move < 0 || trial_score < best_score) {
+                config_destroy(best_config);
+                best_config = config;
+                best_move = move;
+                best_score = trial_score;
+                best_sample = sample;
+                best_slowdown = slowdown;
+                best_growth = growth;
+            } else {
+                config_destroy(config);
+            }
+        }
+        
+        // Nothing left to weaken
+        if (best_move < 0) break;
+        
+        apply_move(tuner, current, best_move);
+        config_destroy(result->config);
+        result->config = best_config;
+        result->best = best_sample;
+        result->slowdown = best_slowdown;
+        result->growth = best_growth;
+        score = best_score;
+    }
+    
+    result->baseline = tuner->baseline;
+    result->candidates = tuner->measured;
+    result->within_budget = score <= 1.0;
+    return true;
+}
+
+AutotuneResult* autotune(const ASTNode* ast, const ObfuscationConfig* base,
+                         const AutotuneOptions* options) {
+    if (!ast || !base || !options) return NULL;
+    if (options->max_slowdown <= 0.0 || options->max_growth <= 0.0) return NULL;
+    
+    Tuner tuner = {0};
+    tuner.base = base;
+    tuner.options = options;
+    tuner.function_count = collect_functions(ast, NULL, 0);
+    
+    int slots = tuner.function_count > 0 ? tuner.function_count : 1;
+    tuner.functions = malloc(sizeof(const char*) * slots);
+    Candidate current = {0}, trial = {0};
+    current.levels = malloc(sizeof(int) * slots);
+    trial.levels = malloc(sizeof(int) * slots);
+    AutotuneResult* result = calloc(1, sizeof(AutotuneResult));
+    
+    bool ok = tuner.functions && current.levels && trial.levels && result;
+    if (ok) {
+        collect_functions(ast, tuner.functions, 0);
+        ok = search(&tuner, ast, &current, &trial, result);
+    }
+    
+    free(tuner.functions);
+    free(current.levels);
+    free(trial.levels);
+    if (!ok) {
+        autotune_result_destroy(result);
+        return NULL;
+    }
+    return result;
+}
+
+void autotune_result_destroy(AutotuneResult* result) {
+    if (!result) return;
+    
+    config_destroy(result->config);
+    free(result);
+}
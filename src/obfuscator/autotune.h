@@ -0,0 +1,79 @@
+#ifndef OBFUSCATOR_AUTOTUNE_H
+#define OBFUSCATOR_AUTOTUNE_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Overhead Autotuning
+ *
+ * Searches for the strongest configuration whose output stays within a
+ * slowdown and a size budget, both relative to the unobfuscated program.
+ * The search starts with every knob at its strongest setting and
+ * greedily takes, one at a time, the weakening step that brings the
+ * measured overshoot down the most:
+ *
+ *   - each function's level cap (extreme → intermediate → basic)
+ *   - MBA budget per expression (AUTOTUNE_MBA_STEPS)
+ *   - string decryption per literal → whole table on first use
+ *   - control-flow flattening on → off
+ *   - dead-code density (AUTOTUNE_DEAD_CODE_STEPS)
+ *
+ * Candidates are rendered with a fixed seed, built with the local C
+ * compiler and timed by running a user-supplied benchmark command on the
+ * binary; the fastest of several runs counts. Measurement is a callback,
+ * so it can be replaced (tests, remote runners).
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define AUTOTUNE_MBA_STEPS        { 48, 24, 8, 0 }
+#define AUTOTUNE_DEAD_CODE_STEPS  { 30, 15, 0 }
+
+/* Cost of one candidate */
+typedef struct {
+    double seconds;            /* Benchmark wall time */
+    size_t size;               /* Output size in bytes (the binary by default) */
+} AutotuneSample;
+
+/* Builds and times `code`; false when it does not compile or run */
+typedef bool (*AutotuneMeasure)(const char* code, void* user, AutotuneSample* sample);
+
+typedef struct {
+    double max_slowdown;       /* Benchmark time relative to the original */
+    double max_growth;         /* Output size relative to the original */
+    const char* compiler;      /* Default measurement: "cc" */
+    const char* bench;         /* Command; `{}` is replaced by the binary's path,
+                                  which is appended when absent */
+    int runs;                  /* Timing runs per candidate */
+    unsigned int seed;         /* Every candidate is rendered with this seed;
+                                  nonzero */
+    AutotuneMeasure measure;   /* NULL: compile and time with the above */
+    void* user;
+    bool verbose;              /* One line per measured candidate */
+} AutotuneOptions;
+
+typedef struct {
+    ObfuscationConfig* config; /* Best configuration found */
+    AutotuneSample baseline;
+    AutotuneSample best;
+    double slowdown;
+    double growth;
+    int candidates;            /* Configurations measured */
+    bool within_budget;        /* Otherwise `config` is the closest found */
+} AutotuneResult;
+
+void autotune_options_init(AutotuneOptions* options);
+
+/* Tunes `base` (left untouched) for the program `ast`; NULL when the
+ * original program cannot be measured. Candidates that fail to build or
+ * run count as infinitely over budget. */
+AutotuneResult* autotune(const ASTNode* ast, const ObfuscationConfig* base,
+                         const AutotuneOptions* options);
+void autotune_result_destroy(AutotuneResult* result);
+
+/* Obfuscates a copy of `ast` with `config` (NULL: unobfuscated) and
+ * generates its code, prologue included; repeatable when config->seed is set */
+char* autotune_render(const ASTNode* ast, const ObfuscationConfig* config);
+
+/* The default measurement; `user` is the AutotuneOptions */
+bool autotune_measure_command(const char* code, void* user, AutotuneSample* sample);
+
+#endif /* OBFUSCATOR_AUTOTUNE_H */
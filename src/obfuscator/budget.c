@@ -0,0 +1,145 @@
+#include "budget.h"
+#include "ast_utils.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Setup
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Nodes `original` may gain under a growth ratio; -1 = unlimited */
+static long growth_limit(long original, double max_growth) {
+    if (max_growth <= 0.0) return -1;
+    
+    double limit = (double)original * (max_growth - 1.0);
+    if (limit < 0.0) return 0;
+    return limit > (double)LONG_MAX ? LONG_MAX : (long)limit;
+}
+
+static bool add_functions(GrowthBudget* budget, const ObfuscationConfig* config,
+                          const ASTNode* node) {
+    for (; node; node = node->next) {
+        if (node->type == NODE_PROGRAM) {
+            if (!add_functions(budget, config, node->data.program.declarations)) return false;
+            continue;
+        }
+        if (node->type != NODE_FUNCTION) continue;
+        
+        FunctionGrowth* function = calloc(1, sizeof(FunctionGrowth));
+        if (!function) return false;
+        
+        function->function = node;
+        function->name = node->data.function.name ? strdup(node->data.function.name) : NULL;
+        function->original = (long)ast_count_nodes(node);
+        function->limit = growth_limit(function->original, config->max_growth);
+        function->next = budget->functions;
+        budget->functions = function;
+    }
+    return true;
+}
+
+GrowthBudget* budget_create(const ObfuscationConfig* config, const ASTNode* ast) {
+    if (!config || (config->max_growth <= 0.0 && config->max_nodes <= 0)) return NULL;
+    
+    GrowthBudget* budget = calloc(1, sizeof(GrowthBudget));
+    if (!budget) return NULL;
+    
+    for (const ASTNode* node = ast; node; node = node->next) {
+        budget->original += (long)ast_count_nodes(node);
+    }
+    
+    // The tighter of the ratio and the absolute cap wins
+    budget->limit = growth_limit(budget->original, config->max_growth);
+    if (config->max_nodes > 0) {
+        long cap = config->max_nodes > budget->original ? config->max_nodes - budget->original : 0;
+        if (budget->limit < 0 || cap < budget->limit) budget->limit = cap;
+    }
+    
+    if (!add_functions(budget, config, ast)) {
+        budget_destroy(budget);
+        return NULL;
+    }
+    return budget;
+}
+
+void budget_destroy(GrowthBudget* budget) {
+    if (!budget) return;
+    
+    FunctionGrowth* function = budget->functions;
+    while (function) {
+        FunctionGrowth* next = function->next;
+        free(function->name);
+        free(function);
+        function = next;
+    }
+    free(budget);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Accounting
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void budget_enter(GrowthBudget* budget, const ASTNode* function) {
+    if (!budget) return;
+    
+    budget->current = NULL;
+    for (FunctionGrowth* f = budget->functions; f && function; f = f->next) {
+        if (f->function == function) {
+            budget->current = f;
+            return;
+        }
+    }
+}
+
+long budget_remaining(const GrowthBudget* budget) {
+    if (!budget) return LONG_MAX;
+    
+    long remaining = LONG_MAX;
+    if (budget->limit >= 0) {
+        remaining = budget->limit - budget->added;
+    }
+    
+    const FunctionGrowth* f = budget->current;
+    if (f && f->limit >= 0 && f->limit - f->added < remaining) {
+        remaining = f->limit - f->added;
+    }
+    return remaining > 0 ? remaining : 0;
+}
+
+bool budget_allows(GrowthBudget* budget, long nodes) {
+    if (!budget || nodes <= budget_remaining(budget)) return true;
+    
+    budget->degraded++;
+    return false;
+}
+
+int budget_cap(GrowthBudget* budget, int wanted) {
+    long remaining = budget_remaining(budget);
+    if (remaining >= wanted) return wanted;
+    
+    budget->degraded++;
+    return (int)remaining;
+}
+
+void budget_charge(GrowthBudget* budget, long nodes) {
+    if (!budget) return;
+    
+    budget->added += nodes;
+    if (budget->current) {
+        budget->current->added += nodes;
+    }
+}
+
+void budget_print(const GrowthBudget* budget, FILE* out) {
+    if (!budget || !out) return;
+    
+    long total = budget->original + budget->added;
+    fprintf(out, "Growth: %ld -> %ld nodes (%.2fx)", budget->original, total,
+            budget->original > 0 ? (double)total / (double)budget->original : 1.0);
+    if (budget->limit >= 0) {
+        fprintf(out, ", limit %ld", budget->original + budget->limit);
+    }
+    fprintf(out, "; %d transformation%s scaled back\n", budget->degraded,
+            budget->degraded == 1 ? "" : "s");
+}
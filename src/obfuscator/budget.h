@@ -0,0 +1,59 @@
+#ifndef OBFUSCATOR_BUDGET_H
+#define OBFUSCATOR_BUDGET_H
+
+#include "../common/types.h"
+#include <stdio.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Growth Budget
+ *
+ * Bounds how many AST nodes the passes may add, program-wide and per
+ * function. `--max-growth 3x` lets the program and each function grow to
+ * three times their original node count; `--max-nodes N` caps the
+ * program's total. Passes charge what they add as they go and, once a
+ * budget runs low, pick a smaller variant (a cheaper MBA identity, a dead
+ * assignment instead of a bogus branch) or leave the code as it is.
+ *
+ * A NULL budget is unlimited, so passes call these unconditionally.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct FunctionGrowth {
+    const ASTNode* function;   /* Identity only */
+    char* name;
+    long original;             /* Nodes before any pass */
+    long limit;                /* Most nodes it may gain; -1 = unlimited */
+    long added;
+    struct FunctionGrowth* next;
+} FunctionGrowth;
+
+typedef struct {
+    long original;
+    long limit;                /* Most nodes the program may gain; -1 = unlimited */
+    long added;
+    FunctionGrowth* functions;
+    FunctionGrowth* current;   /* Function being transformed; NULL at file scope */
+    int degraded;              /* Transformations shrunk or skipped */
+} GrowthBudget;
+
+/* NULL when the configuration sets no limit */
+GrowthBudget* budget_create(const ObfuscationConfig* config, const ASTNode* ast);
+void budget_destroy(GrowthBudget* budget);
+
+/* Charges go to `function` (NULL: file scope) until the next call */
+void budget_enter(GrowthBudget* budget, const ASTNode* function);
+
+/* Nodes that may still be added here */
+long budget_remaining(const GrowthBudget* budget);
+
+/* Whether `nodes` more fit; a refusal counts as a degraded transformation */
+bool budget_allows(GrowthBudget* budget, long nodes);
+
+/* Lowers a pass's own growth allowance to what is left */
+int budget_cap(GrowthBudget* budget, int wanted);
+
+/* Records growth (negative when a pass shrinks code) */
+void budget_charge(GrowthBudget* budget, long nodes);
+
+void budget_print(const GrowthBudget* budget, FILE* out);
+
+#endif /* OBFUSCATOR_BUDGET_H */
@@ -0,0 +1,264 @@
+#include "constants.h"
+#include "ast_utils.h"
+#include "../analysis/hotness.h"
+#include "../parser/parser.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Encodings
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* The pool read is an L1 hit once its line is warm */
+static const int encoding_costs[CONSTANT_ENCODING_COUNT] = {
+    [CONSTANT_ENCODING_SHARES] = 1,
+    [CONSTANT_ENCODING_AFFINE] = 4,
+    [CONSTANT_ENCODING_TABLE]  = 5,
+};
+
+int constant_encoding_cost(ConstantEncoding encoding) {
+    if (encoding < 0 || encoding >= CONSTANT_ENCODING_COUNT) return INT_MAX;
+    return encoding_costs[encoding];
+}
+
+static int random_int(Random* random) {
+    return (int)(random_next(random) & 0x7fffffffu);
+}
+
+static ASTNode* hex_literal(int value) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "0x%x", (unsigned int)value);
+    return ast_create_literal(buffer);
+}
+
+static ASTNode* encode_shares(Random* random, int value) {
+    int share = random_int(random);
+    return ast_create_binary_op("^", hex_literal(share), hex_literal(value ^ share));
+}
+
+/* A random quotient rather than value / modulus, which is 0 for most small
+ * literals and would leave the value itself as the remainder */
+static ASTNode* encode_affine(Random* random, int value) {
+    int modulus = 3 + random_below(random, 1021);
+    int quotient = 1 + random_below(random, 32767);
+    
+    // |quotient * modulus| < 2^25, so the remainder stays within int
+    int remainder = value - quotient * modulus;
+    if (remainder == 0) {
+        quotient++;
+        remainder -= modulus;
+    }
+    
+    ASTNode* product = ast_create_binary_op("*", ast_create_literal_number(quotient),
+                                            ast_create_literal_number(modulus));
+    if (remainder < 0) {
+        return ast_create_binary_op("-", product, ast_create_literal_number(-remainder));
+    }
+    return ast_create_binary_op("+", product, ast_create_literal_number(remainder));
+}
+
+static ASTNode* encode_table(ObfuscationContext* ctx, int value) {
+    int mask = random_int(ctx->random);
+    int index = constant_pool_add(ctx->constants, value ^ mask);
+    if (index < 0) return NULL;
+    
+    return ast_create_call(ast_create_identifier("__obf_const"),
+                           ast_link(ast_create_literal_number(index), hex_literal(mask)));
+}
+
+int constant_budget(const ObfuscationContext* ctx, const ASTNode* node) {
+    int budget = ctx->config->constant_cost_budget;
+    
+    // Same scaling as the transformation odds: a loop keeps a quarter
+    if (ctx->config->static_hotness && node) {
+        budget = hotness_scale_percent(budget, node->hotness);
+    }
+    return budget;
+}
+
+ASTNode* constant_encode(ObfuscationContext* ctx, int value, int budget) {
+    if (!ctx || value < 0) return NULL;
+    
+    ConstantEncoding affordable[CONSTANT_ENCODING_COUNT];
+    int count = 0;
+    for (int i = 0; i < CONSTANT_ENCODING_COUNT; i++) {
+        if (encoding_costs[i] <= budget) affordable[count++] = (ConstantEncoding)i;
+    }
+    if (count == 0) return NULL;
+    
+    ASTNode* encoded = NULL;
+    switch (affordable[random_below(ctx->random, count)]) {
+        case CONSTANT_ENCODING_TABLE:
+            encoded = encode_table(ctx, value);
+            if (encoded) break;
+            // A full pool falls back to the cheapest form
+            encoded = encode_shares(ctx->random, value);
+            break;
+        case CONSTANT_ENCODING_AFFINE:
+            encoded = encode_affine(ctx->random, value);
+            break;
+        default:
+            encoded = encode_shares(ctx->random, value);
+            break;
+    }
+    
+    // The simplifier would fold the arithmetic forms straight back
+    if (encoded) {
+        encoded->flags |= AST_FLAG_OPAQUE;
+    }
+    return encoded;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Pass
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void encode_expression(ObfuscationContext* ctx, ASTNode* node) {
+    if (!node || (node->flags & (AST_FLAG_OPAQUE | AST_FLAG_PROTECTED))) return;
+    
+    switch (node->type) {
+        case NODE_LITERAL: {
+            int value;
+            if (!ast_literal_int_value(node, &value)) break;
+            if (obfuscator_effective_level(ctx, node) < OBF_INTERMEDIATE) break;
+            if (!obfuscator_should_apply(ctx, node, 50)) break;
+            
+            ASTNode* encoded = constant_encode(ctx, value, constant_budget(ctx, node));
+            if (!encoded) break;
+            
+            long growth = (long)ast_count_nodes(encoded) - 1;
+            if (!budget_allows(ctx->budget, growth)) {
+                ast_node_destroy(encoded);
+                break;
+            }
+            undo_replace(ctx->undo, node, encoded);
+            budget_charge(ctx->budget, growth);
+            break;
+        }
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            encode_expression(ctx, node->data.binary.left);
+            encode_expression(ctx, node->data.binary.right);
+            
+            // Ternaries chain the else branch after the then branch
+            if (node->data.binary.right && node->data.binary.operator &&
+                strcmp(node->data.binary.operator, "?:") == 0) {
+                encode_expression(ctx, node->data.binary.right->next);
+            }
+            break;
+        
+        case NODE_UNARY_OP:
+            // Label addresses and sizeof operands are not values
+            if (node->data.unary.operator &&
+                (strcmp(node->data.unary.operator, "&&") == 0 ||
+                 strcmp(node->data.unary.operator, "sizeof") == 0)) {
+                break;
+            }
+            encode_expression(ctx, node->data.unary.operand);
+            break;
+        
+        case NODE_CALL:
+            for (ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                encode_expression(ctx, arg);
+            }
+            break;
+        
+        case NODE_STMT_EXPR:
+            for (ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+                if (stmt->type == NODE_VARIABLE) {
+                    encode_expression(ctx, stmt->data.variable.initializer);
+                } else {
+                    encode_expression(ctx, stmt);
+                }
+            }
+            break;
+        
+        default:
+            break;
+    }
+}
+
+static void encode_statements(ObfuscationContext* ctx, ASTNode* node, bool in_function) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            encode_statements(ctx, node->data.program.declarations, in_function);
+            break;
+        
+        case NODE_FUNCTION:
+            budget_enter(ctx->budget, node);
+            encode_statements(ctx, node->data.function.body, true);
+            budget_enter(ctx->budget, NULL);
+            break;
+        
+        case NODE_VARIABLE:
+            // Static and file-scope initializers must stay constant expressions
+            if (in_function && !node->data.variable.is_static) {
+                encode_expression(ctx, node->data.variable.initializer);
+            }
+            break;
+        
+        case NODE_IF:
+            encode_expression(ctx, node->data.if_stmt.condition);
+            encode_statements(ctx, node->data.if_stmt.then_stmt, in_function);
+            encode_statements(ctx, node->data.if_stmt.else_stmt, in_function);
+            break;
+        
+        case NODE_WHILE:
+            encode_expression(ctx, node->data.while_stmt.condition);
+            encode_statements(ctx, node->data.while_stmt.body, in_function);
+            break;
+        
+        case NODE_FOR:
+            encode_statements(ctx, node->data.for_stmt.init, in_function);
+            encode_expression(ctx, node->data.for_stmt.condition);
+            encode_expression(ctx, node->data.for_stmt.update);
+            encode_statements(ctx, node->data.for_stmt.body, in_function);
+            break;
+        
+        case NODE_BLOCK:
+            encode_statements(ctx, node->data.block.statements, in_function);
+            break;
+        
+        case NODE_SWITCH:
+            encode_expression(ctx, node->data.switch_stmt.expression);
+            encode_statements(ctx, node->data.switch_stmt.cases, in_function);
+            break;
+        
+        case NODE_CASE:
+            // Case labels must stay constant expressions
+            encode_statements(ctx, node->data.case_stmt.statements, in_function);
+            break;
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_UNARY_OP:
+        case NODE_CALL:
+        case NODE_STMT_EXPR:
+            // Expression statement
+            if (in_function) {
+                encode_expression(ctx, node);
+            }
+            break;
+        
+        default:
+            break;
+    }
+    
+    encode_statements(ctx, node->next, in_function);
+}
+
+bool encode_constants(ObfuscationContext* ctx, ASTNode* ast) {
+    if (!ctx || !ast) return false;
+    
+    // Only function bodies are encoded; everything outside is file scope
+    encode_statements(ctx, ast, false);
+    
+    ctx->pass_count++;
+    return true;
+}
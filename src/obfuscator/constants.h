@@ -0,0 +1,42 @@
+#ifndef OBFUSCATOR_CONSTANTS_H
+#define OBFUSCATOR_CONSTANTS_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Constant Encoding
+ *
+ * Integer literals are replaced by expressions that evaluate to the same
+ * int: XOR shares `(a ^ b)`, an affine split `(q * m ± r)`, or a masked
+ * entry of the cache-line-aligned constant pool `__obf_const(i, k)`. All
+ * operands stay within int, so nothing can overflow, and the arithmetic
+ * forms fold at compile time.
+ *
+ * Every use is charged against a cycle budget (constant_cost_budget)
+ * scaled down by hotness; only the pool costs a memory load, so hot loops
+ * fall back to the arithmetic forms or keep the literal. Literals in case
+ * labels and static or file-scope initializers are left alone, since those
+ * must stay constant expressions.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef enum {
+    CONSTANT_ENCODING_SHARES,      /* (a ^ b) */
+    CONSTANT_ENCODING_AFFINE,      /* (q * m ± r), q random */
+    CONSTANT_ENCODING_TABLE,       /* __obf_const(i, k), one load */
+    CONSTANT_ENCODING_COUNT
+} ConstantEncoding;
+
+/* Estimated cycles per evaluation when not folded */
+int constant_encoding_cost(ConstantEncoding encoding);
+
+/* Cycles an encoded constant may spend in code at `node` */
+int constant_budget(const ObfuscationContext* ctx, const ASTNode* node);
+
+/* Expression equal to `value` (0..INT_MAX) within the budget, flagged
+ * AST_FLAG_OPAQUE; NULL when even the cheapest form costs too much */
+ASTNode* constant_encode(ObfuscationContext* ctx, int value, int budget);
+
+/* Pass entry point */
+bool encode_constants(ObfuscationContext* ctx, ASTNode* ast);
+
+#endif /* OBFUSCATOR_CONSTANTS_H */
@@ -0,0 +1,274 @@
+#include "cse.h"
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Candidate Collection
+ *
+ * Only subtrees that are evaluated unconditionally, and unsequenced relative
+ * to the rest of the expression, are collected: evaluating them once up
+ * front is then one of the orders the original expression already allowed.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    ASTNode* node;
+    uint64_t hash;
+    size_t size;
+} CSECandidate;
+
+typedef struct {
+    CSECandidate* items;
+    size_t count;
+    size_t capacity;
+} CSECandidates;
+
+static bool op_is(const char* op, const char* candidate) {
+    return op && strcmp(op, candidate) == 0;
+}
+
+/* Operators whose right operand is conditional or sequenced after the left */
+static bool is_sequencing_operator(const char* op) {
+    return op_is(op, "&&") || op_is(op, "||") || op_is(op, "?:") || op_is(op, ",");
+}
+
+static bool is_assigning_operator(const char* op) {
+    if (!op) return false;
+    
+    size_t len = strlen(op);
+    if (len == 0 || op[len - 1] != '=') return false;
+    return !op_is(op, "==") && !op_is(op, "!=") && !op_is(op, "<=") && !op_is(op, ">=");
+}
+
+static void add_candidate(CSECandidates* list, ASTNode* node, size_t size) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 32;
+        CSECandidate* items = realloc(list->items, capacity * sizeof(CSECandidate));
+        if (!items) return;
+        
+        list->items = items;
+        list->capacity = capacity;
+    }
+    
+    list->items[list->count].node = node;
+    list->items[list->count].hash = ast_hash(node);
+    list->items[list->count].size = size;
+    list->count++;
+}
+
+static void collect_candidates(CSECandidates* list, ASTNode* node) {
+    if (!node || (node->flags & (AST_FLAG_OPAQUE | AST_FLAG_PROTECTED))) return;
+    
+    switch (node->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT: {
+            const char* op = node->data.binary.operator;
+            
+            // The target of an assignment is an lvalue and must stay in place
+            if (node->type == NODE_BINARY_OP && !is_assigning_operator(op)) {
+                collect_candidates(list, node->data.binary.left);
+            }
+            if (!is_sequencing_operator(op)) {
+                collect_candidates(list, node->data.binary.right);
+            }
+            break;
+        }
+        
+        case NODE_UNARY_OP: {
+            const char* op = node->data.unary.operator;
+            if (!op_is(op, "&") && !op_is(op, "++") && !op_is(op, "--")) {
+                collect_candidates(list, node->data.unary.operand);
+            }
+            break;
+        }
+        
+        case NODE_CALL:
+            for (ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                collect_candidates(list, arg);
+            }
+            break;
+        
+        default:
+            // Statement expressions introduce their own scope; they're
+            // handled as separate roots
+            return;
+    }
+    
+    size_t size = ast_count_nodes(node);
+    if (size >= CSE_MIN_NODES && node->type != NODE_ASSIGNMENT) {
+        add_candidate(list, node, size);
+    }
+}
+
+bool cse_is_candidate(const ASTNode* node) {
+    if (!node || (node->flags & (AST_FLAG_OPAQUE | AST_FLAG_PROTECTED))) return false;
+    
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            if (is_assigning_operator(node->data.binary.operator)) return false;
+            break;
+        case NODE_UNARY_OP:
+        case NODE_CALL:
+            break;
+        default:
+            return false;
+    }
+    
+    return ast_count_nodes(node) >= CSE_MIN_NODES;
+}
+
+static int compare_candidates(const void* a, const void* b) {
+    const CSECandidate* x = a;
+    const CSECandidate* y = b;
+    
+    // Largest subtrees first, so outer repeats win over their pieces
+    if (x->size != y->size) return x->size > y->size ? -1 : 1;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return 0;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Hoisting
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Fills `members` with the candidates structurally equal to items[first].
+ * Side-effecting subtrees are merged only when every copy but one was
+ * introduced by a pass (AST_FLAG_DUPLICATE). */
+static size_t find_group(const CSECandidates* list, size_t first, ASTNode** members) {
+    const CSECandidate* lead = &list->items[first];
+    size_t count = 0;
+    int originals = 0;
+    bool pure = true;
+    
+    for (size_t i = first; i < list->count; i++) {
+        const CSECandidate* item = &list->items[i];
+        if (item->size != lead->size || item->hash != lead->hash) break;
+        if (!ast_equal(item->node, lead->node)) continue;
+        
+        members[count++] = item->node;
+        if (!(item->node->flags & AST_FLAG_DUPLICATE)) originals++;
+        if (ast_has_side_effects(item->node)) pure = false;
+    }
+    
+    if (count < 2) return 0;
+    if (!pure && originals > 1) return 0;
+    return count;
+}
+
+static ASTNode* hoist_group(ObfuscationContext* ctx, ASTNode** members, size_t count) {
+    char* name = obfuscator_fresh_temp_name(ctx);
+    if (!name) return NULL;
+    
+    ASTNode* value = ast_copy(members[0]);
+    if (value) {
+        value->flags &= ~AST_FLAG_DUPLICATE;
+    }
+    ASTNode* decl = ast_create_variable(name, "__auto_type", value);
+    
+    for (size_t i = 0; i < count; i++) {
+        undo_replace_subtree(ctx->undo, members[i], ast_create_identifier(name));
+    }
+    
+    free(name);
+    return decl;
+}
+
+/* Turns `expr` into a statement expression that declares `decls` first
+ * and then yields the original value */
+static void wrap_with_declarations(ObfuscationContext* ctx, ASTNode* expr, ASTNode* decls) {
+    ASTNode* inner = ast_copy_node(expr);
+    if (!inner) return;
+    
+    undo_replace(ctx->undo, expr, ast_create_stmt_expr(ast_link(decls, inner)));
+}
+
+/* Statement expressions nested in the tree are roots of their own */
+static int hoist_nested(ObfuscationContext* ctx, ASTNode* node) {
+    if (!node) return 0;
+    
+    int hoisted = 0;
+    
+    switch (node->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+            hoisted += hoist_nested(ctx, node->data.binary.left);
+            for (ASTNode* r = node->data.binary.right; r; r = r->next) {
+                hoisted += hoist_nested(ctx, r);
+            }
+            break;
+        
+        case NODE_UNARY_OP:
+            hoisted += hoist_nested(ctx, node->data.unary.operand);
+            break;
+        
+        case NODE_CALL:
+            for (ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                hoisted += hoist_nested(ctx, arg);
+            }
+            break;
+        
+        case NODE_STMT_EXPR:
+            for (ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+                if (stmt->type == NODE_VARIABLE) {
+                    hoisted += cse_hoist_expression(ctx, stmt->data.variable.initializer);
+                } else {
+                    hoisted += cse_hoist_expression(ctx, stmt);
+                }
+            }
+            break;
+        
+        default:
+            break;
+    }
+    
+    return hoisted;
+}
+
+int cse_hoist_expression(ObfuscationContext* ctx, ASTNode* expr) {
+    if (!ctx || !expr || (expr->flags & AST_FLAG_OPAQUE)) return 0;
+    
+    int hoisted = hoist_nested(ctx, expr);
+    if (expr->type == NODE_STMT_EXPR) return hoisted;
+    
+    ASTNode* decls = NULL;
+    CSECandidates list = {0};
+    
+    // One group per round: replacing a group invalidates the candidates
+    // inside it, so the tree is collected again afterwards
+    for (;;) {
+        list.count = 0;
+        collect_candidates(&list, expr);
+        if (list.count < 2) break;
+        
+        qsort(list.items, list.count, sizeof(CSECandidate), compare_candidates);
+        
+        ASTNode** members = malloc(list.count * sizeof(ASTNode*));
+        if (!members) break;
+        
+        size_t count = 0;
+        for (size_t i = 0; i + 1 < list.count && count == 0; i++) {
+            count = find_group(&list, i, members);
+        }
+        
+        ASTNode* decl = count ? hoist_group(ctx, members, count) : NULL;
+        free(members);
+        if (!decl) break;
+        
+        decls = ast_link(decls, decl);
+        hoisted++;
+    }
+    
+    free(list.items);
+    
+    if (decls) {
+        // Hoisted values may repeat pieces among themselves
+        for (ASTNode* decl = decls; decl; decl = decl->next) {
+            hoisted += cse_hoist_expression(ctx, decl->data.variable.initializer);
+        }
+        wrap_with_declarations(ctx, expr, decls);
+    }
+    
+    return hoisted;
+}
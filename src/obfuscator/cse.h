@@ -0,0 +1,22 @@
+#ifndef OBFUSCATOR_CSE_H
+#define OBFUSCATOR_CSE_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Common-Subexpression Hoisting
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Smallest subtree (in AST nodes) worth binding to a temporary */
+#define CSE_MIN_NODES 3
+
+/* Hoists repeated subtrees of an expression into temporaries declared in a
+ * GNU statement expression that replaces the expression in place. Returns
+ * the number of temporaries introduced. */
+int cse_hoist_expression(ObfuscationContext* ctx, ASTNode* expr);
+
+/* Whether a subtree, outside sequenced operands, would be hoisted when
+ * repeated */
+bool cse_is_candidate(const ASTNode* node);
+
+#endif /* OBFUSCATOR_CSE_H */
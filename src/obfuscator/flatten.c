@@ -0,0 +1,441 @@
+#include "flatten.h"
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include "../analysis/cfg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Feasibility
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool references_name(const ASTNode* node, const char* name);
+
+static bool list_references_name(const ASTNode* list, const char* name) {
+    for (; list; list = list->next) {
+        if (references_name(list, name)) return true;
+    }
+    return false;
+}
+
+static bool references_name(const ASTNode* node, const char* name) {
+    if (!node) return false;
+    
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            return strcmp(node->data.identifier.name, name) == 0;
+        case NODE_VARIABLE:
+            return references_name(node->data.variable.initializer, name);
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            return references_name(node->data.binary.left, name) ||
+                   list_references_name(node->data.binary.right, name);
+        case NODE_UNARY_OP:
+            return references_name(node->data.unary.operand, name);
+        case NODE_CALL:
+            return references_name(node->data.call.function, name) ||
+                   list_references_name(node->data.call.arguments, name);
+        case NODE_IF:
+            return references_name(node->data.if_stmt.condition, name) ||
+                   references_name(node->data.if_stmt.then_stmt, name) ||
+                   references_name(node->data.if_stmt.else_stmt, name);
+        case NODE_WHILE:
+            return references_name(node->data.while_stmt.condition, name) ||
+                   references_name(node->data.while_stmt.body, name);
+        case NODE_FOR:
+            return references_name(node->data.for_stmt.init, name) ||
+                   references_name(node->data.for_stmt.condition, name) ||
+                   references_name(node->data.for_stmt.update, name) ||
+                   references_name(node->data.for_stmt.body, name);
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            return list_references_name(node->data.block.statements, name);
+        case NODE_SWITCH:
+            return references_name(node->data.switch_stmt.expression, name) ||
+                   list_references_name(node->data.switch_stmt.cases, name);
+        case NODE_CASE:
+            return list_references_name(node->data.case_stmt.statements, name);
+        default:
+            return false;
+    }
+}
+
+/* Hoisting must not change what any name refers to, and the declaration
+ * has to be splittable into `type name;` plus an assignment */
+static bool can_flatten(const ASTNode* statements) {
+    // Straight-line code would become a single state: nothing to hide
+    bool branches = false;
+    for (const ASTNode* stmt = statements; stmt; stmt = stmt->next) {
+        if (cfg_can_lower(stmt)) branches = true;
+    }
+    if (!branches) return false;
+    
+    for (const ASTNode* stmt = statements; stmt; stmt = stmt->next) {
+        if (stmt->type != NODE_VARIABLE) continue;
+        
+        const char* type = stmt->data.variable.type;
+        const ASTNode* init = stmt->data.variable.initializer;
+        if (!type || strchr(type, '[')) return false;
+        if (init && init->type == NODE_LITERAL && init->data.literal.value[0] == '{') {
+            return false;
+        }
+        
+        // An earlier use would switch from an outer entity to the local
+        for (const ASTNode* earlier = statements; earlier != stmt; earlier = earlier->next) {
+            if (references_name(earlier, stmt->data.variable.name)) return false;
+        }
+    }
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Declaration Hoisting
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Moves top-level declarations ahead of the dispatcher; initializers stay
+ * where they were as assignments. Returns the remaining statements. */
+static ASTNode* hoist_declarations(ASTNode* statements, ASTNode** hoisted, int* count) {
+    ASTNode* kept = NULL;
+    
+    while (statements) {
+        ASTNode* stmt = statements;
+        statements = stmt->next;
+        stmt->next = NULL;
+        
+        if (stmt->type != NODE_VARIABLE) {
+            kept = ast_link(kept, stmt);
+            continue;
+        }
+        
+        // Static storage is initialized once no matter where it is declared
+        ASTNode* init = stmt->data.variable.initializer;
+        if (!stmt->data.variable.is_static) {
+            if (init) {
+                kept = ast_link(kept, ast_create_assignment(
+                    ast_create_identifier(stmt->data.variable.name), init));
+                stmt->data.variable.initializer = NULL;
+            }
+            
+            // The value is now assigned after the declaration
+            stmt->data.variable.is_const = false;
+        }
+        
+        *hoisted = ast_link(*hoisted, stmt);
+        (*count)++;
+    }
+    return kept;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * State Numbering
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    CFG* cfg;
+    int* order;                /* Block index per state */
+    int* state;                /* State per block index; -1 = dropped */
+    int states;
+    float hotness;             /* Peak over the body; the dispatcher runs as often */
+} Flattener;
+
+static size_t count_list(const ASTNode* list) {
+    size_t count = 0;
+    for (; list; list = list->next) {
+        count += ast_count_nodes(list);
+    }
+    return count;
+}
+
+/* Hottest statement anywhere in a list; 0 when nothing was estimated */
+static float peak_hotness(const ASTNode* list) {
+    float peak = 0.0f;
+    for (; list; list = list->next) {
+        float inner = 0.0f;
+        switch (list->type) {
+            case NODE_IF: {
+                inner = peak_hotness(list->data.if_stmt.then_stmt);
+                float other = peak_hotness(list->data.if_stmt.else_stmt);
+                if (other > inner) inner = other;
+                break;
+            }
+            case NODE_WHILE:
+                inner = peak_hotness(list->data.while_stmt.body);
+                break;
+            case NODE_FOR:
+                inner = peak_hotness(list->data.for_stmt.body);
+                break;
+            case NODE_BLOCK:
+                inner = peak_hotness(list->data.block.statements);
+                break;
+            case NODE_SWITCH:
+                inner = peak_hotness(list->data.switch_stmt.cases);
+                break;
+            case NODE_CASE:
+                inner = peak_hotness(list->data.case_stmt.statements);
+                break;
+            default:
+                break;
+        }
+        if (list->hotness > peak) peak = list->hotness;
+        if (inner > peak) peak = inner;
+    }
+    return peak;
+}
+
+/* Numbers the blocks that survive densely in breadth-first order from the
+ * entry; false when out of memory */
+static bool number_states(Flattener* f) {
+    int count = f->cfg->count;
+    f->order = malloc(count * sizeof(int));
+    f->state = malloc(count * sizeof(int));
+    if (!f->order || !f->state) return false;
+    
+    f->states = cfg_order(f->cfg, f->order);
+    for (int i = 0; i < count; i++) {
+        f->state[i] = -1;
+    }
+    for (int i = 0; i < f->states; i++) {
+        f->state[f->order[i]] = i;
+    }
+    return true;
+}
+
+static void flattener_release(Flattener* f) {
+    cfg_destroy(f->cfg);
+    free(f->order);
+    free(f->state);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Dispatcher Emission
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    uint32_t multiplier;       /* Odd, so it has an inverse mod 2^32 */
+    uint32_t inverse;
+    uint32_t offset;
+    bool encoded;
+} StateEncoding;
+
+static StateEncoding make_encoding(Random* random, bool encoded) {
+    StateEncoding e = { 1, 1, 0, encoded };
+    if (!encoded) return e;
+    
+    e.multiplier = random_next(random) | 1u;
+    e.offset = random_next(random);
+    
+    // Newton's iteration doubles the correct low bits each round
+    uint32_t x = e.multiplier;
+    for (int i = 0; i < 5; i++) {
+        x *= 2u - e.multiplier * x;
+    }
+    e.inverse = x;
+    return e;
+}
+
+static uint32_t encode_state(const StateEncoding* e, int state) {
+    return e->multiplier * (uint32_t)state + e->offset;
+}
+
+static ASTNode* unsigned_literal(uint32_t value) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "0x%08xu", (unsigned int)value);
+    return ast_create_literal(buffer);
+}
+
+static int target_state(const Flattener* f, int block) {
+    return block == CFG_EXIT ? f->states : f->state[block];
+}
+
+/* Constant written or added to the state variable to reach `target` */
+static ASTNode* state_step(const Flattener* f, const StateEncoding* e, int from, int target) {
+    int state = target_state(f, target);
+    if (!e->encoded) return ast_create_literal_number(state);
+    return unsigned_literal(encode_state(e, state) - encode_state(e, from));
+}
+
+static ASTNode* switch_transition(const Flattener* f, const StateEncoding* e, int from,
+                                  const CFGBlock* b, const char* state_name) {
+    ASTNode* value = state_step(f, e, from, b->next);
+    if (b->condition) {
+        ASTNode* other = state_step(f, e, from, b->other);
+        value = ast_create_binary_op("?:", b->condition, ast_link(value, other));
+    }
+    
+    ASTNode* target = ast_create_identifier(state_name);
+    if (e->encoded) return ast_create_binary_op("+=", target, value);
+    return ast_create_assignment(target, value);
+}
+
+/* while (s != EXIT) { switch (decode(s)) { case k: ...; s += d; break; } } */
+static ASTNode* emit_switch(Flattener* f, const StateEncoding* e, const char* state_name) {
+    int states = f->states;
+    ASTNode* cases = NULL;
+    for (int i = 0; i < states; i++) {
+        CFGBlock* b = &f->cfg->blocks[f->order[i]];
+        ASTNode* body = b->statements;
+        
+        // A returning block never reaches its transition
+        if (!b->returns) {
+            body = ast_link(body, ast_link(switch_transition(f, e, i, b, state_name),
+                                           ast_create_break()));
+        }
+        cases = ast_link(cases, ast_create_case(ast_create_literal_number(i), body));
+        b->statements = NULL;
+        b->condition = NULL;
+    }
+    
+    ASTNode* selector = ast_create_identifier(state_name);
+    if (e->encoded) {
+        selector = ast_create_binary_op("+",
+            ast_create_binary_op("*", selector, unsigned_literal(e->inverse)),
+            unsigned_literal(0u - e->offset * e->inverse));
+    }
+    
+    ASTNode* exit_value = e->encoded ? unsigned_literal(encode_state(e, states)) :
+                                       ast_create_literal_number(states);
+    ASTNode* condition = ast_create_binary_op("!=", ast_create_identifier(state_name), exit_value);
+    
+    ASTNode* state = ast_create_variable(state_name, e->encoded ? "unsigned int" : "int",
+        e->encoded ? unsigned_literal(encode_state(e, 0)) : ast_create_literal_number(0));
+    ASTNode* dispatch = ast_create_switch(selector, cases);
+    ASTNode* block = ast_create_block(dispatch);
+    ASTNode* loop = ast_create_while(condition, block);
+    
+    // Passes after this one scale their odds by hotness; the dispatcher
+    // runs on every transition, as often as the hottest block
+    state->hotness = f->hotness;
+    loop->hotness = block->hotness = dispatch->hotness = f->hotness;
+    for (ASTNode* c = cases; c; c = c->next) {
+        c->hotness = f->hotness;
+    }
+    return ast_link(state, loop);
+}
+
+static ASTNode* label_address(const char* base, int state) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s_%d", base, state);
+    return ast_create_unary_op("&&", ast_create_identifier(name), true);
+}
+
+/* L0: ...; s = &&Lk; goto *s; ... Lexit: ; */
+static ASTNode* emit_goto(Flattener* f, const char* state_name) {
+    int states = f->states;
+    
+    // Only jumped-to states get a label; unused labels draw warnings
+    bool* referenced = calloc(states + 1, sizeof(bool));
+    if (!referenced) return NULL;
+    
+    for (int i = 0; i < states; i++) {
+        const CFGBlock* b = &f->cfg->blocks[f->order[i]];
+        if (b->returns) continue;
+        
+        referenced[target_state(f, b->next)] = true;
+        if (b->condition) referenced[target_state(f, b->other)] = true;
+    }
+    
+    ASTNode* code = ast_create_variable(state_name, "void*", NULL);
+    
+    char label[64];
+    for (int i = 0; i <= states; i++) {
+        if (referenced[i]) {
+            snprintf(label, sizeof(label), "%s_%d", state_name, i);
+            code = ast_link(code, ast_create_label(label));
+        }
+        if (i == states) break;
+        
+        CFGBlock* b = &f->cfg->blocks[f->order[i]];
+        code = ast_link(code, b->statements);
+        b->statements = NULL;
+        if (b->returns) continue;
+        
+        ASTNode* value = label_address(state_name, target_state(f, b->next));
+        if (b->condition) {
+            value = ast_create_binary_op("?:", b->condition,
+                ast_link(value, label_address(state_name, target_state(f, b->other))));
+        }
+        b->condition = NULL;
+        
+        ASTNode* transition = ast_create_assignment(ast_create_identifier(state_name), value);
+        ASTNode* jump = ast_create_computed_goto(ast_create_identifier(state_name));
+        code = ast_link(code, ast_link(transition, jump));
+    }
+    
+    free(referenced);
+    return code;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Pass Entry Point
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+bool flatten_function(ObfuscationContext* ctx, ASTNode* function, FlattenStats* stats) {
+    if (!ctx || !function || function->type != NODE_FUNCTION) return false;
+    
+    ASTNode* body = function->data.function.body;
+    if (!body || body->type != NODE_BLOCK || !can_flatten(body->data.block.statements)) {
+        return false;
+    }
+    
+    char* state_name = obfuscator_fresh_temp_name(ctx);
+    if (!state_name) return false;
+    
+    // Lowering takes the statements apart, so it works on a copy and the
+    // body stays as written until the dispatcher is ready
+    ASTNode* copy = ast_copy_list(body->data.block.statements);
+    if (!copy) {
+        free(state_name);
+        return false;
+    }
+    
+    ASTNode* hoisted = NULL;
+    int hoisted_count = 0;
+    ASTNode* statements = hoist_declarations(copy, &hoisted, &hoisted_count);
+    
+    Flattener f = {0};
+    f.hotness = peak_hotness(body->data.block.statements);
+    f.cfg = cfg_build(statements);
+    int merged = f.cfg ? cfg_simplify(f.cfg, ctx->config->flatten_merge_blocks) : 0;
+    
+    // Nothing left to dispatch, or out of memory
+    if (!f.cfg || !number_states(&f) || f.states == 0) {
+        free(state_name);
+        flattener_release(&f);
+        ast_tree_destroy(hoisted);
+        return false;
+    }
+    
+    ASTNode* dispatcher;
+    if (ctx->config->flatten_dispatch == FLATTEN_DISPATCH_GOTO) {
+        dispatcher = emit_goto(&f, state_name);
+    } else {
+        StateEncoding encoding = make_encoding(ctx->random, ctx->config->flatten_encode_states);
+        dispatcher = emit_switch(&f, &encoding, state_name);
+    }
+    ASTNode* flattened = ast_link(hoisted, dispatcher);
+    
+    // Small branchy bodies grow several times over; measured, not assumed
+    long growth = (long)count_list(flattened) - (long)count_list(body->data.block.statements);
+    if (!dispatcher || !budget_allows(ctx->budget, growth)) {
+        free(state_name);
+        flattener_release(&f);
+        ast_tree_destroy(flattened);
+        return false;
+    }
+    budget_charge(ctx->budget, growth);
+    
+    ast_tree_destroy(body->data.block.statements);
+    body->data.block.statements = flattened;
+    
+    if (stats) {
+        stats->blocks += f.states;
+        stats->hoisted += hoisted_count;
+        stats->merged += merged;
+    }
+    
+    free(state_name);
+    flattener_release(&f);
+    return true;
+}
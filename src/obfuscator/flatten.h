@@ -0,0 +1,36 @@
+#ifndef OBFUSCATOR_FLATTEN_H
+#define OBFUSCATOR_FLATTEN_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Control-Flow Flattening
+ *
+ * A function body is split into maximal basic blocks (analysis/cfg) that
+ * all sit at the same level behind one dispatcher, so there is one
+ * dispatch per control-flow edge rather than per statement. Blocks that
+ * can only be entered from the block before them are merged into it when
+ * flatten_merge_blocks is set. Top-level declarations are hoisted ahead of
+ * the dispatcher; straight-line bodies are left alone.
+ *
+ * FLATTEN_DISPATCH_SWITCH keeps state IDs dense (0..n-1), so the switch
+ * compiles to one bounds check and a jump table. With encoded states the
+ * variable holds A * id + B (mod 2^32) for a random odd A: transitions add
+ * a constant delta and the dispatcher decodes with a multiply-add.
+ *
+ * FLATTEN_DISPATCH_GOTO stores label addresses (GNU labels-as-values) and
+ * ends every block with `goto *state`, one indirect jump per block.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    int blocks;                /* States behind the dispatcher */
+    int hoisted;               /* Declarations moved ahead of it */
+    int merged;                /* Blocks folded into their predecessor */
+} FlattenStats;
+
+/* Flattens a function body in place and charges the growth to
+ * ctx->budget; false when it was left unchanged, e.g. because the
+ * dispatcher would not fit the budget */
+bool flatten_function(ObfuscationContext* ctx, ASTNode* function, FlattenStats* stats);
+
+#endif /* OBFUSCATOR_FLATTEN_H */
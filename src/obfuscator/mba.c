@@ -0,0 +1,313 @@
+#include "mba.h"
+#include "ast_utils.h"
+#include "cse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Identity Builders
+ *
+ * Each builder consumes `a` and `b` and duplicates them for repeated uses.
+ * Non-trivial operands are either bound to temporaries first or replicated
+ * and merged by CSE afterwards, so duplication never repeats computation.
+ *
+ * The identities hold modulo 2^N, so their arithmetic is done in unsigned int,
+ * where intermediate terms such as 2 * (a & b) wrap instead of overflowing,
+ * and the result is converted back to int.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define A() ast_duplicate(a)
+#define B() ast_duplicate(b)
+
+static ASTNode* op2(const char* op, ASTNode* left, ASTNode* right) {
+    return ast_create_binary_op(op, left, right);
+}
+
+static ASTNode* not1(ASTNode* operand) {
+    return ast_create_unary_op("~", operand, true);
+}
+
+static ASTNode* u(ASTNode* operand) {
+    return ast_create_cast("unsigned int", operand);
+}
+
+static ASTNode* to_int(ASTNode* value) {
+    return ast_create_cast("int", value);
+}
+
+/* a + b == (a ^ b) + 2 * (a & b) */
+static ASTNode* build_add_xor_and(ASTNode* a, ASTNode* b) {
+    return to_int(op2("+", u(op2("^", A(), B())),
+                           op2("*", ast_create_literal("2"), u(op2("&", a, b)))));
+}
+
+/* a + b == (a | b) + (a & b) */
+static ASTNode* build_add_or_and(ASTNode* a, ASTNode* b) {
+    return to_int(op2("+", u(op2("|", A(), B())), u(op2("&", a, b))));
+}
+
+/* a + b == 2 * (a | b) - (a ^ b) */
+static ASTNode* build_add_or_xor(ASTNode* a, ASTNode* b) {
+    return to_int(op2("-", op2("*", ast_create_literal("2"), u(op2("|", A(), B()))),
+                           u(op2("^", a, b))));
+}
+
+/* a - b == (a ^ b) - 2 * (~a & b) */
+static ASTNode* build_sub_xor_nand(ASTNode* a, ASTNode* b) {
+    return to_int(op2("-", u(op2("^", A(), B())),
+                           op2("*", ast_create_literal("2"), u(op2("&", not1(a), b)))));
+}
+
+/* a - b == (a & ~b) - (~a & b) */
+static ASTNode* build_sub_and_nand(ASTNode* a, ASTNode* b) {
+    return to_int(op2("-", u(op2("&", A(), not1(B()))), u(op2("&", not1(a), b))));
+}
+
+/* a ^ b == (a | b) - (a & b) */
+static ASTNode* build_xor_or_and(ASTNode* a, ASTNode* b) {
+    return to_int(op2("-", u(op2("|", A(), B())), u(op2("&", a, b))));
+}
+
+/* a ^ b == (a & ~b) | (~a & b); bitwise only, no casts needed */
+static ASTNode* build_xor_and_nand(ASTNode* a, ASTNode* b) {
+    return op2("|", op2("&", A(), not1(B())), op2("&", not1(a), b));
+}
+
+/* a | b == (a & ~b) + b */
+static ASTNode* build_or_and_not(ASTNode* a, ASTNode* b) {
+    return to_int(op2("+", u(op2("&", a, not1(B()))), u(b)));
+}
+
+/* a | b == (a ^ b) + (a & b) */
+static ASTNode* build_or_xor_and(ASTNode* a, ASTNode* b) {
+    return to_int(op2("+", u(op2("^", A(), B())), u(op2("&", a, b))));
+}
+
+/* a & b == (a | b) - (a ^ b) */
+static ASTNode* build_and_or_xor(ASTNode* a, ASTNode* b) {
+    return to_int(op2("-", u(op2("|", A(), B())), u(op2("^", a, b))));
+}
+
+/* a * b == (a & b) * (a | b) + (a & ~b) * (~a & b) */
+static ASTNode* build_mul_and_or(ASTNode* a, ASTNode* b) {
+    return to_int(op2("+", op2("*", u(op2("&", A(), B())), u(op2("|", A(), B()))),
+                           op2("*", u(op2("&", A(), not1(B()))), u(op2("&", not1(a), b)))));
+}
+
+#undef A
+#undef B
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Identity Catalog
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const MBAIdentity mba_identities[] = {
+    { "+", "(a ^ b) + 2 * (a & b)",                 9,  3, build_add_xor_and },
+    { "+", "(a | b) + (a & b)",                     7,  2, build_add_or_and },
+    { "+", "2 * (a | b) - (a ^ b)",                 9,  3, build_add_or_xor },
+    { "-", "(a ^ b) - 2 * (~a & b)",                10, 4, build_sub_xor_nand },
+    { "-", "(a & ~b) - (~a & b)",                   9,  4, build_sub_and_nand },
+    { "^", "(a | b) - (a & b)",                     7,  2, build_xor_or_and },
+    { "^", "(a & ~b) | (~a & b)",                   6,  4, build_xor_and_nand },
+    { "|", "(a & ~b) + b",                          6,  2, build_or_and_not },
+    { "|", "(a ^ b) + (a & b)",                     7,  2, build_or_xor_and },
+    { "&", "(a | b) - (a ^ b)",                     7,  2, build_and_or_xor },
+    { "*", "(a & b) * (a | b) + (a & ~b) * (~a & b)", 19, 8, build_mul_and_or },
+};
+
+const MBAIdentity* mba_catalog(size_t* count) {
+    if (count) {
+        *count = sizeof(mba_identities) / sizeof(mba_identities[0]);
+    }
+    return mba_identities;
+}
+
+const MBAIdentity* mba_select_identity(Random* random, const char* op, int budget) {
+    if (!op || budget <= 0) return NULL;
+    
+    size_t count;
+    const MBAIdentity* catalog = mba_catalog(&count);
+    
+    // Pick uniformly among the identities for `op` that fit the budget
+    int candidates = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(catalog[i].op, op) == 0 && catalog[i].node_growth <= budget) {
+            candidates++;
+        }
+    }
+    if (candidates == 0) return NULL;
+    
+    int pick = random_below(random, candidates);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(catalog[i].op, op) == 0 && catalog[i].node_growth <= budget) {
+            if (pick-- == 0) return &catalog[i];
+        }
+    }
+    
+    return NULL;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Budget Management
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void mba_begin_function(MBAState* state, const ObfuscationConfig* config) {
+    if (!state || !config) return;
+    
+    state->function_remaining = config->mba_function_budget;
+    state->expr_remaining = config->mba_expr_budget;
+}
+
+void mba_begin_expression(MBAState* state, const ObfuscationConfig* config) {
+    if (!state || !config) return;
+    
+    state->expr_remaining = config->mba_expr_budget;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Rewriting
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Cost of binding a non-trivial operand to a temporary: the declaration
+ * plus the identifier that replaces the operand */
+#define MBA_HOIST_COST 2
+
+static ASTNode* mba_hoist_operand(ObfuscationContext* ctx, ASTNode* operand,
+                                  ASTNode** hoisted) {
+    if (ast_is_trivial_operand(operand)) return operand;
+    
+    char* name = obfuscator_fresh_temp_name(ctx);
+    if (!name) return NULL;
+    
+    ASTNode* decl = ast_create_variable(name, "__auto_type", operand);
+    ASTNode* ref = ast_create_identifier(name);
+    free(name);
+    if (ref) ref->flags |= operand->flags & AST_FLAG_INT;
+    
+    *hoisted = ast_link(*hoisted, decl);
+    return ref;
+}
+
+/* A side-effecting operand that CSE hoists is replicated like a trivial one,
+ * and CSE then merges the replicas (AST_FLAG_DUPLICATE) into one evaluation.
+ * Needs the undo log to take the rewrite back if they were not merged. */
+static bool mba_can_replicate(const ObfuscationContext* ctx, const ASTNode* operand) {
+    return ast_is_trivial_operand(operand) ||
+           (ctx->undo && ast_has_side_effects(operand) && cse_is_candidate(operand));
+}
+
+static bool has_replica(const ASTNode* node);
+
+static bool list_has_replica(const ASTNode* list) {
+    for (; list; list = list->next) {
+        if (has_replica(list)) return true;
+    }
+    return false;
+}
+
+static bool has_replica(const ASTNode* node) {
+    if (!node) return false;
+    if ((node->flags & AST_FLAG_DUPLICATE) && !ast_is_trivial_operand(node)) return true;
+    
+    switch (node->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            return has_replica(node->data.binary.left) ||
+                   list_has_replica(node->data.binary.right);
+        case NODE_UNARY_OP:
+            return has_replica(node->data.unary.operand);
+        case NODE_CALL:
+            return has_replica(node->data.call.function) ||
+                   list_has_replica(node->data.call.arguments);
+        case NODE_VARIABLE:
+            return has_replica(node->data.variable.initializer);
+        case NODE_STMT_EXPR:
+            return list_has_replica(node->data.block.statements);
+        default:
+            return false;
+    }
+}
+
+static bool mba_apply_replicated(ObfuscationContext* ctx, ASTNode* node,
+                                 const MBAIdentity* identity) {
+    size_t mark = undo_checkpoint(ctx->undo);
+    
+    ASTNode* rewritten = identity->build(node->data.binary.left, node->data.binary.right);
+    if (rewritten) {
+        undo_replace(ctx->undo, node, rewritten);
+        cse_hoist_expression(ctx, node);
+    }
+    
+    // A replica left over would evaluate its side effects again
+    if (!rewritten || has_replica(node)) {
+        undo_rollback(ctx->undo, mark);
+        return false;
+    }
+    
+    undo_commit(ctx->undo, mark);
+    return true;
+}
+
+bool mba_rewrite(ObfuscationContext* ctx, MBAState* state, ASTNode* node) {
+    if (!ctx || !state || !node || node->type != NODE_BINARY_OP) return false;
+    
+    ASTNode* left = node->data.binary.left;
+    ASTNode* right = node->data.binary.right;
+    if (!left || !right || right->next) return false;
+    
+    // Bitwise identities are meaningless for pointers and floating point
+    if (!ast_is_integer_operand(left) || !ast_is_integer_operand(right)) {
+        return false;
+    }
+    
+    int hoist_cost = 0;
+    if (!ast_is_trivial_operand(left)) hoist_cost += MBA_HOIST_COST;
+    if (!ast_is_trivial_operand(right)) hoist_cost += MBA_HOIST_COST;
+    if (hoist_cost > 0) hoist_cost += 1; // statement expression wrapper
+    
+    // Statement expressions are not allowed in constant initializers
+    if (hoist_cost > 0 && state->constant_context) return false;
+    
+    int budget = state->expr_remaining < state->function_remaining ?
+                 state->expr_remaining : state->function_remaining;
+    
+    // Cheaper identities once the program's growth budget runs low
+    budget = budget_cap(ctx->budget, budget);
+    
+    const MBAIdentity* identity = mba_select_identity(ctx->random, node->data.binary.operator,
+                                                      budget - hoist_cost);
+    if (!identity) return false;
+    
+    // Evaluate non-trivial operands exactly once: through CSE when it can
+    // merge their replicas, otherwise in temporaries bound here
+    if (hoist_cost > 0 && mba_can_replicate(ctx, left) && mba_can_replicate(ctx, right) &&
+        mba_apply_replicated(ctx, node, identity)) {
+        state->hoisted++;
+    } else {
+        ASTNode* hoisted = NULL;
+        ASTNode* a = mba_hoist_operand(ctx, left, &hoisted);
+        ASTNode* b = mba_hoist_operand(ctx, right, &hoisted);
+        if (!a || !b) return false;
+        
+        ASTNode* rewritten = identity->build(a, b);
+        if (!rewritten) return false;
+        
+        if (hoisted) {
+            rewritten = ast_create_stmt_expr(ast_link(hoisted, rewritten));
+            state->hoisted++;
+        }
+        
+        // The operands live on in the rewritten tree
+        undo_replace(ctx->undo, node, rewritten);
+    }
+    
+    int growth = identity->node_growth + hoist_cost;
+    state->expr_remaining -= growth;
+    state->function_remaining -= growth;
+    state->rewrites++;
+    budget_charge(ctx->budget, growth);
+    
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef OBFUSCATOR_MBA_H
+#define OBFUSCATOR_MBA_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Mixed Boolean-Arithmetic (MBA) Rewriting Engine
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Identity in the MBA catalog. Builders receive trivial operands (identifiers
+ * or literals) and may duplicate them freely. Identities hold in two's
+ * complement (modulo 2^n) arithmetic. */
+typedef struct {
+    const char* op;            /* Operator being rewritten */
+    const char* form;          /* Human-readable rewritten form */
+    int node_growth;           /* AST nodes added over `a op b` */
+    int op_cost;               /* Extra ALU operations at runtime */
+    ASTNode* (*build)(ASTNode* a, ASTNode* b);
+} MBAIdentity;
+
+/* Growth budgets for the expression and function being rewritten */
+typedef struct {
+    int expr_remaining;
+    int function_remaining;
+    int rewrites;
+    int hoisted;
+    bool in_function;          /* Inside a function body */
+    bool constant_context;     /* Static or file-scope initializer */
+} MBAState;
+
+/* Budget Management */
+void mba_begin_function(MBAState* state, const ObfuscationConfig* config);
+void mba_begin_expression(MBAState* state, const ObfuscationConfig* config);
+
+/* Rewriting */
+bool mba_rewrite(ObfuscationContext* ctx, MBAState* state, ASTNode* node);
+
+/* Catalog Access */
+const MBAIdentity* mba_catalog(size_t* count);
+const MBAIdentity* mba_select_identity(Random* random, const char* op, int budget);
+
+#endif /* OBFUSCATOR_MBA_H */
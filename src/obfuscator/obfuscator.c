@@ -1,8 +1,20 @@
 #include "obfuscator.h"
+#include "ast_utils.h"
+#include "mba.h"
+#include "simplify.h"
+#include "cse.h"
+#include "flatten.h"
+#include "opaque.h"
+#include "constants.h"
+#include "virtualize.h"
+#include "../analysis/profile.h"
+#include "../analysis/hotness.h"
+#include "../analysis/typing.h"
+#include "../parser/parser.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
-#include <time.h>
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Aesthetic Name Generation Patterns
@@ -60,9 +72,21 @@ ObfuscationContext* obfuscator_create(ObfuscationConfig* config) {
     ctx->name_gen = name_generator_create(config->aesthetic);
     ctx->errors = NULL;
     ctx->pass_count = 0;
-    
-    // Seed random number generator for obfuscation
-    srand((unsigned int)time(NULL));
+    ctx->temp_counter = 0;
+    ctx->helpers = 0;
+    ctx->loops = NULL;
+    ctx->budget = NULL;
+    ctx->undo = undo_log_create();
+    
+    // Every random choice of this context comes from its own generator,
+    // so contexts never perturb each other's output
+    ctx->random = malloc(sizeof(Random));
+    random_seed(ctx->random, config->seed);
+    
+    // Created after seeding so the string key differs between runs
+    ctx->strings = string_table_create(ctx->random);
+    ctx->constants = constant_pool_create();
+    ctx->bytecode = vm_program_create(ctx->random);
     
     return ctx;
 }
@@ -72,10 +96,58 @@ void obfuscator_destroy(ObfuscationContext* ctx) {
     
     symbol_table_destroy(ctx->symbol_table);
     name_generator_destroy(ctx->name_gen);
-    // TODO: Free error list
+    string_table_destroy(ctx->strings);
+    constant_pool_destroy(ctx->constants);
+    vm_program_destroy(ctx->bytecode);
+    loop_report_destroy(ctx->loops);
+    budget_destroy(ctx->budget);
+    undo_log_destroy(ctx->undo);
+    free(ctx->random);
+    
+    Error* error = ctx->errors;
+    while (error) {
+        Error* next = error->next;
+        free(error->message);
+        free(error);
+        error = next;
+    }
+    
     free(ctx);
 }
 
+void obfuscator_add_error(ObfuscationContext* ctx, ErrorType type, const char* message) {
+    if (!ctx || !message) return;
+    
+    Error* error = malloc(sizeof(Error));
+    if (!error) return;
+    
+    error->type = type;
+    error->message = strdup(message);
+    error->location.filename = NULL;
+    error->location.line = 0;
+    error->location.column = 0;
+    error->next = ctx->errors;
+    ctx->errors = error;
+}
+
+ObfuscationLevel obfuscator_effective_level(const ObfuscationContext* ctx, const ASTNode* node) {
+    ObfuscationLevel level = ctx->config->level;
+    
+    // Profiles and annotations can only lower the configured level
+    if (node && node->level_cap > 0 && node->level_cap < (int)level) {
+        level = (ObfuscationLevel)node->level_cap;
+    }
+    return level;
+}
+
+bool obfuscator_should_apply(const ObfuscationContext* ctx, const ASTNode* node, int percent) {
+    // Frequently executed code gets proportionally fewer transformations
+    if (ctx->config->static_hotness && node) {
+        percent = hotness_scale_percent(percent, node->hotness);
+    }
+    return random_below(ctx->random, 100) < percent;
+}
+
 bool obfuscator_has_errors(const ObfuscationContext* ctx) {
     return ctx && ctx->errors != NULL;
 }
@@ -84,6 +156,63 @@ Error* obfuscator_get_errors(const ObfuscationContext* ctx) {
     return ctx ? ctx->errors : NULL;
 }
 
+/* Call to a shared runtime helper; marks it for the emitted prologue */
+ASTNode* obfuscator_helper_call(ObfuscationContext* ctx, RuntimeHelper helper, ASTNode* arguments) {
+    const char* name = runtime_helper_name(helper);
+    if (!ctx || !name) return NULL;
+    
+    ASTNode* call = ast_create_call(ast_create_identifier(name), arguments);
+    if (!call) return NULL;
+    
+    ctx->helpers |= 1u << helper;
+    return call;
+}
+
+/* Appends `part` to `prologue`, taking ownership of both */
+static char* append_source(char* prologue, char* part) {
+    if (!prologue) return part;
+    if (!part) return prologue;
+    
+    size_t length = strlen(prologue);
+    char* joined = realloc(prologue, length + strlen(part) + 1);
+    if (joined) {
+        strcpy(joined + length, part);
+    } else {
+        free(prologue);
+    }
+    free(part);
+    return joined;
+}
+
+/* Helper section first, then the tables that call into it */
+char* obfuscator_runtime_prologue(const ObfuscationContext* ctx) {
+    if (!ctx) return NULL;
+    
+    RuntimeHelperSet helpers = ctx->helpers;
+    if (ctx->strings && ctx->strings->count > 0) {
+        helpers |= 1u << RUNTIME_HELPER_STR_DECRYPT;
+    }
+    if (ctx->bytecode && ctx->bytecode->count > 0) {
+        helpers |= 1u << RUNTIME_HELPER_UNLIKELY;
+    }
+    
+    char* prologue = runtime_helpers_emit(helpers);
+    prologue = append_source(prologue,
+                             string_table_emit(ctx->strings, ctx->config->string_decrypt_all));
+    prologue = append_source(prologue, constant_pool_emit(ctx->constants));
+    return append_source(prologue, vm_program_emit(ctx->bytecode));
+}
+
+char* obfuscator_fresh_temp_name(ObfuscationContext* ctx) {
+    if (!ctx) return NULL;
+    
+    // Temporaries use their own namespace so they never collide with the
+    // names handed out by the identifier pass
+    char base[32];
+    snprintf(base, sizeof(base), "__obf_t%d", ctx->temp_counter++);
+    return make_unique_name(ctx->symbol_table, base);
+}
+
 /* ═══════════════════════════════════════════════════════════════════════════
  * Advanced Name Generation
  * ═══════════════════════════════════════════════════════════════════════════ */
@@ -151,7 +280,7 @@ static char* generate_artistic_name(int counter) {
     return name;
 }
 
-static char* generate_chaotic_name(int counter) {
+static char* generate_chaotic_name(Random* random, int counter) {
     char* name = malloc(64);
     if (!name) return NULL;
     
@@ -161,8 +290,8 @@ static char* generate_chaotic_name(int counter) {
     const char* pattern = chaotic_patterns[counter % pattern_count];
     
     // Add random numbers and characters for maximum chaos
-    int random_suffix = rand() % 1000;
-    char random_char = 'A' + (rand() % 26);
+    int random_suffix = random_below(random, 1000);
+    char random_char = 'A' + random_below(random, 26);
     
     snprintf(name, 64, "_%s%c%d_%c", pattern, random_char, random_suffix, 
              'a' + (counter % 26));
@@ -234,40 +363,44 @@ static char* generate_runic_name(int counter) {
     return name;
 }
 
-char* generate_aesthetic_name_advanced(AestheticStyle style, int counter) {
+static char* generate_style_name(Random* random, AestheticStyle style, int counter) {
     switch (style) {
         case AESTHETIC_MINIMAL:
             return generate_minimal_name(counter);
-            
+        
         case AESTHETIC_UNICODE:
             return generate_unicode_aesthetic_name(counter);
-            
+        
         case AESTHETIC_HEXADECIMAL:
             return generate_hexadecimal_name(counter);
-            
+        
         case AESTHETIC_ARTISTIC:
             return generate_artistic_name(counter);
-            
+        
         case AESTHETIC_CHAOTIC:
-            return generate_chaotic_name(counter);
-            
+            return generate_chaotic_name(random, counter);
+        
         case AESTHETIC_MATRIX:
             return generate_matrix_name(counter);
-            
+        
         case AESTHETIC_MYSTICAL:
             return generate_mystical_name(counter);
-            
+        
         case AESTHETIC_ASCII_ART:
             return generate_ascii_art_name(counter);
-            
+        
         case AESTHETIC_RUNIC:
             return generate_runic_name(counter);
-            
+        
         default:
             return generate_artistic_name(counter);
     }
 }
 
+char* generate_aesthetic_name_advanced(AestheticStyle style, int counter) {
+    return generate_style_name(NULL, style, counter);
+}
+
 /* ═══════════════════════════════════════════════════════════════════════════
  * AST Traversal for Identifier Collection
  * ═══════════════════════════════════════════════════════════════════════════ */
@@ -308,6 +441,8 @@ static void collect_identifiers_recursive(ObfuscationContext* ctx, ASTNode* node
             break;
         }
         
+        // Parameters are declared like variables
+        case NODE_PARAMETER:
         case NODE_VARIABLE: {
             const char* name = node->data.variable.name;
             if (name && !symbol_table_lookup(ctx->symbol_table, name)) {
@@ -326,42 +461,44 @@ static void collect_identifiers_recursive(ObfuscationContext* ctx, ASTNode* node
             collect_identifiers_recursive(ctx, node->data.call.function);
             collect_identifiers_recursive(ctx, node->data.call.arguments);
             break;
-            
+        
         case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
             collect_identifiers_recursive(ctx, node->data.binary.left);
             collect_identifiers_recursive(ctx, node->data.binary.right);
             break;
-            
+        
         case NODE_UNARY_OP:
             collect_identifiers_recursive(ctx, node->data.unary.operand);
             break;
-            
+        
         case NODE_IF:
             collect_identifiers_recursive(ctx, node->data.if_stmt.condition);
             collect_identifiers_recursive(ctx, node->data.if_stmt.then_stmt);
             collect_identifiers_recursive(ctx, node->data.if_stmt.else_stmt);
             break;
-            
+        
         case NODE_WHILE:
             collect_identifiers_recursive(ctx, node->data.while_stmt.condition);
             collect_identifiers_recursive(ctx, node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
             collect_identifiers_recursive(ctx, node->data.for_stmt.init);
             collect_identifiers_recursive(ctx, node->data.for_stmt.condition);
             collect_identifiers_recursive(ctx, node->data.for_stmt.update);
             collect_identifiers_recursive(ctx, node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
             collect_identifiers_recursive(ctx, node->data.block.statements);
             break;
-            
+        
         case NODE_STRUCT:
             collect_identifiers_recursive(ctx, node->data.struct_def.members);
             break;
-            
+        
         default:
             break;
     }
@@ -386,15 +523,15 @@ static void generate_obfuscated_names(ObfuscationContext* ctx) {
         while (symbol) {
             if (!symbol->is_obfuscated && !is_reserved_keyword(symbol->original_name)) {
                 // Generate aesthetic obfuscated name
-                symbol->obfuscated_name = generate_aesthetic_name_advanced(
-                    ctx->config->aesthetic, counter++);
+                symbol->obfuscated_name = generate_style_name(
+                    ctx->random, ctx->config->aesthetic, counter++);
                 symbol->is_obfuscated = true;
                 
                 // Ensure uniqueness
                 while (symbol_table_lookup(ctx->symbol_table, symbol->obfuscated_name)) {
                     free(symbol->obfuscated_name);
-                    symbol->obfuscated_name = generate_aesthetic_name_advanced(
-                        ctx->config->aesthetic, counter++);
+                    symbol->obfuscated_name = generate_style_name(
+                        ctx->random, ctx->config->aesthetic, counter++);
                 }
             }
             symbol = symbol->next;
@@ -432,6 +569,7 @@ static void apply_identifier_obfuscation_recursive(ObfuscationContext* ctx, ASTN
             break;
         }
         
+        case NODE_PARAMETER:
         case NODE_VARIABLE: {
             Symbol* symbol = symbol_table_lookup(ctx->symbol_table, 
                                                 node->data.variable.name);
@@ -448,42 +586,44 @@ static void apply_identifier_obfuscation_recursive(ObfuscationContext* ctx, ASTN
             apply_identifier_obfuscation_recursive(ctx, node->data.call.function);
             apply_identifier_obfuscation_recursive(ctx, node->data.call.arguments);
             break;
-            
+        
         case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
             apply_identifier_obfuscation_recursive(ctx, node->data.binary.left);
             apply_identifier_obfuscation_recursive(ctx, node->data.binary.right);
             break;
-            
+        
         case NODE_UNARY_OP:
             apply_identifier_obfuscation_recursive(ctx, node->data.unary.operand);
             break;
-            
+        
         case NODE_IF:
             apply_identifier_obfuscation_recursive(ctx, node->data.if_stmt.condition);
             apply_identifier_obfuscation_recursive(ctx, node->data.if_stmt.then_stmt);
             apply_identifier_obfuscation_recursive(ctx, node->data.if_stmt.else_stmt);
             break;
-            
+        
         case NODE_WHILE:
             apply_identifier_obfuscation_recursive(ctx, node->data.while_stmt.condition);
             apply_identifier_obfuscation_recursive(ctx, node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
             apply_identifier_obfuscation_recursive(ctx, node->data.for_stmt.init);
             apply_identifier_obfuscation_recursive(ctx, node->data.for_stmt.condition);
             apply_identifier_obfuscation_recursive(ctx, node->data.for_stmt.update);
             apply_identifier_obfuscation_recursive(ctx, node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
             apply_identifier_obfuscation_recursive(ctx, node->data.block.statements);
             break;
-            
+        
         case NODE_STRUCT:
             apply_identifier_obfuscation_recursive(ctx, node->data.struct_def.members);
             break;
-            
+        
         default:
             break;
     }
@@ -512,9 +652,60 @@ bool obfuscate_identifiers(ObfuscationContext* ctx, ASTNode* ast) {
  * Main Obfuscation Interface
  * ═══════════════════════════════════════════════════════════════════════════ */
 
+static void apply_function_settings(const ObfuscationConfig* config, ASTNode* node) {
+    if (!config->function_settings) return;
+    
+    for (; node; node = node->next) {
+        if (node->type == NODE_PROGRAM) {
+            apply_function_settings(config, node->data.program.declarations);
+        } else if (node->type == NODE_FUNCTION) {
+            int cap = config_function_level(config, node->data.function.name);
+            if (cap > 0) ast_apply_level_cap(node, cap);
+        }
+    }
+}
+
 ASTNode* obfuscate_ast(ObfuscationContext* ctx, ASTNode* ast) {
     if (!ctx || !ast) return NULL;
     
+    // Keep hot code light: cap intensity per function and loop
+    if (ctx->config->profile_file) {
+        Profile* profile = profile_create();
+        if (!profile || !profile_load(profile, ctx->config->profile_file)) {
+            char message[512];
+            snprintf(message, sizeof(message), "Cannot load profile '%s'",
+                     ctx->config->profile_file);
+            obfuscator_add_error(ctx, ERROR_IO, message);
+            profile_destroy(profile);
+            return NULL;
+        }
+        profile_annotate(profile, ctx->config, ast);
+        profile_destroy(profile);
+    }
+    
+    // Tuned per-function levels, e.g. from an autotuned configuration file
+    apply_function_settings(ctx->config, ast);
+    
+    // Pragma, profile and configured caps apply to everything beneath them
+    ast_propagate_level_caps(ast);
+    
+    if (ctx->config->static_hotness) {
+        hotness_annotate(ast);
+    }
+    
+    // Counted loops keep the shape auto-vectorizers look for
+    if (ctx->config->protect_loops) {
+        loop_report_destroy(ctx->loops);
+        ctx->loops = loop_protect(ast);
+    }
+    
+    // Int-only rewrites (MBA, algebraic folds, helper calls) need known types
+    typing_annotate(ast);
+    
+    // Every pass below charges the nodes it adds
+    budget_destroy(ctx->budget);
+    ctx->budget = budget_create(ctx->config, ast);
+    
     // Apply obfuscation passes based on configuration level
     if (ctx->config->level >= OBF_BASIC) {
         if (!obfuscate_identifiers(ctx, ast)) {
@@ -522,18 +713,28 @@ ASTNode* obfuscate_ast(ObfuscationContext* ctx, ASTNode* ast) {
         }
     }
     
+    // Bytecode is compiled from the source as written, before any rewrite
+    if (ctx->config->level >= OBF_EXTREME && ctx->config->virtualize) {
+        if (!virtualize_functions(ctx, ast)) {
+            return NULL;
+        }
+    }
+    
     // Add more obfuscation passes for higher levels
     if (ctx->config->level >= OBF_INTERMEDIATE) {
         if (!obfuscate_expressions(ctx, ast)) {
             return NULL;
         }
+        if (ctx->config->constant_encoding && !encode_constants(ctx, ast)) {
+            return NULL;
+        }
         if (!obfuscate_strings(ctx, ast)) {
             return NULL;
         }
     }
     
     if (ctx->config->level >= OBF_EXTREME) {
-        if (!obfuscate_control_flow(ctx, ast)) {
+        if (ctx->config->obfuscate_control_flow && !obfuscate_control_flow(ctx, ast)) {
             return NULL;
         }
         if (!insert_dead_code(ctx, ast)) {
@@ -544,6 +745,13 @@ ASTNode* obfuscate_ast(ObfuscationContext* ctx, ASTNode* ast) {
         }
     }
     
+    // Fold away redundancy the passes left behind
+    if (ctx->config->simplify_output) {
+        if (!simplify_ast(ctx, ast)) {
+            return NULL;
+        }
+    }
+    
     return ast;
 }
 
@@ -563,6 +771,29 @@ ObfuscationConfig* config_create_default(void) {
     config->insert_dead_code = false;
     config->use_macros = true;
     config->output_file = NULL;
+    config->mba_expr_budget = 24;
+    config->mba_function_budget = 512;
+    config->simplify_output = true;
+    config->simplify_preserve_opaque = true;
+    config->profile_file = NULL;
+    config->profile_hot_percent = 10;
+    config->profile_warm_percent = 1;
+    config->static_hotness = true;
+    config->string_decrypt_all = false;
+    config->flatten_dispatch = FLATTEN_DISPATCH_SWITCH;
+    config->flatten_encode_states = true;
+    config->flatten_merge_blocks = true;
+    config->opaque_cost_budget = 16;
+    config->cold_placement = true;
+    config->constant_encoding = true;
+    config->constant_cost_budget = 6;
+    config->virtualize = true;
+    config->protect_loops = true;
+    config->dead_code_percent = 30;
+    config->function_settings = NULL;
+    config->seed = 0;
+    config->max_growth = 0.0;
+    config->max_nodes = 0;
     
     // Initialize name generator
     config->name_gen.pattern = NULL;
@@ -578,7 +809,16 @@ void config_destroy(ObfuscationConfig* config) {
     if (!config) return;
     
     free(config->output_file);
+    free(config->profile_file);
     free(config->name_gen.pattern);
+    
+    FunctionSetting* setting = config->function_settings;
+    while (setting) {
+        FunctionSetting* next = setting->next;
+        free(setting->function);
+        free(setting);
+        setting = next;
+    }
     free(config);
 }
 
@@ -593,476 +833,572 @@ void config_set_aesthetic(ObfuscationConfig* config, AestheticStyle style) {
     config->name_gen.use_unicode = (style == AESTHETIC_UNICODE);
 }
 
-/* ═══════════════════════════════════════════════════════════════════════════
- * Forward Declarations
- * ═══════════════════════════════════════════════════════════════════════════ */
-
-static void obfuscate_expressions_recursive(ObfuscationContext* ctx, ASTNode* node);
-static void obfuscate_strings_recursive(ObfuscationContext* ctx, ASTNode* node);
-static void obfuscate_control_flow_recursive(ObfuscationContext* ctx, ASTNode* node);
-static void insert_dead_code_recursive(ObfuscationContext* ctx, ASTNode* node);
-static void insert_anti_debug_code_recursive(ObfuscationContext* ctx, ASTNode* node);
-
-/* ═══════════════════════════════════════════════════════════════════════════
- * AST Helper Functions
- * ═══════════════════════════════════════════════════════════════════════════ */
-
-static ASTNode* ast_create_literal(const char* value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_LITERAL;
-    node->data.literal.value = strdup(value);
-    node->next = NULL;
-    return node;
-}
-
-static ASTNode* ast_create_literal_number(int value) {
-    char buffer[32];
-    sprintf(buffer, "%d", value);
-    return ast_create_literal(buffer);
+static char* strdup_or_null(const char* str) {
+    return str ? strdup(str) : NULL;
 }
 
-static ASTNode* ast_create_identifier(const char* name) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+ObfuscationConfig* config_clone(const ObfuscationConfig* config) {
+    if (!config) return NULL;
     
-    node->type = NODE_IDENTIFIER;
-    node->data.identifier.name = strdup(name);
-    node->next = NULL;
-    return node;
+    ObfuscationConfig* clone = malloc(sizeof(ObfuscationConfig));
+    if (!clone) return NULL;
+    
+    *clone = *config;
+    clone->output_file = strdup_or_null(config->output_file);
+    clone->profile_file = strdup_or_null(config->profile_file);
+    clone->name_gen.pattern = strdup_or_null(config->name_gen.pattern);
+    clone->function_settings = NULL;
+    
+    FunctionSetting** tail = &clone->function_settings;
+    for (const FunctionSetting* s = config->function_settings; s; s = s->next) {
+        FunctionSetting* copy = malloc(sizeof(FunctionSetting));
+        if (!copy || !(copy->function = strdup(s->function))) {
+            free(copy);
+            config_destroy(clone);
+            return NULL;
+        }
+        copy->level_cap = s->level_cap;
+        copy->next = NULL;
+        *tail = copy;
+        tail = &copy->next;
+    }
+    return clone;
 }
 
-static ASTNode* ast_create_binary_op(const char* op, ASTNode* left, ASTNode* right) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+bool config_set_function_level(ObfuscationConfig* config, const char* function, int level_cap) {
+    if (!config || !function) return false;
+    
+    for (FunctionSetting* s = config->function_settings; s; s = s->next) {
+        if (strcmp(s->function, function) == 0) {
+            s->level_cap = level_cap;
+            return true;
+        }
+    }
     
-    node->type = NODE_BINARY_OP;
-    node->data.binary.operator = strdup(op);
-    node->data.binary.left = left;
-    node->data.binary.right = right;
-    node->next = NULL;
-    return node;
+    FunctionSetting* setting = malloc(sizeof(FunctionSetting));
+    if (!setting) return false;
+    setting->function = strdup(function);
+    if (!setting->function) {
+        free(setting);
+        return false;
+    }
+    setting->level_cap = level_cap;
+    setting->next = config->function_settings;
+    config->function_settings = setting;
+    return true;
 }
 
-static ASTNode* ast_create_unary_op(const char* op, ASTNode* operand, bool is_prefix) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+int config_function_level(const ObfuscationConfig* config, const char* function) {
+    if (!config || !function) return 0;
     
-    node->type = NODE_UNARY_OP;
-    node->data.unary.operator = strdup(op);
-    node->data.unary.operand = operand;
-    node->data.unary.is_prefix = is_prefix;
-    node->next = NULL;
-    return node;
+    for (const FunctionSetting* s = config->function_settings; s; s = s->next) {
+        if (strcmp(s->function, function) == 0) return s->level_cap;
+    }
+    return 0;
 }
 
-static ASTNode* ast_create_variable(const char* name, const char* type, ASTNode* initializer) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_VARIABLE;
-    node->data.variable.name = strdup(name);
-    node->data.variable.type = strdup(type);
-    node->data.variable.initializer = initializer;
-    node->data.variable.is_static = false;
-    node->data.variable.is_const = false;
-    node->next = NULL;
-    return node;
-}
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Configuration Files
+ *
+ * One `key = value` per line; `#` starts a comment. Per-function levels
+ * are written as `function.NAME.level = basic|intermediate|extreme`.
+ * ═══════════════════════════════════════════════════════════════════════════ */
 
-static ASTNode* ast_create_assignment(ASTNode* target, ASTNode* value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_ASSIGNMENT;
-    // Simplified - would need proper assignment structure in ASTNode
-    node->data.binary.left = target;
-    node->data.binary.right = value;
-    node->data.binary.operator = strdup("=");
-    node->next = NULL;
-    return node;
-}
+typedef enum { SETTING_BOOL, SETTING_INT, SETTING_LEVEL, SETTING_DISPATCH, SETTING_STRING } SettingKind;
+
+typedef struct {
+    const char* key;
+    SettingKind kind;
+    size_t offset;
+} SettingField;
+
+static const SettingField setting_fields[] = {
+    {"level",                  SETTING_LEVEL, offsetof(ObfuscationConfig, level)},
+    {"obfuscate_strings",      SETTING_BOOL,  offsetof(ObfuscationConfig, obfuscate_strings)},
+    {"string_decrypt_all",     SETTING_BOOL,  offsetof(ObfuscationConfig, string_decrypt_all)},
+    {"obfuscate_control_flow", SETTING_BOOL,  offsetof(ObfuscationConfig, obfuscate_control_flow)},
+    {"dead_code_percent",      SETTING_INT,   offsetof(ObfuscationConfig, dead_code_percent)},
+    {"mba_expr_budget",        SETTING_INT,   offsetof(ObfuscationConfig, mba_expr_budget)},
+    {"mba_function_budget",    SETTING_INT,   offsetof(ObfuscationConfig, mba_function_budget)},
+    {"constant_encoding",      SETTING_BOOL,  offsetof(ObfuscationConfig, constant_encoding)},
+    {"constant_cost_budget",   SETTING_INT,   offsetof(ObfuscationConfig, constant_cost_budget)},
+    {"opaque_cost_budget",     SETTING_INT,   offsetof(ObfuscationConfig, opaque_cost_budget)},
+    {"cold_placement",         SETTING_BOOL,  offsetof(ObfuscationConfig, cold_placement)},
+    {"virtualize",             SETTING_BOOL,  offsetof(ObfuscationConfig, virtualize)},
+    {"protect_loops",          SETTING_BOOL,  offsetof(ObfuscationConfig, protect_loops)},
+    {"static_hotness",         SETTING_BOOL,  offsetof(ObfuscationConfig, static_hotness)},
+    {"flatten_dispatch",       SETTING_DISPATCH, offsetof(ObfuscationConfig, flatten_dispatch)},
+    {"flatten_encode_states",  SETTING_BOOL,  offsetof(ObfuscationConfig, flatten_encode_states)},
+    {"flatten_merge_blocks",   SETTING_BOOL,  offsetof(ObfuscationConfig, flatten_merge_blocks)},
+    {"profile_file",           SETTING_STRING, offsetof(ObfuscationConfig, profile_file)},
+    {"profile_hot_percent",    SETTING_INT,   offsetof(ObfuscationConfig, profile_hot_percent)},
+    {"profile_warm_percent",   SETTING_INT,   offsetof(ObfuscationConfig, profile_warm_percent)},
+    {NULL, SETTING_BOOL, 0}
+};
 
-static ASTNode* ast_create_if(ASTNode* condition, ASTNode* then_stmt, ASTNode* else_stmt) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_IF;
-    node->data.if_stmt.condition = condition;
-    node->data.if_stmt.then_stmt = then_stmt;
-    node->data.if_stmt.else_stmt = else_stmt;
-    node->next = NULL;
-    return node;
-}
+static const char* level_names[] = {NULL, "basic", "intermediate", "extreme"};
+static const char* dispatch_names[] = {"switch", "goto"};
 
-static ASTNode* ast_create_while(ASTNode* condition, ASTNode* body) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_WHILE;
-    node->data.while_stmt.condition = condition;
-    node->data.while_stmt.body = body;
-    node->next = NULL;
-    return node;
+static int parse_level_name(const char* value) {
+    for (int level = OBF_BASIC; level <= OBF_EXTREME; level++) {
+        if (strcmp(value, level_names[level]) == 0) return level;
+    }
+    return 0;
 }
 
-static ASTNode* ast_create_for(ASTNode* init, ASTNode* condition, ASTNode* update, ASTNode* body) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
-    
-    node->type = NODE_FOR;
-    node->data.for_stmt.init = init;
-    node->data.for_stmt.condition = condition;
-    node->data.for_stmt.update = update;
-    node->data.for_stmt.body = body;
-    node->next = NULL;
-    return node;
+static char* trim(char* str) {
+    while (*str == ' ' || *str == '\t') str++;
+    char* end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) {
+        *--end = '\0';
+    }
+    return str;
 }
 
-static ASTNode* ast_create_block(ASTNode* statements) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+static bool apply_setting(ObfuscationConfig* config, const char* key, const char* value) {
+    // function.NAME.level
+    if (strncmp(key, "function.", 9) == 0) {
+        const char* name = key + 9;
+        const char* dot = strrchr(name, '.');
+        if (!dot || dot == name || strcmp(dot, ".level") != 0) return false;
+        
+        int level = parse_level_name(value);
+        if (!level) return false;
+        
+        char function[256];
+        size_t length = (size_t)(dot - name);
+        if (length >= sizeof(function)) return false;
+        memcpy(function, name, length);
+        function[length] = '\0';
+        return config_set_function_level(config, function, level);
+    }
     
-    node->type = NODE_BLOCK;
-    node->data.block.statements = statements;
-    node->next = NULL;
-    return node;
+    for (const SettingField* field = setting_fields; field->key; field++) {
+        if (strcmp(field->key, key) != 0) continue;
+        
+        char* target = (char*)config + field->offset;
+        switch (field->kind) {
+            case SETTING_BOOL:
+                if (strcmp(value, "true") == 0) *(bool*)target = true;
+                else if (strcmp(value, "false") == 0) *(bool*)target = false;
+                else return false;
+                return true;
+            
+            case SETTING_INT: {
+                char* end;
+                long number = strtol(value, &end, 10);
+                if (end == value || *end || number < 0 || number > 1000000) return false;
+                *(int*)target = (int)number;
+                return true;
+            }
+            
+            case SETTING_LEVEL: {
+                int level = parse_level_name(value);
+                if (!level) return false;
+                *(ObfuscationLevel*)target = (ObfuscationLevel)level;
+                return true;
+            }
+            
+            case SETTING_DISPATCH:
+                if (strcmp(value, dispatch_names[FLATTEN_DISPATCH_SWITCH]) == 0) {
+                    *(FlattenDispatch*)target = FLATTEN_DISPATCH_SWITCH;
+                } else if (strcmp(value, dispatch_names[FLATTEN_DISPATCH_GOTO]) == 0) {
+                    *(FlattenDispatch*)target = FLATTEN_DISPATCH_GOTO;
+                } else {
+                    return false;
+                }
+                return true;
+            
+            case SETTING_STRING: {
+                // An empty value clears the setting
+                char* copy = NULL;
+                if (*value && !(copy = strdup(value))) return false;
+                free(*(char**)target);
+                *(char**)target = copy;
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-static ASTNode* ast_create_switch(ASTNode* expression, ASTNode* cases) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+bool config_load(ObfuscationConfig* config, const char* filename) {
+    if (!config || !filename) return false;
     
-    node->type = NODE_BINARY_OP; // Reuse for switch - simplified
-    node->data.binary.left = expression;
-    node->data.binary.right = cases;
-    node->data.binary.operator = strdup("switch");
-    node->next = NULL;
-    return node;
-}
-
-static ASTNode* ast_create_case(ASTNode* value, ASTNode* statement) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    if (!node) return NULL;
+    FILE* file = fopen(filename, "r");
+    if (!file) return false;
+    
+    char line[512];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        
+        char* text = trim(line);
+        if (!*text) continue;
+        
+        char* equals = strchr(text, '=');
+        if (!equals) {
+            ok = false;
+            break;
+        }
+        *equals = '\0';
+        ok = apply_setting(config, trim(text), trim(equals + 1));
+    }
     
-    node->type = NODE_BINARY_OP; // Reuse for case - simplified
-    node->data.binary.left = value;
-    node->data.binary.right = statement;
-    node->data.binary.operator = strdup("case");
-    node->next = NULL;
-    return node;
+    fclose(file);
+    return ok;
 }
 
-static ASTNode* ast_copy(ASTNode* original) {
-    if (!original) return NULL;
+bool config_save(const ObfuscationConfig* config, const char* filename) {
+    if (!config || !filename) return false;
     
-    ASTNode* copy = malloc(sizeof(ASTNode));
-    if (!copy) return NULL;
+    FILE* file = fopen(filename, "w");
+    if (!file) return false;
     
-    *copy = *original; // Shallow copy
-    copy->next = NULL;
+    fprintf(file, "# Obfuscator configuration\n");
+    for (const SettingField* field = setting_fields; field->key; field++) {
+        const char* source = (const char*)config + field->offset;
+        switch (field->kind) {
+            case SETTING_BOOL:
+                fprintf(file, "%s = %s\n", field->key, *(const bool*)source ? "true" : "false");
+                break;
+            case SETTING_INT:
+                fprintf(file, "%s = %d\n", field->key, *(const int*)source);
+                break;
+            case SETTING_LEVEL:
+                fprintf(file, "%s = %s\n", field->key, level_names[*(const ObfuscationLevel*)source]);
+                break;
+            case SETTING_DISPATCH:
+                fprintf(file, "%s = %s\n", field->key, dispatch_names[*(const FlattenDispatch*)source]);
+                break;
+            case SETTING_STRING:
+                if (*(char* const*)source) fprintf(file, "%s = %s\n", field->key, *(char* const*)source);
+                break;
+        }
+    }
     
-    // Deep copy specific data based on node type
-    switch (original->type) {
-        case NODE_LITERAL:
-            copy->data.literal.value = strdup(original->data.literal.value);
-            break;
-        case NODE_IDENTIFIER:
-            copy->data.identifier.name = strdup(original->data.identifier.name);
-            break;
-        case NODE_BINARY_OP:
-            copy->data.binary.operator = strdup(original->data.binary.operator);
-            copy->data.binary.left = ast_copy(original->data.binary.left);
-            copy->data.binary.right = ast_copy(original->data.binary.right);
-            break;
-        case NODE_UNARY_OP:
-            copy->data.unary.operator = strdup(original->data.unary.operator);
-            copy->data.unary.operand = ast_copy(original->data.unary.operand);
-            break;
-        default:
-            break;
+    for (const FunctionSetting* s = config->function_settings; s; s = s->next) {
+        if (s->level_cap < OBF_BASIC || s->level_cap > OBF_EXTREME) continue;
+        fprintf(file, "function.%s.level = %s\n", s->function, level_names[s->level_cap]);
     }
     
-    return copy;
+    return fclose(file) == 0;
 }
 
-static ASTNode* ast_link(ASTNode* first, ASTNode* second) {
-    if (!first) return second;
-    if (!second) return first;
-    
-    ASTNode* current = first;
-    while (current->next) {
-        current = current->next;
-    }
-    current->next = second;
-    return first;
-}
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Forward Declarations
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void obfuscate_expressions_recursive(ObfuscationContext* ctx, MBAState* mba, ASTNode* node);
+static void obfuscate_strings_recursive(ObfuscationContext* ctx, ASTNode* node, bool in_function);
+static void obfuscate_control_flow_recursive(ObfuscationContext* ctx, ASTNode* node);
+static void insert_dead_code_recursive(ObfuscationContext* ctx, ASTNode* node,
+                                       const ASTNode* function);
+static void insert_anti_debug_code_recursive(ObfuscationContext* ctx, ASTNode* node);
+static void apply_helper_calls_recursive(ObfuscationContext* ctx, ASTNode* node);
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Advanced Expression Obfuscation
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static ASTNode* create_complex_expression(ASTNode* original) {
-    if (!original || original->type != NODE_BINARY_OP) return original;
-    
-    // Transform simple operations into complex bitwise equivalents
-    char* op = original->data.binary.operator;
+/* Rewrites one expression tree bottom-up. Operands are rewritten before
+ * their parent so that hoisted temporaries capture already-obfuscated
+ * subexpressions, and every rewrite is charged to the MBA budgets. */
+static void obfuscate_expression_tree(ObfuscationContext* ctx, MBAState* mba, ASTNode* node) {
+    if (!node || (node->flags & AST_FLAG_PROTECTED)) return;
     
-    if (strcmp(op, "+") == 0) {
-        // a + b -> ((a ^ b) + 2 * (a & b))
-        ASTNode* xor_node = ast_create_binary_op("^", 
-            ast_copy(original->data.binary.left), 
-            ast_copy(original->data.binary.right));
+    switch (node->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            obfuscate_expression_tree(ctx, mba, node->data.binary.left);
+            obfuscate_expression_tree(ctx, mba, node->data.binary.right);
+            
+            // Ternaries chain the else branch after the then branch
+            if (node->data.binary.right && node->data.binary.operator &&
+                strcmp(node->data.binary.operator, "?:") == 0) {
+                obfuscate_expression_tree(ctx, mba, node->data.binary.right->next);
+            }
+            
+            // A pragma can cap part of an expression whose root is not capped
+            if (node->type == NODE_BINARY_OP &&
+                obfuscator_effective_level(ctx, node) >= OBF_INTERMEDIATE &&
+                obfuscator_should_apply(ctx, node, 70)) {
+                mba_rewrite(ctx, mba, node);
+            }
+            break;
         
-        ASTNode* and_node = ast_create_binary_op("&", 
-            ast_copy(original->data.binary.left), 
-            ast_copy(original->data.binary.right));
+        case NODE_UNARY_OP:
+            obfuscate_expression_tree(ctx, mba, node->data.unary.operand);
+            break;
+        
+        case NODE_CALL: {
+            ASTNode* arg = node->data.call.arguments;
+            while (arg) {
+                obfuscate_expression_tree(ctx, mba, arg);
+                arg = arg->next;
+            }
+            break;
+        }
         
-        ASTNode* two_node = ast_create_literal("2");
-        ASTNode* mul_node = ast_create_binary_op("*", two_node, and_node);
+        case NODE_STMT_EXPR: {
+            // Hoisted temporaries and the resulting value
+            ASTNode* stmt = node->data.block.statements;
+            while (stmt) {
+                if (stmt->type == NODE_VARIABLE) {
+                    obfuscate_expression_tree(ctx, mba, stmt->data.variable.initializer);
+                } else {
+                    obfuscate_expression_tree(ctx, mba, stmt);
+                }
+                stmt = stmt->next;
+            }
+            break;
+        }
         
-        return ast_create_binary_op("+", xor_node, mul_node);
+        default:
+            break;
+    }
+}
+
+static void rewrite_expression(ObfuscationContext* ctx, MBAState* mba, ASTNode* node) {
+    // Evaluate repeated subexpressions once, through fresh temporaries
+    if (!mba->constant_context) {
+        cse_hoist_expression(ctx, node);
     }
     
-    if (strcmp(op, "*") == 0) {
-        // a * b -> ((a & b) + ((a ^ b) >> 1)) << 1 + (a & b & 1)
-        ASTNode* and_node = ast_create_binary_op("&", 
-            ast_copy(original->data.binary.left), 
-            ast_copy(original->data.binary.right));
-        
-        ASTNode* xor_node = ast_create_binary_op("^", 
-            ast_copy(original->data.binary.left), 
-            ast_copy(original->data.binary.right));
-        
-        ASTNode* shift_node = ast_create_binary_op(">>", xor_node, ast_create_literal("1"));
-        ASTNode* add_node = ast_create_binary_op("+", and_node, shift_node);
-        ASTNode* left_shift = ast_create_binary_op("<<", add_node, ast_create_literal("1"));
-        
-        ASTNode* final_and = ast_create_binary_op("&", 
-            ast_copy(original->data.binary.left), 
-            ast_copy(original->data.binary.right));
-        ASTNode* one_node = ast_create_literal("1");
-        ASTNode* final_and2 = ast_create_binary_op("&", final_and, one_node);
-        
-        return ast_create_binary_op("+", left_shift, final_and2);
+    mba_begin_expression(mba, ctx->config);
+    obfuscate_expression_tree(ctx, mba, node);
+}
+
+static void obfuscate_expression_root(ObfuscationContext* ctx, MBAState* mba, ASTNode* node) {
+    if (!node || (node->flags & AST_FLAG_PROTECTED)) return;
+    if (obfuscator_effective_level(ctx, node) < OBF_INTERMEDIATE) return;
+    
+    if (!ctx->budget) {
+        rewrite_expression(ctx, mba, node);
+        return;
+    }
+    
+    // Under a growth budget the expression is rewritten as a whole or not
+    // at all: MBA charges as it goes, but hoisting only shows up in the
+    // measured size, and a half-rewritten expression is the worst of both
+    MBAState before = *mba;
+    long charged = ctx->budget->added;
+    long size = (long)ast_count_nodes(node);
+    size_t mark = undo_checkpoint(ctx->undo);
+    
+    rewrite_expression(ctx, mba, node);
+    
+    charged = ctx->budget->added - charged;
+    long uncharged = (long)ast_count_nodes(node) - size - charged;
+    if (uncharged > 0 && !budget_allows(ctx->budget, uncharged)) {
+        undo_rollback(ctx->undo, mark);
+        budget_charge(ctx->budget, -charged);
+        *mba = before;
+        return;
     }
     
-    return original;
+    budget_charge(ctx->budget, uncharged);
+    undo_commit(ctx->undo, mark);
 }
 
 bool obfuscate_expressions(ObfuscationContext* ctx, ASTNode* ast) {
     if (!ctx || !ast) return false;
     
+    MBAState mba = {0};
+    mba_begin_function(&mba, ctx->config);
+    
     // Recursively obfuscate all binary expressions
-    obfuscate_expressions_recursive(ctx, ast);
+    obfuscate_expressions_recursive(ctx, &mba, ast);
     
     ctx->pass_count++;
     return true;
 }
 
-static void obfuscate_expressions_recursive(ObfuscationContext* ctx, ASTNode* node) {
+static void obfuscate_expressions_recursive(ObfuscationContext* ctx, MBAState* mba, ASTNode* node) {
     if (!node) return;
     
     switch (node->type) {
-        case NODE_BINARY_OP: {
-            // Obfuscate children first
-            obfuscate_expressions_recursive(ctx, node->data.binary.left);
-            obfuscate_expressions_recursive(ctx, node->data.binary.right);
-            
-            // Apply complex expression transformation with some probability
-            if (rand() % 100 < 70) { // 70% chance to obfuscate
-                ASTNode* complex = create_complex_expression(node);
-                if (complex != node) {
-                    // Replace the node (simplified - in real implementation would need proper AST node replacement)
-                    *node = *complex;
-                    free(complex);
-                }
-            }
+        case NODE_FUNCTION: {
+            bool was_in_function = mba->in_function;
+            mba_begin_function(mba, ctx->config);
+            mba->in_function = true;
+            budget_enter(ctx->budget, node);
+            obfuscate_expressions_recursive(ctx, mba, node->data.function.body);
+            budget_enter(ctx->budget, NULL);
+            mba->in_function = was_in_function;
             break;
         }
         
-        case NODE_UNARY_OP:
-            obfuscate_expressions_recursive(ctx, node->data.unary.operand);
+        case NODE_VARIABLE:
+            // Static and file-scope initializers must stay constant expressions
+            mba->constant_context = !mba->in_function || node->data.variable.is_static;
+            obfuscate_expression_root(ctx, mba, node->data.variable.initializer);
+            mba->constant_context = false;
             break;
-            
-        case NODE_CALL:
-            obfuscate_expressions_recursive(ctx, node->data.call.function);
-            obfuscate_expressions_recursive(ctx, node->data.call.arguments);
+        
+        case NODE_RETURN:
+            // Return values are not modelled by the parser yet
             break;
-            
+        
         case NODE_IF:
-            obfuscate_expressions_recursive(ctx, node->data.if_stmt.condition);
-            obfuscate_expressions_recursive(ctx, node->data.if_stmt.then_stmt);
-            obfuscate_expressions_recursive(ctx, node->data.if_stmt.else_stmt);
+            obfuscate_expression_root(ctx, mba, node->data.if_stmt.condition);
+            obfuscate_expressions_recursive(ctx, mba, node->data.if_stmt.then_stmt);
+            obfuscate_expressions_recursive(ctx, mba, node->data.if_stmt.else_stmt);
             break;
-            
+        
         case NODE_WHILE:
-            obfuscate_expressions_recursive(ctx, node->data.while_stmt.condition);
-            obfuscate_expressions_recursive(ctx, node->data.while_stmt.body);
+            obfuscate_expression_root(ctx, mba, node->data.while_stmt.condition);
+            obfuscate_expressions_recursive(ctx, mba, node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
-            obfuscate_expressions_recursive(ctx, node->data.for_stmt.init);
-            obfuscate_expressions_recursive(ctx, node->data.for_stmt.condition);
-            obfuscate_expressions_recursive(ctx, node->data.for_stmt.update);
-            obfuscate_expressions_recursive(ctx, node->data.for_stmt.body);
+            obfuscate_expressions_recursive(ctx, mba, node->data.for_stmt.init);
+            obfuscate_expression_root(ctx, mba, node->data.for_stmt.condition);
+            obfuscate_expression_root(ctx, mba, node->data.for_stmt.update);
+            obfuscate_expressions_recursive(ctx, mba, node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
-            obfuscate_expressions_recursive(ctx, node->data.block.statements);
+            obfuscate_expressions_recursive(ctx, mba, node->data.block.statements);
             break;
-            
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_UNARY_OP:
+        case NODE_CALL:
+            // Expression statement
+            obfuscate_expression_root(ctx, mba, node);
+            break;
+        
         default:
             break;
     }
     
-    obfuscate_expressions_recursive(ctx, node->next);
+    obfuscate_expressions_recursive(ctx, mba, node->next);
 }
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * String Encryption Obfuscation
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static char* encrypt_string(const char* original) {
-    if (!original) return NULL;
-    
-    size_t len = strlen(original);
-    char* encrypted = malloc(len * 8 + 256); // Extra space for decryption code
-    if (!encrypted) return NULL;
-    
-    // Create XOR encryption with random key
-    unsigned char key = 0x42 ^ (rand() % 256);
-    
-    // Generate decryption function code
-    sprintf(encrypted, 
-        "({ static const unsigned char k[%zu] = {", len);
-    char* ptr = encrypted + strlen(encrypted);
-    
-    for (size_t i = 0; i < len; i++) {
-        unsigned char encrypted_char = original[i] ^ key;
-        ptr += sprintf(ptr, "%d", encrypted_char);
-        if (i < len - 1) ptr += sprintf(ptr, ",");
+/* Moves a string literal into the context's encrypted table and replaces
+ * it with a lookup of its decrypt-once slot */
+static void encrypt_string_literal(ObfuscationContext* ctx, ASTNode* node) {
+    unsigned char* bytes = NULL;
+    size_t length = 0;
+    if (!string_literal_decode(node->data.literal.value, &bytes, &length)) return;
+    
+    // The lookup call adds its callee and index
+    if (!budget_allows(ctx->budget, 2)) {
+        free(bytes);
+        return;
     }
     
-    ptr += sprintf(ptr, "}; "
-        "char buf[%zu]; "
-        "for(size_t i=0;i<%zu;i++) buf[i]=k[i]^%d; "
-        "buf[%zu]='\\0'; buf; })", len, len, key, len);
+    int index = string_table_add(ctx->strings, bytes, length);
+    free(bytes);
+    if (index < 0) return;
     
-    return encrypted;
+    ASTNode* lookup = ast_create_call(ast_create_identifier("__obf_str"),
+                                      ast_create_literal_number(index));
+    if (lookup) {
+        undo_replace(ctx->undo, node, lookup);
+        budget_charge(ctx->budget, 2);
+    }
 }
 
+
 bool obfuscate_strings(ObfuscationContext* ctx, ASTNode* ast) {
     if (!ctx || !ast) return false;
     
     // Recursively find and encrypt all string literals
-    obfuscate_strings_recursive(ctx, ast);
+    obfuscate_strings_recursive(ctx, ast, false);
     
     ctx->pass_count++;
     return true;
 }
 
-static void obfuscate_strings_recursive(ObfuscationContext* ctx, ASTNode* node) {
+static void obfuscate_strings_recursive(ObfuscationContext* ctx, ASTNode* node, bool in_function) {
     if (!node) return;
     
     switch (node->type) {
         case NODE_LITERAL: {
-            if (node->data.literal.value && node->data.literal.value[0] == '"') {
+            if (node->data.literal.value && node->data.literal.value[0] == '"' &&
+                obfuscator_effective_level(ctx, node) >= OBF_INTERMEDIATE) {
                 // This is a string literal
-                char* encrypted = encrypt_string(node->data.literal.value);
-                if (encrypted) {
-                    free(node->data.literal.value);
-                    node->data.literal.value = encrypted;
-                }
+                encrypt_string_literal(ctx, node);
+            }
+            break;
+        }
+        
+        case NODE_FUNCTION:
+            budget_enter(ctx->budget, node);
+            obfuscate_strings_recursive(ctx, node->data.function.body, true);
+            budget_enter(ctx->budget, NULL);
+            break;
+        
+        case NODE_VARIABLE: {
+            // Static storage needs constant initializers, and arrays are
+            // initialized from the literal itself
+            const char* type = node->data.variable.type;
+            if (in_function && !node->data.variable.is_static &&
+                !(type && strchr(type, '[')) && !strchr(node->data.variable.name, '[')) {
+                obfuscate_strings_recursive(ctx, node->data.variable.initializer, in_function);
             }
             break;
         }
         
         case NODE_CALL:
-            obfuscate_strings_recursive(ctx, node->data.call.function);
-            obfuscate_strings_recursive(ctx, node->data.call.arguments);
+            obfuscate_strings_recursive(ctx, node->data.call.function, in_function);
+            obfuscate_strings_recursive(ctx, node->data.call.arguments, in_function);
             break;
-            
+        
         case NODE_BINARY_OP:
-            obfuscate_strings_recursive(ctx, node->data.binary.left);
-            obfuscate_strings_recursive(ctx, node->data.binary.right);
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            obfuscate_strings_recursive(ctx, node->data.binary.left, in_function);
+            obfuscate_strings_recursive(ctx, node->data.binary.right, in_function);
             break;
-            
+        
         case NODE_UNARY_OP:
-            obfuscate_strings_recursive(ctx, node->data.unary.operand);
+            obfuscate_strings_recursive(ctx, node->data.unary.operand, in_function);
             break;
-            
+        
         case NODE_IF:
-            obfuscate_strings_recursive(ctx, node->data.if_stmt.condition);
-            obfuscate_strings_recursive(ctx, node->data.if_stmt.then_stmt);
-            obfuscate_strings_recursive(ctx, node->data.if_stmt.else_stmt);
+            obfuscate_strings_recursive(ctx, node->data.if_stmt.condition, in_function);
+            obfuscate_strings_recursive(ctx, node->data.if_stmt.then_stmt, in_function);
+            obfuscate_strings_recursive(ctx, node->data.if_stmt.else_stmt, in_function);
             break;
-            
+        
         case NODE_WHILE:
-            obfuscate_strings_recursive(ctx, node->data.while_stmt.condition);
-            obfuscate_strings_recursive(ctx, node->data.while_stmt.body);
+            obfuscate_strings_recursive(ctx, node->data.while_stmt.condition, in_function);
+            obfuscate_strings_recursive(ctx, node->data.while_stmt.body, in_function);
             break;
-            
+        
         case NODE_FOR:
-            obfuscate_strings_recursive(ctx, node->data.for_stmt.init);
-            obfuscate_strings_recursive(ctx, node->data.for_stmt.condition);
-            obfuscate_strings_recursive(ctx, node->data.for_stmt.update);
-            obfuscate_strings_recursive(ctx, node->data.for_stmt.body);
+            obfuscate_strings_recursive(ctx, node->data.for_stmt.init, in_function);
+            obfuscate_strings_recursive(ctx, node->data.for_stmt.condition, in_function);
+            obfuscate_strings_recursive(ctx, node->data.for_stmt.update, in_function);
+            obfuscate_strings_recursive(ctx, node->data.for_stmt.body, in_function);
             break;
-            
+        
         case NODE_BLOCK:
-            obfuscate_strings_recursive(ctx, node->data.block.statements);
+        case NODE_STMT_EXPR:
+            obfuscate_strings_recursive(ctx, node->data.block.statements, in_function);
             break;
-            
+        
         default:
             break;
     }
     
-    obfuscate_strings_recursive(ctx, node->next);
+    obfuscate_strings_recursive(ctx, node->next, in_function);
 }
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Control Flow Obfuscation
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static ASTNode* create_state_machine(ASTNode* statements) {
-    if (!statements) return NULL;
-    
-    // Create state variable
-    ASTNode* state_var = ast_create_variable("__state", "int", ast_create_literal("0"));
-    
-    // Create main state machine loop
-    ASTNode* state_condition = ast_create_binary_op("!=", 
-        ast_create_identifier("__state"), 
-        ast_create_literal("-1"));
-    
-    // Create switch statement
-    ASTNode* switch_stmt = ast_create_switch(ast_create_identifier("__state"), NULL);
-    
-    // Convert each statement to a case in the state machine
-    int state_id = 0;
-    ASTNode* current = statements;
-    while (current) {
-        // Create case statement
-        ASTNode* case_label = ast_create_literal_number(state_id);
-        ASTNode* case_stmt = ast_create_case(case_label, current);
-        
-        // Add case to switch (simplified - would need proper AST linking)
-        current = current->next;
-        state_id++;
-    }
-    
-    // Create while loop containing the switch
-    ASTNode* while_body = ast_create_block(switch_stmt);
-    ASTNode* while_loop = ast_create_while(state_condition, while_body);
-    
-    // Create the complete function body
-    ASTNode* body = ast_create_block(ast_link(state_var, while_loop));
-    
-    return body;
-}
-
 bool obfuscate_control_flow(ObfuscationContext* ctx, ASTNode* ast) {
     if (!ctx || !ast) return false;
     
@@ -1078,17 +1414,13 @@ static void obfuscate_control_flow_recursive(ObfuscationContext* ctx, ASTNode* n
     
     switch (node->type) {
         case NODE_FUNCTION: {
-            // Transform function body into state machine
-            if (node->data.function.body && 
-                node->data.function.body->type == NODE_BLOCK) {
-                
-                ASTNode* statements = node->data.function.body->data.block.statements;
-                if (statements && statements->next) { // Only if multiple statements
-                    ASTNode* state_machine = create_state_machine(statements);
-                    if (state_machine) {
-                        node->data.function.body = state_machine;
-                    }
-                }
+            // Flatten the body behind a dispatcher; hot code is spared more often.
+            // flatten_function checks the dispatcher's real size against the budget
+            if (obfuscator_effective_level(ctx, node) >= OBF_EXTREME &&
+                obfuscator_should_apply(ctx, node, 100)) {
+                budget_enter(ctx->budget, node);
+                flatten_function(ctx, node, NULL);
+                budget_enter(ctx->budget, NULL);
             }
             break;
         }
@@ -1098,23 +1430,23 @@ static void obfuscate_control_flow_recursive(ObfuscationContext* ctx, ASTNode* n
             obfuscate_control_flow_recursive(ctx, node->data.if_stmt.then_stmt);
             obfuscate_control_flow_recursive(ctx, node->data.if_stmt.else_stmt);
             break;
-            
+        
         case NODE_WHILE:
             obfuscate_control_flow_recursive(ctx, node->data.while_stmt.condition);
             obfuscate_control_flow_recursive(ctx, node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
             obfuscate_control_flow_recursive(ctx, node->data.for_stmt.init);
             obfuscate_control_flow_recursive(ctx, node->data.for_stmt.condition);
             obfuscate_control_flow_recursive(ctx, node->data.for_stmt.update);
             obfuscate_control_flow_recursive(ctx, node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
             obfuscate_control_flow_recursive(ctx, node->data.block.statements);
             break;
-            
+        
         default:
             break;
     }
@@ -1126,8 +1458,28 @@ static void obfuscate_control_flow_recursive(ObfuscationContext* ctx, ASTNode* n
  * Dead Code Insertion
  * ═══════════════════════════════════════════════════════════════════════════ */
 
-static ASTNode* generate_dead_code(void) {
-    int type = rand() % 4;
+/* Opaque condition for a bogus branch, hinted as never taken */
+static ASTNode* bogus_condition(ObfuscationContext* ctx, const ASTNode* region,
+                                const ASTNode* function) {
+    ASTNode* condition = opaque_false(ctx, region, function);
+    if (!condition || !ctx->config->cold_placement) return condition;
+    
+    ASTNode* hinted = obfuscator_helper_call(ctx, RUNTIME_HELPER_UNLIKELY, condition);
+    return hinted ? hinted : condition;
+}
+
+/* Payload of a bogus branch; outlined so it takes no room in the caller */
+static ASTNode* bogus_payload(ObfuscationContext* ctx) {
+    if (!ctx->config->cold_placement) return ast_create_literal("0");
+    
+    ASTNode* call = obfuscator_helper_call(ctx, RUNTIME_HELPER_COLD_PATH,
+                                           ast_create_literal_number(random_below(ctx->random, 1000)));
+    return call ? call : ast_create_literal("0");
+}
+
+static ASTNode* generate_dead_code(ObfuscationContext* ctx, const ASTNode* region,
+                                   const ASTNode* function) {
+    int type = random_below(ctx->random, 4);
     
     switch (type) {
         case 0: {
@@ -1139,24 +1491,25 @@ static ASTNode* generate_dead_code(void) {
         
         case 1: {
             // Unconditional false condition
-            ASTNode* condition = ast_create_binary_op("==", 
-                ast_create_literal("1"), ast_create_literal("0"));
-            ASTNode* body = ast_create_block(ast_create_literal("0"));
+            ASTNode* condition = bogus_condition(ctx, region, function);
+            if (!condition) return NULL;
+            ASTNode* body = ast_create_block(bogus_payload(ctx));
             return ast_create_if(condition, body, NULL);
         }
         
         case 2: {
             // Meaningless loop
-            ASTNode* condition = ast_create_literal("0");
-            ASTNode* body = ast_create_block(ast_create_literal("0"));
+            ASTNode* condition = bogus_condition(ctx, region, function);
+            if (!condition) return NULL;
+            ASTNode* body = ast_create_block(bogus_payload(ctx));
             return ast_create_while(condition, body);
         }
         
         case 3: {
-            // Dead assignment
-            ASTNode* var = ast_create_identifier("__dead_counter");
-            ASTNode* value = ast_create_binary_op("+", var, ast_create_literal("0"));
-            return ast_create_assignment(var, value);
+            // Dead value read from an opaque predicate
+            ASTNode* value = opaque_false(ctx, region, function);
+            if (!value) return NULL;
+            return ast_create_variable("__dead_var", "int", value);
         }
         
         default:
@@ -1168,53 +1521,69 @@ bool insert_dead_code(ObfuscationContext* ctx, ASTNode* ast) {
     if (!ctx || !ast) return false;
     
     // Insert dead code into blocks
-    insert_dead_code_recursive(ctx, ast);
+    insert_dead_code_recursive(ctx, ast, NULL);
     
     ctx->pass_count++;
     return true;
 }
 
-static void insert_dead_code_recursive(ObfuscationContext* ctx, ASTNode* node) {
+/* `function` encloses `node`; opaque predicates read its parameters */
+static void insert_dead_code_recursive(ObfuscationContext* ctx, ASTNode* node,
+                                       const ASTNode* function) {
     if (!node) return;
     
     switch (node->type) {
         case NODE_BLOCK: {
             // Insert dead code with some probability
-            if (rand() % 100 < 30) { // 30% chance
-                ASTNode* dead = generate_dead_code();
+            ASTNode* original = node->data.block.statements;
+            if (obfuscator_effective_level(ctx, node) >= OBF_EXTREME &&
+                obfuscator_should_apply(ctx, node, ctx->config->dead_code_percent)) {
+                ASTNode* dead = generate_dead_code(ctx, node, function);
+                if (dead && !budget_allows(ctx->budget, (long)ast_count_nodes(dead))) {
+                    // Nothing is inserted when the dead code won't fit
+                    ast_node_destroy(dead);
+                    dead = NULL;
+                }
                 if (dead) {
+                    budget_charge(ctx->budget, (long)ast_count_nodes(dead));
                     // Insert dead code into the block
                     dead->next = node->data.block.statements;
                     node->data.block.statements = dead;
                 }
             }
             
-            insert_dead_code_recursive(ctx, node->data.block.statements);
+            // Bogus code never runs; nesting more inside it only adds size
+            insert_dead_code_recursive(ctx, original, function);
             break;
         }
         
         case NODE_FUNCTION:
-            insert_dead_code_recursive(ctx, node->data.function.body);
+            budget_enter(ctx->budget, node);
+            insert_dead_code_recursive(ctx, node->data.function.body, node);
+            budget_enter(ctx->budget, NULL);
             break;
-            
+        
         case NODE_IF:
-            insert_dead_code_recursive(ctx, node->data.if_stmt.then_stmt);
-            insert_dead_code_recursive(ctx, node->data.if_stmt.else_stmt);
+            insert_dead_code_recursive(ctx, node->data.if_stmt.then_stmt, function);
+            insert_dead_code_recursive(ctx, node->data.if_stmt.else_stmt, function);
             break;
-            
+        
         case NODE_WHILE:
-            insert_dead_code_recursive(ctx, node->data.while_stmt.body);
+            insert_dead_code_recursive(ctx, node->data.while_stmt.body, function);
             break;
-            
+        
         case NODE_FOR:
-            insert_dead_code_recursive(ctx, node->data.for_stmt.body);
+            // A branch in the body keeps a protected loop from vectorizing
+            if (!(node->flags & AST_FLAG_PROTECTED)) {
+                insert_dead_code_recursive(ctx, node->data.for_stmt.body, function);
+            }
             break;
-            
+        
         default:
             break;
     }
     
-    insert_dead_code_recursive(ctx, node->next);
+    insert_dead_code_recursive(ctx, node->next, function);
 }
 
 /* ═══════════════════════════════════════════════════════════════════════════
@@ -1241,7 +1610,7 @@ static char* generate_anti_debug_code(void) {
     return code;
 }
 
-static char* generate_checksum_verification(void) {
+static char* generate_checksum_verification(Random* random) {
     char* code = malloc(512);
     if (!code) return NULL;
     
@@ -1251,7 +1620,7 @@ static char* generate_checksum_verification(void) {
         "unsigned int __calc = 0;\n"
         "for(int i=0;i<sizeof(check_data);i++) __calc += ((unsigned char*)check_data)[i];\n"
         "if(__calc != __checksum) { exit(1); }\n",
-        rand());
+        (unsigned int)random_next(random));
     
     return code;
 }
@@ -1262,24 +1631,75 @@ bool apply_macro_obfuscation(ObfuscationContext* ctx, ASTNode* ast) {
     // Insert anti-debugging code at the beginning of main function
     insert_anti_debug_code_recursive(ctx, ast);
     
-    // Add macro definitions for obfuscation
-    char* macros = malloc(2048);
-    if (macros) {
-        sprintf(macros,
-            "// Obfuscation macros\n"
-            "#define HIDE_VAR(x) (__##x##__hidden)\n"
-            "#define OPAQUE_ZERO ((1^1)^1)\n"
-            "#define COMPLEX_ADD(a,b) (((a)^(b))+2*((a)&(b)))\n"
-            "#define DEBUG_CHECK if(ptrace(PTRACE_TRACEME,0,1,0)<0)exit(1)\n");
-        
-        // These would be added to the output file header
-        free(macros);
-    }
+    // Route int additions through the shared helper instead of macros
+    apply_helper_calls_recursive(ctx, ast);
     
     ctx->pass_count++;
     return true;
 }
 
+/* `int x = a + b;` becomes `int x = __obf_complex_add(a, b);`. Only int
+ * declarations qualify: the helper computes in int, so wider or
+ * floating-point results would change. */
+static void apply_helper_calls_recursive(ObfuscationContext* ctx, ASTNode* node) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case NODE_VARIABLE: {
+            ASTNode* init = node->data.variable.initializer;
+            if (init && init->type == NODE_BINARY_OP &&
+                strcmp(init->data.binary.operator, "+") == 0 &&
+                node->data.variable.type && strcmp(node->data.variable.type, "int") == 0 &&
+                !node->data.variable.is_static &&
+                ast_is_integer_operand(init->data.binary.left) &&
+                ast_is_integer_operand(init->data.binary.right) &&
+                !init->data.binary.right->next &&
+                obfuscator_effective_level(ctx, node) >= OBF_EXTREME &&
+                budget_allows(ctx->budget, 1)) {
+                ASTNode* arguments = ast_link(init->data.binary.left, init->data.binary.right);
+                ASTNode* call = obfuscator_helper_call(ctx, RUNTIME_HELPER_COMPLEX_ADD, arguments);
+                if (call) {
+                    init->data.binary.left = NULL;
+                    init->data.binary.right = NULL;
+                    ast_replace_in_place(init, call);
+                    budget_charge(ctx->budget, 1);
+                } else {
+                    arguments->next = NULL;
+                }
+            }
+            break;
+        }
+        
+        case NODE_FUNCTION:
+            budget_enter(ctx->budget, node);
+            apply_helper_calls_recursive(ctx, node->data.function.body);
+            budget_enter(ctx->budget, NULL);
+            break;
+        
+        case NODE_BLOCK:
+            apply_helper_calls_recursive(ctx, node->data.block.statements);
+            break;
+        
+        case NODE_IF:
+            apply_helper_calls_recursive(ctx, node->data.if_stmt.then_stmt);
+            apply_helper_calls_recursive(ctx, node->data.if_stmt.else_stmt);
+            break;
+        
+        case NODE_WHILE:
+            apply_helper_calls_recursive(ctx, node->data.while_stmt.body);
+            break;
+        
+        case NODE_FOR:
+            apply_helper_calls_recursive(ctx, node->data.for_stmt.body);
+            break;
+        
+        default:
+            break;
+    }
+    
+    apply_helper_calls_recursive(ctx, node->next);
+}
+
 static void insert_anti_debug_code_recursive(ObfuscationContext* ctx, ASTNode* node) {
     if (!node) return;
     
@@ -3,6 +3,10 @@
 
 #include "../common/types.h"
 #include "../symbols/symbols.h"
+#include "runtime.h"
+#include "budget.h"
+#include "undo.h"
+#include "../analysis/loops.h"
 
 /* ═══════════════════════════════════════════════════════════════════════════
  * Obfuscation Engine Interface
@@ -15,6 +19,15 @@ typedef struct {
     NameGenerator* name_gen;
     Error* errors;
     int pass_count;
+    int temp_counter;
+    StringTable* strings;      /* Encrypted literals for the emitted prologue */
+    ConstantPool* constants;   /* Masked integers for the emitted prologue */
+    VMProgram* bytecode;       /* Code of virtualized functions */
+    LoopReport* loops;         /* Loops kept vectorizable; NULL when not run */
+    GrowthBudget* budget;      /* Node growth left; NULL = unlimited */
+    UndoLog* undo;             /* Rewrites since the open checkpoint */
+    Random* random;            /* Source of every random choice */
+    RuntimeHelperSet helpers;  /* Shared helpers referenced by rewritten code */
 } ObfuscationContext;
 
 /* Function Prototypes */
@@ -26,6 +39,12 @@ void obfuscator_destroy(ObfuscationContext* ctx);
 ASTNode* obfuscate_ast(ObfuscationContext* ctx, ASTNode* ast);
 bool obfuscator_has_errors(const ObfuscationContext* ctx);
 Error* obfuscator_get_errors(const ObfuscationContext* ctx);
+char* obfuscator_fresh_temp_name(ObfuscationContext* ctx);
+char* obfuscator_runtime_prologue(const ObfuscationContext* ctx);
+ASTNode* obfuscator_helper_call(ObfuscationContext* ctx, RuntimeHelper helper, ASTNode* arguments);
+void obfuscator_add_error(ObfuscationContext* ctx, ErrorType type, const char* message);
+ObfuscationLevel obfuscator_effective_level(const ObfuscationContext* ctx, const ASTNode* node);
+bool obfuscator_should_apply(const ObfuscationContext* ctx, const ASTNode* node, int percent);
 
 /* Obfuscation Passes */
 bool obfuscate_identifiers(ObfuscationContext* ctx, ASTNode* ast);
@@ -60,5 +79,12 @@ ObfuscationConfig* config_create_default(void);
 void config_destroy(ObfuscationConfig* config);
 void config_set_level(ObfuscationConfig* config, ObfuscationLevel level);
 void config_set_aesthetic(ObfuscationConfig* config, AestheticStyle style);
+ObfuscationConfig* config_clone(const ObfuscationConfig* config);
+bool config_set_function_level(ObfuscationConfig* config, const char* function, int level_cap);
+int config_function_level(const ObfuscationConfig* config, const char* function);
+
+/* `key = value` files; loading overrides only the keys present */
+bool config_load(ObfuscationConfig* config, const char* filename);
+bool config_save(const ObfuscationConfig* config, const char* filename);
 
 #endif /* OBFUSCATOR_OBFUSCATOR_H */
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "opaque.h"
+#include "ast_utils.h"
+#include "../analysis/hotness.h"
+#include "../analysis/typing.h"
+#include "../parser/parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Predicate Catalog
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Costs assume the helper is inlined; the shared-state predicate also
+ * bounces a cache line between threads that hit it */
+static const OpaquePredicate predicate_catalog[] = {
+    { RUNTIME_HELPER_OPAQUE_ZERO,   OPAQUE_FAMILY_NUMBER_THEORY, 4,  2 },
+    { RUNTIME_HELPER_OPAQUE_MOD4,   OPAQUE_FAMILY_NUMBER_THEORY, 4,  2 },
+    { RUNTIME_HELPER_OPAQUE_CUBE,   OPAQUE_FAMILY_NUMBER_THEORY, 9,  3 },
+    { RUNTIME_HELPER_OPAQUE_ALIAS,  OPAQUE_FAMILY_ALIASING,      6,  6 },
+    { RUNTIME_HELPER_OPAQUE_GLOBAL, OPAQUE_FAMILY_GLOBAL_STATE,  12, 8 },
+};
+
+#define PREDICATE_COUNT ((int)(sizeof(predicate_catalog) / sizeof(predicate_catalog[0])))
+
+int opaque_predicate_count(void) {
+    return PREDICATE_COUNT;
+}
+
+const OpaquePredicate* opaque_predicate_get(int index) {
+    if (index < 0 || index >= PREDICATE_COUNT) return NULL;
+    return &predicate_catalog[index];
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Selection
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+int opaque_budget(const ObfuscationContext* ctx, const ASTNode* node) {
+    int budget = ctx->config->opaque_cost_budget;
+    
+    // Hot code affords proportionally less, like the transformation odds
+    if (ctx->config->static_hotness && node) {
+        budget = hotness_scale_percent(budget, node->hotness);
+    }
+    return budget;
+}
+
+const OpaquePredicate* opaque_select(Random* random, int budget) {
+    int total = 0;
+    for (int i = 0; i < PREDICATE_COUNT; i++) {
+        if (predicate_catalog[i].cost <= budget) total += predicate_catalog[i].resistance;
+    }
+    if (total == 0) return NULL;
+    
+    // Weighted by resistance, but every affordable predicate stays in play
+    // so no single pattern dominates the output
+    int pick = random_below(random, total);
+    for (int i = 0; i < PREDICATE_COUNT; i++) {
+        const OpaquePredicate* p = &predicate_catalog[i];
+        if (p->cost > budget) continue;
+        
+        if (pick < p->resistance) return p;
+        pick -= p->resistance;
+    }
+    return NULL;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Predicate Arguments
+ *
+ * A constant argument lets the compiler evaluate the predicate and drop the
+ * branch, so the argument is a live value instead.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Whether a declaration in the statement list `node` reuses `name`, which
+ * could hide the parameter at the point of use */
+static bool redeclares(const ASTNode* node, const char* name) {
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_VARIABLE:
+                if (strcmp(node->data.variable.name, name) == 0) return true;
+                break;
+            case NODE_BLOCK:
+                if (redeclares(node->data.block.statements, name)) return true;
+                break;
+            case NODE_IF:
+                if (redeclares(node->data.if_stmt.then_stmt, name) ||
+                    redeclares(node->data.if_stmt.else_stmt, name)) return true;
+                break;
+            case NODE_WHILE:
+                if (redeclares(node->data.while_stmt.body, name)) return true;
+                break;
+            case NODE_FOR:
+                if (redeclares(node->data.for_stmt.init, name) ||
+                    redeclares(node->data.for_stmt.body, name)) return true;
+                break;
+            case NODE_SWITCH:
+                if (redeclares(node->data.switch_stmt.cases, name)) return true;
+                break;
+            case NODE_CASE:
+                if (redeclares(node->data.case_stmt.statements, name)) return true;
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+static ASTNode* opaque_argument(ObfuscationContext* ctx, const ASTNode* function) {
+    const ASTNode* usable[8];
+    int count = 0;
+    
+    if (function && function->type == NODE_FUNCTION) {
+        for (const ASTNode* param = function->data.function.parameters;
+             param && count < 8; param = param->next) {
+            if (param->type == NODE_PARAMETER && param->data.variable.name &&
+                typing_is_int_type(param->data.variable.type) &&
+                !redeclares(function->data.function.body, param->data.variable.name)) {
+                usable[count++] = param;
+            }
+        }
+    }
+    
+    if (count == 0) return obfuscator_helper_call(ctx, RUNTIME_HELPER_OPAQUE_INPUT, NULL);
+    
+    const ASTNode* param = usable[random_below(ctx->random, count)];
+    ASTNode* argument = ast_create_identifier(param->data.variable.name);
+    if (argument) argument->flags |= AST_FLAG_INT;
+    return argument;
+}
+
+ASTNode* opaque_false(ObfuscationContext* ctx, const ASTNode* node, const ASTNode* function) {
+    if (!ctx) return NULL;
+    
+    const OpaquePredicate* predicate = opaque_select(ctx->random, opaque_budget(ctx, node));
+    if (!predicate) return NULL;
+    
+    ASTNode* argument = opaque_argument(ctx, function);
+    if (!argument) return NULL;
+    
+    ASTNode* call = obfuscator_helper_call(ctx, predicate->helper, argument);
+    if (call) {
+        call->flags |= AST_FLAG_OPAQUE;
+    } else {
+        ast_node_destroy(argument);
+    }
+    return call;
+}
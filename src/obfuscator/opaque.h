@@ -0,0 +1,48 @@
+#ifndef OBFUSCATOR_OPAQUE_H
+#define OBFUSCATOR_OPAQUE_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Opaque Predicates
+ *
+ * Each predicate is a runtime helper that returns 0 for every argument but
+ * is hard to prove so. They trade run-time cost for resistance:
+ * number-theoretic identities cost a few multiplies but fold as soon as the
+ * argument is a constant; aliasing and shared-state predicates survive
+ * optimization and static analysis at the price of memory traffic.
+ *
+ * Code gets a cycle budget (opaque_cost_budget) scaled down by its estimated
+ * hotness, and only predicates within that budget are chosen for it.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef enum {
+    OPAQUE_FAMILY_NUMBER_THEORY,
+    OPAQUE_FAMILY_ALIASING,
+    OPAQUE_FAMILY_GLOBAL_STATE
+} OpaqueFamily;
+
+typedef struct {
+    RuntimeHelper helper;      /* Returns 0 for every argument */
+    OpaqueFamily family;
+    int cost;                  /* Estimated cycles per evaluation */
+    int resistance;            /* 1 (folded at -O1) .. 10 */
+} OpaquePredicate;
+
+int opaque_predicate_count(void);
+const OpaquePredicate* opaque_predicate_get(int index);
+
+/* Cycles an opaque predicate may spend in code at `node` */
+int opaque_budget(const ObfuscationContext* ctx, const ASTNode* node);
+
+/* Random predicate within the budget, stronger ones more likely; NULL when
+ * even the cheapest costs too much */
+const OpaquePredicate* opaque_select(Random* random, int budget);
+
+/* Always-false condition sized for `node`, flagged AST_FLAG_OPAQUE; NULL
+ * when the code is too hot for any predicate. The argument is a value known
+ * only at run time: an int parameter of `function`, the function enclosing
+ * `node`, or a volatile load when it has none that is safe to use. */
+ASTNode* opaque_false(ObfuscationContext* ctx, const ASTNode* node, const ASTNode* function);
+
+#endif /* OBFUSCATOR_OPAQUE_H */
@@ -0,0 +1,835 @@
+#include "runtime.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * String Table Management
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+unsigned char string_keystream(uint32_t key, uint32_t nonce, size_t index) {
+    uint32_t x = (key ^ nonce) + (uint32_t)index * 0x9e3779b9u;
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return (unsigned char)x;
+}
+
+StringTable* string_table_create(Random* random) {
+    StringTable* table = malloc(sizeof(StringTable));
+    if (!table) return NULL;
+    
+    table->data = NULL;
+    table->size = 0;
+    table->capacity = 0;
+    table->entries = NULL;
+    table->count = 0;
+    table->entry_capacity = 0;
+    table->buckets = NULL;
+    table->bucket_count = 0;
+    
+    table->random = random;
+    table->key = random_next(random);
+    return table;
+}
+
+void string_table_destroy(StringTable* table) {
+    if (!table) return;
+    
+    free(table->data);
+    free(table->entries);
+    free(table->buckets);
+    free(table);
+}
+
+static uint32_t hash_bytes(const unsigned char* bytes, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool entry_matches(const StringTable* table, const StringTableEntry* entry,
+                          const unsigned char* bytes, size_t length, uint32_t hash) {
+    if (entry->hash != hash || entry->length != length) return false;
+    
+    const unsigned char* stored = table->data + entry->offset;
+    for (size_t i = 0; i < length; i++) {
+        if ((stored[i] ^ string_keystream(table->key, entry->nonce, i)) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int* find_bucket(const StringTable* table, const unsigned char* bytes, size_t length,
+                        uint32_t hash) {
+    int mask = table->bucket_count - 1;
+    for (int i = hash & mask; ; i = (i + 1) & mask) {
+        int* bucket = &table->buckets[i];
+        if (*bucket < 0 || entry_matches(table, &table->entries[*bucket], bytes, length, hash)) {
+            return bucket;
+        }
+    }
+}
+
+/* Keeps the load factor at or below one half */
+static bool reserve_buckets(StringTable* table) {
+    if ((table->count + 1) * 2 <= table->bucket_count) return true;
+    
+    int bucket_count = table->bucket_count ? table->bucket_count * 2 : 32;
+    int* buckets = malloc(bucket_count * sizeof(int));
+    if (!buckets) return false;
+    
+    for (int i = 0; i < bucket_count; i++) {
+        buckets[i] = -1;
+    }
+    
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_count = bucket_count;
+    
+    for (int i = 0; i < table->count; i++) {
+        int mask = bucket_count - 1;
+        int slot = table->entries[i].hash & mask;
+        while (buckets[slot] >= 0) slot = (slot + 1) & mask;
+        buckets[slot] = i;
+    }
+    return true;
+}
+
+static bool reserve_data(StringTable* table, size_t additional) {
+    if (table->size + additional <= table->capacity) return true;
+    
+    size_t capacity = table->capacity ? table->capacity : 256;
+    while (capacity < table->size + additional) {
+        capacity *= 2;
+    }
+    
+    unsigned char* data = realloc(table->data, capacity);
+    if (!data) return false;
+    
+    table->data = data;
+    table->capacity = capacity;
+    return true;
+}
+
+static bool reserve_entry(StringTable* table) {
+    if (table->count < table->entry_capacity) return true;
+    
+    int capacity = table->entry_capacity ? table->entry_capacity * 2 : 16;
+    StringTableEntry* entries = realloc(table->entries, capacity * sizeof(StringTableEntry));
+    if (!entries) return false;
+    
+    table->entries = entries;
+    table->entry_capacity = capacity;
+    return true;
+}
+
+int string_table_find(const StringTable* table, const unsigned char* bytes, size_t length) {
+    if (!table || table->bucket_count == 0 || (!bytes && length > 0)) return -1;
+    return *find_bucket(table, bytes, length, hash_bytes(bytes, length));
+}
+
+int string_table_add(StringTable* table, const unsigned char* bytes, size_t length) {
+    if (!table || (!bytes && length > 0)) return -1;
+    
+    // Repeated literals share one slot
+    int existing = string_table_find(table, bytes, length);
+    if (existing >= 0) return existing;
+    
+    if (!reserve_buckets(table) || !reserve_data(table, length + 1) ||
+        !reserve_entry(table)) {
+        return -1;
+    }
+    
+    uint32_t hash = hash_bytes(bytes, length);
+    StringTableEntry* entry = &table->entries[table->count];
+    entry->offset = table->size;
+    entry->length = length;
+    entry->nonce = random_next(table->random);
+    entry->hash = hash;
+    
+    // The terminating NUL is encrypted with the rest of the slice
+    for (size_t i = 0; i <= length; i++) {
+        unsigned char plain = i < length ? bytes[i] : 0;
+        table->data[table->size++] = plain ^ string_keystream(table->key, entry->nonce, i);
+    }
+    
+    *find_bucket(table, bytes, length, hash) = table->count;
+    return table->count++;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Literal Decoding
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool string_literal_decode(const char* literal, unsigned char** bytes, size_t* length) {
+    if (!literal || !bytes || !length) return false;
+    
+    size_t len = strlen(literal);
+    if (len < 2 || literal[0] != '"' || literal[len - 1] != '"') return false;
+    
+    unsigned char* out = malloc(len);
+    if (!out) return false;
+    
+    size_t count = 0;
+    const char* end = literal + len - 1;
+    
+    for (const char* p = literal + 1; p < end; p++) {
+        if (*p != '\\') {
+            out[count++] = (unsigned char)*p;
+            continue;
+        }
+        
+        if (++p >= end) {
+            free(out);
+            return false;
+        }
+        
+        switch (*p) {
+            case 'n':  out[count++] = '\n'; break;
+            case 't':  out[count++] = '\t'; break;
+            case 'r':  out[count++] = '\r'; break;
+            case 'a':  out[count++] = '\a'; break;
+            case 'b':  out[count++] = '\b'; break;
+            case 'f':  out[count++] = '\f'; break;
+            case 'v':  out[count++] = '\v'; break;
+            case '\\': out[count++] = '\\'; break;
+            case '\'': out[count++] = '\''; break;
+            case '"':  out[count++] = '"';  break;
+            case '?':  out[count++] = '?';  break;
+            
+            case 'x': {
+                unsigned int value = 0;
+                int digits = 0;
+                while (p + 1 < end && hex_value(p[1]) >= 0) {
+                    value = value * 16 + hex_value(*++p);
+                    digits++;
+                }
+                if (digits == 0) {
+                    free(out);
+                    return false;
+                }
+                out[count++] = (unsigned char)value;
+                break;
+            }
+            
+            default:
+                if (*p >= '0' && *p <= '7') {
+                    unsigned int value = *p - '0';
+                    for (int i = 0; i < 2 && p + 1 < end && p[1] >= '0' && p[1] <= '7'; i++) {
+                        value = value * 8 + (*++p - '0');
+                    }
+                    out[count++] = (unsigned char)value;
+                } else {
+                    // Universal character names and the like stay unsupported
+                    free(out);
+                    return false;
+                }
+                break;
+        }
+    }
+    
+    *bytes = out;
+    *length = count;
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Source Text Buffer
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+static void text_append(TextBuffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (needed < 0) return;
+    
+    if (buffer->length + needed + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+        while (capacity < buffer->length + needed + 1) {
+            capacity *= 2;
+        }
+        char* text = realloc(buffer->text, capacity);
+        if (!text) return;
+        buffer->text = text;
+        buffer->capacity = capacity;
+    }
+    
+    va_start(args, format);
+    vsnprintf(buffer->text + buffer->length, needed + 1, format, args);
+    va_end(args);
+    buffer->length += needed;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Helper Catalog
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    const char* name;
+    const char* source;
+    bool atomics;              /* Needs <stdatomic.h> */
+    RuntimeHelperSet requires; /* Emitted ahead of it */
+} RuntimeHelperInfo;
+
+#define PLACEMENT (1u << RUNTIME_HELPER_UNLIKELY)
+
+static const RuntimeHelperInfo helper_catalog[RUNTIME_HELPER_COUNT] = {
+    /* The section is ELF-specific; other GNU targets still get the hints */
+    [RUNTIME_HELPER_UNLIKELY] = { "__OBF_UNLIKELY",
+        "#if defined(__GNUC__)\n"
+        "#define __OBF_UNLIKELY(x) __builtin_expect(!!(x), 0)\n"
+        "#define __OBF_COLD __attribute__((cold, noinline))\n"
+        "#else\n"
+        "#define __OBF_UNLIKELY(x) (x)\n"
+        "#define __OBF_COLD\n"
+        "#endif\n"
+        "#if defined(__GNUC__) && defined(__ELF__)\n"
+        "#define __OBF_RARE __attribute__((noinline, section(\".text.unlikely\")))\n"
+        "#else\n"
+        "#define __OBF_RARE\n"
+        "#endif\n" },
+    
+    /* Mirrors string_keystream(); the loop body only depends on `j`, so it
+     * compiles to SIMD lanes under -O2 -ftree-vectorize or -O3. It runs
+     * once per string, so it lives out of line in the unlikely section
+     * (not __OBF_COLD, which would optimize it for size). */
+    [RUNTIME_HELPER_STR_DECRYPT] = { "__obf_str_decrypt",
+        "static __OBF_RARE void __obf_str_decrypt(char* restrict out,\n"
+        "                                         const unsigned char* restrict in,\n"
+        "                                         unsigned int n, uint32_t seed) {\n"
+        "    for (unsigned int j = 0; j < n; j++) {\n"
+        "        uint32_t x = seed + j * 0x9e3779b9u;\n"
+        "        x ^= x >> 16;\n"
+        "        x *= 0x85ebca6bu;\n"
+        "        x ^= x >> 13;\n"
+        "        x *= 0xc2b2ae35u;\n"
+        "        x ^= x >> 16;\n"
+        "        out[j] = (char)(in[j] ^ (unsigned char)x);\n"
+        "    }\n"
+        "}\n", false, PLACEMENT },
+    
+    /* x * (x + 1) is even for every x, modulo 2^n included */
+    [RUNTIME_HELPER_OPAQUE_ZERO] = { "__obf_opaque_zero",
+        "static inline int __obf_opaque_zero(unsigned int x) {\n"
+        "    return (int)((x * (x + 1u)) & 1u);\n"
+        "}\n" },
+    
+    /* a + b == (a ^ b) + 2 * (a & b), evaluated unsigned to stay defined */
+    [RUNTIME_HELPER_COMPLEX_ADD] = { "__obf_complex_add",
+        "static inline int __obf_complex_add(int a, int b) {\n"
+        "    unsigned int x = (unsigned int)a, y = (unsigned int)b;\n"
+        "    return (int)((x ^ y) + 2u * (x & y));\n"
+        "}\n" },
+    
+    /* A square is 0 or 1 mod 4, and wrapping mod 2^32 keeps the low bits */
+    [RUNTIME_HELPER_OPAQUE_MOD4] = { "__obf_opaque_square_mod4",
+        "static inline int __obf_opaque_square_mod4(unsigned int x) {\n"
+        "    return (int)(((x * x) & 3u) >> 1);\n"
+        "}\n" },
+    
+    /* x^3 - x = (x - 1) x (x + 1) always has a factor of 3; 16-bit inputs
+     * keep the cube exact in 64 bits */
+    [RUNTIME_HELPER_OPAQUE_CUBE] = { "__obf_opaque_cube_mod3",
+        "static inline int __obf_opaque_cube_mod3(unsigned int x) {\n"
+        "    uint64_t v = x & 0xffffu;\n"
+        "    return (int)((v * v * v - v) % 3u != 0u);\n"
+        "}\n" },
+    
+    /* The indices are never written, so both pointers name the same cell;
+     * only the volatile loads at run time reveal that */
+    [RUNTIME_HELPER_OPAQUE_ALIAS] = { "__obf_opaque_alias",
+        "static volatile unsigned int __obf_alias_index[2];\n"
+        "static inline int __obf_opaque_alias(unsigned int x) {\n"
+        "    unsigned int cell[2] = { 0u, 0u };\n"
+        "    unsigned int* p = &cell[__obf_alias_index[0] & 1u];\n"
+        "    unsigned int* q = &cell[__obf_alias_index[1] & 1u];\n"
+        "    *p = x | 1u;\n"
+        "    return *q == 0u;\n"
+        "}\n" },
+    
+    /* Every update adds an even step, so the shared state stays even even
+     * when threads race on it */
+    [RUNTIME_HELPER_OPAQUE_GLOBAL] = { "__obf_opaque_global",
+        "static atomic_uint __obf_opaque_state = 0x2468ace0u;\n"
+        "static inline int __obf_opaque_global(unsigned int x) {\n"
+        "    unsigned int s = atomic_load_explicit(&__obf_opaque_state, memory_order_relaxed);\n"
+        "    atomic_store_explicit(&__obf_opaque_state, s + (x << 1), memory_order_relaxed);\n"
+        "    return (int)(s & 1u);\n"
+        "}\n", true },
+    
+    /* Never runs; the store keeps it from being optimized away */
+    [RUNTIME_HELPER_COLD_PATH] = { "__obf_cold_path",
+        "static volatile unsigned int __obf_cold_sink;\n"
+        "static __OBF_COLD void __obf_cold_path(unsigned int x) {\n"
+        "    __obf_cold_sink = (__obf_cold_sink ^ x) * 0x9e3779b9u;\n"
+        "}\n", false, PLACEMENT },
+    
+    /* A volatile load, so predicates fed from it never fold to a constant */
+    [RUNTIME_HELPER_OPAQUE_INPUT] = { "__obf_opaque_input",
+        "static volatile unsigned int __obf_opaque_seed;\n"
+        "static inline unsigned int __obf_opaque_input(void) {\n"
+        "    return __obf_opaque_seed;\n"
+        "}\n" },
+};
+
+const char* runtime_helper_name(RuntimeHelper helper) {
+    if (helper < 0 || helper >= RUNTIME_HELPER_COUNT) return NULL;
+    return helper_catalog[helper].name;
+}
+
+char* runtime_helpers_emit(RuntimeHelperSet helpers) {
+    if (!helpers) return NULL;
+    
+    // Dependencies only ever point at earlier entries
+    for (int i = RUNTIME_HELPER_COUNT - 1; i >= 0; i--) {
+        if (helpers & (1u << i)) helpers |= helper_catalog[i].requires;
+    }
+    
+    TextBuffer buffer = {0};
+    text_append(&buffer, "#include <stdint.h>\n");
+    for (int i = 0; i < RUNTIME_HELPER_COUNT; i++) {
+        if ((helpers & (1u << i)) && helper_catalog[i].atomics) {
+            text_append(&buffer, "#include <stdatomic.h>\n");
+            break;
+        }
+    }
+    text_append(&buffer, "\n");
+    
+    for (int i = 0; i < RUNTIME_HELPER_COUNT; i++) {
+        if (helpers & (1u << i)) {
+            text_append(&buffer, "%s\n", helper_catalog[i].source);
+        }
+    }
+    return buffer.text;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * String Table Emission
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Per-slice decryption on first use of each slot */
+static const char* slice_runtime =
+    "static char __obf_str_plain[sizeof(__obf_str_data)];\n"
+    "static atomic_int __obf_str_state[%d];\n"
+    "\n"
+    "/* 0 = encrypted, 1 = being decrypted, 2 = plaintext ready */\n"
+    "static char* __obf_str_get(int i) {\n"
+    "    unsigned int offset = __obf_str_index[i].offset;\n"
+    "    if (atomic_load_explicit(&__obf_str_state[i], memory_order_acquire) != 2) {\n"
+    "        int expected = 0;\n"
+    "        if (atomic_compare_exchange_strong(&__obf_str_state[i], &expected, 1)) {\n"
+    "            __obf_str_decrypt(__obf_str_plain + offset, __obf_str_data + offset,\n"
+    "                              __obf_str_index[i].length + 1,\n"
+    "                              __obf_str_key ^ __obf_str_index[i].nonce);\n"
+    "            atomic_store_explicit(&__obf_str_state[i], 2, memory_order_release);\n"
+    "        } else {\n"
+    "            while (atomic_load_explicit(&__obf_str_state[i], memory_order_acquire) != 2) {\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    return &__obf_str_plain[offset];\n"
+    "}\n"
+    "\n"
+    "#define __obf_str(i) __obf_str_get(i)\n"
+    "\n";
+
+/* Whole-blob decryption on the first lookup */
+static const char* blob_runtime =
+    "static char __obf_str_plain[sizeof(__obf_str_data)];\n"
+    "static atomic_int __obf_str_state;\n"
+    "\n"
+    "/* 0 = encrypted, 1 = being decrypted, 2 = plaintext ready */\n"
+    "static char* __obf_str_get(int i) {\n"
+    "    if (atomic_load_explicit(&__obf_str_state, memory_order_acquire) != 2) {\n"
+    "        int expected = 0;\n"
+    "        if (atomic_compare_exchange_strong(&__obf_str_state, &expected, 1)) {\n"
+    "            for (int k = 0; k < %d; k++) {\n"
+    "                unsigned int offset = __obf_str_index[k].offset;\n"
+    "                __obf_str_decrypt(__obf_str_plain + offset, __obf_str_data + offset,\n"
+    "                                  __obf_str_index[k].length + 1,\n"
+    "                                  __obf_str_key ^ __obf_str_index[k].nonce);\n"
+    "            }\n"
+    "            atomic_store_explicit(&__obf_str_state, 2, memory_order_release);\n"
+    "        } else {\n"
+    "            while (atomic_load_explicit(&__obf_str_state, memory_order_acquire) != 2) {\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    return &__obf_str_plain[__obf_str_index[i].offset];\n"
+    "}\n"
+    "\n"
+    "#define __obf_str(i) __obf_str_get(i)\n"
+    "\n";
+
+char* string_table_emit(const StringTable* table, bool decrypt_all) {
+    if (!table || table->count == 0) return NULL;
+    
+    TextBuffer buffer = {0};
+    
+    text_append(&buffer, "#include <stdatomic.h>\n\n");
+    text_append(&buffer, "static const uint32_t __obf_str_key = 0x%08xu;\n\n",
+                (unsigned int)table->key);
+    
+    text_append(&buffer, "static const unsigned char __obf_str_data[%zu] = {", table->size);
+    for (size_t i = 0; i < table->size; i++) {
+        text_append(&buffer, "%s0x%02x%s", i % 16 == 0 ? "\n    " : "",
+                    table->data[i], i + 1 < table->size ? "," : "");
+    }
+    text_append(&buffer, "\n};\n\n");
+    
+    text_append(&buffer, "static const struct { unsigned int offset, length; uint32_t nonce; } "
+                         "__obf_str_index[%d] = {\n", table->count);
+    for (int i = 0; i < table->count; i++) {
+        const StringTableEntry* entry = &table->entries[i];
+        text_append(&buffer, "    { %zu, %zu, 0x%08xu }%s\n", entry->offset, entry->length,
+                    (unsigned int)entry->nonce, i + 1 < table->count ? "," : "");
+    }
+    text_append(&buffer, "};\n\n");
+    
+    if (decrypt_all) {
+        text_append(&buffer, blob_runtime, table->count);
+    } else {
+        text_append(&buffer, slice_runtime, table->count);
+    }
+    
+    return buffer.text;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Constant Pool
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+ConstantPool* constant_pool_create(void) {
+    ConstantPool* pool = malloc(sizeof(ConstantPool));
+    if (!pool) return NULL;
+    
+    pool->values = NULL;
+    pool->count = 0;
+    pool->capacity = 0;
+    return pool;
+}
+
+void constant_pool_destroy(ConstantPool* pool) {
+    if (!pool) return;
+    
+    free(pool->values);
+    free(pool);
+}
+
+int constant_pool_add(ConstantPool* pool, int value) {
+    if (!pool || pool->count >= CONSTANT_POOL_MAX) return -1;
+    
+    if (pool->count == pool->capacity) {
+        int capacity = pool->capacity ? pool->capacity * 2 : 16;
+        int* values = realloc(pool->values, capacity * sizeof(int));
+        if (!values) return -1;
+        
+        pool->values = values;
+        pool->capacity = capacity;
+    }
+    
+    pool->values[pool->count] = value;
+    return pool->count++;
+}
+
+char* constant_pool_emit(const ConstantPool* pool) {
+    if (!pool || pool->count == 0) return NULL;
+    
+    TextBuffer buffer = {0};
+    text_append(&buffer, "static _Alignas(64) const int __obf_const_pool[%d] = {", pool->count);
+    for (int i = 0; i < pool->count; i++) {
+        text_append(&buffer, "%s%d%s", i % 8 == 0 ? "\n    " : " ", pool->values[i],
+                    i + 1 < pool->count ? "," : "");
+    }
+    text_append(&buffer, "\n};\n\n");
+    text_append(&buffer, "static inline int __obf_const(int index, int mask) {\n"
+                         "    return __obf_const_pool[index] ^ mask;\n"
+                         "}\n\n");
+    return buffer.text;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Bytecode Programs
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef enum {
+    VM_FLOW_NEXT,              /* Runs `action`, then falls through */
+    VM_FLOW_BRANCH,            /* Jumps when `action` holds; NULL = always */
+    VM_FLOW_EXIT               /* `action` returns to the host */
+} VMFlow;
+
+typedef struct {
+    const char* label;
+    int operands;
+    VMFlow flow;
+    const char* action;
+} VMOpcodeInfo;
+
+/* Operands as the emitted handlers read them */
+#define VM_D "r[ip[1].value]"
+#define VM_A "r[ip[2].value]"
+#define VM_B "r[ip[3].value]"
+#define VM_IMM "ip[3].value"
+#define VM_WRAP(op, b) VM_D " = (int)((unsigned int)" VM_A " " op " (unsigned int)" b ");"
+#define VM_BINARY(op) VM_D " = " VM_A " " op " " VM_B ";"
+#define VM_COMPARE(op) "r[ip[1].value] " op " r[ip[2].value]"
+
+static const VMOpcodeInfo opcode_catalog[VM_OP_COUNT] = {
+    [VM_OP_HALT]  = { "halt",  0, VM_FLOW_EXIT,   "return -1;" },
+    [VM_OP_CALL]  = { "call",  1, VM_FLOW_EXIT,   "f->ip = ip + 2;\n    return ip[1].value;" },
+    [VM_OP_JMP]   = { "jmp",   1, VM_FLOW_BRANCH, NULL },
+    [VM_OP_JZ]    = { "jz",    2, VM_FLOW_BRANCH, "!r[ip[1].value]" },
+    [VM_OP_JNZ]   = { "jnz",   2, VM_FLOW_BRANCH, "r[ip[1].value]" },
+    [VM_OP_JEQ]   = { "jeq",   3, VM_FLOW_BRANCH, VM_COMPARE("==") },
+    [VM_OP_JNE]   = { "jne",   3, VM_FLOW_BRANCH, VM_COMPARE("!=") },
+    [VM_OP_JLT]   = { "jlt",   3, VM_FLOW_BRANCH, VM_COMPARE("<") },
+    [VM_OP_JLE]   = { "jle",   3, VM_FLOW_BRANCH, VM_COMPARE("<=") },
+    [VM_OP_JGT]   = { "jgt",   3, VM_FLOW_BRANCH, VM_COMPARE(">") },
+    [VM_OP_JGE]   = { "jge",   3, VM_FLOW_BRANCH, VM_COMPARE(">=") },
+    [VM_OP_MOV]   = { "mov",   2, VM_FLOW_NEXT,   VM_D " = " VM_A ";" },
+    [VM_OP_LOADI] = { "loadi", 2, VM_FLOW_NEXT,   VM_D " = ip[2].value;" },
+    [VM_OP_ADD]   = { "add",   3, VM_FLOW_NEXT,   VM_WRAP("+", VM_B) },
+    [VM_OP_SUB]   = { "sub",   3, VM_FLOW_NEXT,   VM_WRAP("-", VM_B) },
+    [VM_OP_MUL]   = { "mul",   3, VM_FLOW_NEXT,   VM_WRAP("*", VM_B) },
+    [VM_OP_DIV]   = { "div",   3, VM_FLOW_NEXT,   VM_BINARY("/") },
+    [VM_OP_MOD]   = { "mod",   3, VM_FLOW_NEXT,   VM_BINARY("%") },
+    [VM_OP_AND]   = { "and",   3, VM_FLOW_NEXT,   VM_BINARY("&") },
+    [VM_OP_OR]    = { "or",    3, VM_FLOW_NEXT,   VM_BINARY("|") },
+    [VM_OP_XOR]   = { "xor",   3, VM_FLOW_NEXT,   VM_BINARY("^") },
+    [VM_OP_SHL]   = { "shl",   3, VM_FLOW_NEXT,   VM_WRAP("<<", VM_B) },
+    [VM_OP_SHR]   = { "shr",   3, VM_FLOW_NEXT,   VM_BINARY(">>") },
+    [VM_OP_EQ]    = { "eq",    3, VM_FLOW_NEXT,   VM_BINARY("==") },
+    [VM_OP_NE]    = { "ne",    3, VM_FLOW_NEXT,   VM_BINARY("!=") },
+    [VM_OP_LT]    = { "lt",    3, VM_FLOW_NEXT,   VM_BINARY("<") },
+    [VM_OP_LE]    = { "le",    3, VM_FLOW_NEXT,   VM_BINARY("<=") },
+    [VM_OP_GT]    = { "gt",    3, VM_FLOW_NEXT,   VM_BINARY(">") },
+    [VM_OP_GE]    = { "ge",    3, VM_FLOW_NEXT,   VM_BINARY(">=") },
+    [VM_OP_ADDI]  = { "addi",  3, VM_FLOW_NEXT,   VM_WRAP("+", VM_IMM) },
+    [VM_OP_MULI]  = { "muli",  3, VM_FLOW_NEXT,   VM_WRAP("*", VM_IMM) },
+    [VM_OP_ANDI]  = { "andi",  3, VM_FLOW_NEXT,   VM_D " = " VM_A " & " VM_IMM ";" },
+    [VM_OP_NEG]   = { "neg",   2, VM_FLOW_NEXT,   VM_D " = (int)(0u - (unsigned int)" VM_A ");" },
+    [VM_OP_NOT]   = { "not",   2, VM_FLOW_NEXT,   VM_D " = !" VM_A ";" },
+    [VM_OP_INV]   = { "inv",   2, VM_FLOW_NEXT,   VM_D " = ~" VM_A ";" },
+    [VM_OP_BOOL]  = { "bool",  2, VM_FLOW_NEXT,   VM_D " = " VM_A " != 0;" },
+};
+
+VMProgram* vm_program_create(Random* random) {
+    VMProgram* program = malloc(sizeof(VMProgram));
+    if (!program) return NULL;
+    
+    program->code = NULL;
+    program->count = 0;
+    program->capacity = 0;
+    
+    // Fisher-Yates over the opcode numbers, so no two programs agree
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        program->encoding[i] = i;
+    }
+    for (int i = VM_OP_COUNT - 1; i > 0; i--) {
+        int j = random_below(random, i + 1);
+        int swap = program->encoding[i];
+        program->encoding[i] = program->encoding[j];
+        program->encoding[j] = swap;
+    }
+    return program;
+}
+
+void vm_program_destroy(VMProgram* program) {
+    if (!program) return;
+    
+    free(program->code);
+    free(program);
+}
+
+int vm_opcode_operands(VMOpcode opcode, bool* jump) {
+    if (opcode < 0 || opcode >= VM_OP_COUNT) return -1;
+    
+    if (jump) *jump = opcode_catalog[opcode].flow == VM_FLOW_BRANCH;
+    return opcode_catalog[opcode].operands;
+}
+
+int vm_program_append(VMProgram* program, const int* code, int count) {
+    if (!program || !code || count <= 0) return -1;
+    if (count > VM_PROGRAM_MAX - program->count) return -1;
+    
+    if (program->count + count > program->capacity) {
+        int capacity = program->capacity ? program->capacity : 256;
+        while (capacity < program->count + count) {
+            capacity *= 2;
+        }
+        int* grown = realloc(program->code, capacity * sizeof(int));
+        if (!grown) return -1;
+        
+        program->code = grown;
+        program->capacity = capacity;
+    }
+    
+    // Opcodes take their emitted numbers and jump targets become absolute
+    int base = program->count;
+    int* out = program->code + base;
+    for (int pc = 0; pc < count; ) {
+        bool jump;
+        int operands = vm_opcode_operands((VMOpcode)code[pc], &jump);
+        if (operands < 0 || pc + operands >= count) return -1;
+        
+        out[pc] = program->encoding[code[pc]];
+        for (int k = 1; k <= operands; k++) {
+            out[pc + k] = code[pc + k];
+        }
+        if (jump) out[pc + operands] += base;
+        pc += 1 + operands;
+    }
+    
+    program->count += count;
+    return base;
+}
+
+/* The translation runs once per program, so it lives out of line. Until it
+ * finishes, concurrent callers wait on the same state word the string
+ * table uses: 0 = raw, 1 = being threaded, 2 = ready. */
+static const char* vm_runtime_head =
+    "#include <stdatomic.h>\n"
+    "\n"
+    "typedef union __obf_vm_cell {\n"
+    "    const void* op;\n"
+    "    int value;\n"
+    "    union __obf_vm_cell* to;\n"
+    "} __obf_vm_cell;\n"
+    "\n"
+    "typedef struct {\n"
+    "    int r[%d];\n"
+    "    __obf_vm_cell* ip;\n"
+    "} __obf_vm_frame;\n"
+    "\n"
+    "static inline int __obf_vm_reg(const __obf_vm_frame* f, int index) {\n"
+    "    return f->r[index];\n"
+    "}\n"
+    "\n"
+    "static inline void __obf_vm_set(__obf_vm_frame* f, int index, int value) {\n"
+    "    f->r[index] = value;\n"
+    "}\n"
+    "\n";
+
+static const char* vm_runtime_thread =
+    "static __obf_vm_cell __obf_vm_threaded[%d];\n"
+    "static atomic_int __obf_vm_state;\n"
+    "\n"
+    "static __OBF_RARE void __obf_vm_thread(const void* const* handlers) {\n"
+    "    int expected = 0;\n"
+    "    if (!atomic_compare_exchange_strong(&__obf_vm_state, &expected, 1)) {\n"
+    "        while (atomic_load_explicit(&__obf_vm_state, memory_order_acquire) != 2) {\n"
+    "        }\n"
+    "        return;\n"
+    "    }\n"
+    "    for (int pc = 0; pc < %d; ) {\n"
+    "        int op = __obf_vm_code[pc];\n"
+    "        int operands = __obf_vm_shape[op] & 0x7f;\n"
+    "        __obf_vm_threaded[pc].op = handlers[op];\n"
+    "        for (int k = 1; k <= operands; k++) {\n"
+    "            int word = __obf_vm_code[pc + k];\n"
+    "            if (k == operands && (__obf_vm_shape[op] & 0x80)) {\n"
+    "                __obf_vm_threaded[pc + k].to = &__obf_vm_threaded[word];\n"
+    "            } else {\n"
+    "                __obf_vm_threaded[pc + k].value = word;\n"
+    "            }\n"
+    "        }\n"
+    "        pc += 1 + operands;\n"
+    "    }\n"
+    "    atomic_store_explicit(&__obf_vm_state, 2, memory_order_release);\n"
+    "}\n"
+    "\n"
+    "/* Starts at `entry`, or resumes after a call when it is negative; returns\n"
+    " * the call site the host must perform, or -1 once the function returns */\n"
+    "static __attribute__((noinline)) int __obf_vm_run(__obf_vm_frame* f, int entry) {\n"
+    "    static const void* const handlers[%d] = {";
+
+char* vm_program_emit(const VMProgram* program) {
+    if (!program || program->count == 0) return NULL;
+    
+    // Opcodes by emitted number
+    int decode[VM_OP_COUNT];
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        decode[program->encoding[i]] = i;
+    }
+    
+    TextBuffer buffer = {0};
+    text_append(&buffer, vm_runtime_head, VM_REGISTERS);
+    
+    text_append(&buffer, "static const int __obf_vm_code[%d] = {", program->count);
+    for (int i = 0; i < program->count; i++) {
+        text_append(&buffer, "%s%d%s", i % 12 == 0 ? "\n    " : " ", program->code[i],
+                    i + 1 < program->count ? "," : "");
+    }
+    text_append(&buffer, "\n};\n\n");
+    
+    // Operand count, plus 0x80 when the last operand is a jump target
+    text_append(&buffer, "static const unsigned char __obf_vm_shape[%d] = {", VM_OP_COUNT);
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        const VMOpcodeInfo* info = &opcode_catalog[decode[i]];
+        text_append(&buffer, "%s%d%s", i % 12 == 0 ? "\n    " : " ",
+                    info->operands | (info->flow == VM_FLOW_BRANCH ? 0x80 : 0),
+                    i + 1 < VM_OP_COUNT ? "," : "");
+    }
+    text_append(&buffer, "\n};\n\n");
+    
+    text_append(&buffer, vm_runtime_thread, program->count, program->count, VM_OP_COUNT);
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        text_append(&buffer, "%s&&__obf_vm_%s%s", i % 6 == 0 ? "\n        " : " ",
+                    opcode_catalog[decode[i]].label, i + 1 < VM_OP_COUNT ? "," : "");
+    }
+    text_append(&buffer, "\n    };\n"
+                         "    if (__OBF_UNLIKELY(atomic_load_explicit(&__obf_vm_state,\n"
+                         "                                            memory_order_acquire) != 2)) {\n"
+                         "        __obf_vm_thread(handlers);\n"
+                         "    }\n"
+                         "    int* r = f->r;\n"
+                         "    __obf_vm_cell* ip = entry >= 0 ? &__obf_vm_threaded[entry] : f->ip;\n"
+                         "    goto *ip->op;\n");
+    
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        const VMOpcodeInfo* info = &opcode_catalog[i];
+        text_append(&buffer, "__obf_vm_%s:\n", info->label);
+        
+        switch (info->flow) {
+            case VM_FLOW_NEXT:
+                text_append(&buffer, "    %s\n    ip += %d;\n", info->action, info->operands + 1);
+                break;
+            case VM_FLOW_BRANCH:
+                if (info->action) {
+                    text_append(&buffer, "    ip = %s ? ip[%d].to : ip + %d;\n", info->action,
+                                info->operands, info->operands + 1);
+                } else {
+                    text_append(&buffer, "    ip = ip[1].to;\n");
+                }
+                break;
+            case VM_FLOW_EXIT:
+                text_append(&buffer, "    %s\n", info->action);
+                continue;
+        }
+        text_append(&buffer, "    goto *ip->op;\n");
+    }
+    text_append(&buffer, "}\n\n");
+    return buffer.text;
+}
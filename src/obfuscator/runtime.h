@@ -0,0 +1,189 @@
+#ifndef OBFUSCATOR_RUNTIME_H
+#define OBFUSCATOR_RUNTIME_H
+
+#include "../common/types.h"
+#include "../common/random.h"
+#include <stdint.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Emitted Runtime Support
+ *
+ * Obfuscated string literals are deduplicated into one contiguous blob of
+ * ciphertext described by offset/length slots. The emitted prologue
+ * decrypts each slot the first time it is used (or the whole blob in one
+ * pass) and caches the plaintext, so `__obf_str(i)` costs an atomic load
+ * after the first call. The prologue requires C11 <stdatomic.h>.
+ *
+ * Bytes are XORed with a counter-mode keystream: byte j of a string is
+ * masked by the low byte of a 32-bit mix of (key ^ nonce) + j * golden.
+ * Every byte depends only on its own counter, so the emitted decryption
+ * loop auto-vectorizes.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* One distinct string; `length` excludes the terminating NUL, which is
+ * stored (encrypted) after the bytes */
+typedef struct {
+    size_t offset;
+    size_t length;
+    uint32_t nonce;
+    uint32_t hash;
+} StringTableEntry;
+
+typedef struct {
+    unsigned char* data;       /* Encrypted blob */
+    size_t size;
+    size_t capacity;
+    uint32_t key;
+    Random* random;            /* Nonces; borrowed, NULL = rand() */
+    StringTableEntry* entries;
+    int count;
+    int entry_capacity;
+    int* buckets;              /* Open-addressed entry indices; -1 = empty */
+    int bucket_count;
+} StringTable;
+
+/* Masked integer constants, read back by `__obf_const(i, mask)` as
+ * `__obf_const_pool[i] ^ mask`. The pool starts on a cache line so the
+ * first few dozen entries cost one miss at most. */
+typedef struct {
+    int* values;
+    int count;
+    int capacity;
+} ConstantPool;
+
+#define CONSTANT_POOL_MAX 4096
+
+/* Bytecode of every virtualized function, run by one register machine
+ * emitted alongside it. Instructions are an opcode followed by register
+ * indices, immediates or (last) a jump target, all ints. The emitted
+ * interpreter rewrites the code once into direct-threaded form (handler
+ * addresses and target pointers, GNU labels-as-values) and then costs one
+ * indirect jump per instruction. Opcode numbers are shuffled per program.
+ *
+ * Superinstructions cover the common pairs: compare-and-branch (JEQ..JGE)
+ * and arithmetic with an immediate operand (ADDI, MULI, ANDI). A CALL
+ * returns its call-site number to the host function, which performs the
+ * call and resumes the machine. */
+typedef enum {
+    VM_OP_HALT,                /* Return from the function */
+    VM_OP_CALL,                /* site: yield to the host for a call */
+    VM_OP_JMP,                 /* target */
+    VM_OP_JZ,                  /* s, target */
+    VM_OP_JNZ,                 /* s, target */
+    VM_OP_JEQ,                 /* a, b, target: branch if a == b */
+    VM_OP_JNE,
+    VM_OP_JLT,
+    VM_OP_JLE,
+    VM_OP_JGT,
+    VM_OP_JGE,
+    VM_OP_MOV,                 /* d, s */
+    VM_OP_LOADI,               /* d, imm */
+    VM_OP_ADD,                 /* d, a, b; +, - and * wrap */
+    VM_OP_SUB,
+    VM_OP_MUL,
+    VM_OP_DIV,
+    VM_OP_MOD,
+    VM_OP_AND,
+    VM_OP_OR,
+    VM_OP_XOR,
+    VM_OP_SHL,
+    VM_OP_SHR,
+    VM_OP_EQ,                  /* d, a, b: d = a == b */
+    VM_OP_NE,
+    VM_OP_LT,
+    VM_OP_LE,
+    VM_OP_GT,
+    VM_OP_GE,
+    VM_OP_ADDI,                /* d, a, imm */
+    VM_OP_MULI,
+    VM_OP_ANDI,
+    VM_OP_NEG,                 /* d, s */
+    VM_OP_NOT,                 /* d, s: d = !s */
+    VM_OP_INV,                 /* d, s: d = ~s */
+    VM_OP_BOOL,                /* d, s: d = s != 0 */
+    VM_OP_COUNT
+} VMOpcode;
+
+#define VM_REGISTERS   32      /* Per frame */
+#define VM_PROGRAM_MAX 65536   /* Words */
+
+typedef struct {
+    int* code;
+    int count;
+    int capacity;
+    int encoding[VM_OP_COUNT]; /* Emitted number of each opcode */
+} VMProgram;
+
+/* Shared helpers, emitted once as `static inline` functions ahead of any
+ * code that calls them. Code that only runs once or never is kept out of
+ * the hot text instead: __OBF_UNLIKELY(x) hints a branch as not taken,
+ * __OBF_COLD outlines a function into .text.unlikely and __OBF_RARE places
+ * run-once code there without optimizing it for size. All three expand to
+ * nothing on compilers without GNU attributes. */
+typedef enum {
+    RUNTIME_HELPER_UNLIKELY,       /* Placement macros, pulled in on demand */
+    RUNTIME_HELPER_STR_DECRYPT,    /* __obf_str_decrypt(out, in, n, seed) */
+    RUNTIME_HELPER_OPAQUE_ZERO,    /* __obf_opaque_zero(x), always 0 */
+    RUNTIME_HELPER_COMPLEX_ADD,    /* __obf_complex_add(a, b), int a + b */
+    RUNTIME_HELPER_OPAQUE_MOD4,    /* __obf_opaque_square_mod4(x), always 0 */
+    RUNTIME_HELPER_OPAQUE_CUBE,    /* __obf_opaque_cube_mod3(x), always 0 */
+    RUNTIME_HELPER_OPAQUE_ALIAS,   /* __obf_opaque_alias(x), always 0 */
+    RUNTIME_HELPER_OPAQUE_GLOBAL,  /* __obf_opaque_global(x), always 0 */
+    RUNTIME_HELPER_COLD_PATH,      /* __obf_cold_path(x), payload of dead branches */
+    RUNTIME_HELPER_OPAQUE_INPUT,   /* __obf_opaque_input(), unknown until run time */
+    RUNTIME_HELPER_COUNT
+} RuntimeHelper;
+
+typedef unsigned int RuntimeHelperSet;  /* Bit per RuntimeHelper */
+
+const char* runtime_helper_name(RuntimeHelper helper);
+
+/* Helper definitions in catalog order, plus whatever they depend on; NULL
+ * when the set is empty. Pulls in <stdatomic.h> when a helper keeps shared
+ * state. */
+char* runtime_helpers_emit(RuntimeHelperSet helpers);
+
+/* String Table Management */
+StringTable* string_table_create(Random* random);
+void string_table_destroy(StringTable* table);
+int string_table_add(StringTable* table, const unsigned char* bytes, size_t length);
+int string_table_find(const StringTable* table, const unsigned char* bytes, size_t length);
+
+/* Keystream byte `index` of the string with the given nonce */
+unsigned char string_keystream(uint32_t key, uint32_t nonce, size_t index);
+
+/* Decodes the escapes of a plain "..." literal; caller frees *bytes */
+bool string_literal_decode(const char* literal, unsigned char** bytes, size_t* length);
+
+/* C source defining the table and __obf_str(); NULL when the table is empty.
+ * With `decrypt_all` the first lookup decrypts the whole blob at once.
+ * Calls the RUNTIME_HELPER_STR_DECRYPT helper. */
+char* string_table_emit(const StringTable* table, bool decrypt_all);
+
+/* Constant Pool Management */
+ConstantPool* constant_pool_create(void);
+void constant_pool_destroy(ConstantPool* pool);
+
+/* Index of the new entry; -1 when the pool is full */
+int constant_pool_add(ConstantPool* pool, int value);
+
+/* C source defining the pool and __obf_const(); NULL when it is empty */
+char* constant_pool_emit(const ConstantPool* pool);
+
+/* Bytecode Programs */
+VMProgram* vm_program_create(Random* random);
+void vm_program_destroy(VMProgram* program);
+
+/* Operands following the opcode; the last is a jump target when `jump` */
+int vm_opcode_operands(VMOpcode opcode, bool* jump);
+
+/* Appends a function's code, with jump targets relative to its start;
+ * returns its entry offset, or -1 when the program would grow too large */
+int vm_program_append(VMProgram* program, const int* code, int count);
+
+/* C source defining the frame type, __obf_vm_reg/__obf_vm_set and
+ * __obf_vm_run(frame, entry); NULL when no code was added. Needs GNU C and
+ * the RUNTIME_HELPER_UNLIKELY macros. */
+char* vm_program_emit(const VMProgram* program);
+
+#endif /* OBFUSCATOR_RUNTIME_H */
@@ -0,0 +1,473 @@
+#include "simplify.h"
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Helpers
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool is_preserved(const ObfuscationConfig* config, const ASTNode* node) {
+    if (!node || !(node->flags & AST_FLAG_OPAQUE)) return false;
+    return !config || config->simplify_preserve_opaque;
+}
+
+static bool op_is(const char* op, const char* candidate) {
+    return op && strcmp(op, candidate) == 0;
+}
+
+/* Reads an unsuffixed, non-negative literal that has type int. Anything else
+ * (suffixes, floats, characters, values above INT_MAX) is left alone so that
+ * folding never changes the type of an expression. */
+static bool literal_int_value(const ASTNode* node, long long* value) {
+    if (!node || node->type != NODE_LITERAL) return false;
+    
+    const char* text = node->data.literal.value;
+    if (!text || !isdigit((unsigned char)text[0])) return false;
+    
+    char* end = NULL;
+    errno = 0;
+    unsigned long long parsed = strtoull(text, &end, 0);
+    if (errno != 0 || !end || *end != '\0') return false;
+    if (parsed > INT_MAX) return false;
+    
+    *value = (long long)parsed;
+    return true;
+}
+
+/* Evaluates `a op b` with C int semantics. Fails on anything that would be
+ * undefined, negative, or outside int. */
+static bool fold_binary(const char* op, long long a, long long b, long long* result) {
+    long long r;
+    
+    if (op_is(op, "+")) r = a + b;
+    else if (op_is(op, "-")) r = a - b;
+    else if (op_is(op, "*")) r = a * b;
+    else if (op_is(op, "/")) { if (b == 0) return false; r = a / b; }
+    else if (op_is(op, "%")) { if (b == 0) return false; r = a % b; }
+    else if (op_is(op, "&")) r = a & b;
+    else if (op_is(op, "|")) r = a | b;
+    else if (op_is(op, "^")) r = a ^ b;
+    else if (op_is(op, "<<")) { if (b >= 31) return false; r = a << b; }
+    else if (op_is(op, ">>")) { if (b >= 31) return false; r = a >> b; }
+    else if (op_is(op, "==")) r = a == b;
+    else if (op_is(op, "!=")) r = a != b;
+    else if (op_is(op, "<")) r = a < b;
+    else if (op_is(op, ">")) r = a > b;
+    else if (op_is(op, "<=")) r = a <= b;
+    else if (op_is(op, ">=")) r = a >= b;
+    else if (op_is(op, "&&")) r = a && b;
+    else if (op_is(op, "||")) r = a || b;
+    else return false;
+    
+    if (r < 0 || r > INT_MAX) return false;
+    
+    *result = r;
+    return true;
+}
+
+/* Literal-only expressions with no side effects, e.g. `0` or `42 * 0` */
+static bool is_constant_expression(const ASTNode* node) {
+    if (!node) return false;
+    
+    switch (node->type) {
+        case NODE_LITERAL:
+            return true;
+        case NODE_UNARY_OP:
+            return !ast_has_side_effects(node) &&
+                   is_constant_expression(node->data.unary.operand);
+        case NODE_BINARY_OP:
+            if (ast_has_side_effects(node)) return false;
+            if (!is_constant_expression(node->data.binary.left)) return false;
+            for (const ASTNode* r = node->data.binary.right; r; r = r->next) {
+                if (!is_constant_expression(r)) return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void replace_with_number(ASTNode* node, long long value) {
+    ast_replace_subtree(node, ast_create_literal_number((int)value));
+}
+
+/* Replaces a binary node by one of its operands, freeing the other */
+static void replace_with_left(ASTNode* node) {
+    ASTNode* keep = node->data.binary.left;
+    node->data.binary.left = NULL;
+    ast_replace_subtree(node, keep);
+}
+
+static void replace_with_right(ASTNode* node) {
+    ASTNode* keep = node->data.binary.right;
+    node->data.binary.right = NULL;
+    ast_replace_subtree(node, keep);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Expression Simplification
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Collapses `(x op c1) op c2` into `x op (c1 op' c2)` for associative
+ * operators and shift chains such as `<< 1 << 1`; additions only over int,
+ * since `(d + 1) + 2` rounds differently from `d + 3` */
+static bool merge_constant_chain(const ObfuscationConfig* config, ASTNode* node, long long b) {
+    const char* op = node->data.binary.operator;
+    ASTNode* inner = node->data.binary.left;
+    
+    if (!inner || inner->type != NODE_BINARY_OP || is_preserved(config, inner)) return false;
+    if (!op_is(inner->data.binary.operator, op)) return false;
+    
+    long long c;
+    if (!literal_int_value(inner->data.binary.right, &c)) return false;
+    
+    long long merged;
+    if (op_is(op, "<<") || op_is(op, ">>")) {
+        merged = c + b;
+        if (merged >= 31) return false;
+    } else if (op_is(op, "+")) {
+        if (!ast_is_integer_operand(inner->data.binary.left)) return false;
+        if (!fold_binary("+", c, b, &merged)) return false;
+    } else if (op_is(op, "&") || op_is(op, "|") || op_is(op, "^")) {
+        if (!fold_binary(op, c, b, &merged)) return false;
+    } else {
+        return false;
+    }
+    
+    replace_with_number(inner->data.binary.right, merged);
+    replace_with_left(node);
+    return true;
+}
+
+static void simplify_ternary(ASTNode* node, SimplifyStats* stats) {
+    ASTNode* then_expr = node->data.binary.right;
+    ASTNode* else_expr = then_expr ? then_expr->next : NULL;
+    long long cond;
+    
+    if (!else_expr || !literal_int_value(node->data.binary.left, &cond)) return;
+    
+    // Detach the branch that survives; the other is never evaluated
+    then_expr->next = NULL;
+    if (cond) {
+        node->data.binary.right = else_expr;
+        ast_replace_subtree(node, then_expr);
+    } else {
+        node->data.binary.right = then_expr;
+        ast_replace_subtree(node, else_expr);
+    }
+    stats->identities_removed++;
+}
+
+static void simplify_binary(const ObfuscationConfig* config, ASTNode* node, SimplifyStats* stats) {
+    const char* op = node->data.binary.operator;
+    ASTNode* left = node->data.binary.left;
+    ASTNode* right = node->data.binary.right;
+    
+    if (!op || !left || !right) return;
+    
+    if (op_is(op, "?:")) {
+        simplify_ternary(node, stats);
+        return;
+    }
+    if (right->next) return;
+    
+    long long a, b, r;
+    bool left_const = literal_int_value(left, &a);
+    bool right_const = literal_int_value(right, &b);
+    
+    if (left_const && right_const && fold_binary(op, a, b, &r)) {
+        replace_with_number(node, r);
+        stats->constants_folded++;
+        return;
+    }
+    
+    // Short-circuit operators whose right side is never evaluated
+    if (left_const && ((op_is(op, "&&") && a == 0) || (op_is(op, "||") && a != 0))) {
+        replace_with_number(node, a != 0);
+        stats->constants_folded++;
+        return;
+    }
+    
+    if (right_const) {
+        // -0.0 + 0 is 0.0, so adding zero is only the identity over int
+        if (b == 0 && (op_is(op, "|") || op_is(op, "^") || op_is(op, "<<") || op_is(op, ">>") ||
+                       ((op_is(op, "+") || op_is(op, "-")) && ast_is_integer_operand(left)))) {
+            replace_with_left(node);
+            stats->identities_removed++;
+            return;
+        }
+        if (b == 1 && (op_is(op, "*") || op_is(op, "/"))) {
+            replace_with_left(node);
+            stats->identities_removed++;
+            return;
+        }
+        if (b == 0 && (op_is(op, "*") || op_is(op, "&")) &&
+            ast_is_integer_operand(left) && !ast_has_side_effects(left)) {
+            replace_with_number(node, 0);
+            stats->identities_removed++;
+            return;
+        }
+        if (merge_constant_chain(config, node, b)) {
+            stats->identities_removed++;
+            // The merged constant may itself form an identity, e.g. x & 2 & 1
+            simplify_binary(config, node, stats);
+            return;
+        }
+    }
+    
+    if (left_const) {
+        if (a == 0 && (op_is(op, "|") || op_is(op, "^") ||
+                       (op_is(op, "+") && ast_is_integer_operand(right)))) {
+            replace_with_right(node);
+            stats->identities_removed++;
+            return;
+        }
+        if (a == 1 && op_is(op, "*")) {
+            replace_with_right(node);
+            stats->identities_removed++;
+            return;
+        }
+        if (a == 0 && (op_is(op, "*") || op_is(op, "&")) &&
+            ast_is_integer_operand(right) && !ast_has_side_effects(right)) {
+            replace_with_number(node, 0);
+            stats->identities_removed++;
+            return;
+        }
+    }
+}
+
+static void simplify_unary(const ObfuscationConfig* config, ASTNode* node, SimplifyStats* stats) {
+    const char* op = node->data.unary.operator;
+    ASTNode* operand = node->data.unary.operand;
+    
+    if (!op || !operand || !node->data.unary.is_prefix) return;
+    
+    // ~~x and - -x are the identity
+    if ((op_is(op, "~") || op_is(op, "-")) && operand->type == NODE_UNARY_OP &&
+        operand->data.unary.is_prefix && op_is(operand->data.unary.operator, op) &&
+        !is_preserved(config, operand)) {
+        ASTNode* keep = operand->data.unary.operand;
+        operand->data.unary.operand = NULL;
+        ast_replace_subtree(node, keep);
+        stats->identities_removed++;
+        return;
+    }
+    
+    long long value;
+    if (!literal_int_value(operand, &value)) return;
+    
+    if (op_is(op, "!")) {
+        replace_with_number(node, !value);
+        stats->constants_folded++;
+    } else if (op_is(op, "+") || (op_is(op, "-") && value == 0)) {
+        replace_with_number(node, value);
+        stats->constants_folded++;
+    }
+}
+
+void simplify_expression(const ObfuscationConfig* config, ASTNode* expr, SimplifyStats* stats) {
+    if (!expr || !stats || is_preserved(config, expr)) return;
+    
+    switch (expr->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            simplify_expression(config, expr->data.binary.left, stats);
+            for (ASTNode* r = expr->data.binary.right; r; r = r->next) {
+                simplify_expression(config, r, stats);
+            }
+            if (expr->type == NODE_BINARY_OP) {
+                simplify_binary(config, expr, stats);
+            }
+            break;
+        
+        case NODE_UNARY_OP:
+            simplify_expression(config, expr->data.unary.operand, stats);
+            simplify_unary(config, expr, stats);
+            break;
+        
+        case NODE_CALL:
+            simplify_expression(config, expr->data.call.function, stats);
+            for (ASTNode* arg = expr->data.call.arguments; arg; arg = arg->next) {
+                simplify_expression(config, arg, stats);
+            }
+            break;
+        
+        case NODE_STMT_EXPR: {
+            // The last statement is the value and must stay in place
+            ASTNode* statements = expr->data.block.statements;
+            if (!statements) break;
+            
+            ASTNode* value = statements;
+            ASTNode* prev = NULL;
+            while (value->next) {
+                prev = value;
+                value = value->next;
+            }
+            
+            if (prev) {
+                prev->next = NULL;
+                statements = simplify_statements(config, statements, stats);
+            } else {
+                statements = NULL;
+            }
+            simplify_expression(config, value, stats);
+            expr->data.block.statements = ast_link(statements, value);
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Statement Simplification
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool simplify_statement(const ObfuscationConfig* config, ASTNode* node, SimplifyStats* stats);
+
+/* Simplifies a statement in a single-statement position (if/loop body) */
+static void simplify_branch(const ObfuscationConfig* config, ASTNode* node, SimplifyStats* stats) {
+    if (!node) return;
+    
+    if (!simplify_statement(config, node, stats) && node->type != NODE_BLOCK) {
+        ast_replace_subtree(node, ast_create_block(NULL));
+        stats->statements_removed++;
+    }
+}
+
+/* Returns false when the statement has no effect and can be dropped */
+static bool simplify_statement(const ObfuscationConfig* config, ASTNode* node, SimplifyStats* stats) {
+    if (!node || is_preserved(config, node)) return true;
+    
+    long long value;
+    
+    switch (node->type) {
+        case NODE_PROGRAM:
+            for (ASTNode* decl = node->data.program.declarations; decl; decl = decl->next) {
+                simplify_statement(config, decl, stats);
+            }
+            return true;
+        
+        case NODE_FUNCTION:
+            simplify_branch(config, node->data.function.body, stats);
+            return true;
+        
+        case NODE_VARIABLE:
+            simplify_expression(config, node->data.variable.initializer, stats);
+            return true;
+        
+        case NODE_BLOCK:
+            node->data.block.statements =
+                simplify_statements(config, node->data.block.statements, stats);
+            return node->data.block.statements != NULL;
+        
+        case NODE_IF: {
+            simplify_expression(config, node->data.if_stmt.condition, stats);
+            simplify_branch(config, node->data.if_stmt.then_stmt, stats);
+            simplify_branch(config, node->data.if_stmt.else_stmt, stats);
+            
+            if (!literal_int_value(node->data.if_stmt.condition, &value)) return true;
+            
+            ASTNode* taken = value ? node->data.if_stmt.then_stmt : node->data.if_stmt.else_stmt;
+            if (!taken) return false;
+            
+            if (value) {
+                node->data.if_stmt.then_stmt = NULL;
+            } else {
+                node->data.if_stmt.else_stmt = NULL;
+            }
+            ast_replace_subtree(node, taken);
+            stats->statements_removed++;
+            return true;
+        }
+        
+        case NODE_WHILE:
+            simplify_expression(config, node->data.while_stmt.condition, stats);
+            simplify_branch(config, node->data.while_stmt.body, stats);
+            return !(literal_int_value(node->data.while_stmt.condition, &value) && value == 0);
+        
+        case NODE_FOR:
+            if (node->data.for_stmt.init && node->data.for_stmt.init->type == NODE_VARIABLE) {
+                simplify_statement(config, node->data.for_stmt.init, stats);
+            } else {
+                simplify_expression(config, node->data.for_stmt.init, stats);
+            }
+            simplify_expression(config, node->data.for_stmt.condition, stats);
+            simplify_expression(config, node->data.for_stmt.update, stats);
+            simplify_branch(config, node->data.for_stmt.body, stats);
+            return !(node->data.for_stmt.init == NULL &&
+                     literal_int_value(node->data.for_stmt.condition, &value) && value == 0);
+        
+        case NODE_SWITCH:
+            simplify_expression(config, node->data.switch_stmt.expression, stats);
+            for (ASTNode* c = node->data.switch_stmt.cases; c; c = c->next) {
+                c->data.case_stmt.statements =
+                    simplify_statements(config, c->data.case_stmt.statements, stats);
+            }
+            return true;
+        
+        case NODE_LITERAL:
+        case NODE_IDENTIFIER:
+        case NODE_BINARY_OP:
+        case NODE_UNARY_OP:
+        case NODE_CALL:
+        case NODE_ASSIGNMENT:
+        case NODE_STMT_EXPR:
+            // Expression statement
+            simplify_expression(config, node, stats);
+            return !is_constant_expression(node);
+        
+        default:
+            return true;
+    }
+}
+
+ASTNode* simplify_statements(const ObfuscationConfig* config, ASTNode* statements,
+                             SimplifyStats* stats) {
+    if (!stats) return statements;
+    
+    ASTNode** link = &statements;
+    while (*link) {
+        ASTNode* stmt = *link;
+        
+        if (simplify_statement(config, stmt, stats)) {
+            link = &stmt->next;
+            continue;
+        }
+        
+        // Unlink and free statements that do nothing
+        *link = stmt->next;
+        stmt->next = NULL;
+        ast_node_destroy(stmt);
+        stats->statements_removed++;
+    }
+    
+    return statements;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Pass Entry Point
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+bool simplify_ast(ObfuscationContext* ctx, ASTNode* ast) {
+    if (!ctx || !ast) return false;
+    
+    SimplifyStats stats = {0};
+    
+    // Top-level nodes are owned by the caller, so they're simplified but
+    // never unlinked
+    for (ASTNode* node = ast; node; node = node->next) {
+        simplify_statement(ctx->config, node, &stats);
+    }
+    
+    ctx->pass_count++;
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef OBFUSCATOR_SIMPLIFY_H
+#define OBFUSCATOR_SIMPLIFY_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Post-Obfuscation Peephole Simplifier
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Counters describing what a simplification run removed */
+typedef struct {
+    int constants_folded;      /* Literal-only expressions evaluated */
+    int identities_removed;    /* x + 0, x * 1, (x << 1) << 1, ... */
+    int statements_removed;    /* while (0), if (0), bare literals */
+} SimplifyStats;
+
+/* Pass entry point; runs after the obfuscation passes */
+bool simplify_ast(ObfuscationContext* ctx, ASTNode* ast);
+
+/* Simplify a single expression tree in place */
+void simplify_expression(const ObfuscationConfig* config, ASTNode* expr, SimplifyStats* stats);
+
+/* Simplify a statement list; returns the (possibly new) head of the list */
+ASTNode* simplify_statements(const ObfuscationConfig* config, ASTNode* statements,
+                             SimplifyStats* stats);
+
+#endif /* OBFUSCATOR_SIMPLIFY_H */
@@ -0,0 +1,176 @@
+#include "snapshot.h"
+#include "ast_utils.h"
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../codegen/codegen.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Snapshot Lifecycle
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+ASTSnapshot* snapshot_create(ASTNode* ast, const char* filename) {
+    if (!ast) return NULL;
+    
+    ASTSnapshot* snapshot = calloc(1, sizeof(ASTSnapshot));
+    if (!snapshot) return NULL;
+    
+    snapshot->ast = ast;
+    snapshot->filename = filename ? strdup(filename) : NULL;
+    for (const ASTNode* node = ast; node; node = node->next) {
+        snapshot->node_count += ast_count_nodes(node);
+    }
+    return snapshot;
+}
+
+ASTSnapshot* snapshot_parse(const char* source, const char* filename) {
+    if (!source) return NULL;
+    
+    LexerState* lexer = lexer_create(source, filename ? filename : "<input>");
+    if (!lexer) return NULL;
+    
+    Token* tokens = lexer_tokenize(lexer);
+    if (!tokens || lexer_has_errors(lexer)) {
+        lexer_destroy(lexer);
+        return NULL;
+    }
+    
+    ParserState* parser = parser_create(tokens);
+    if (!parser) {
+        lexer_destroy(lexer);
+        return NULL;
+    }
+    
+    // The tree owns copies of every token string, so neither stage outlives it
+    ASTNode* ast = parser_parse_expression(parser);
+    if (parser_has_errors(parser)) {
+        // A misplaced pragma would silently change what gets obfuscated
+        for (const Error* error = parser_get_errors(parser); error; error = error->next) {
+            fprintf(stderr, "%s:%d:%d: error: %s\n",
+                    error->location.filename ? error->location.filename : "<input>",
+                    error->location.line, error->location.column, error->message);
+        }
+        ast_tree_destroy(ast);
+        ast = NULL;
+    }
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    if (!ast) return NULL;
+    
+    ASTSnapshot* snapshot = snapshot_create(ast, filename);
+    if (!snapshot) ast_tree_destroy(ast);
+    return snapshot;
+}
+
+void snapshot_destroy(ASTSnapshot* snapshot) {
+    if (!snapshot) return;
+    
+    ast_tree_destroy(snapshot->ast);
+    free(snapshot->filename);
+    free(snapshot);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Variants
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+ASTNode* snapshot_checkout(const ASTSnapshot* snapshot) {
+    if (!snapshot) return NULL;
+    
+    return ast_copy_list(snapshot->ast);
+}
+
+static void warn_if_huge(const ASTSnapshot* snapshot, size_t estimate, size_t plain) {
+    if (estimate < SNAPSHOT_WARN_MIN_BYTES) return;
+    
+    double growth = plain > 0 ? (double)estimate / (double)plain : 0.0;
+    if (estimate < SNAPSHOT_WARN_BYTES && growth < SNAPSHOT_WARN_GROWTH) return;
+    
+    fprintf(stderr, "Warning: output for '%s' is estimated at %.1f MB (%.0fx the unobfuscated code)\n",
+            snapshot->filename ? snapshot->filename : "<input>",
+            (double)estimate / (1024.0 * 1024.0), growth);
+}
+
+/* Where a rendered variant goes: a string, or a file as it is generated */
+typedef struct {
+    const char* output_file;   /* NULL: into `code` */
+    char* code;
+    size_t size;
+} RenderTarget;
+
+static bool render(const ASTSnapshot* snapshot, const ObfuscationConfig* config,
+                   FILE* report, RenderTarget* target) {
+    if (!snapshot || !config) return false;
+    
+    ASTNode* ast = snapshot_checkout(snapshot);
+    if (!ast) return false;
+    
+    ObfuscationContext* ctx = obfuscator_create((ObfuscationConfig*)config);
+    if (!ctx || !obfuscate_ast(ctx, ast)) {
+        obfuscator_destroy(ctx);
+        ast_tree_destroy(ast);
+        return false;
+    }
+    
+    if (report) {
+        loop_report_print(ctx->loops, report);
+        budget_print(ctx->budget, report);
+    }
+    
+    CodeGenConfig* codegen_config = codegen_config_create_default();
+    CodeGenState* codegen = NULL;
+    if (codegen_config) {
+        codegen_config->seed = config->seed;
+        codegen_config_set_style(codegen_config, config->aesthetic);
+        codegen = codegen_create(codegen_config);
+    }
+    
+    bool ok = false;
+    if (codegen) {
+        size_t plain = codegen_estimate_size(codegen, snapshot->ast);
+        
+        // Runtime support (the encrypted string table) precedes the program
+        char* prologue = obfuscator_runtime_prologue(ctx);
+        codegen_set_prologue(codegen, prologue);
+        free(prologue);
+        warn_if_huge(snapshot, codegen_estimate_size(codegen, ast), plain);
+        
+        if (!target->output_file) {
+            target->code = generate_code(codegen, ast);
+            ok = target->code != NULL;
+        } else {
+            int fd = open(target->output_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                ok = codegen_stream(codegen, ast, codegen_sink_fd, &fd);
+                ok = close(fd) == 0 && ok;
+            }
+        }
+        target->size = codegen_output_size(codegen);
+    }
+    
+    codegen_destroy(codegen);
+    codegen_config_destroy(codegen_config);
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(ast);
+    return ok;
+}
+
+char* snapshot_render(const ASTSnapshot* snapshot, const ObfuscationConfig* config,
+                      FILE* report) {
+    RenderTarget target = { NULL, NULL, 0 };
+    render(snapshot, config, report, &target);
+    return target.code;
+}
+
+bool snapshot_render_file(const ASTSnapshot* snapshot, const ObfuscationConfig* config,
+                          FILE* report, const char* output_file, size_t* size) {
+    if (!output_file) return false;
+    
+    RenderTarget target = { output_file, NULL, 0 };
+    bool ok = render(snapshot, config, report, &target);
+    if (size) *size = ok ? target.size : 0;
+    return ok;
+}
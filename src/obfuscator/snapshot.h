@@ -0,0 +1,56 @@
+#ifndef OBFUSCATOR_SNAPSHOT_H
+#define OBFUSCATOR_SNAPSHOT_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * AST Snapshots
+ *
+ * The front end (read, lex, parse) runs once per source; every variant
+ * built from it starts from a checkout of the frozen tree. The passes
+ * rewrite nodes in place all the way down, so a checkout is a private
+ * copy made in one linear walk rather than an overlay: cheap next to the
+ * passes themselves, and it leaves the snapshot safe to check out from
+ * several threads at once since nothing ever writes to it.
+ *
+ * A variant is fully described by its configuration; with a non-zero
+ * seed, rendering it again gives the same code byte for byte.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Rendering warns on stderr, before writing anything, when the estimated
+ * output reaches SNAPSHOT_WARN_BYTES, or SNAPSHOT_WARN_GROWTH times the
+ * unobfuscated program once it is past SNAPSHOT_WARN_MIN_BYTES */
+#define SNAPSHOT_WARN_BYTES      ((size_t)256 << 20)
+#define SNAPSHOT_WARN_MIN_BYTES  ((size_t)1 << 20)
+#define SNAPSHOT_WARN_GROWTH     50
+
+typedef struct {
+    ASTNode* ast;              /* Frozen; never handed to a pass */
+    char* filename;
+    size_t node_count;
+} ASTSnapshot;
+
+/* Runs the front end over `source`; NULL when it does not lex or parse.
+ * Parse errors, such as a bad `#pragma obfuscate`, go to stderr */
+ASTSnapshot* snapshot_parse(const char* source, const char* filename);
+
+/* Freezes `ast`, which the snapshot takes over */
+ASTSnapshot* snapshot_create(ASTNode* ast, const char* filename);
+void snapshot_destroy(ASTSnapshot* snapshot);
+
+/* A private copy of the tree for one variant; free with ast_tree_destroy */
+ASTNode* snapshot_checkout(const ASTSnapshot* snapshot);
+
+/* Obfuscates a checkout with `config` and generates its code, runtime
+ * prologue included. Pass reports (loops, growth) go to `report` when it
+ * is not NULL. */
+char* snapshot_render(const ASTSnapshot* snapshot, const ObfuscationConfig* config,
+                      FILE* report);
+
+/* snapshot_render, streamed into `output_file` chunk by chunk; `size`
+ * (may be NULL) receives the bytes written. The file is only created once
+ * obfuscation has succeeded. */
+bool snapshot_render_file(const ASTSnapshot* snapshot, const ObfuscationConfig* config,
+                          FILE* report, const char* output_file, size_t* size);
+
+#endif /* OBFUSCATOR_SNAPSHOT_H */
@@ -0,0 +1,291 @@
+#include "undo.h"
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Tree Queries
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define UNDO_MAX_CHILDREN 4
+
+/* Child pointers of a node; each heads a list walked through `next` */
+static int child_slots(ASTNode* node, ASTNode** slots[UNDO_MAX_CHILDREN]) {
+    switch (node->type) {
+        case NODE_PROGRAM:
+            slots[0] = &node->data.program.declarations;
+            return 1;
+        case NODE_FUNCTION:
+            slots[0] = &node->data.function.parameters;
+            slots[1] = &node->data.function.body;
+            return 2;
+        case NODE_VARIABLE:
+        case NODE_PARAMETER:
+            slots[0] = &node->data.variable.initializer;
+            return 1;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
+            slots[0] = &node->data.binary.left;
+            slots[1] = &node->data.binary.right;
+            return 2;
+        case NODE_UNARY_OP:
+            slots[0] = &node->data.unary.operand;
+            return 1;
+        case NODE_CALL:
+            slots[0] = &node->data.call.function;
+            slots[1] = &node->data.call.arguments;
+            return 2;
+        case NODE_IF:
+            slots[0] = &node->data.if_stmt.condition;
+            slots[1] = &node->data.if_stmt.then_stmt;
+            slots[2] = &node->data.if_stmt.else_stmt;
+            return 3;
+        case NODE_WHILE:
+            slots[0] = &node->data.while_stmt.condition;
+            slots[1] = &node->data.while_stmt.body;
+            return 2;
+        case NODE_FOR:
+            slots[0] = &node->data.for_stmt.init;
+            slots[1] = &node->data.for_stmt.condition;
+            slots[2] = &node->data.for_stmt.update;
+            slots[3] = &node->data.for_stmt.body;
+            return 4;
+        case NODE_BLOCK:
+        case NODE_STMT_EXPR:
+            slots[0] = &node->data.block.statements;
+            return 1;
+        case NODE_SWITCH:
+            slots[0] = &node->data.switch_stmt.expression;
+            slots[1] = &node->data.switch_stmt.cases;
+            return 2;
+        case NODE_CASE:
+            slots[0] = &node->data.case_stmt.value;
+            slots[1] = &node->data.case_stmt.statements;
+            return 2;
+        case NODE_GOTO:
+        case NODE_LABEL:
+            slots[0] = &node->data.jump.target;
+            return 1;
+        case NODE_STRUCT:
+            slots[0] = &node->data.struct_def.members;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Frees a node's own strings and shell, not its children */
+static void free_shell(ASTNode* node) {
+    ASTNode** slots[UNDO_MAX_CHILDREN];
+    int count = child_slots(node, slots);
+    for (int i = 0; i < count; i++) {
+        *slots[i] = NULL;
+    }
+    node->next = NULL;
+    ast_node_destroy(node);
+}
+
+static bool is_reused(const UndoEntry* entry, const ASTNode* node) {
+    for (size_t i = 0; i < entry->reused_count; i++) {
+        if (entry->reused[i] == node) return true;
+    }
+    return false;
+}
+
+/* Frees a list built by a rewrite, leaving the old children it reused */
+static void discard_list(ASTNode* node, const UndoEntry* entry) {
+    while (node) {
+        ASTNode* next = node->next;
+        
+        if (!is_reused(entry, node)) {
+            ASTNode** slots[UNDO_MAX_CHILDREN];
+            int count = child_slots(node, slots);
+            for (int i = 0; i < count; i++) {
+                discard_list(*slots[i], entry);
+            }
+            free_shell(node);
+        }
+        
+        node = next;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Log Lifecycle
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+UndoLog* undo_log_create(void) {
+    return calloc(1, sizeof(UndoLog));
+}
+
+static void release_entry(UndoEntry* entry) {
+    if (entry->owns_children) {
+        entry->saved->next = NULL;
+        ast_node_destroy(entry->saved);
+    } else {
+        free_shell(entry->saved);
+    }
+    free(entry->reused);
+    free(entry->reused_next);
+}
+
+static void release_all(UndoLog* log) {
+    for (size_t i = 0; i < log->count; i++) {
+        release_entry(&log->entries[i]);
+    }
+    log->count = 0;
+}
+
+void undo_log_destroy(UndoLog* log) {
+    if (!log) return;
+    
+    release_all(log);
+    free(log->entries);
+    free(log);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Checkpoints
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+size_t undo_checkpoint(UndoLog* log) {
+    if (!log) return 0;
+    
+    log->depth++;
+    return log->count;
+}
+
+void undo_commit(UndoLog* log, size_t mark) {
+    (void)mark;
+    if (!log || log->depth == 0) return;
+    
+    // An enclosing checkpoint may still roll these back
+    if (--log->depth == 0) {
+        release_all(log);
+    }
+}
+
+static void rollback_entry(UndoEntry* entry) {
+    ASTNode* node = entry->node;
+    
+    // Swap the old contents back in; the shell then holds the rewrite
+    ASTNode* built = entry->saved;
+    ASTNode current = *node;
+    *node = *built;
+    *built = current;
+    
+    ASTNode** slots[UNDO_MAX_CHILDREN];
+    int count = child_slots(built, slots);
+    for (int i = 0; i < count; i++) {
+        discard_list(*slots[i], entry);
+    }
+    free_shell(built);
+    
+    for (size_t i = 0; i < entry->reused_count; i++) {
+        entry->reused[i]->next = entry->reused_next[i];
+    }
+    free(entry->reused);
+    free(entry->reused_next);
+}
+
+void undo_rollback(UndoLog* log, size_t mark) {
+    if (!log || log->depth == 0) return;
+    
+    while (log->count > mark) {
+        rollback_entry(&log->entries[--log->count]);
+    }
+    log->depth--;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Rewrites
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool record_children(UndoEntry* entry) {
+    ASTNode** slots[UNDO_MAX_CHILDREN];
+    int count = child_slots(entry->saved, slots);
+    
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        for (ASTNode* child = *slots[i]; child; child = child->next) total++;
+    }
+    if (total == 0) return true;
+    
+    entry->reused = malloc(total * sizeof(ASTNode*));
+    entry->reused_next = malloc(total * sizeof(ASTNode*));
+    if (!entry->reused || !entry->reused_next) {
+        free(entry->reused);
+        free(entry->reused_next);
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        for (ASTNode* child = *slots[i]; child; child = child->next) {
+            entry->reused[entry->reused_count] = child;
+            entry->reused_next[entry->reused_count] = child->next;
+            entry->reused_count++;
+        }
+    }
+    return true;
+}
+
+/* Logs `node` and overwrites it; false leaves both untouched */
+static bool record_replace(UndoLog* log, ASTNode* node, ASTNode* replacement,
+                           bool owns_children) {
+    if (log->count == log->capacity) {
+        size_t capacity = log->capacity ? log->capacity * 2 : 16;
+        UndoEntry* entries = realloc(log->entries, capacity * sizeof(UndoEntry));
+        if (!entries) return false;
+        log->entries = entries;
+        log->capacity = capacity;
+    }
+    
+    UndoEntry* entry = &log->entries[log->count];
+    memset(entry, 0, sizeof(UndoEntry));
+    entry->node = node;
+    entry->owns_children = owns_children;
+    entry->saved = malloc(sizeof(ASTNode));
+    if (!entry->saved) return false;
+    *entry->saved = *node;
+    
+    if (!owns_children && !record_children(entry)) {
+        free(entry->saved);
+        return false;
+    }
+    log->count++;
+    
+    // Same overwrite as ast_replace_in_place, minus freeing the old strings
+    ast_overwrite(node, replacement);
+    
+    free(replacement);
+    return true;
+}
+
+void undo_replace(UndoLog* log, ASTNode* node, ASTNode* replacement) {
+    if (!node || !replacement || node == replacement) return;
+    
+    if (!log || log->depth == 0) {
+        ast_replace_in_place(node, replacement);
+        return;
+    }
+    
+    // Out of memory for the log: the rewrite still happens, for good
+    if (!record_replace(log, node, replacement, false)) {
+        ast_replace_in_place(node, replacement);
+    }
+}
+
+void undo_replace_subtree(UndoLog* log, ASTNode* node, ASTNode* replacement) {
+    if (!node || !replacement || node == replacement) return;
+    
+    if (!log || log->depth == 0) {
+        ast_replace_subtree(node, replacement);
+        return;
+    }
+    
+    if (!record_replace(log, node, replacement, true)) {
+        ast_replace_subtree(node, replacement);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef OBFUSCATOR_UNDO_H
+#define OBFUSCATOR_UNDO_H
+
+#include "../common/types.h"
+#include <stddef.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Undo Log
+ *
+ * Lets a pass try a rewrite and take it back. Between a checkpoint and its
+ * commit or rollback, every node overwritten through undo_replace keeps
+ * its previous contents in the log. Rolling back frees what the rewrite
+ * built and restores those contents, newest first, so it costs as much as
+ * the rewrite did rather than a copy of the tree. Old contents are
+ * released when the outermost checkpoint commits.
+ *
+ * Outside a checkpoint, and with a NULL log, rewrites are applied
+ * directly, so passes call these unconditionally.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    ASTNode* node;             /* Overwritten in place */
+    ASTNode* saved;            /* Its previous contents, in a detached shell */
+    ASTNode** reused;          /* saved's children, which the rewrite may reuse */
+    ASTNode** reused_next;     /* ... and their `next` at the time */
+    size_t reused_count;
+    bool owns_children;        /* Subtree replacement: they are freed on commit */
+} UndoEntry;
+
+typedef struct {
+    UndoEntry* entries;
+    size_t count;
+    size_t capacity;
+    int depth;                 /* Open checkpoints */
+} UndoLog;
+
+UndoLog* undo_log_create(void);
+void undo_log_destroy(UndoLog* log);
+
+/* Opens a checkpoint; pass the result to the matching commit or rollback */
+size_t undo_checkpoint(UndoLog* log);
+void undo_commit(UndoLog* log, size_t mark);
+void undo_rollback(UndoLog* log, size_t mark);
+
+/* ast_replace_in_place: `replacement` may reuse the children of `node` */
+void undo_replace(UndoLog* log, ASTNode* node, ASTNode* replacement);
+
+/* ast_replace_subtree: the children of `node` are freed with it */
+void undo_replace_subtree(UndoLog* log, ASTNode* node, ASTNode* replacement);
+
+#endif /* OBFUSCATOR_UNDO_H */
@@ -0,0 +1,174 @@
+#include "variants.h"
+#include "../common/random.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Variant Sets
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+VariantSet* variant_set_create(void) {
+    return calloc(1, sizeof(VariantSet));
+}
+
+void variant_set_destroy(VariantSet* set) {
+    if (!set) return;
+    
+    for (int i = 0; i < set->count; i++) {
+        free(set->variants[i].output_file);
+    }
+    free(set->variants);
+    free(set);
+}
+
+bool variant_set_add(VariantSet* set, unsigned int seed, int aesthetic, int level) {
+    if (!set) return false;
+    
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 8;
+        Variant* variants = realloc(set->variants, (size_t)capacity * sizeof(Variant));
+        if (!variants) return false;
+        set->variants = variants;
+        set->capacity = capacity;
+    }
+    
+    Variant* variant = &set->variants[set->count++];
+    memset(variant, 0, sizeof(Variant));
+    variant->seed = seed;
+    variant->aesthetic = aesthetic;
+    variant->level = level;
+    return true;
+}
+
+bool variant_set_fill(VariantSet* set, int count) {
+    if (!set) return false;
+    
+    while (set->count < count) {
+        if (!variant_set_add(set, 0, VARIANT_BASE, VARIANT_BASE)) return false;
+    }
+    return true;
+}
+
+char* variant_output_name(const char* output_file, int index) {
+    if (!output_file) return NULL;
+    
+    // The extension belongs to the last path component only
+    const char* slash = strrchr(output_file, '/');
+    const char* dot = strrchr(output_file, '.');
+    if (dot && ((slash && dot < slash) || dot == output_file || dot[-1] == '/')) dot = NULL;
+    size_t stem = dot ? (size_t)(dot - output_file) : strlen(output_file);
+    
+    size_t length = strlen(output_file) + 16;
+    char* name = malloc(length);
+    if (!name) return NULL;
+    
+    snprintf(name, length, "%.*s.%d%s", (int)stem, output_file, index, dot ? dot : "");
+    return name;
+}
+
+bool variant_set_prepare(VariantSet* set, const ObfuscationConfig* base,
+                         const char* output_file) {
+    if (!set || !base || !output_file) return false;
+    
+    // Variant i gets the i-th draw whether or not its seed was given
+    Random random;
+    random_seed(&random, base->seed);
+    
+    for (int i = 0; i < set->count; i++) {
+        Variant* variant = &set->variants[i];
+        unsigned int drawn = (unsigned int)random_next(&random);
+        if (variant->seed == 0) {
+            variant->seed = drawn ? drawn : 1;
+        }
+        
+        free(variant->output_file);
+        variant->output_file = variant_output_name(output_file, i + 1);
+        if (!variant->output_file) return false;
+    }
+    return true;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Emission
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    VariantSet* set;
+    const ASTSnapshot* snapshot;
+    const ObfuscationConfig* base;
+    pthread_mutex_t lock;
+    int next;                  /* First variant no worker has taken */
+} VariantQueue;
+
+static void emit_variant(const VariantQueue* queue, Variant* variant) {
+    variant->ok = false;
+    variant->size = 0;
+    
+    ObfuscationConfig* config = config_clone(queue->base);
+    if (!config) return;
+    
+    config->seed = variant->seed;
+    if (variant->aesthetic != VARIANT_BASE) {
+        config_set_aesthetic(config, (AestheticStyle)variant->aesthetic);
+    }
+    if (variant->level != VARIANT_BASE) {
+        config->level = (ObfuscationLevel)variant->level;
+    }
+    
+    variant->ok = snapshot_render_file(queue->snapshot, config, NULL, variant->output_file,
+                                       &variant->size);
+    config_destroy(config);
+}
+
+static void* variant_worker(void* arg) {
+    VariantQueue* queue = arg;
+    
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int index = queue->next < queue->set->count ? queue->next++ : -1;
+        pthread_mutex_unlock(&queue->lock);
+        if (index < 0) return NULL;
+        
+        emit_variant(queue, &queue->set->variants[index]);
+    }
+}
+
+static int default_jobs(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+int variants_emit(VariantSet* set, const ASTSnapshot* snapshot,
+                  const ObfuscationConfig* base, int jobs) {
+    if (!set) return 0;
+    if (!snapshot || !base) return set->count;
+    
+    VariantQueue queue = { set, snapshot, base, PTHREAD_MUTEX_INITIALIZER, 0 };
+    
+    if (jobs <= 0) jobs = default_jobs();
+    if (jobs > set->count) jobs = set->count;
+    
+    // The calling thread is the last worker
+    pthread_t* threads = jobs > 1 ? malloc((size_t)(jobs - 1) * sizeof(pthread_t)) : NULL;
+    int started = 0;
+    while (threads && started < jobs - 1 &&
+           pthread_create(&threads[started], NULL, variant_worker, &queue) == 0) {
+        started++;
+    }
+    
+    variant_worker(&queue);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+    
+    int failed = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (!set->variants[i].ok) failed++;
+    }
+    return failed;
+}
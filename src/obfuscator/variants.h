@@ -0,0 +1,59 @@
+#ifndef OBFUSCATOR_VARIANTS_H
+#define OBFUSCATOR_VARIANTS_H
+
+#include "snapshot.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Multi-Variant Emission
+ *
+ * Emits several differently obfuscated builds of one snapshot in a single
+ * process. Every variant is the base configuration with its own seed, and
+ * optionally its own style and level; seeds not given explicitly are
+ * drawn from the base seed in variant order before any work starts, so
+ * a base seed reproduces the whole set whatever the scheduling.
+ *
+ * Variants are spread over a pool of worker threads. Each one checks out
+ * the shared snapshot, renders with its own context and code generator,
+ * and writes its file; nothing else is shared between workers.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define VARIANT_BASE (-1)      /* Style or level taken from the base config */
+
+typedef struct {
+    unsigned int seed;         /* 0 = drawn from the base seed */
+    int aesthetic;             /* AestheticStyle or VARIANT_BASE */
+    int level;                 /* ObfuscationLevel or VARIANT_BASE */
+    char* output_file;
+
+    // Filled in by variants_emit
+    bool ok;
+    size_t size;               /* Bytes written */
+} Variant;
+
+typedef struct {
+    Variant* variants;
+    int count;
+    int capacity;
+} VariantSet;
+
+VariantSet* variant_set_create(void);
+void variant_set_destroy(VariantSet* set);
+
+bool variant_set_add(VariantSet* set, unsigned int seed, int aesthetic, int level);
+
+/* Adds base-config variants until the set holds `count` */
+bool variant_set_fill(VariantSet* set, int count);
+
+/* Draws missing seeds from `base` and names each output after
+ * `output_file`: out.c → out.1.c, out.2.c, ... */
+bool variant_set_prepare(VariantSet* set, const ObfuscationConfig* base,
+                         const char* output_file);
+
+/* Renders and writes every variant on up to `jobs` threads (0: one per
+ * online CPU); returns how many failed */
+int variants_emit(VariantSet* set, const ASTSnapshot* snapshot,
+                  const ObfuscationConfig* base, int jobs);
+
+char* variant_output_name(const char* output_file, int index);
+
+#endif /* OBFUSCATOR_VARIANTS_H */
@@ -0,0 +1,839 @@
+#include "virtualize.h"
+#include "ast_utils.h"
+#include "../parser/parser.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Compiler State
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+#define LOOP_DEPTH 64
+
+typedef struct {
+    const char* name;
+    int reg;
+    int depth;
+} VMLocal;
+
+typedef struct {
+    int* code;                 /* Jump operands hold label numbers until resolved */
+    int count;
+    int capacity;
+    
+    int* labels;               /* Code offset per label; -1 until placed */
+    int label_count;
+    int label_capacity;
+    
+    VMLocal locals[VM_REGISTERS];
+    int local_count;
+    int depth;
+    int next_register;         /* Temporaries sit above the innermost local */
+    
+    int loop_exit[LOOP_DEPTH];
+    int loop_depth;
+    
+    char* frame;               /* Stub variable holding the registers */
+    ASTNode* sites;            /* Stub case per call site */
+    int site_count;
+    
+    bool failed;
+} VMCompiler;
+
+static void emit(VMCompiler* c, VMOpcode opcode, int x, int y, int z) {
+    if (c->failed) return;
+    
+    if (c->count + 4 > c->capacity) {
+        int capacity = c->capacity ? c->capacity * 2 : 64;
+        int* code = realloc(c->code, capacity * sizeof(int));
+        if (!code) {
+            c->failed = true;
+            return;
+        }
+        c->code = code;
+        c->capacity = capacity;
+    }
+    
+    int operands = vm_opcode_operands(opcode, NULL);
+    int words[3] = { x, y, z };
+    c->code[c->count++] = opcode;
+    for (int i = 0; i < operands; i++) {
+        c->code[c->count++] = words[i];
+    }
+}
+
+static int new_label(VMCompiler* c) {
+    if (c->label_count == c->label_capacity) {
+        int capacity = c->label_capacity ? c->label_capacity * 2 : 16;
+        int* labels = realloc(c->labels, capacity * sizeof(int));
+        if (!labels) {
+            c->failed = true;
+            return 0;
+        }
+        c->labels = labels;
+        c->label_capacity = capacity;
+    }
+    
+    c->labels[c->label_count] = -1;
+    return c->label_count++;
+}
+
+static void place_label(VMCompiler* c, int label) {
+    if (!c->failed) c->labels[label] = c->count;
+}
+
+/* Replaces label numbers in jump operands by code offsets */
+static void resolve_labels(VMCompiler* c) {
+    for (int pc = 0; pc < c->count && !c->failed; ) {
+        bool jump;
+        int operands = vm_opcode_operands((VMOpcode)c->code[pc], &jump);
+        if (jump) {
+            int offset = c->labels[c->code[pc + operands]];
+            if (offset < 0) c->failed = true;
+            c->code[pc + operands] = offset;
+        }
+        pc += 1 + operands;
+    }
+}
+
+static int temporary(VMCompiler* c) {
+    if (c->next_register >= VM_REGISTERS) {
+        c->failed = true;
+        return 0;
+    }
+    return c->next_register++;
+}
+
+static int target(VMCompiler* c, int dst) {
+    return dst >= 0 ? dst : temporary(c);
+}
+
+static int lookup(const VMCompiler* c, const char* name) {
+    for (int i = c->local_count - 1; i >= 0; i--) {
+        if (strcmp(c->locals[i].name, name) == 0) return c->locals[i].reg;
+    }
+    return -1;
+}
+
+static void declare(VMCompiler* c, const char* name, int reg) {
+    if (c->local_count == VM_REGISTERS) {
+        c->failed = true;
+        return;
+    }
+    c->locals[c->local_count++] = (VMLocal){ name, reg, c->depth };
+}
+
+/* First register free once every temporary is released */
+static int scope_top(const VMCompiler* c) {
+    return c->local_count > 0 ? c->locals[c->local_count - 1].reg + 1 : 0;
+}
+
+/* Only plain int keeps C's semantics on wrapping registers */
+static bool is_int_type(const char* type) {
+    return type && (strcmp(type, "int") == 0 || strcmp(type, "signed int") == 0 ||
+                    strcmp(type, "signed") == 0);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Operators
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+typedef struct {
+    const char* op;
+    VMOpcode reg;
+    VMOpcode imm;              /* VM_OP_COUNT = no immediate form */
+    bool negate;               /* Immediate form adds the negated literal */
+} ArithmeticOp;
+
+static const ArithmeticOp arithmetic_ops[] = {
+    { "+",  VM_OP_ADD, VM_OP_ADDI,  false },
+    { "-",  VM_OP_SUB, VM_OP_ADDI,  true },
+    { "*",  VM_OP_MUL, VM_OP_MULI,  false },
+    { "/",  VM_OP_DIV, VM_OP_COUNT, false },
+    { "%",  VM_OP_MOD, VM_OP_COUNT, false },
+    { "&",  VM_OP_AND, VM_OP_ANDI,  false },
+    { "|",  VM_OP_OR,  VM_OP_COUNT, false },
+    { "^",  VM_OP_XOR, VM_OP_COUNT, false },
+    { "<<", VM_OP_SHL, VM_OP_COUNT, false },
+    { ">>", VM_OP_SHR, VM_OP_COUNT, false },
+};
+
+typedef struct {
+    const char* op;
+    VMOpcode value;
+    VMOpcode jump;             /* Taken when the comparison holds */
+    VMOpcode inverse;          /* Taken when it fails */
+} ComparisonOp;
+
+static const ComparisonOp comparison_ops[] = {
+    { "==", VM_OP_EQ, VM_OP_JEQ, VM_OP_JNE },
+    { "!=", VM_OP_NE, VM_OP_JNE, VM_OP_JEQ },
+    { "<",  VM_OP_LT, VM_OP_JLT, VM_OP_JGE },
+    { "<=", VM_OP_LE, VM_OP_JLE, VM_OP_JGT },
+    { ">",  VM_OP_GT, VM_OP_JGT, VM_OP_JLE },
+    { ">=", VM_OP_GE, VM_OP_JGE, VM_OP_JLT },
+};
+
+static const ArithmeticOp* find_arithmetic(const char* op, size_t length) {
+    for (size_t i = 0; i < sizeof(arithmetic_ops) / sizeof(arithmetic_ops[0]); i++) {
+        const char* name = arithmetic_ops[i].op;
+        if (strlen(name) == length && strncmp(name, op, length) == 0) return &arithmetic_ops[i];
+    }
+    return NULL;
+}
+
+static const ComparisonOp* find_comparison(const char* op) {
+    for (size_t i = 0; i < sizeof(comparison_ops) / sizeof(comparison_ops[0]); i++) {
+        if (strcmp(comparison_ops[i].op, op) == 0) return &comparison_ops[i];
+    }
+    return NULL;
+}
+
+/* `=` and the compound forms, not the comparisons that also end in '=' */
+static bool is_assignment(const char* op) {
+    size_t length = strlen(op);
+    if (length == 0 || op[length - 1] != '=') return false;
+    return length == 1 || !find_comparison(op);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Host Calls
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* frame_address(const VMCompiler* c) {
+    return ast_create_unary_op("&", ast_create_identifier(c->frame), true);
+}
+
+/* __obf_vm_reg(&frame, reg) */
+static ASTNode* register_read(const VMCompiler* c, int reg) {
+    return ast_create_call(ast_create_identifier("__obf_vm_reg"),
+                           ast_link(frame_address(c), ast_create_literal_number(reg)));
+}
+
+/* __obf_vm_set(&frame, reg, value) */
+static ASTNode* register_write(const VMCompiler* c, int reg, ASTNode* value) {
+    ASTNode* arguments = ast_link(frame_address(c), ast_create_literal_number(reg));
+    return ast_create_call(ast_create_identifier("__obf_vm_set"), ast_link(arguments, value));
+}
+
+/* Whether evaluating `node` needs a register; such arguments are computed
+ * by the bytecode, the rest stay host expressions */
+static bool reads_locals(const VMCompiler* c, const ASTNode* node) {
+    if (!node) return false;
+    
+    switch (node->type) {
+        case NODE_IDENTIFIER:
+            return lookup(c, node->data.identifier.name) >= 0;
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+            if (reads_locals(c, node->data.binary.left)) return true;
+            for (const ASTNode* right = node->data.binary.right; right; right = right->next) {
+                if (reads_locals(c, right)) return true;
+            }
+            return false;
+        case NODE_UNARY_OP:
+            return reads_locals(c, node->data.unary.operand);
+        case NODE_CALL:
+            if (reads_locals(c, node->data.call.function)) return true;
+            for (const ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                if (reads_locals(c, arg)) return true;
+            }
+            return false;
+        case NODE_LITERAL:
+        case NODE_SIZEOF:
+            return false;
+        default:
+            // Statement expressions and the like may declare anything
+            return true;
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Expressions
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static int compile_expression(VMCompiler* c, ASTNode* node, int dst);
+static void compile_branch(VMCompiler* c, ASTNode* condition, bool when, int label);
+
+static int move_to(VMCompiler* c, int reg, int dst) {
+    if (dst < 0 || dst == reg) return reg;
+    
+    emit(c, VM_OP_MOV, dst, reg, 0);
+    return dst;
+}
+
+/* Yields to the host, which performs the call and stores its value */
+static int compile_call(VMCompiler* c, ASTNode* node, int dst, bool want) {
+    ASTNode* callee = node->data.call.function;
+    if (!callee || callee->type != NODE_IDENTIFIER || lookup(c, callee->data.identifier.name) >= 0) {
+        c->failed = true;
+        return 0;
+    }
+    
+    // A result lands in an int register; only calls typing_annotate() found
+    // to return int may produce one, anything else stays native
+    if (want && !(node->flags & AST_FLAG_INT)) {
+        c->failed = true;
+        return 0;
+    }
+    
+    ASTNode* arguments = NULL;
+    for (ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+        if (!reads_locals(c, arg)) {
+            arguments = ast_link(arguments, ast_copy(arg));
+        } else {
+            arguments = ast_link(arguments, register_read(c, compile_expression(c, arg, -1)));
+        }
+    }
+    
+    int site = c->site_count++;
+    emit(c, VM_OP_CALL, site, 0, 0);
+    
+    ASTNode* call = ast_create_call(ast_copy(callee), arguments);
+    int result = 0;
+    if (want) {
+        result = target(c, dst);
+        call = register_write(c, result, call);
+    }
+    
+    c->sites = ast_link(c->sites, ast_create_case(ast_create_literal_number(site),
+                                                  ast_link(call, ast_create_break())));
+    return result;
+}
+
+static int compile_arithmetic(VMCompiler* c, const ArithmeticOp* op, int left, ASTNode* right,
+                              int dst) {
+    int value;
+    if (op->imm != VM_OP_COUNT && ast_literal_int_value(right, &value)) {
+        int d = target(c, dst);
+        emit(c, op->imm, d, left, op->negate ? -value : value);
+        return d;
+    }
+    
+    int b = compile_expression(c, right, -1);
+    int d = target(c, dst);
+    emit(c, op->reg, d, left, b);
+    return d;
+}
+
+static int compile_assignment(VMCompiler* c, ASTNode* node, int dst) {
+    ASTNode* left = node->data.binary.left;
+    const char* op = node->data.binary.operator;
+    int reg = left && left->type == NODE_IDENTIFIER ? lookup(c, left->data.identifier.name) : -1;
+    if (reg < 0) {
+        c->failed = true;
+        return 0;
+    }
+    
+    if (strcmp(op, "=") == 0) {
+        compile_expression(c, node->data.binary.right, reg);
+    } else {
+        const ArithmeticOp* arithmetic = find_arithmetic(op, strlen(op) - 1);
+        if (!arithmetic) {
+            c->failed = true;
+            return 0;
+        }
+        compile_arithmetic(c, arithmetic, reg, node->data.binary.right, reg);
+    }
+    return move_to(c, reg, dst);
+}
+
+/* Multi-step results go through a temporary so that `dst` is never
+ * written before every operand has been read */
+static int compile_logical(VMCompiler* c, ASTNode* node, int dst) {
+    bool conjunction = strcmp(node->data.binary.operator, "&&") == 0;
+    int t = temporary(c);
+    int end = new_label(c);
+    
+    emit(c, VM_OP_BOOL, t, compile_expression(c, node->data.binary.left, -1), 0);
+    emit(c, conjunction ? VM_OP_JZ : VM_OP_JNZ, t, end, 0);
+    emit(c, VM_OP_BOOL, t, compile_expression(c, node->data.binary.right, -1), 0);
+    place_label(c, end);
+    return move_to(c, t, dst);
+}
+
+static int compile_ternary(VMCompiler* c, ASTNode* node, int dst) {
+    ASTNode* then_expr = node->data.binary.right;
+    if (!then_expr || !then_expr->next) {
+        c->failed = true;
+        return 0;
+    }
+    
+    int t = temporary(c);
+    int otherwise = new_label(c);
+    int end = new_label(c);
+    
+    compile_branch(c, node->data.binary.left, false, otherwise);
+    compile_expression(c, then_expr, t);
+    emit(c, VM_OP_JMP, end, 0, 0);
+    place_label(c, otherwise);
+    compile_expression(c, then_expr->next, t);
+    place_label(c, end);
+    return move_to(c, t, dst);
+}
+
+static int compile_binary(VMCompiler* c, ASTNode* node, int dst) {
+    const char* op = node->data.binary.operator;
+    if (!op) {
+        c->failed = true;
+        return 0;
+    }
+    
+    if (strcmp(op, "?:") == 0) return compile_ternary(c, node, dst);
+    if (strcmp(op, "&&") == 0 || strcmp(op, "||") == 0) return compile_logical(c, node, dst);
+    if (node->type == NODE_ASSIGNMENT || is_assignment(op)) return compile_assignment(c, node, dst);
+    
+    const ComparisonOp* comparison = find_comparison(op);
+    if (comparison) {
+        int a = compile_expression(c, node->data.binary.left, -1);
+        int b = compile_expression(c, node->data.binary.right, -1);
+        int d = target(c, dst);
+        emit(c, comparison->value, d, a, b);
+        return d;
+    }
+    
+    const ArithmeticOp* arithmetic = find_arithmetic(op, strlen(op));
+    if (!arithmetic) {
+        c->failed = true;
+        return 0;
+    }
+    int a = compile_expression(c, node->data.binary.left, -1);
+    return compile_arithmetic(c, arithmetic, a, node->data.binary.right, dst);
+}
+
+/* `discard` compiles x++ like ++x when nothing reads the old value */
+static int compile_unary(VMCompiler* c, ASTNode* node, int dst, bool discard) {
+    const char* op = node->data.unary.operator;
+    ASTNode* operand = node->data.unary.operand;
+    
+    if (strcmp(op, "+") == 0) return compile_expression(c, operand, dst);
+    
+    if (strcmp(op, "++") == 0 || strcmp(op, "--") == 0) {
+        int reg = operand && operand->type == NODE_IDENTIFIER ?
+                  lookup(c, operand->data.identifier.name) : -1;
+        if (reg < 0) {
+            c->failed = true;
+            return 0;
+        }
+        
+        int delta = op[0] == '+' ? 1 : -1;
+        if (node->data.unary.is_prefix || discard) {
+            emit(c, VM_OP_ADDI, reg, reg, delta);
+            return move_to(c, reg, dst);
+        }
+        
+        int old = temporary(c);
+        emit(c, VM_OP_MOV, old, reg, 0);
+        emit(c, VM_OP_ADDI, reg, reg, delta);
+        return move_to(c, old, dst);
+    }
+    
+    VMOpcode opcode;
+    if (strcmp(op, "-") == 0) {
+        opcode = VM_OP_NEG;
+    } else if (strcmp(op, "!") == 0) {
+        opcode = VM_OP_NOT;
+    } else if (strcmp(op, "~") == 0) {
+        opcode = VM_OP_INV;
+    } else {
+        // Pointers never reach a register
+        c->failed = true;
+        return 0;
+    }
+    
+    int s = compile_expression(c, operand, -1);
+    int d = target(c, dst);
+    emit(c, opcode, d, s, 0);
+    return d;
+}
+
+/* Register holding the value of `node`; `dst` when it is not negative */
+static int compile_expression(VMCompiler* c, ASTNode* node, int dst) {
+    if (!node || c->failed) {
+        c->failed = true;
+        return 0;
+    }
+    
+    switch (node->type) {
+        case NODE_LITERAL: {
+            int value;
+            if (!ast_literal_int_value(node, &value)) break;
+            
+            int d = target(c, dst);
+            emit(c, VM_OP_LOADI, d, value, 0);
+            return d;
+        }
+        
+        case NODE_IDENTIFIER: {
+            int reg = lookup(c, node->data.identifier.name);
+            if (reg < 0) break;
+            return move_to(c, reg, dst);
+        }
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+            return compile_binary(c, node, dst);
+        
+        case NODE_UNARY_OP:
+            return compile_unary(c, node, dst, false);
+        
+        case NODE_CALL:
+            return compile_call(c, node, dst, true);
+        
+        default:
+            break;
+    }
+    
+    c->failed = true;
+    return 0;
+}
+
+/* Jumps to `label` when the truth of `condition` equals `when`; compares
+ * fuse with the branch and && / || never materialize a value */
+static void compile_branch(VMCompiler* c, ASTNode* condition, bool when, int label) {
+    if (!condition) {
+        c->failed = true;
+        return;
+    }
+    
+    int value;
+    if (ast_literal_int_value(condition, &value)) {
+        if ((value != 0) == when) emit(c, VM_OP_JMP, label, 0, 0);
+        return;
+    }
+    
+    if (condition->type == NODE_UNARY_OP && strcmp(condition->data.unary.operator, "!") == 0) {
+        compile_branch(c, condition->data.unary.operand, !when, label);
+        return;
+    }
+    
+    if (condition->type == NODE_BINARY_OP && condition->data.binary.operator) {
+        const char* op = condition->data.binary.operator;
+        ASTNode* left = condition->data.binary.left;
+        ASTNode* right = condition->data.binary.right;
+        
+        // The jump is taken on the first operand's value unless both decide
+        bool conjunction = strcmp(op, "&&") == 0;
+        if (conjunction || strcmp(op, "||") == 0) {
+            if (conjunction != when) {
+                compile_branch(c, left, when, label);
+                compile_branch(c, right, when, label);
+            } else {
+                int skip = new_label(c);
+                compile_branch(c, left, !when, skip);
+                compile_branch(c, right, when, label);
+                place_label(c, skip);
+            }
+            return;
+        }
+        
+        const ComparisonOp* comparison = find_comparison(op);
+        if (comparison) {
+            int a = compile_expression(c, left, -1);
+            int b = compile_expression(c, right, -1);
+            emit(c, when ? comparison->jump : comparison->inverse, a, b, label);
+            return;
+        }
+    }
+    
+    int reg = compile_expression(c, condition, -1);
+    emit(c, when ? VM_OP_JNZ : VM_OP_JZ, reg, label, 0);
+}
+
+/* Expression statement; its value is dropped */
+static void compile_effect(VMCompiler* c, ASTNode* node) {
+    if (node->type == NODE_CALL) {
+        compile_call(c, node, -1, false);
+    } else if (node->type == NODE_UNARY_OP) {
+        compile_unary(c, node, -1, true);
+    } else {
+        compile_expression(c, node, -1);
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Statements
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static void compile_statement(VMCompiler* c, ASTNode* node);
+
+static void enter_scope(VMCompiler* c) {
+    c->depth++;
+}
+
+static void leave_scope(VMCompiler* c) {
+    while (c->local_count > 0 && c->locals[c->local_count - 1].depth == c->depth) {
+        c->local_count--;
+    }
+    c->depth--;
+    c->next_register = scope_top(c);
+}
+
+static void compile_declaration(VMCompiler* c, ASTNode* node) {
+    if (node->data.variable.is_static || !is_int_type(node->data.variable.type)) {
+        c->failed = true;
+        return;
+    }
+    
+    // The initializer still sees an outer variable of the same name
+    int reg = temporary(c);
+    if (node->data.variable.initializer) {
+        compile_expression(c, node->data.variable.initializer, reg);
+    }
+    declare(c, node->data.variable.name, reg);
+}
+
+/* Loops are rotated: the test sits after the body, so each iteration
+ * takes one fused compare-and-branch */
+static void compile_loop(VMCompiler* c, ASTNode* condition, ASTNode* body, ASTNode* update) {
+    if (c->loop_depth == LOOP_DEPTH) {
+        c->failed = true;
+        return;
+    }
+    
+    int top = new_label(c);
+    int test = new_label(c);
+    int exit = new_label(c);
+    
+    emit(c, VM_OP_JMP, test, 0, 0);
+    place_label(c, top);
+    
+    c->loop_exit[c->loop_depth++] = exit;
+    compile_statement(c, body);
+    c->loop_depth--;
+    
+    if (update) {
+        compile_effect(c, update);
+        c->next_register = scope_top(c);
+    }
+    
+    place_label(c, test);
+    if (condition) {
+        compile_branch(c, condition, true, top);
+    } else {
+        emit(c, VM_OP_JMP, top, 0, 0);
+    }
+    place_label(c, exit);
+}
+
+static void compile_statement(VMCompiler* c, ASTNode* node) {
+    if (!node || c->failed) return;
+    
+    switch (node->type) {
+        case NODE_VARIABLE:
+            compile_declaration(c, node);
+            break;
+        
+        case NODE_BLOCK:
+            enter_scope(c);
+            for (ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+                compile_statement(c, stmt);
+            }
+            leave_scope(c);
+            break;
+        
+        case NODE_IF: {
+            int otherwise = new_label(c);
+            compile_branch(c, node->data.if_stmt.condition, false, otherwise);
+            compile_statement(c, node->data.if_stmt.then_stmt);
+            
+            if (node->data.if_stmt.else_stmt) {
+                int end = new_label(c);
+                emit(c, VM_OP_JMP, end, 0, 0);
+                place_label(c, otherwise);
+                compile_statement(c, node->data.if_stmt.else_stmt);
+                place_label(c, end);
+            } else {
+                place_label(c, otherwise);
+            }
+            break;
+        }
+        
+        case NODE_WHILE:
+            compile_loop(c, node->data.while_stmt.condition, node->data.while_stmt.body, NULL);
+            break;
+        
+        case NODE_FOR:
+            // A declaration in the init clause is scoped to the loop
+            enter_scope(c);
+            if (node->data.for_stmt.init) {
+                if (node->data.for_stmt.init->type == NODE_VARIABLE) {
+                    compile_declaration(c, node->data.for_stmt.init);
+                } else {
+                    compile_effect(c, node->data.for_stmt.init);
+                }
+                c->next_register = scope_top(c);
+            }
+            compile_loop(c, node->data.for_stmt.condition, node->data.for_stmt.body,
+                         node->data.for_stmt.update);
+            leave_scope(c);
+            break;
+        
+        case NODE_BREAK:
+            if (c->loop_depth == 0) {
+                c->failed = true;
+                break;
+            }
+            emit(c, VM_OP_JMP, c->loop_exit[c->loop_depth - 1], 0, 0);
+            break;
+        
+        case NODE_RETURN:
+            emit(c, VM_OP_HALT, 0, 0, 0);
+            break;
+        
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_UNARY_OP:
+        case NODE_CALL:
+        case NODE_IDENTIFIER:
+        case NODE_LITERAL:
+            compile_effect(c, node);
+            break;
+        
+        default:
+            // switch, goto, labels and statement expressions
+            c->failed = true;
+            break;
+    }
+    
+    c->next_register = scope_top(c);
+}
+
+static void compiler_release(VMCompiler* c) {
+    free(c->code);
+    free(c->labels);
+    ast_tree_destroy(c->sites);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Host Stub
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* run_call(const VMCompiler* c, int entry) {
+    return ast_create_call(ast_create_identifier("__obf_vm_run"),
+                           ast_link(frame_address(c), ast_create_literal_number(entry)));
+}
+
+/* Frame, parameter loads, then the run/call loop when anything is called */
+static ASTNode* build_stub(ObfuscationContext* ctx, VMCompiler* c, ASTNode* parameters,
+                           int entry) {
+    ASTNode* stub = ast_create_variable(c->frame, "__obf_vm_frame", NULL);
+    
+    int reg = 0;
+    for (ASTNode* param = parameters; param; param = param->next) {
+        stub = ast_link(stub, register_write(c, reg++,
+                                             ast_create_identifier(param->data.variable.name)));
+    }
+    
+    if (c->site_count == 0) return ast_link(stub, run_call(c, entry));
+    
+    char* site = obfuscator_fresh_temp_name(ctx);
+    if (!site) {
+        ast_tree_destroy(stub);
+        return NULL;
+    }
+    
+    ASTNode* resume = ast_create_assignment(ast_create_identifier(site), run_call(c, -1));
+    ASTNode* dispatch = ast_create_switch(ast_create_identifier(site), c->sites);
+    c->sites = NULL;
+    
+    ASTNode* loop = ast_create_while(
+        ast_create_binary_op(">=", ast_create_identifier(site), ast_create_literal_number(0)),
+        ast_create_block(ast_link(dispatch, resume)));
+    stub = ast_link(stub, ast_link(ast_create_variable(site, "int", run_call(c, entry)), loop));
+    
+    free(site);
+    return stub;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Pass Entry Point
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static size_t count_list(const ASTNode* list) {
+    size_t count = 0;
+    for (; list; list = list->next) {
+        count += ast_count_nodes(list);
+    }
+    return count;
+}
+
+bool virtualize_function(ObfuscationContext* ctx, ASTNode* function, VirtualizeStats* stats) {
+    if (!ctx || !ctx->bytecode || !function || function->type != NODE_FUNCTION) return false;
+    
+    ASTNode* body = function->data.function.body;
+    const char* return_type = function->data.function.return_type;
+    if (!body || body->type != NODE_BLOCK || !return_type || strcmp(return_type, "void") != 0) {
+        return false;
+    }
+    
+    VMCompiler c = {0};
+    c.frame = obfuscator_fresh_temp_name(ctx);
+    if (!c.frame) return false;
+    
+    // Parameters take the first registers, in order
+    ASTNode* parameters = function->data.function.parameters;
+    for (ASTNode* param = parameters; param; param = param->next) {
+        if (param->type != NODE_PARAMETER || !is_int_type(param->data.variable.type)) {
+            c.failed = true;
+            break;
+        }
+        declare(&c, param->data.variable.name, temporary(&c));
+    }
+    
+    compile_statement(&c, body);
+    emit(&c, VM_OP_HALT, 0, 0, 0);
+    resolve_labels(&c);
+    
+    // The stub is sized before anything is committed: a small body, say
+    // one call, grows by the whole run/call loop
+    int entry = ctx->bytecode->count;
+    ASTNode* stub = c.failed ? NULL : build_stub(ctx, &c, parameters, entry);
+    long growth = stub ? (long)count_list(stub) - (long)count_list(body->data.block.statements) : 0;
+    if (!stub || !budget_allows(ctx->budget, growth) ||
+        vm_program_append(ctx->bytecode, c.code, c.count) != entry) {
+        ast_tree_destroy(stub);
+        free(c.frame);
+        compiler_release(&c);
+        return false;
+    }
+    budget_charge(ctx->budget, growth);
+    
+    ast_tree_destroy(body->data.block.statements);
+    body->data.block.statements = stub;
+    
+    if (stats) {
+        stats->functions++;
+        stats->words += c.count;
+        stats->call_sites += c.site_count;
+    }
+    
+    free(c.frame);
+    compiler_release(&c);
+    return true;
+}
+
+/* Hot code keeps native speed: a cap from a pragma or profile, or a
+ * static estimate above the limit, refuses the annotation */
+static bool may_virtualize(const ObfuscationContext* ctx, const ASTNode* function) {
+    if (!(function->flags & AST_FLAG_VIRTUALIZE)) return false;
+    if (obfuscator_effective_level(ctx, function) < OBF_EXTREME) return false;
+    return !ctx->config->static_hotness || function->hotness <= VIRTUALIZE_MAX_HOTNESS;
+}
+
+bool virtualize_functions(ObfuscationContext* ctx, ASTNode* ast) {
+    if (!ctx || !ast) return false;
+    
+    ASTNode* list = ast->type == NODE_PROGRAM ? ast->data.program.declarations : ast;
+    for (ASTNode* node = list; node; node = node->next) {
+        if (node->type == NODE_FUNCTION && may_virtualize(ctx, node)) {
+            // Only the stub counts against the budget; bytecode is not AST
+            budget_enter(ctx->budget, node);
+            virtualize_function(ctx, node, NULL);
+            budget_enter(ctx->budget, NULL);
+        }
+    }
+    
+    ctx->pass_count++;
+    return true;
+}
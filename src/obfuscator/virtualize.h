@@ -0,0 +1,51 @@
+#ifndef OBFUSCATOR_VIRTUALIZE_H
+#define OBFUSCATOR_VIRTUALIZE_H
+
+#include "obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Bytecode Virtualization
+ *
+ * Functions annotated `virtualize` are compiled to register-machine
+ * bytecode (see VMOpcode) and their body is replaced by a host stub that
+ * loads the parameters into a frame and runs the shared interpreter:
+ *
+ *     __obf_vm_frame f;
+ *     __obf_vm_set(&f, 0, a);
+ *     int s = __obf_vm_run(&f, ENTRY);
+ *     while (s >= 0) {
+ *         switch (s) { case 0: __obf_vm_set(&f, 3, g(__obf_vm_reg(&f, 2))); break; }
+ *         s = __obf_vm_run(&f, -1);
+ *     }
+ *
+ * Each call site becomes a case of the stub, so callees keep their real
+ * signatures; arguments that read no locals stay host expressions.
+ *
+ * The subset is void functions over int parameters and locals: integer
+ * arithmetic, comparisons, logical operators, assignments, ++/--, calls
+ * (used values only from functions declared to return int),
+ * if/while/for/break/return. Anything else (pointers, globals in
+ * bytecode, switch, goto) leaves the function unchanged. So do a level
+ * cap from a pragma or profile and static hotness above
+ * VIRTUALIZE_MAX_HOTNESS: the interpreter is meant for licensing and
+ * validation code that runs a handful of times.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Estimated runs per program run; code inside a loop is refused */
+#define VIRTUALIZE_MAX_HOTNESS 4.0f
+
+typedef struct {
+    int functions;             /* Replaced by a stub */
+    int words;                 /* Bytecode emitted */
+    int call_sites;
+} VirtualizeStats;
+
+/* Compiles one function and replaces its body, charging the stub's growth
+ * to ctx->budget; false when it was left unchanged, also when the stub
+ * would not fit. Does not check the annotation, level or hotness. */
+bool virtualize_function(ObfuscationContext* ctx, ASTNode* function, VirtualizeStats* stats);
+
+/* Pass entry point: every annotated function that qualifies */
+bool virtualize_functions(ObfuscationContext* ctx, ASTNode* ast);
+
+#endif /* OBFUSCATOR_VIRTUALIZE_H */
@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "../symbols/symbols.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,6 +32,8 @@ typedef enum {
  * Parser State Management
  * ═══════════════════════════════════════════════════════════════════════════ */
 
+static void parser_skip_annotations(ParserState* parser);
+
 ParserState* parser_create(Token* tokens) {
     ParserState* parser = malloc(sizeof(ParserState));
     if (!parser) return NULL;
@@ -40,7 +43,12 @@ ParserState* parser_create(Token* tokens) {
     parser->symbol_table = symbol_table_create();
     parser->errors = NULL;
     parser->error_count = 0;
+    parser->level_cap = 0;
+    parser->pragma_depth = 0;
+    parser->pending_no_obf = false;
+    parser->pending_virtualize = false;
     
+    parser_skip_annotations(parser);
     return parser;
 }
 
@@ -48,7 +56,14 @@ void parser_destroy(ParserState* parser) {
     if (!parser) return;
     
     symbol_table_destroy(parser->symbol_table);
-    // TODO: Free error list
+    
+    Error* error = parser->errors;
+    while (error) {
+        Error* next = error->next;
+        free(error->message);
+        free(error);
+        error = next;
+    }
     free(parser);
 }
 
@@ -76,67 +91,90 @@ void ast_node_destroy(ASTNode* node) {
         case NODE_FUNCTION:
             free(node->data.function.name);
             free(node->data.function.return_type);
-            ast_node_destroy(node->data.function.parameters);
+            ast_tree_destroy(node->data.function.parameters);
             ast_node_destroy(node->data.function.body);
             break;
-            
+        
         case NODE_VARIABLE:
+        case NODE_PARAMETER:
             free(node->data.variable.name);
             free(node->data.variable.type);
             ast_node_destroy(node->data.variable.initializer);
             break;
-            
+        
         case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+        case NODE_ARRAY_ACCESS:
             free(node->data.binary.operator);
             ast_node_destroy(node->data.binary.left);
-            ast_node_destroy(node->data.binary.right);
+            ast_tree_destroy(node->data.binary.right);
             break;
-            
+        
         case NODE_UNARY_OP:
             free(node->data.unary.operator);
             ast_node_destroy(node->data.unary.operand);
             break;
-            
+        
         case NODE_CALL:
             ast_node_destroy(node->data.call.function);
-            ast_node_destroy(node->data.call.arguments);
+            ast_tree_destroy(node->data.call.arguments);
             break;
-            
+        
         case NODE_IF:
             ast_node_destroy(node->data.if_stmt.condition);
             ast_node_destroy(node->data.if_stmt.then_stmt);
             ast_node_destroy(node->data.if_stmt.else_stmt);
             break;
-            
+        
         case NODE_WHILE:
             ast_node_destroy(node->data.while_stmt.condition);
             ast_node_destroy(node->data.while_stmt.body);
             break;
-            
+        
         case NODE_FOR:
             ast_node_destroy(node->data.for_stmt.init);
             ast_node_destroy(node->data.for_stmt.condition);
             ast_node_destroy(node->data.for_stmt.update);
             ast_node_destroy(node->data.for_stmt.body);
             break;
-            
+        
         case NODE_BLOCK:
-            ast_node_destroy(node->data.block.statements);
+            ast_tree_destroy(node->data.block.statements);
             break;
-            
+        
+        case NODE_STMT_EXPR:
+            ast_tree_destroy(node->data.block.statements);
+            break;
+        
+        case NODE_SWITCH:
+            ast_node_destroy(node->data.switch_stmt.expression);
+            ast_tree_destroy(node->data.switch_stmt.cases);
+            break;
+        
+        case NODE_CASE:
+            ast_node_destroy(node->data.case_stmt.value);
+            ast_tree_destroy(node->data.case_stmt.statements);
+            break;
+        
+        case NODE_GOTO:
+        case NODE_LABEL:
+            free(node->data.jump.name);
+            ast_node_destroy(node->data.jump.target);
+            break;
+        
         case NODE_LITERAL:
             free(node->data.literal.value);
             break;
-            
+        
         case NODE_IDENTIFIER:
             free(node->data.identifier.name);
             break;
-            
+        
         case NODE_STRUCT:
             free(node->data.struct_def.name);
-            ast_node_destroy(node->data.struct_def.members);
+            ast_tree_destroy(node->data.struct_def.members);
             break;
-            
+        
         default:
             break;
     }
@@ -152,6 +190,139 @@ void ast_tree_destroy(ASTNode* root) {
     }
 }
 
+/* Records an error at `location`; the message is copied */
+static void parser_add_error(ParserState* parser, const char* message, SourceLocation location) {
+    parser->error_count++;
+    
+    Error* error = malloc(sizeof(Error));
+    if (!error) return;
+    
+    error->type = ERROR_SYNTAX;
+    error->message = strdup(message);
+    error->location = location;
+    error->next = parser->errors;
+    parser->errors = error;
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Obfuscation Pragmas and Annotations
+ *
+ * `#pragma obfuscate push|pop|off|level(basic|intermediate|extreme)` and
+ * `__attribute__((annotate("no_obf")))` are consumed as the parser advances,
+ * so the grammar never sees them. They become level caps on the nodes that
+ * follow; `off` caps at basic, since renaming has to stay consistent across
+ * the whole program. `annotate("virtualize")` flags the next function for
+ * the bytecode pass instead. Both annotations wait for a function node, so
+ * they take effect only once function definitions parse; today only
+ * expressions do, and only the pragmas reach parsed code.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool parse_pragma_level(const char* argument, int* level) {
+    if (strcmp(argument, "level(basic)") == 0) {
+        *level = OBF_BASIC;
+    } else if (strcmp(argument, "level(intermediate)") == 0) {
+        *level = OBF_INTERMEDIATE;
+    } else if (strcmp(argument, "level(extreme)") == 0) {
+        *level = OBF_EXTREME;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void parser_apply_pragma(ParserState* parser, const Token* pragma) {
+    const char* argument = pragma->value;
+    char message[256];
+    int level;
+    
+    if (strcmp(argument, "push") == 0) {
+        if (parser->pragma_depth == PARSER_PRAGMA_DEPTH) {
+            snprintf(message, sizeof(message), "'#pragma obfuscate push' nested more than %d deep",
+                     PARSER_PRAGMA_DEPTH);
+            parser_add_error(parser, message, pragma->location);
+            return;
+        }
+        parser->pragma_stack[parser->pragma_depth++] = parser->level_cap;
+    } else if (strcmp(argument, "pop") == 0) {
+        if (parser->pragma_depth == 0) {
+            parser_add_error(parser, "'#pragma obfuscate pop' without a matching push",
+                             pragma->location);
+            return;
+        }
+        parser->level_cap = parser->pragma_stack[--parser->pragma_depth];
+    } else if (strcmp(argument, "off") == 0) {
+        parser->level_cap = OBF_BASIC;
+    } else if (parse_pragma_level(argument, &level)) {
+        parser->level_cap = level;
+    } else {
+        snprintf(message, sizeof(message), "Unknown '#pragma obfuscate %.200s'", argument);
+        parser_add_error(parser, message, pragma->location);
+    }
+}
+
+static bool token_is(const Token* token, TokenType type, const char* value) {
+    return token && token->type == type && strcmp(token->value, value) == 0;
+}
+
+/* Consumes `__attribute__((...))`, noting annotate("no_obf") and
+ * annotate("virtualize") for the next function */
+static void parser_skip_attribute(ParserState* parser) {
+    Token* token = parser->current_token->next;
+    int depth = 0;
+    
+    do {
+        if (token_is(token, TOKEN_PUNCTUATION, "(")) {
+            depth++;
+        } else if (token_is(token, TOKEN_PUNCTUATION, ")")) {
+            depth--;
+        } else if (token_is(token, TOKEN_IDENTIFIER, "annotate") &&
+                   token_is(token->next, TOKEN_PUNCTUATION, "(") &&
+                   token_is(token->next->next, TOKEN_STRING, "\"no_obf\"")) {
+            parser->pending_no_obf = true;
+        } else if (token_is(token, TOKEN_IDENTIFIER, "annotate") &&
+                   token_is(token->next, TOKEN_PUNCTUATION, "(") &&
+                   token_is(token->next->next, TOKEN_STRING, "\"virtualize\"")) {
+            parser->pending_virtualize = true;
+        }
+        token = token->next;
+    } while (depth > 0 && token && token->type != TOKEN_EOF);
+    
+    parser->current_token = token;
+}
+
+static void parser_skip_annotations(ParserState* parser) {
+    for (;;) {
+        Token* token = parser->current_token;
+        
+        if (token && token->type == TOKEN_PRAGMA) {
+            parser_apply_pragma(parser, token);
+            parser->current_token = token->next;
+        } else if (token_is(token, TOKEN_IDENTIFIER, "__attribute__") &&
+                   token_is(token->next, TOKEN_PUNCTUATION, "(")) {
+            parser_skip_attribute(parser);
+        } else {
+            return;
+        }
+    }
+}
+
+/* Creates a node carrying the obfuscation cap in effect at this point */
+static ASTNode* parser_node_create(ParserState* parser, NodeType type, SourceLocation location) {
+    ASTNode* node = ast_node_create(type, location);
+    if (!node) return NULL;
+    
+    node->level_cap = parser->level_cap;
+    if (type == NODE_FUNCTION && parser->pending_no_obf) {
+        node->level_cap = OBF_BASIC;
+        parser->pending_no_obf = false;
+    }
+    if (type == NODE_FUNCTION && parser->pending_virtualize) {
+        node->flags |= AST_FLAG_VIRTUALIZE;
+        parser->pending_virtualize = false;
+    }
+    return node;
+}
+
 /* ═══════════════════════════════════════════════════════════════════════════
  * Parser Utility Functions
  * ═══════════════════════════════════════════════════════════════════════════ */
@@ -159,6 +330,7 @@ void ast_tree_destroy(ASTNode* root) {
 Token* parser_advance(ParserState* parser) {
     if (parser->current_token && parser->current_token->type != TOKEN_EOF) {
         parser->current_token = parser->current_token->next;
+        parser_skip_annotations(parser);
     }
     return parser->current_token;
 }
@@ -178,8 +350,9 @@ bool parser_consume(ParserState* parser, TokenType type, const char* error_msg)
         return true;
     }
     
-    // TODO: Add error reporting
-    parser->error_count++;
+    SourceLocation location = {0, 0, NULL};
+    if (parser->current_token) location = parser->current_token->location;
+    parser_add_error(parser, error_msg ? error_msg : "Unexpected token", location);
     return false;
 }
 
@@ -251,7 +424,7 @@ ASTNode* parser_parse_primary(ParserState* parser) {
         case TOKEN_NUMBER:
         case TOKEN_STRING:
         case TOKEN_CHAR: {
-            ASTNode* node = ast_node_create(NODE_LITERAL, token->location);
+            ASTNode* node = parser_node_create(parser, NODE_LITERAL, token->location);
             if (node) {
                 node->data.literal.value = strdup(token->value);
             }
@@ -260,7 +433,7 @@ ASTNode* parser_parse_primary(ParserState* parser) {
         }
         
         case TOKEN_IDENTIFIER: {
-            ASTNode* node = ast_node_create(NODE_IDENTIFIER, token->location);
+            ASTNode* node = parser_node_create(parser, NODE_IDENTIFIER, token->location);
             if (node) {
                 node->data.identifier.name = strdup(token->value);
             }
@@ -270,7 +443,7 @@ ASTNode* parser_parse_primary(ParserState* parser) {
             if (parser_match(parser, TOKEN_PUNCTUATION) && 
                 strcmp(parser_peek(parser)->value, "(") == 0) {
                 
-                ASTNode* call_node = ast_node_create(NODE_CALL, token->location);
+                ASTNode* call_node = parser_node_create(parser, NODE_CALL, token->location);
                 if (call_node) {
                     call_node->data.call.function = node;
                     
@@ -308,6 +481,26 @@ ASTNode* parser_parse_primary(ParserState* parser) {
                 return call_node;
             }
             
+            // Subscripts, possibly chained: a[i][j]
+            while (node && parser_match(parser, TOKEN_PUNCTUATION) &&
+                   strcmp(parser_peek(parser)->value, "[") == 0) {
+                SourceLocation bracket = parser_peek(parser)->location;
+                parser_advance(parser); // consume '['
+                
+                ASTNode* index = parser_parse_expression(parser);
+                parser_consume(parser, TOKEN_PUNCTUATION, "Expected ']'");
+                
+                ASTNode* access = parser_node_create(parser, NODE_ARRAY_ACCESS, bracket);
+                if (!access) {
+                    ast_node_destroy(index);
+                    break;
+                }
+                access->data.binary.operator = strdup("[]");
+                access->data.binary.left = node;
+                access->data.binary.right = index;
+                node = access;
+            }
+            
             return node;
         }
         
@@ -328,7 +521,7 @@ ASTNode* parser_parse_primary(ParserState* parser) {
                 strcmp(token->value, "*") == 0 || strcmp(token->value, "&") == 0 ||
                 strcmp(token->value, "++") == 0 || strcmp(token->value, "--") == 0) {
                 
-                ASTNode* node = ast_node_create(NODE_UNARY_OP, token->location);
+                ASTNode* node = parser_node_create(parser, NODE_UNARY_OP, token->location);
                 if (node) {
                     node->data.unary.operator = strdup(token->value);
                     node->data.unary.is_prefix = true;
@@ -342,7 +535,7 @@ ASTNode* parser_parse_primary(ParserState* parser) {
         
         case TOKEN_KEYWORD: {
             if (strcmp(token->value, "sizeof") == 0) {
-                ASTNode* node = ast_node_create(NODE_SIZEOF, token->location);
+                ASTNode* node = parser_node_create(parser, NODE_SIZEOF, token->location);
                 parser_advance(parser);
                 
                 if (parser_match(parser, TOKEN_PUNCTUATION) &&
@@ -384,7 +577,7 @@ static ASTNode* parse_expression_precedence(ParserState* parser, Precedence min_
             ASTNode* else_expr = parse_expression_precedence(parser, prec);
             
             // Create ternary node (represented as special binary op)
-            ASTNode* ternary = ast_node_create(NODE_BINARY_OP, op_location);
+            ASTNode* ternary = parser_node_create(parser, NODE_BINARY_OP, op_location);
             if (ternary) {
                 ternary->data.binary.operator = strdup("?:");
                 ternary->data.binary.left = left;
@@ -413,7 +606,7 @@ static ASTNode* parse_expression_precedence(ParserState* parser, Precedence min_
             return NULL;
         }
         
-        ASTNode* binary = ast_node_create(NODE_BINARY_OP, op_location);
+        ASTNode* binary = parser_node_create(parser, NODE_BINARY_OP, op_location);
         if (binary) {
             binary->data.binary.operator = strdup(op);
             binary->data.binary.left = left;
@@ -8,6 +8,9 @@
  * Parser Interface
  * ═══════════════════════════════════════════════════════════════════════════ */
 
+/* Nesting limit for `#pragma obfuscate push` */
+#define PARSER_PRAGMA_DEPTH 32
+
 /* Parser State */
 typedef struct {
     Token* tokens;
@@ -15,6 +18,13 @@ typedef struct {
     SymbolTable* symbol_table;
     Error* errors;
     int error_count;
+    
+    /* In-source obfuscation control, stamped on every node created */
+    int level_cap;                          /* From `#pragma obfuscate`; 0 = none */
+    int pragma_stack[PARSER_PRAGMA_DEPTH];  /* Caps saved by `push` */
+    int pragma_depth;
+    bool pending_no_obf;                    /* `annotate("no_obf")` awaiting its function */
+    bool pending_virtualize;                /* `annotate("virtualize")` likewise */
 } ParserState;
 
 /* Function Prototypes */
@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/autotune.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Autotuner Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Two functions with arithmetic to rewrite and branches to flatten */
+static ASTNode* create_program(void) {
+    ASTNode* setup = create_function("setup", "void", NULL, ast_create_block(
+        ast_link(ast_create_assignment(id("x"), op("+", op("*", id("a"), num(7)), id("b"))),
+                 ast_create_if(op(">", id("x"), num(3)),
+                               ast_create_assignment(id("y"), op("^", id("x"), num(5))),
+                               NULL))));
+    ASTNode* kernel = create_function("kernel", "void", NULL, ast_create_block(
+        ast_link(ast_create_assignment(id("s"), op("-", op("+", id("s"), id("v")), num(1))),
+                 ast_create_while(op("<", id("s"), num(100)),
+                                  ast_create_block(ast_create_assignment(id("s"),
+                                      op("+", id("s"), op("&", id("v"), num(15)))))))));
+    return ast_link(setup, kernel);
+}
+
+/* Stand-in for compiling and timing: the cost of a candidate is the size
+ * of its source */
+static int fake_calls = 0;
+
+static bool measure_source(const char* code, void* user, AutotuneSample* sample) {
+    (void)user;
+    fake_calls++;
+    sample->size = strlen(code);
+    sample->seconds = (double)strlen(code) / 1000.0;
+    return true;
+}
+
+/* Same, but sources longer than `*user` bytes fail to build */
+static bool measure_limited(const char* code, void* user, AutotuneSample* sample) {
+    if (strlen(code) > *(size_t*)user) return false;
+    return measure_source(code, NULL, sample);
+}
+
+static void init_options(AutotuneOptions* options, double budget) {
+    autotune_options_init(options);
+    options->max_slowdown = budget;
+    options->max_growth = budget;
+    options->measure = measure_source;
+}
+
+void test_generous_budget() {
+    printf("Testing a budget the strongest settings meet...\n");
+    
+    ASTNode* program = create_program();
+    ObfuscationConfig* base = config_create_default();
+    AutotuneOptions options;
+    init_options(&options, 1000.0);
+    
+    fake_calls = 0;
+    AutotuneResult* result = autotune(program, base, &options);
+    assert(result != NULL);
+    assert(result->within_budget);
+    assert(result->candidates == 1);
+    assert(fake_calls == 2);     // The original and one candidate
+    
+    ObfuscationConfig* config = result->config;
+    assert(config->level == OBF_EXTREME);
+    assert(config->obfuscate_control_flow);
+    assert(!config->string_decrypt_all);
+    assert(config->dead_code_percent == 30);
+    assert(config_function_level(config, "setup") == OBF_EXTREME);
+    assert(config_function_level(config, "kernel") == OBF_EXTREME);
+    
+    // The base configuration is left alone
+    assert(base->level == OBF_INTERMEDIATE);
+    assert(base->function_settings == NULL);
+    
+    autotune_result_destroy(result);
+    config_destroy(base);
+    ast_tree_destroy(program);
+    printf("✓ Generous budget test passed\n");
+}
+
+void test_tight_budget() {
+    printf("Testing a budget that forces weaker settings...\n");
+    
+    ASTNode* program = create_program();
+    ObfuscationConfig* base = config_create_default();
+    
+    // What the strongest candidate costs, to pick a budget below it
+    AutotuneOptions options;
+    init_options(&options, 1000.0);
+    AutotuneResult* strongest = autotune(program, base, &options);
+    assert(strongest != NULL);
+    double limit = strongest->growth * 0.6;
+    assert(limit > 1.0);
+    autotune_result_destroy(strongest);
+    
+    init_options(&options, limit);
+    AutotuneResult* result = autotune(program, base, &options);
+    assert(result != NULL);
+    assert(result->within_budget);
+    assert(result->growth <= limit);
+    assert(result->slowdown <= limit);
+    assert(result->candidates > 1);
+    
+    // Something was given up
+    ObfuscationConfig* config = result->config;
+    assert(config_function_level(config, "setup") < OBF_EXTREME ||
+           config_function_level(config, "kernel") < OBF_EXTREME ||
+           config->mba_expr_budget < 48 || config->string_decrypt_all ||
+           !config->obfuscate_control_flow || config->dead_code_percent < 30);
+    
+    // Rendering the chosen configuration reproduces the measured size
+    char* code = autotune_render(program, config);
+    assert(code != NULL);
+    assert(strlen(code) == result->best.size);
+    free(code);
+    
+    autotune_result_destroy(result);
+    config_destroy(base);
+    ast_tree_destroy(program);
+    printf("✓ Tight budget test passed\n");
+}
+
+void test_impossible_budget() {
+    printf("Testing a budget nothing meets...\n");
+    
+    ASTNode* program = create_program();
+    ObfuscationConfig* base = config_create_default();
+    AutotuneOptions options;
+    init_options(&options, 0.5);
+    
+    // The closest candidate has every knob at its weakest
+    AutotuneResult* result = autotune(program, base, &options);
+    assert(result != NULL);
+    assert(!result->within_budget);
+    
+    ObfuscationConfig* config = result->config;
+    assert(config_function_level(config, "setup") == OBF_BASIC);
+    assert(config_function_level(config, "kernel") == OBF_BASIC);
+    assert(config->mba_expr_budget == 0);
+    assert(config->string_decrypt_all);
+    assert(!config->obfuscate_control_flow);
+    assert(config->dead_code_percent == 0);
+    
+    autotune_result_destroy(result);
+    config_destroy(base);
+    ast_tree_destroy(program);
+    printf("✓ Impossible budget test passed\n");
+}
+
+void test_failed_candidates() {
+    printf("Testing candidates that fail to build...\n");
+    
+    ASTNode* program = create_program();
+    ObfuscationConfig* base = config_create_default();
+    AutotuneOptions options;
+    init_options(&options, 1000.0);
+    AutotuneResult* strongest = autotune(program, base, &options);
+    assert(strongest != NULL);
+    size_t original = strongest->baseline.size;
+    size_t limit = strongest->best.size * 8 / 10;
+    assert(limit > original);
+    autotune_result_destroy(strongest);
+    
+    // The strongest candidate fails; the descent goes on past it
+    options.measure = measure_limited;
+    options.user = &limit;
+    AutotuneResult* result = autotune(program, base, &options);
+    assert(result != NULL);
+    assert(result->within_budget);
+    assert(result->candidates > 1);
+    assert(result->best.size > 0 && result->best.size <= limit);
+    autotune_result_destroy(result);
+    
+    // Nothing but the original builds: the weakest candidate is still
+    // reached, and reported as over budget
+    limit = original;
+    result = autotune(program, base, &options);
+    assert(result != NULL);
+    assert(!result->within_budget);
+    assert(config_function_level(result->config, "setup") == OBF_BASIC);
+    assert(config_function_level(result->config, "kernel") == OBF_BASIC);
+    assert(!result->config->obfuscate_control_flow);
+    autotune_result_destroy(result);
+    
+    // Without the original there is nothing to compare against
+    limit = 0;
+    assert(autotune(program, base, &options) == NULL);
+    
+    config_destroy(base);
+    ast_tree_destroy(program);
+    printf("✓ Failed candidate test passed\n");
+}
+
+void test_config_file() {
+    printf("Testing configuration files...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    config->mba_expr_budget = 8;
+    config->string_decrypt_all = true;
+    config->obfuscate_control_flow = false;
+    config->dead_code_percent = 15;
+    assert(config_set_function_level(config, "setup", OBF_BASIC));
+    assert(config_set_function_level(config, "kernel", OBF_INTERMEDIATE));
+    
+    const char* path = "test_autotune.conf";
+    assert(config_save(config, path));
+    
+    ObfuscationConfig* loaded = config_create_default();
+    assert(config_load(loaded, path));
+    assert(loaded->level == OBF_EXTREME);
+    assert(loaded->mba_expr_budget == 8);
+    assert(loaded->string_decrypt_all);
+    assert(!loaded->obfuscate_control_flow);
+    assert(loaded->dead_code_percent == 15);
+    assert(config_function_level(loaded, "setup") == OBF_BASIC);
+    assert(config_function_level(loaded, "kernel") == OBF_INTERMEDIATE);
+    assert(config_function_level(loaded, "other") == 0);
+    
+    // Clones are deep
+    ObfuscationConfig* clone = config_clone(loaded);
+    assert(config_set_function_level(clone, "setup", OBF_EXTREME));
+    assert(config_function_level(loaded, "setup") == OBF_BASIC);
+    config_destroy(clone);
+    
+    // Unknown keys and bad values are rejected
+    FILE* file = fopen(path, "w");
+    fprintf(file, "# comment\nlevel = extreme\nmba_depth = 3\n");
+    fclose(file);
+    assert(!config_load(loaded, path));
+    
+    file = fopen(path, "w");
+    fprintf(file, "function.setup.level = maximum\n");
+    fclose(file);
+    assert(!config_load(loaded, path));
+    remove(path);
+    
+    config_destroy(loaded);
+    config_destroy(config);
+    printf("✓ Configuration file test passed\n");
+}
+
+void test_function_caps_applied() {
+    printf("Testing per-function levels in the pipeline...\n");
+    
+    // A basic-level function keeps its arithmetic as written
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    assert(config_set_function_level(config, "setup", OBF_BASIC));
+    assert(config_set_function_level(config, "kernel", OBF_BASIC));
+    
+    ASTNode* program = create_program();
+    size_t before = ast_count_nodes(program);
+    config->seed = 3;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    assert(obfuscate_ast(ctx, program) != NULL);
+    assert(ast_count_nodes(program) == before);
+    
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(program);
+    config_destroy(config);
+    printf("✓ Per-function level test passed\n");
+}
+
+int main() {
+    printf("Running Autotuner Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_generous_budget();
+    test_tight_budget();
+    test_impossible_budget();
+    test_failed_candidates();
+    test_config_file();
+    test_function_caps_applied();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All autotuner tests passed! ✓\n");
+    
+    return 0;
+}
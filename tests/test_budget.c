@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/budget.h"
+#include "../src/obfuscator/flatten.h"
+#include "../src/obfuscator/virtualize.h"
+#include "../src/codegen/codegen.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Growth Budget Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Arithmetic, constants and branches in two functions over int globals */
+static ASTNode* create_program(void) {
+    ASTNode* globals = NULL;
+    const char* names[] = { "a", "b", "s", "v", "x", "y" };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        globals = ast_link(globals, ast_create_variable(names[i], "int", NULL));
+    }
+    
+    ASTNode* statements = NULL;
+    for (int i = 0; i < 6; i++) {
+        statements = ast_link(statements,
+            ast_create_assignment(id("x"), op("+", op("^", id("a"), num(i + 3)),
+                                              op("-", id("b"), id("x")))));
+    }
+    statements = ast_link(statements,
+        ast_create_if(op(">", id("x"), num(9)),
+                      ast_create_block(ast_create_assignment(id("y"), op("|", id("x"), num(4)))),
+                      NULL));
+    ASTNode* first = create_function("first", "void", NULL, ast_create_block(statements));
+    ASTNode* second = create_function("second", "void", NULL, ast_create_block(
+        ast_create_while(op("<", id("s"), num(100)),
+                         ast_create_block(ast_create_assignment(id("s"),
+                             op("+", id("s"), op("&", id("v"), num(15))))))));
+    return ast_link(globals, ast_link(first, second));
+}
+
+static size_t count_list(const ASTNode* node) {
+    size_t count = 0;
+    for (; node; node = node->next) count += ast_count_nodes(node);
+    return count;
+}
+
+void test_accounting() {
+    printf("Testing budget accounting...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ASTNode* program = create_program();
+    long original = (long)count_list(program);
+    
+    // No limit, no budget; NULL allows everything
+    assert(budget_create(config, program) == NULL);
+    assert(budget_allows(NULL, 1000000));
+    assert(budget_cap(NULL, 48) == 48);
+    
+    config->max_growth = 2.0;
+    GrowthBudget* budget = budget_create(config, program);
+    assert(budget != NULL);
+    assert(budget->original == original);
+    assert(budget->limit == original);
+    
+    // Each function may double, too
+    ASTNode* second = program;
+    while (second->type != NODE_FUNCTION || strcmp(second->data.function.name, "second") != 0) {
+        second = second->next;
+    }
+    long second_size = (long)ast_count_nodes(second);
+    budget_enter(budget, second);
+    assert(budget_remaining(budget) == second_size);
+    assert(budget_allows(budget, second_size));
+    assert(!budget_allows(budget, second_size + 1));
+    assert(budget->degraded == 1);
+    
+    budget_charge(budget, second_size - 2);
+    assert(budget_remaining(budget) == 2);
+    assert(budget_cap(budget, 24) == 2);
+    assert(budget_cap(budget, 1) == 1);
+    assert(budget->degraded == 2);
+    
+    // File scope only has the program-wide limit left
+    budget_enter(budget, NULL);
+    assert(budget_remaining(budget) == original - (second_size - 2));
+    budget_destroy(budget);
+    
+    // An absolute cap tighter than the ratio wins
+    config->max_nodes = original + 10;
+    budget = budget_create(config, program);
+    assert(budget->limit == 10);
+    budget_destroy(budget);
+    
+    // A cap below the original leaves nothing to add
+    config->max_growth = 0.0;
+    config->max_nodes = 5;
+    budget = budget_create(config, program);
+    assert(budget->limit == 0);
+    assert(!budget_allows(budget, 1));
+    budget_destroy(budget);
+    
+    ast_tree_destroy(program);
+    config_destroy(config);
+    printf("✓ Budget accounting test passed\n");
+}
+
+static size_t obfuscate_with(double max_growth, long max_nodes, unsigned int seed,
+                             size_t* original, int* degraded) {
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    config->simplify_output = false;
+    config->max_growth = max_growth;
+    config->max_nodes = max_nodes;
+    config->seed = seed;
+    
+    ASTNode* program = create_program();
+    *original = count_list(program);
+    
+    ObfuscationContext* ctx = obfuscator_create(config);
+    assert(obfuscate_ast(ctx, program) != NULL);
+    size_t final_size = count_list(program);
+    
+    // Scaled-back dead code never refers to anything undeclared
+    ASTNode* shell = calloc(1, sizeof(ASTNode));
+    shell->type = NODE_PROGRAM;
+    shell->data.program.declarations = program;
+    CodeGenConfig* codegen_config = codegen_config_create_default();
+    CodeGenState* codegen = codegen_create(codegen_config);
+    char* code = generate_code(codegen, shell);
+    assert(code != NULL);
+    assert(strstr(code, "__dead_counter") == NULL);
+    free(code);
+    free(shell);
+    codegen_destroy(codegen);
+    codegen_config_destroy(codegen_config);
+    
+    if (ctx->budget) {
+        assert((long)final_size == ctx->budget->original + ctx->budget->added);
+        *degraded = ctx->budget->degraded;
+    } else {
+        *degraded = 0;
+    }
+    
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(program);
+    config_destroy(config);
+    return final_size;
+}
+
+void test_pipeline_limits() {
+    printf("Testing limits across the passes...\n");
+    
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        size_t original;
+        int degraded;
+        size_t unlimited = obfuscate_with(0.0, 0, seed, &original, &degraded);
+        
+        // Only test limits the unlimited run actually exceeds
+        assert(unlimited > original * 3 / 2);
+        
+        size_t limited = obfuscate_with(1.5, 0, seed, &original, &degraded);
+        assert(limited <= original * 3 / 2);
+        assert(degraded > 0);
+        
+        limited = obfuscate_with(0.0, (long)original + 20, seed, &original, &degraded);
+        assert(limited <= original + 20);
+        
+        // Room for everything: nothing is scaled back
+        size_t roomy = obfuscate_with(1000.0, 0, seed, &original, &degraded);
+        assert(roomy == unlimited);
+        assert(degraded == 0);
+    }
+    
+    printf("✓ Pipeline limit test passed\n");
+}
+
+/* int a, b, x; void branches() { if (a) x = b; ... six times } */
+static ASTNode* create_branchy_program(void) {
+    ASTNode* globals = ast_link(ast_create_variable("a", "int", NULL),
+        ast_link(ast_create_variable("b", "int", NULL), ast_create_variable("x", "int", NULL)));
+    ASTNode* statements = NULL;
+    for (int i = 0; i < 6; i++) {
+        statements = ast_link(statements,
+            ast_create_if(id("a"), ast_create_assignment(id("x"), id("b")), NULL));
+    }
+    return ast_link(globals, create_function("branches", "void", NULL,
+                                             ast_create_block(statements)));
+}
+
+void test_flattening_limits() {
+    printf("Testing flattening against the budget...\n");
+    
+    // Small branches: the dispatcher is several times the body it replaces
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        ObfuscationConfig* config = config_create_default();
+        config->level = OBF_EXTREME;
+        config->simplify_output = false;
+        config->max_growth = 2.0;
+        config->seed = seed;
+        
+        ASTNode* program = create_branchy_program();
+        size_t original = count_list(program);
+        ObfuscationContext* ctx = obfuscator_create(config);
+        assert(obfuscate_ast(ctx, program) != NULL);
+        assert(count_list(program) <= original * 2);
+        assert((long)count_list(program) == ctx->budget->original + ctx->budget->added);
+        
+        obfuscator_destroy(ctx);
+        ast_tree_destroy(program);
+        config_destroy(config);
+    }
+    
+    // Refused outright, the body is left as written
+    ObfuscationConfig* config = config_create_default();
+    config->max_growth = 2.0;
+    ASTNode* program = create_branchy_program();
+    ASTNode* function = program->next->next->next;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    ctx->budget = budget_create(config, program);
+    budget_enter(ctx->budget, function);
+    
+    size_t before = ast_count_nodes(function);
+    assert(!flatten_function(ctx, function, NULL));
+    assert(ast_count_nodes(function) == before);
+    assert(ctx->budget->added == 0);
+    assert(ctx->budget->degraded > 0);
+    
+    // With room to spare it goes through and is charged exactly
+    budget_destroy(ctx->budget);
+    config->max_growth = 100.0;
+    ctx->budget = budget_create(config, program);
+    budget_enter(ctx->budget, function);
+    assert(flatten_function(ctx, function, NULL));
+    assert((long)ast_count_nodes(function) == (long)before + ctx->budget->added);
+    
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(program);
+    config_destroy(config);
+    
+    printf("✓ Flattening limit test passed\n");
+}
+
+void test_virtualization_limits() {
+    printf("Testing virtualization against the budget...\n");
+    
+    // A single call: the dispatch loop around it outweighs the body
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    config->max_growth = 2.0;
+    ASTNode* program = create_function("once", "void", NULL,
+                                       ast_create_block(ast_create_call(id("tick"), num(7))));
+    program->flags = AST_FLAG_VIRTUALIZE;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    ctx->budget = budget_create(config, program);
+    
+    size_t before = ast_count_nodes(program);
+    assert(virtualize_functions(ctx, program));
+    assert(ast_count_nodes(program) == before);
+    assert(program->data.function.body->data.block.statements->type == NODE_CALL);
+    assert(ctx->bytecode->count == 0);
+    assert(ctx->budget->added == 0);
+    assert(ctx->budget->degraded > 0);
+    
+    // With room to spare it goes through and is charged exactly
+    budget_destroy(ctx->budget);
+    config->max_growth = 100.0;
+    ctx->budget = budget_create(config, program);
+    assert(virtualize_functions(ctx, program));
+    assert(ctx->bytecode->count > 0);
+    assert((long)ast_count_nodes(program) == (long)before + ctx->budget->added);
+    
+    obfuscator_destroy(ctx);
+    ast_tree_destroy(program);
+    config_destroy(config);
+    
+    printf("✓ Virtualization limit test passed\n");
+}
+
+int main() {
+    printf("Running Growth Budget Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_accounting();
+    test_pipeline_limits();
+    test_flattening_limits();
+    test_virtualization_limits();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All growth budget tests passed! ✓\n");
+    
+    return 0;
+}
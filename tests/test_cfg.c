@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/analysis/cfg.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Control-Flow Graph Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parse(const char* source) {
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL);
+    
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    return expr;
+}
+
+static int count_statements(const ASTNode* list) {
+    int count = 0;
+    for (; list; list = list->next) count++;
+    return count;
+}
+
+/* Builds and simplifies; returns the number of blocks that would be emitted */
+static int build(ASTNode* statements, bool merge, CFG** out, int* merged) {
+    CFG* cfg = cfg_build(statements);
+    assert(cfg != NULL);
+    
+    int folded = cfg_simplify(cfg, merge);
+    if (merged) *merged = folded;
+    
+    int* order = malloc(cfg->count * sizeof(int));
+    int blocks = cfg_order(cfg, order);
+    free(order);
+    
+    *out = cfg;
+    return blocks;
+}
+
+/* for (i = 0; i < n; i = i + 1) { a(); } b(); */
+static ASTNode* create_loop(void) {
+    ASTNode* loop = ast_create_for(parse("i = 0"), parse("i < n"), parse("i = i + 1"),
+                                   ast_create_block(parse("a()")));
+    return ast_link(loop, parse("b()"));
+}
+
+void test_straight_line() {
+    printf("Testing straight-line code...\n");
+    
+    CFG* cfg;
+    ASTNode* statements = ast_link(ast_link(parse("a()"), parse("b()")), parse("c()"));
+    assert(build(statements, true, &cfg, NULL) == 1);
+    
+    // One maximal block that falls off the end
+    const CFGBlock* entry = &cfg->blocks[cfg->entry];
+    assert(count_statements(entry->statements) == 3);
+    assert(entry->condition == NULL);
+    assert(entry->next == CFG_EXIT);
+    cfg_destroy(cfg);
+    
+    printf("✓ Straight-line test passed\n");
+}
+
+void test_branches() {
+    printf("Testing branch splitting...\n");
+    
+    CFG* cfg;
+    
+    // a(); if (c) x(); else y(); z();
+    ASTNode* branch = ast_create_if(parse("c"), parse("x()"), parse("y()"));
+    ASTNode* statements = ast_link(ast_link(parse("a()"), branch), parse("z()"));
+    assert(build(statements, true, &cfg, NULL) == 4);
+    
+    const CFGBlock* entry = &cfg->blocks[cfg->entry];
+    assert(count_statements(entry->statements) == 1);
+    assert(entry->condition != NULL);
+    assert(entry->next != entry->other);
+    
+    // Both arms meet at the join, which keeps its own block
+    const CFGBlock* then_block = &cfg->blocks[entry->next];
+    const CFGBlock* else_block = &cfg->blocks[entry->other];
+    assert(then_block->next == else_block->next);
+    assert(cfg->blocks[then_block->next].predecessors == 2);
+    cfg_destroy(cfg);
+    
+    // A loop containing `break` is kept whole
+    ASTNode* loop = ast_create_while(parse("c"), ast_create_block(ast_create_break()));
+    assert(!cfg_can_lower(loop));
+    assert(build(ast_link(parse("a()"), loop), true, &cfg, NULL) == 1);
+    assert(cfg->blocks[cfg->entry].statements->next->type == NODE_WHILE);
+    cfg_destroy(cfg);
+    
+    printf("✓ Branch splitting test passed\n");
+}
+
+void test_return_splitting() {
+    printf("Testing return splitting...\n");
+    
+    CFG* cfg;
+    
+    // if (c) { x(); return; } y();
+    ASTNode* then_stmt = ast_create_block(ast_link(parse("x()"), ast_create_return()));
+    ASTNode* statements = ast_link(ast_create_if(parse("c"), then_stmt, NULL), parse("y()"));
+    assert(build(statements, true, &cfg, NULL) == 3);
+    
+    const CFGBlock* entry = &cfg->blocks[cfg->entry];
+    const CFGBlock* then_block = &cfg->blocks[entry->next];
+    assert(then_block->returns);
+    assert(count_statements(then_block->statements) == 2);
+    
+    // Only the fall-through edge reaches the join
+    assert(cfg->blocks[entry->other].predecessors == 1);
+    cfg_destroy(cfg);
+    
+    // a(); return; b(); keeps the unreachable tail in its own block
+    statements = ast_link(ast_link(parse("a()"), ast_create_return()), parse("b()"));
+    assert(build(statements, true, &cfg, NULL) == 2);
+    assert(cfg->blocks[cfg->entry].returns);
+    cfg_destroy(cfg);
+    
+    printf("✓ Return splitting test passed\n");
+}
+
+void test_block_merging() {
+    printf("Testing block merging...\n");
+    
+    CFG* cfg;
+    int merged = 0;
+    int unmerged_blocks = build(create_loop(), false, &cfg, &merged);
+    assert(merged == 0);
+    assert(unmerged_blocks == 5);
+    cfg_destroy(cfg);
+    
+    // The loop body and its update step run back to back
+    int merged_blocks = build(create_loop(), true, &cfg, &merged);
+    assert(merged == 1);
+    assert(merged_blocks == unmerged_blocks - merged);
+    
+    const CFGBlock* head = &cfg->blocks[cfg->blocks[cfg->entry].next];
+    assert(head->condition != NULL);
+    assert(head->predecessors == 2);
+    
+    const CFGBlock* body = &cfg->blocks[head->next];
+    assert(count_statements(body->statements) == 2);
+    assert(body->next == cfg->blocks[cfg->entry].next);
+    cfg_destroy(cfg);
+    
+    printf("✓ Block merging test passed\n");
+}
+
+int main() {
+    printf("Running Control-Flow Graph Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_straight_line();
+    test_branches();
+    test_return_splitting();
+    test_block_merging();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All control-flow graph tests passed! ✓\n");
+    
+    return 0;
+}
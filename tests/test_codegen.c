@@ -0,0 +1,307 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/codegen/codegen.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Code Generator Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static CodeGenConfig* plain_config(int indent_size) {
+    CodeGenConfig* config = codegen_config_create_default();
+    config->add_comments = false;
+    config->add_ascii_art = false;
+    config->indent_size = indent_size;
+    config->seed = 1;
+    return config;
+}
+
+/* `depth` nested blocks around one assignment */
+static ASTNode* nested_blocks(int depth) {
+    ASTNode* node = ast_create_assignment(id("x"), op("+", id("x"), num(1)));
+    for (int i = 0; i < depth; i++) {
+        node = ast_create_block(node);
+    }
+    return node;
+}
+
+void test_buffer_writes() {
+    printf("Testing length-aware buffer writes...\n");
+    
+    CodeGenConfig* config = plain_config(4);
+    CodeGenState* gen = codegen_create(config);
+    
+    // Explicit lengths may cut a string short
+    codegen_write_n(gen, "abcdef", 3);
+    codegen_write_literal(gen, " = ");
+    codegen_write(gen, "value");
+    codegen_write_char(gen, ';');
+    codegen_write_n(gen, NULL, 4);
+    codegen_write_n(gen, "ignored", 0);
+    assert(gen->buffer_pos == strlen("abc = value;"));
+    assert(memcmp(gen->output_buffer, "abc = value;", gen->buffer_pos) == 0);
+    
+    gen->indent_level = 3;
+    size_t before = gen->buffer_pos;
+    codegen_indent(gen);
+    assert(gen->buffer_pos == before + 12);
+    for (size_t i = before; i < gen->buffer_pos; i++) {
+        assert(gen->output_buffer[i] == ' ');
+    }
+    
+    // Growing keeps everything written so far
+    size_t start = gen->buffer_pos;
+    for (int i = 0; i < 20000; i++) {
+        codegen_write_literal(gen, "0123456789");
+    }
+    assert(gen->buffer_pos == start + 200000);
+    assert(gen->buffer_size >= gen->buffer_pos);
+    assert(memcmp(gen->output_buffer, "abc = value;", 12) == 0);
+    assert(memcmp(gen->output_buffer + gen->buffer_pos - 10, "0123456789", 10) == 0);
+    
+    codegen_destroy(gen);
+    codegen_config_destroy(config);
+    printf("✓ Buffer write test passed\n");
+}
+
+static char* render(ASTNode* ast, int indent_size) {
+    CodeGenConfig* config = plain_config(indent_size);
+    CodeGenState* gen = codegen_create(config);
+    char* code = generate_code(gen, ast);
+    codegen_destroy(gen);
+    codegen_config_destroy(config);
+    return code;
+}
+
+void test_indentation() {
+    printf("Testing indentation...\n");
+    
+    ASTNode* ast = nested_blocks(2);
+    char* code = render(ast, 2);
+    // A block opens on the line of whatever precedes it
+    assert(strcmp(code, "{\n{\n    x = x + 1;\n  }\n}\n") == 0);
+    free(code);
+    
+    // Deeper than one run of spaces
+    ast_tree_destroy(ast);
+    ast = nested_blocks(20);
+    code = render(ast, 4);
+    const char* line = strstr(code, "x = ");
+    assert(line != NULL);
+    const char* indent = line;
+    while (indent > code && indent[-1] == ' ') indent--;
+    assert(line - indent == 20 * 4);
+    assert(code[strlen(code) - 1] == '\n');
+    free(code);
+    
+    ast_tree_destroy(ast);
+    printf("✓ Indentation test passed\n");
+}
+
+/* Enough statements for several chunks */
+static ASTNode* long_block(int statements) {
+    ASTNode* list = NULL;
+    for (int i = 0; i < statements; i++) {
+        list = ast_link(list, ast_create_assignment(id("accumulator"),
+            op("^", op("+", id("accumulator"), num(i)), op("*", id("factor"), num(i + 7)))));
+    }
+    return ast_create_block(list);
+}
+
+typedef struct {
+    char* data;
+    size_t length;
+    int calls;
+    size_t largest;
+    int fail_after;            /* Calls that succeed; -1 = all */
+} Collector;
+
+static bool collect(const char* data, size_t length, void* user) {
+    Collector* collector = user;
+    if (collector->fail_after >= 0 && collector->calls >= collector->fail_after) return false;
+    
+    collector->data = realloc(collector->data, collector->length + length + 1);
+    memcpy(collector->data + collector->length, data, length);
+    collector->length += length;
+    collector->data[collector->length] = '\0';
+    collector->calls++;
+    if (length > collector->largest) collector->largest = length;
+    return true;
+}
+
+void test_streaming() {
+    printf("Testing streamed output...\n");
+    
+    ASTNode* ast = long_block(6000);
+    CodeGenConfig* config = plain_config(4);
+    CodeGenState* gen = codegen_create(config);
+    
+    // A prologue larger than a chunk goes straight through
+    size_t prologue_length = CODEGEN_CHUNK_SIZE + 100;
+    char* prologue = malloc(prologue_length + 1);
+    memset(prologue, '/', prologue_length);
+    prologue[prologue_length - 1] = '\n';
+    prologue[prologue_length] = '\0';
+    codegen_set_prologue(gen, prologue);
+    
+    char* expected = generate_code(gen, ast);
+    assert(strlen(expected) > 4 * CODEGEN_CHUNK_SIZE);
+    assert(codegen_output_size(gen) == strlen(expected));
+    
+    // The same text, in pieces no larger than a chunk beyond the prologue
+    Collector collector = { NULL, 0, 0, 0, -1 };
+    assert(codegen_stream(gen, ast, collect, &collector));
+    assert(collector.length == strlen(expected));
+    assert(strcmp(collector.data, expected) == 0);
+    assert(collector.calls > 4);
+    assert(collector.largest == prologue_length);
+    assert(gen->buffer_size == CODEGEN_CHUNK_SIZE);
+    assert(codegen_output_size(gen) == collector.length);
+    free(collector.data);
+    
+    // A failing sink ends the stream
+    Collector failing = { NULL, 0, 0, 0, 2 };
+    assert(!codegen_stream(gen, ast, collect, &failing));
+    assert(failing.calls == 2);
+    assert(gen->failed);
+    free(failing.data);
+    
+    // Into a file descriptor
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    assert(codegen_stream(gen, ast, codegen_sink_fd, &fd));
+    char* written = malloc(strlen(expected) + 1);
+    rewind(file);
+    size_t read = fread(written, 1, strlen(expected) + 1, file);
+    assert(read == strlen(expected));
+    written[read] = '\0';
+    assert(strcmp(written, expected) == 0);
+    fclose(file);
+    
+    // In memory again afterwards
+    char* again = generate_code(gen, ast);
+    assert(strcmp(again, expected) == 0);
+    assert(!gen->failed);
+    
+    free(again);
+    free(written);
+    free(expected);
+    free(prologue);
+    codegen_destroy(gen);
+    codegen_config_destroy(config);
+    ast_tree_destroy(ast);
+    printf("✓ Streaming test passed\n");
+}
+
+/* A function touching every statement form the generator knows */
+static ASTNode* create_program(void) {
+    ASTNode* statements = ast_create_variable("total", "int", num(0));
+    statements = ast_link(statements, ast_create_for(
+        ast_create_assignment(id("i"), num(0)), op("<", id("i"), id("n")),
+        ast_create_unary_op("++", id("i"), false),
+        ast_create_block(ast_create_assignment(id("total"),
+            op("+", id("total"), ast_create_array_access(id("values"), id("i")))))));
+    statements = ast_link(statements, ast_create_while(op(">", id("total"), num(1000)),
+        ast_create_block(ast_create_assignment(id("total"), op(">>", id("total"), num(1))))));
+    statements = ast_link(statements, ast_create_if(op("==", op("&", id("total"), num(1)), num(0)),
+        ast_create_block(ast_create_call(id("puts"), ast_create_literal("\"even\""))),
+        ast_create_block(ast_create_call(id("puts"), ast_create_literal("\"odd\"")))));
+    statements = ast_link(statements, ast_create_switch(id("total"),
+        ast_link(ast_create_case(num(1), ast_link(ast_create_assignment(id("n"), ast_create_unary_op("-", id("n"), true)),
+                                                  ast_create_break())),
+                 ast_create_case(NULL, ast_create_break()))));
+    statements = ast_link(statements, ast_create_return());
+    
+    return create_function("sum_values", "int", NULL, ast_create_block(statements));
+}
+
+void test_size_estimate() {
+    printf("Testing output size estimates...\n");
+    
+    // Plain trees: the estimate covers the output without wasting much
+    ASTNode* block = long_block(2000);
+    char* code = render(block, 4);
+    CodeGenConfig* config = plain_config(4);
+    CodeGenState* gen = codegen_create(config);
+    size_t estimate = codegen_estimate_size(gen, block);
+    assert(estimate >= strlen(code));
+    assert(estimate < strlen(code) * 3 / 2);
+    free(code);
+    ast_tree_destroy(block);
+    
+    // Casts are counted with their type; sizeof prints nothing yet
+    ASTNode* sizeof_node = calloc(1, sizeof(ASTNode));
+    sizeof_node->type = NODE_SIZEOF;
+    block = ast_create_block(ast_link(
+        ast_create_assignment(id("whole"), ast_create_cast("unsigned long long", id("ratio"))),
+        ast_create_assignment(id("bytes"), op("*", sizeof_node, num(4)))));
+    code = render(block, 4);
+    estimate = codegen_estimate_size(gen, block);
+    assert(strstr(code, "(unsigned long long)") != NULL);
+    assert(estimate >= strlen(code));
+    free(code);
+    ast_tree_destroy(block);
+    codegen_destroy(gen);
+    codegen_config_destroy(config);
+    
+    // Obfuscated programs in every style, prologue included
+    AestheticStyle styles[] = { AESTHETIC_MINIMAL, AESTHETIC_UNICODE, AESTHETIC_HEXADECIMAL,
+                                AESTHETIC_ARTISTIC, AESTHETIC_CHAOTIC };
+    for (unsigned int seed = 1; seed <= 10; seed++) {
+        for (size_t s = 0; s < sizeof(styles) / sizeof(styles[0]); s++) {
+            ObfuscationConfig* obf_config = config_create_default();
+            obf_config->level = OBF_EXTREME;
+            obf_config->seed = seed;
+            config_set_aesthetic(obf_config, styles[s]);
+            ObfuscationContext* ctx = obfuscator_create(obf_config);
+            
+            ASTNode* program = calloc(1, sizeof(ASTNode));
+            program->type = NODE_PROGRAM;
+            program->data.program.declarations = create_program();
+            assert(obfuscate_ast(ctx, program->data.program.declarations) != NULL);
+            
+            config = codegen_config_create_default();
+            config->seed = seed;
+            codegen_config_set_style(config, styles[s]);
+            gen = codegen_create(config);
+            char* prologue = obfuscator_runtime_prologue(ctx);
+            codegen_set_prologue(gen, prologue);
+            free(prologue);
+            
+            estimate = codegen_estimate_size(gen, program);
+            code = generate_code(gen, program);
+            assert(estimate >= strlen(code));
+            assert(estimate < strlen(code) * 2);
+            
+            free(code);
+            codegen_destroy(gen);
+            codegen_config_destroy(config);
+            ast_tree_destroy(program->data.program.declarations);
+            free(program);
+            obfuscator_destroy(ctx);
+            config_destroy(obf_config);
+        }
+    }
+    
+    printf("✓ Size estimate test passed\n");
+}
+
+int main() {
+    printf("Running Code Generator Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_buffer_writes();
+    test_indentation();
+    test_streaming();
+    test_size_estimate();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All code generator tests passed! ✓\n");
+    
+    return 0;
+}
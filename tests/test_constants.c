@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/constants.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Constant Encoding Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Evaluates an encoded constant the way the emitted C would */
+static long long evaluate(const ObfuscationContext* ctx, const ASTNode* node) {
+    switch (node->type) {
+        case NODE_LITERAL:
+            return strtoll(node->data.literal.value, NULL, 0);
+        
+        case NODE_BINARY_OP: {
+            long long a = evaluate(ctx, node->data.binary.left);
+            long long b = evaluate(ctx, node->data.binary.right);
+            const char* op = node->data.binary.operator;
+            if (strcmp(op, "^") == 0) return a ^ b;
+            if (strcmp(op, "*") == 0) return a * b;
+            if (strcmp(op, "+") == 0) return a + b;
+            if (strcmp(op, "-") == 0) return a - b;
+            assert(!"unexpected operator");
+            return 0;
+        }
+        
+        case NODE_CALL: {
+            assert(strcmp(node->data.call.function->data.identifier.name, "__obf_const") == 0);
+            long long index = evaluate(ctx, node->data.call.arguments);
+            long long mask = evaluate(ctx, node->data.call.arguments->next);
+            assert(index >= 0 && index < ctx->constants->count);
+            return ctx->constants->values[index] ^ mask;
+        }
+        
+        default:
+            assert(!"unexpected node");
+            return 0;
+    }
+}
+
+static bool is_literal(const ASTNode* node, const char* value) {
+    return node->type == NODE_LITERAL && strcmp(node->data.literal.value, value) == 0;
+}
+
+void test_encodings_preserve_values() {
+    printf("Testing encoded values...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    const int values[] = { 0, 1, 7, 255, 1000, 65536, 123456789, 2147483647 };
+    bool used[3] = { false, false, false };
+    for (int round = 0; round < 50; round++) {
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+            ASTNode* encoded = constant_encode(ctx, values[i], 100);
+            assert(encoded != NULL);
+            assert(encoded->flags & AST_FLAG_OPAQUE);
+            assert(evaluate(ctx, encoded) == values[i]);
+            
+            if (encoded->type == NODE_CALL) used[CONSTANT_ENCODING_TABLE] = true;
+            else if (strcmp(encoded->data.binary.operator, "^") == 0) used[CONSTANT_ENCODING_SHARES] = true;
+            else used[CONSTANT_ENCODING_AFFINE] = true;
+            ast_node_destroy(encoded);
+        }
+    }
+    assert(used[CONSTANT_ENCODING_SHARES]);
+    assert(used[CONSTANT_ENCODING_AFFINE]);
+    assert(used[CONSTANT_ENCODING_TABLE]);
+    
+    // The pool is emitted on its own cache line with its accessor
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(strstr(prologue, "_Alignas(64) const int __obf_const_pool[") != NULL);
+    assert(strstr(prologue, "static inline int __obf_const(") != NULL);
+    free(prologue);
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Encoded value test passed\n");
+}
+
+void test_affine_terms() {
+    printf("Testing affine terms...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // Affine alone: shares cost less, the pool more
+    int budget = constant_encoding_cost(CONSTANT_ENCODING_AFFINE);
+    const int values[] = { 0, 1, 10, 255, 1000 };
+    int affine = 0;
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+            ASTNode* encoded = constant_encode(ctx, values[i], budget);
+            assert(evaluate(ctx, encoded) == values[i]);
+            if (strcmp(encoded->data.binary.operator, "^") != 0) {
+                // Neither the product nor the remainder gives the value away
+                ASTNode* product = encoded->data.binary.left;
+                assert(evaluate(ctx, product->data.binary.left) != 0);
+                assert(evaluate(ctx, product) != values[i]);
+                assert(evaluate(ctx, encoded->data.binary.right) != values[i]);
+                affine++;
+            }
+            ast_node_destroy(encoded);
+        }
+    }
+    assert(affine > 0);
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Affine term test passed\n");
+}
+
+void test_cost_cap() {
+    printf("Testing per-use cost cap...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    assert(constant_encode(ctx, 42, 0) == NULL);
+    
+    // Below the cost of a load, the pool is never touched
+    int budget = constant_encoding_cost(CONSTANT_ENCODING_TABLE) - 1;
+    for (int i = 0; i < 200; i++) {
+        ASTNode* encoded = constant_encode(ctx, 42, budget);
+        assert(encoded->type == NODE_BINARY_OP);
+        ast_node_destroy(encoded);
+    }
+    assert(ctx->constants->count == 0);
+    
+    // Loops get a fraction of the budget, nested loops nothing
+    ASTNode* loop = ast_create_literal("5");
+    ASTNode* nested = ast_create_literal("5");
+    loop->hotness = 8.0f;
+    nested->hotness = 64.0f;
+    assert(constant_budget(ctx, loop) < constant_encoding_cost(CONSTANT_ENCODING_TABLE));
+    assert(constant_budget(ctx, nested) == 0);
+    ast_node_destroy(loop);
+    ast_node_destroy(nested);
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Cost cap test passed\n");
+}
+
+void test_constant_contexts() {
+    printf("Testing constant-expression contexts...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // static int s = 3; switch (v) { case 4: f(5, ...); } ... many f(5)
+    ASTNode* saved = ast_create_variable("s", "int", ast_create_literal("3"));
+    saved->data.variable.is_static = true;
+    
+    ASTNode* calls = NULL;
+    for (int i = 0; i < 40; i++) {
+        calls = ast_link(calls, ast_create_call(ast_create_identifier("f"),
+                                                ast_create_literal("5")));
+    }
+    ASTNode* label = ast_create_case(ast_create_literal("4"), calls);
+    ASTNode* dispatch = ast_create_switch(ast_create_identifier("v"), label);
+    
+    ASTNode* function = calloc(1, sizeof(ASTNode));
+    function->type = NODE_FUNCTION;
+    function->data.function.name = strdup("g");
+    function->data.function.return_type = strdup("void");
+    function->data.function.body = ast_create_block(ast_link(saved, dispatch));
+    
+    // File-scope initializers are constant expressions too
+    ASTNode* global = ast_create_variable("limit", "int", ast_create_literal("9"));
+    ASTNode* program = calloc(1, sizeof(ASTNode));
+    program->type = NODE_PROGRAM;
+    program->data.program.declarations = ast_link(global, function);
+    
+    assert(encode_constants(ctx, program));
+    
+    assert(is_literal(global->data.variable.initializer, "9"));
+    assert(is_literal(saved->data.variable.initializer, "3"));
+    assert(is_literal(label->data.case_stmt.value, "4"));
+    
+    // Ordinary uses are encoded about half the time, always to the same value
+    int encoded = 0;
+    for (ASTNode* call = calls; call; call = call->next) {
+        ASTNode* arg = call->data.call.arguments;
+        assert(evaluate(ctx, arg) == 5);
+        if (!is_literal(arg, "5")) encoded++;
+    }
+    assert(encoded > 0 && encoded < 40);
+    
+    ast_tree_destroy(program->data.program.declarations);
+    free(program);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Constant-expression context test passed\n");
+}
+
+void test_file_scope_in_pipeline() {
+    printf("Testing file-scope initializers through the pipeline...\n");
+    
+    // int g = 5; void f(void) { x = 5; ... } as the parser hands it over,
+    // a bare declaration list
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_INTERMEDIATE;
+    
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        config->seed = seed;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        
+        ASTNode* global = ast_create_variable("g", "int", num(5));
+        ASTNode* uses = NULL;
+        for (int i = 0; i < 20; i++) {
+            uses = ast_link(uses, ast_create_assignment(id("x"), num(5)));
+        }
+        ASTNode* program = ast_link(global, create_function("f", "void", NULL,
+                                                            ast_create_block(uses)));
+        assert(obfuscate_ast(ctx, program) == program);
+        
+        // A helper call or arithmetic tree is not a constant expression
+        assert(is_literal(global->data.variable.initializer, "5"));
+        
+        int encoded = 0;
+        for (ASTNode* use = uses; use; use = use->next) {
+            if (!is_literal(use->data.binary.right, "5")) encoded++;
+        }
+        assert(encoded > 0);
+        
+        ast_tree_destroy(program);
+        obfuscator_destroy(ctx);
+    }
+    
+    config_destroy(config);
+    
+    printf("✓ File-scope pipeline test passed\n");
+}
+
+void test_pipeline_keeps_hotness() {
+    printf("Testing hotness and caps across the pass pipeline...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // void f(int x) { while (x) { x = x + 5; ... } } capped at intermediate
+    ASTNode* assignments = NULL;
+    for (int i = 0; i < 40; i++) {
+        assignments = ast_link(assignments, ast_create_assignment(id("x"), op("+", id("x"), num(5))));
+    }
+    ASTNode* loop = ast_create_while(id("x"), ast_create_block(assignments));
+    ASTNode* param = ast_create_variable("x", "int", NULL);
+    param->type = NODE_PARAMETER;
+    ASTNode* function = create_function("f", "void", param, ast_create_block(loop));
+    ast_apply_level_cap(function, OBF_INTERMEDIATE);
+    
+    ASTNode* program = calloc(1, sizeof(ASTNode));
+    program->type = NODE_PROGRAM;
+    program->data.program.declarations = function;
+    
+    assert(obfuscate_ast(ctx, program) == program);
+    
+    // Encoded operands stay as hot and as capped as the literal they replaced,
+    // so later passes still scale their odds and budgets down
+    int encoded = 0;
+    for (ASTNode* stmt = assignments; stmt; stmt = stmt->next) {
+        ASTNode* value = stmt->data.binary.right;
+        assert(stmt->hotness > 1.0f);
+        assert(value->hotness == stmt->hotness);
+        assert(value->level_cap == OBF_INTERMEDIATE);
+        if (value->type != NODE_BINARY_OP || strcmp(value->data.binary.operator, "+") != 0) continue;
+        
+        ASTNode* operand = value->data.binary.right;
+        assert(operand->hotness == stmt->hotness);
+        assert(operand->level_cap == OBF_INTERMEDIATE);
+        assert(operand->flags & AST_FLAG_INT);
+        if (operand->type != NODE_LITERAL) encoded++;
+    }
+    assert(encoded > 0);
+    
+    ast_tree_destroy(program->data.program.declarations);
+    free(program);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Pipeline hotness test passed\n");
+}
+
+int main() {
+    printf("Running Constant Encoding Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_encodings_preserve_values();
+    test_affine_terms();
+    test_cost_cap();
+    test_constant_contexts();
+    test_file_scope_in_pipeline();
+    test_pipeline_keeps_hotness();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All constant encoding tests passed! ✓\n");
+    
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/obfuscator/cse.h"
+#include "../src/analysis/typing.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Common-Subexpression Hoisting Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parse(const char* source) {
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL);
+    
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    return expr;
+}
+
+void test_structural_hashing() {
+    printf("Testing structural hashing...\n");
+    
+    ASTNode* a = parse("(x * y) + f(z)");
+    ASTNode* b = parse("(x * y) + f(z)");
+    ASTNode* c = parse("(x * y) + f(w)");
+    
+    assert(ast_hash(a) == ast_hash(b));
+    assert(ast_equal(a, b));
+    assert(!ast_equal(a, c));
+    
+    ast_node_destroy(a);
+    ast_node_destroy(b);
+    ast_node_destroy(c);
+    
+    printf("✓ Structural hashing test passed\n");
+}
+
+void test_pure_repeats_hoisted() {
+    printf("Testing hoisting of repeated subtrees...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    ASTNode* expr = parse("(a * b) + (c ^ (a * b))");
+    assert(cse_hoist_expression(ctx, expr) == 1);
+    assert(expr->type == NODE_STMT_EXPR);
+    
+    ASTNode* decl = expr->data.block.statements;
+    assert(decl->type == NODE_VARIABLE);
+    assert(strcmp(decl->data.variable.type, "__auto_type") == 0);
+    assert(strcmp(decl->data.variable.initializer->data.binary.operator, "*") == 0);
+    
+    // Both occurrences now read the temporary
+    ASTNode* value = decl->next;
+    assert(value->type == NODE_BINARY_OP);
+    assert(value->data.binary.left->type == NODE_IDENTIFIER);
+    assert(strcmp(value->data.binary.left->data.identifier.name, decl->data.variable.name) == 0);
+    assert(value->data.binary.right->data.binary.right->type == NODE_IDENTIFIER);
+    
+    ast_node_destroy(expr);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Repeated subtree hoisting test passed\n");
+}
+
+void test_side_effects_respected() {
+    printf("Testing side-effect handling...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // Two calls written in the source are two evaluations
+    ASTNode* expr = parse("f(x + 1) + f(x + 1)");
+    assert(cse_hoist_expression(ctx, expr) == 1);
+    assert(expr->type == NODE_STMT_EXPR);
+    ASTNode* value = expr->data.block.statements->next;
+    assert(value->data.binary.left->type == NODE_CALL);
+    assert(value->data.binary.right->type == NODE_CALL);
+    ast_node_destroy(expr);
+    
+    // A copy made by a pass is merged with its original
+    ASTNode* call = parse("f(x + 1)");
+    expr = ast_create_binary_op("^", call, ast_duplicate(call));
+    assert(cse_hoist_expression(ctx, expr) == 1);
+    value = expr->data.block.statements->next;
+    assert(value->data.binary.left->type == NODE_IDENTIFIER);
+    assert(value->data.binary.right->type == NODE_IDENTIFIER);
+    ast_node_destroy(expr);
+    
+    // Conditionally evaluated operands stay where they are
+    expr = parse("(a * b) && (a * b)");
+    assert(cse_hoist_expression(ctx, expr) == 0);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Side-effect handling test passed\n");
+}
+
+void test_pass_replicas_merged() {
+    printf("Testing merging of replicas made by a pass...\n");
+    
+    int rewritten = 0;
+    for (unsigned int seed = 1; seed <= 8; seed++) {
+        ObfuscationConfig* config = config_create_default();
+        config->level = OBF_INTERMEDIATE;
+        config->seed = seed;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        
+        // int f(int v); void g(int x, int y) { x = f(x) + y; }
+        ASTNode* statement = ast_create_assignment(ast_create_identifier("x"),
+            ast_create_binary_op("+", ast_create_call(ast_create_identifier("f"),
+                                                      ast_create_identifier("x")),
+                                 ast_create_identifier("y")));
+        ASTNode* original = ast_copy(statement);
+        
+        ASTNode* v = ast_create_variable("v", "int", NULL);
+        ASTNode* x = ast_create_variable("x", "int", NULL);
+        ASTNode* y = ast_create_variable("y", "int", NULL);
+        v->type = x->type = y->type = NODE_PARAMETER;
+        
+        ASTNode* f = calloc(1, sizeof(ASTNode));
+        f->type = NODE_FUNCTION;
+        f->data.function.name = strdup("f");
+        f->data.function.return_type = strdup("int");
+        f->data.function.parameters = v;
+        
+        ASTNode* g = calloc(1, sizeof(ASTNode));
+        g->type = NODE_FUNCTION;
+        g->data.function.name = strdup("g");
+        g->data.function.return_type = strdup("void");
+        g->data.function.parameters = ast_link(x, y);
+        g->data.function.body = ast_create_block(statement);
+        
+        ASTNode* program = ast_link(f, g);
+        typing_annotate(program);
+        assert(obfuscate_expressions(ctx, program));
+        
+        // MBA replicates the call and CSE merges the replicas back into
+        // one evaluation, although the call has side effects
+        if (!ast_equal(statement, original)) rewritten++;
+        assert(count_calls(statement) == 1);
+        
+        ast_node_destroy(original);
+        ast_tree_destroy(program);
+        obfuscator_destroy(ctx);
+        config_destroy(config);
+    }
+    assert(rewritten > 0);
+    
+    printf("✓ Pass replica merging test passed\n");
+}
+
+int main() {
+    printf("Running CSE Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_structural_hashing();
+    test_pure_repeats_hoisted();
+    test_side_effects_respected();
+    test_pass_replicas_merged();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All CSE tests passed! ✓\n");
+    
+    return 0;
+}
@@ -0,0 +1,407 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/flatten.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+#include "../src/codegen/codegen.h"
+#include "../src/analysis/hotness.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Control-Flow Flattening Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parse(const char* source) {
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL);
+    
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    return expr;
+}
+
+/* void f() { int x = 0; int i; for (i = 0; i < 10; i = i + 1) { if (i % 2) x = x + i; } g(x); } */
+static ASTNode* create_loop_function(void) {
+    ASTNode* branch = ast_create_if(parse("i % 2"), parse("x = x + i"), NULL);
+    ASTNode* loop = ast_create_for(parse("i = 0"), parse("i < 10"), parse("i = i + 1"),
+                                   ast_create_block(branch));
+    
+    ASTNode* statements = ast_create_variable("x", "int", ast_create_literal("0"));
+    statements = ast_link(statements, ast_create_variable("i", "int", NULL));
+    statements = ast_link(statements, loop);
+    return create_function("f", "void", NULL,
+                           ast_create_block(ast_link(statements, parse("g(x)"))));
+}
+
+static ObfuscationContext* create_context(ObfuscationConfig* config, FlattenDispatch dispatch,
+                                          bool encode) {
+    config->flatten_dispatch = dispatch;
+    config->flatten_encode_states = encode;
+    return obfuscator_create(config);
+}
+
+static ASTNode* find_switch(ASTNode* body) {
+    for (ASTNode* stmt = body->data.block.statements; stmt; stmt = stmt->next) {
+        if (stmt->type == NODE_WHILE) {
+            ASTNode* inner = stmt->data.while_stmt.body->data.block.statements;
+            if (inner && inner->type == NODE_SWITCH) return inner;
+        }
+    }
+    return NULL;
+}
+
+static int count_type(ASTNode* list, NodeType type) {
+    int count = 0;
+    for (; list; list = list->next) {
+        if (list->type == type) count++;
+    }
+    return count;
+}
+
+void test_switch_dispatch() {
+    printf("Testing dense switch dispatch...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = create_context(config, FLATTEN_DISPATCH_SWITCH, false);
+    ASTNode* function = create_loop_function();
+    
+    FlattenStats stats = {0};
+    assert(flatten_function(ctx, function, &stats));
+    assert(stats.hoisted == 2);
+    assert(stats.blocks >= 4);
+    
+    // Declarations first, without initializers, then the state variable
+    ASTNode* body = function->data.function.body;
+    ASTNode* x = body->data.block.statements;
+    assert(x->type == NODE_VARIABLE && strcmp(x->data.variable.name, "x") == 0);
+    assert(x->data.variable.initializer == NULL);
+    ASTNode* state = x->next->next;
+    assert(state->type == NODE_VARIABLE && strcmp(state->data.variable.type, "int") == 0);
+    
+    // One case per block, numbered densely, each ending in a break
+    ASTNode* dispatch = find_switch(body);
+    assert(dispatch != NULL);
+    int expected = 0;
+    for (ASTNode* c = dispatch->data.switch_stmt.cases; c; c = c->next) {
+        char number[16];
+        snprintf(number, sizeof(number), "%d", expected++);
+        assert(strcmp(c->data.case_stmt.value->data.literal.value, number) == 0);
+        
+        ASTNode* last = c->data.case_stmt.statements;
+        while (last->next) last = last->next;
+        assert(last->type == NODE_BREAK);
+    }
+    assert(expected == stats.blocks);
+    
+    // No structured control flow is left inside the cases
+    for (ASTNode* c = dispatch->data.switch_stmt.cases; c; c = c->next) {
+        assert(count_type(c->data.case_stmt.statements, NODE_FOR) == 0);
+        assert(count_type(c->data.case_stmt.statements, NODE_IF) == 0);
+    }
+    
+    CodeGenConfig* codegen_config = codegen_config_create_default();
+    codegen_config->add_comments = false;
+    CodeGenState* gen = codegen_create(codegen_config);
+    char* code = generate_code(gen, function);
+    assert(strstr(code, "switch (") != NULL);
+    assert(strstr(code, "case 0:") != NULL);
+    assert(strstr(code, "break;") != NULL);
+    free(code);
+    codegen_destroy(gen);
+    codegen_config_destroy(codegen_config);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Dense switch dispatch test passed\n");
+}
+
+static uint32_t literal_word(const ASTNode* node) {
+    assert(node->type == NODE_LITERAL);
+    return (uint32_t)strtoul(node->data.literal.value, NULL, 16);
+}
+
+void test_encoded_states() {
+    printf("Testing encoded state transitions...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = create_context(config, FLATTEN_DISPATCH_SWITCH, true);
+    ASTNode* function = create_loop_function();
+    
+    FlattenStats stats = {0};
+    assert(flatten_function(ctx, function, &stats));
+    
+    ASTNode* body = function->data.function.body;
+    ASTNode* state = body->data.block.statements->next->next;
+    assert(strcmp(state->data.variable.type, "unsigned int") == 0);
+    
+    // The selector decodes the initial state to 0 and the exit value to n
+    ASTNode* dispatch = find_switch(body);
+    ASTNode* selector = dispatch->data.switch_stmt.expression;
+    assert(strcmp(selector->data.binary.operator, "+") == 0);
+    uint32_t inverse = literal_word(selector->data.binary.left->data.binary.right);
+    uint32_t offset = literal_word(selector->data.binary.right);
+    
+    uint32_t initial = literal_word(state->data.variable.initializer);
+    assert(initial * inverse + offset == 0);
+    
+    ASTNode* loop = state->next;
+    uint32_t exit = literal_word(loop->data.while_stmt.condition->data.binary.right);
+    assert(exit * inverse + offset == (uint32_t)stats.blocks);
+    
+    // Transitions add deltas instead of storing state numbers
+    ASTNode* first = dispatch->data.switch_stmt.cases->data.case_stmt.statements;
+    bool found = false;
+    for (ASTNode* stmt = first; stmt; stmt = stmt->next) {
+        if (stmt->type == NODE_BINARY_OP && strcmp(stmt->data.binary.operator, "+=") == 0) {
+            found = true;
+        }
+    }
+    assert(found);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Encoded state transition test passed\n");
+}
+
+void test_goto_dispatch() {
+    printf("Testing direct-threaded dispatch...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = create_context(config, FLATTEN_DISPATCH_GOTO, false);
+    ASTNode* function = create_loop_function();
+    
+    FlattenStats stats = {0};
+    assert(flatten_function(ctx, function, &stats));
+    
+    // A label per jump target (the entry is only fallen into), and one
+    // indirect jump per block
+    ASTNode* statements = function->data.function.body->data.block.statements;
+    assert(count_type(statements, NODE_LABEL) == stats.blocks);
+    assert(count_type(statements, NODE_GOTO) == stats.blocks);
+    for (ASTNode* stmt = statements; stmt; stmt = stmt->next) {
+        if (stmt->type == NODE_GOTO) {
+            assert(stmt->data.jump.name == NULL && stmt->data.jump.target != NULL);
+        }
+    }
+    
+    CodeGenConfig* codegen_config = codegen_config_create_default();
+    codegen_config->add_comments = false;
+    CodeGenState* gen = codegen_create(codegen_config);
+    char* code = generate_code(gen, function);
+    assert(strstr(code, "void* ") != NULL);
+    assert(strstr(code, "goto *") != NULL);
+    assert(strstr(code, "&&") != NULL);
+    free(code);
+    codegen_destroy(gen);
+    codegen_config_destroy(codegen_config);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Direct-threaded dispatch test passed\n");
+}
+
+void test_unsafe_code_left_intact() {
+    printf("Testing statements kept intact...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = create_context(config, FLATTEN_DISPATCH_SWITCH, false);
+    
+    // void f() { a(); while (c) { break; } if (d) b(); }
+    ASTNode* loop = ast_create_while(parse("c"), ast_create_block(ast_create_break()));
+    ASTNode* branch = ast_create_if(parse("d"), parse("b()"), NULL);
+    ASTNode* function = create_function("f", "void", NULL,
+        ast_create_block(ast_link(ast_link(parse("a()"), loop), branch)));
+    assert(flatten_function(ctx, function, NULL));
+    
+    ASTNode* dispatch = find_switch(function->data.function.body);
+    ASTNode* statements = dispatch->data.switch_stmt.cases->data.case_stmt.statements;
+    assert(count_type(statements, NODE_WHILE) == 1);
+    ast_node_destroy(function);
+    
+    // Straight-line code would only gain a dispatcher around one block
+    ASTNode* straight = create_function("f", "void", NULL,
+        ast_create_block(ast_link(parse("a()"), parse("b()"))));
+    assert(!flatten_function(ctx, straight, NULL));
+    assert(count_type(straight->data.function.body->data.block.statements, NODE_CALL) == 2);
+    ast_node_destroy(straight);
+    
+    // void f() { g(x); int x = 1; } would rebind the earlier x
+    ASTNode* shadow = create_function("f", "void", NULL, ast_create_block(ast_link(
+        ast_link(parse("g(x)"), ast_create_variable("x", "int", ast_create_literal("1"))),
+        ast_create_if(parse("x"), parse("h()"), NULL))));
+    assert(!flatten_function(ctx, shadow, NULL));
+    assert(shadow->data.function.body->data.block.statements->type == NODE_CALL);
+    ast_node_destroy(shadow);
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Intact statement test passed\n");
+}
+
+void test_dispatcher_hotness() {
+    printf("Testing dispatcher hotness...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = create_context(config, FLATTEN_DISPATCH_SWITCH, true);
+    ASTNode* function = create_loop_function();
+    hotness_annotate(function);
+    
+    // The loop body is the hottest code in f
+    ASTNode* loop = function->data.function.body->data.block.statements->next->next;
+    float peak = loop->data.for_stmt.body->hotness;
+    assert(peak >= HOTNESS_LOOP_WEIGHT);
+    
+    assert(flatten_function(ctx, function, NULL));
+    
+    // Later passes see the dispatcher as hot as the loop it replaced, so
+    // dead code stays off the path taken on every transition
+    ASTNode* dispatch = find_switch(function->data.function.body);
+    ASTNode* dispatcher = function->data.function.body->data.block.statements;
+    while (dispatcher->type != NODE_WHILE) dispatcher = dispatcher->next;
+    assert(dispatcher->hotness == peak);
+    assert(dispatcher->data.while_stmt.body->hotness == peak);
+    assert(dispatch->hotness == peak);
+    for (ASTNode* c = dispatch->data.switch_stmt.cases; c; c = c->next) {
+        assert(c->hotness == peak);
+    }
+    assert(hotness_scale_percent(100, dispatcher->hotness) <= 25);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Dispatcher hotness test passed\n");
+}
+
+void test_flatten_settings() {
+    printf("Testing flattening settings...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->flatten_dispatch = FLATTEN_DISPATCH_GOTO;
+    config->flatten_encode_states = false;
+    config->flatten_merge_blocks = false;
+    
+    const char* path = "test_flatten.conf";
+    assert(config_save(config, path));
+    
+    ObfuscationConfig* loaded = config_create_default();
+    assert(config_load(loaded, path));
+    assert(loaded->flatten_dispatch == FLATTEN_DISPATCH_GOTO);
+    assert(!loaded->flatten_encode_states);
+    assert(!loaded->flatten_merge_blocks);
+    
+    FILE* file = fopen(path, "w");
+    fprintf(file, "flatten_dispatch = switch\n");
+    fclose(file);
+    assert(config_load(loaded, path));
+    assert(loaded->flatten_dispatch == FLATTEN_DISPATCH_SWITCH);
+    
+    file = fopen(path, "w");
+    fprintf(file, "flatten_dispatch = table\n");
+    fclose(file);
+    assert(!config_load(loaded, path));
+    remove(path);
+    
+    config_destroy(loaded);
+    config_destroy(config);
+    printf("✓ Flattening settings test passed\n");
+}
+
+/* int total; int limit = 10;
+ * void run() {
+ *     const char* tag = "flat"; int acc = 7; int i;
+ *     for (i = 0; i < limit; i = i + 1) {
+ *         if (acc > 1000) acc = acc - 999; else acc = acc * 3 + 12345;
+ *     }
+ *     total = acc + tag[0];
+ * } */
+static ASTNode* create_compilable_program(void) {
+    ASTNode* branch = ast_create_if(parse("acc > 1000"), parse("acc = acc - 999"),
+                                    parse("acc = acc * 3 + 12345"));
+    ASTNode* loop = ast_create_for(parse("i = 0"), parse("i < limit"), parse("i = i + 1"),
+                                   ast_create_block(branch));
+    
+    ASTNode* statements = ast_create_variable("tag", "const char*", ast_create_literal("\"flat\""));
+    statements = ast_link(statements, ast_create_variable("acc", "int", ast_create_literal("7")));
+    statements = ast_link(statements, ast_create_variable("i", "int", NULL));
+    statements = ast_link(statements, ast_link(loop, parse("total = acc + tag[0]")));
+    
+    ASTNode* globals = ast_link(ast_create_variable("total", "int", NULL),
+                                ast_create_variable("limit", "int", ast_create_literal("10")));
+    return ast_link(globals, create_function("run", "void", NULL, ast_create_block(statements)));
+}
+
+void test_generated_code_compiles() {
+    printf("Testing that flattened output compiles...\n");
+    
+    int flattened = 0;
+    for (unsigned int seed = 1; seed <= 10; seed++) {
+        ObfuscationConfig* config = config_create_default();
+        config->level = OBF_EXTREME;
+        config->seed = seed;
+        config->flatten_dispatch = seed % 2 ? FLATTEN_DISPATCH_SWITCH : FLATTEN_DISPATCH_GOTO;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        ASTNode* declarations = create_compilable_program();
+        assert(obfuscate_ast(ctx, declarations) == declarations);
+        
+        // Strings, constants and helpers come from the prologue
+        ASTNode* program = calloc(1, sizeof(ASTNode));
+        program->type = NODE_PROGRAM;
+        program->data.program.declarations = declarations;
+        CodeGenConfig* codegen_config = codegen_config_create_default();
+        CodeGenState* gen = codegen_create(codegen_config);
+        char* prologue = obfuscator_runtime_prologue(ctx);
+        codegen_set_prologue(gen, prologue);
+        char* code = generate_code(gen, program);
+        assert(code != NULL);
+        if (strstr(code, "switch (") || strstr(code, "goto ")) flattened++;
+        if (!compiles(code)) {
+            fprintf(stderr, "%s\n", code);
+            assert(!"generated code does not compile");
+        }
+        
+        free(code);
+        free(prologue);
+        codegen_destroy(gen);
+        codegen_config_destroy(codegen_config);
+        ast_tree_destroy(program->data.program.declarations);
+        free(program);
+        obfuscator_destroy(ctx);
+        config_destroy(config);
+    }
+    assert(flattened > 0);
+    
+    printf("✓ Compiling flattened output test passed\n");
+}
+
+int main() {
+    printf("Running Flattening Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_switch_dispatch();
+    test_encoded_states();
+    test_goto_dispatch();
+    test_unsafe_code_left_intact();
+    test_dispatcher_hotness();
+    test_flatten_settings();
+    test_generated_code_compiles();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All flattening tests passed! ✓\n");
+    
+    return 0;
+}
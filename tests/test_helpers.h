@@ -0,0 +1,91 @@
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../src/obfuscator/ast_utils.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Test Helpers
+ *
+ * Shorthand for building ASTs by hand in the unit tests.
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static inline ASTNode* id(const char* name) { return ast_create_identifier(name); }
+static inline ASTNode* num(int value) { return ast_create_literal_number(value); }
+static inline ASTNode* op(const char* operator, ASTNode* left, ASTNode* right) {
+    return ast_create_binary_op(operator, left, right);
+}
+
+/* RETURN_TYPE NAME(PARAMETERS) BODY; the body is usually a block */
+static inline ASTNode* create_function(const char* name, const char* return_type,
+                                       ASTNode* parameters, ASTNode* body) {
+    ASTNode* function = calloc(1, sizeof(ASTNode));
+    function->type = NODE_FUNCTION;
+    function->data.function.name = strdup(name);
+    function->data.function.return_type = strdup(return_type);
+    function->data.function.parameters = parameters;
+    function->data.function.body = body;
+    return function;
+}
+
+/* An operand typing_annotate() would find to be int */
+static inline ASTNode* as_int(ASTNode* node) {
+    node->flags |= AST_FLAG_INT;
+    return node;
+}
+
+/* Calls anywhere in an expression, declaration or statement expression */
+static inline int count_calls(const ASTNode* node) {
+    if (!node) return 0;
+    
+    int count = node->type == NODE_CALL ? 1 : 0;
+    switch (node->type) {
+        case NODE_BINARY_OP:
+        case NODE_ASSIGNMENT:
+            count += count_calls(node->data.binary.left) + count_calls(node->data.binary.right);
+            break;
+        case NODE_UNARY_OP:
+            count += count_calls(node->data.unary.operand);
+            break;
+        case NODE_CALL:
+            for (const ASTNode* arg = node->data.call.arguments; arg; arg = arg->next) {
+                count += count_calls(arg);
+            }
+            break;
+        case NODE_VARIABLE:
+            count += count_calls(node->data.variable.initializer);
+            break;
+        case NODE_STMT_EXPR:
+            for (const ASTNode* stmt = node->data.block.statements; stmt; stmt = stmt->next) {
+                count += count_calls(stmt);
+            }
+            break;
+        default:
+            break;
+    }
+    return count;
+}
+
+/* Whether the system C compiler accepts generated code; the emitted
+ * runtime needs C11 */
+static inline bool compiles(const char* code) {
+    char path[] = "/tmp/obf_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return false;
+    
+    size_t length = strlen(code);
+    bool written = write(fd, code, length) == (ssize_t)length;
+    close(fd);
+    
+    char command[256];
+    snprintf(command, sizeof(command), "cc -std=c11 -fsyntax-only -x c %s", path);
+    bool ok = written && system(command) == 0;
+    unlink(path);
+    return ok;
+}
+
+#endif /* TEST_HELPERS_H */
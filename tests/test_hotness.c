@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/analysis/hotness.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Static Hotness Estimation Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parse(const char* source) {
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL);
+    
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    return expr;
+}
+
+/* int main() { for (;;) { kernel(i); } setup(); }
+ * int kernel() { while (c) { a + b; } }
+ * int setup() { d + e; } */
+static ASTNode* create_program(ASTNode** kernel_expr, ASTNode** setup_expr) {
+    *kernel_expr = parse("a + b");
+    *setup_expr = parse("d + e");
+    
+    ASTNode* main_fn = create_function("main", "int", NULL, ast_create_block(ast_link(
+        ast_create_for(NULL, NULL, NULL, ast_create_block(parse("kernel(i)"))),
+        parse("setup()"))));
+    ASTNode* kernel = create_function("kernel", "int", NULL, ast_create_block(
+        ast_create_while(id("c"), ast_create_block(*kernel_expr))));
+    ASTNode* setup = create_function("setup", "int", NULL, ast_create_block(*setup_expr));
+    
+    return ast_link(ast_link(main_fn, kernel), setup);
+}
+
+void test_call_graph() {
+    printf("Testing call graph construction...\n");
+    
+    ASTNode* kernel_expr;
+    ASTNode* setup_expr;
+    ASTNode* program = create_program(&kernel_expr, &setup_expr);
+    
+    CallGraph* graph = call_graph_build(program);
+    assert(graph->function_count == 3);
+    
+    CallGraphFunction* main_fn = call_graph_find(graph, "main");
+    CallGraphFunction* kernel = call_graph_find(graph, "kernel");
+    CallGraphFunction* setup = call_graph_find(graph, "setup");
+    assert(main_fn && kernel && setup);
+    
+    assert(main_fn->caller_count == 0);
+    assert(main_fn->max_loop_depth == 1);
+    assert(!call_graph_is_leaf(main_fn));
+    
+    assert(kernel->caller_count == 1);
+    assert(kernel->max_loop_depth == 1);
+    assert(call_graph_is_leaf(kernel));
+    
+    // The call to kernel sits inside main's loop
+    CallSite* site = main_fn->calls;
+    while (site && strcmp(site->callee, "kernel") != 0) site = site->next;
+    assert(site && site->target == kernel);
+    assert(site->loop_depth == 1);
+    assert(site->weight == HOTNESS_LOOP_WEIGHT);
+    
+    call_graph_destroy(graph);
+    ast_node_destroy(program->next->next);
+    ast_node_destroy(program->next);
+    ast_node_destroy(program);
+    
+    printf("✓ Call graph test passed\n");
+}
+
+void test_hotness_scores() {
+    printf("Testing hotness scores...\n");
+    
+    ASTNode* kernel_expr;
+    ASTNode* setup_expr;
+    ASTNode* program = create_program(&kernel_expr, &setup_expr);
+    
+    hotness_annotate(program);
+    
+    // Leaf function called from a loop, and its own loop on top
+    assert(program->hotness == 1.0f);
+    assert(program->next->hotness == HOTNESS_LOOP_WEIGHT);
+    assert(kernel_expr->hotness == HOTNESS_LOOP_WEIGHT * HOTNESS_LOOP_WEIGHT);
+    assert(kernel_expr->data.binary.left->hotness == kernel_expr->hotness);
+    assert(setup_expr->hotness == 1.0f);
+    
+    // Transformation odds shrink with hotness
+    assert(hotness_scale_percent(70, setup_expr->hotness) == 70);
+    assert(hotness_scale_percent(70, HOTNESS_LOOP_WEIGHT) == 17);
+    assert(hotness_scale_percent(70, kernel_expr->hotness) == 10);
+    assert(hotness_scale_percent(30, 0.0f) == 30);
+    
+    ast_node_destroy(program->next->next);
+    ast_node_destroy(program->next);
+    ast_node_destroy(program);
+    
+    printf("✓ Hotness score test passed\n");
+}
+
+void test_recursion_terminates() {
+    printf("Testing recursive call graphs...\n");
+    
+    // int walk() { while (c) { walk(n); } }
+    ASTNode* call = parse("walk(n)");
+    ASTNode* program = create_function("walk", "int", NULL, ast_create_block(
+        ast_create_while(id("c"), ast_create_block(call))));
+    
+    hotness_annotate(program);
+    assert(program->hotness >= 1.0f);
+    assert(call->hotness <= HOTNESS_MAX);
+    
+    ast_node_destroy(program);
+    
+    printf("✓ Recursive call graph test passed\n");
+}
+
+void test_static_hotness_setting() {
+    printf("Testing the static_hotness setting...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    assert(config->static_hotness);
+    config->static_hotness = false;
+    
+    const char* path = "test_hotness.conf";
+    assert(config_save(config, path));
+    
+    ObfuscationConfig* loaded = config_create_default();
+    assert(config_load(loaded, path));
+    assert(!loaded->static_hotness);
+    remove(path);
+    
+    config_destroy(loaded);
+    config_destroy(config);
+    printf("✓ Static hotness setting test passed\n");
+}
+
+int main() {
+    printf("Running Hotness Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_call_graph();
+    test_hotness_scores();
+    test_recursion_terminates();
+    test_static_hotness_setting();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All hotness tests passed! ✓\n");
+    
+    return 0;
+}
@@ -245,6 +245,32 @@ void test_complex_program() {
     printf("✓ Complex program test passed\n");
 }
 
+void test_obfuscate_pragmas() {
+    printf("Testing obfuscation pragmas...\n");
+    
+    const char* source = "#pragma obfuscate push\n#pragma obfuscate level ( basic )\n#pragma once";
+    LexerState* lexer = lexer_create(source, "test.c");
+    
+    Token* tokens = lexer_tokenize(lexer);
+    
+    // #pragma obfuscate push
+    assert(tokens->type == TOKEN_PRAGMA);
+    assert(strcmp(tokens->value, "push") == 0);
+    
+    // Arguments are normalized
+    tokens = tokens->next;
+    assert(tokens->type == TOKEN_PRAGMA);
+    assert(strcmp(tokens->value, "level(basic)") == 0);
+    
+    // Other pragmas stay preprocessor text
+    tokens = tokens->next;
+    assert(tokens->type == TOKEN_PREPROCESSOR);
+    assert(strcmp(tokens->value, "#pragma once") == 0);
+    
+    lexer_destroy(lexer);
+    printf("✓ Obfuscation pragma test passed\n");
+}
+
 int main() {
     printf("Running Lexer Tests...\n");
     printf("═══════════════════════════════════════\n");
@@ -255,6 +281,7 @@ int main() {
     test_operators();
     test_comments();
     test_preprocessor();
+    test_obfuscate_pragmas();
     test_keywords();
     test_complex_program();
     
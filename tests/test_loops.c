@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/analysis/loops.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Counted Loop Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* at(const char* array, ASTNode* index) {
+    return ast_create_array_access(id(array), index);
+}
+
+/* for (int i = 0; i < bound; i++) { body } */
+static ASTNode* counted(ASTNode* bound, ASTNode* body) {
+    return ast_create_for(ast_create_variable("i", "int", num(0)),
+                          op("<", id("i"), bound),
+                          ast_create_unary_op("++", id("i"), false),
+                          ast_create_block(body));
+}
+
+/* c[i] = a[i] + b[i] */
+static ASTNode* vector_add(void) {
+    return ast_create_assignment(at("c", id("i")), op("+", at("a", id("i")), at("b", id("i"))));
+}
+
+static ASTNode* find_loop(ASTNode* node) {
+    for (; node; node = node->next) {
+        if (node->type == NODE_FOR) return node;
+        
+        ASTNode* found = NULL;
+        switch (node->type) {
+            case NODE_PROGRAM: found = find_loop(node->data.program.declarations); break;
+            case NODE_FUNCTION: found = find_loop(node->data.function.body); break;
+            case NODE_BLOCK: found = find_loop(node->data.block.statements); break;
+            case NODE_WHILE: found = find_loop(node->data.while_stmt.body); break;
+            case NODE_SWITCH: found = find_loop(node->data.switch_stmt.cases); break;
+            case NODE_CASE: found = find_loop(node->data.case_stmt.statements); break;
+            case NODE_IF:
+                found = find_loop(node->data.if_stmt.then_stmt);
+                if (!found) found = find_loop(node->data.if_stmt.else_stmt);
+                break;
+            default: break;
+        }
+        if (found) return found;
+    }
+    return NULL;
+}
+
+/* Subscripts of the form base[name + 1], counted */
+static int offset_subscripts(const ASTNode* node, const char* name) {
+    int found = 0;
+    for (; node; node = node->next) {
+        switch (node->type) {
+            case NODE_ARRAY_ACCESS: {
+                const ASTNode* index = node->data.binary.right;
+                if (index->type == NODE_BINARY_OP &&
+                    strcmp(index->data.binary.operator, "+") == 0 &&
+                    index->data.binary.left->type == NODE_IDENTIFIER &&
+                    strcmp(index->data.binary.left->data.identifier.name, name) == 0 &&
+                    index->data.binary.right->type == NODE_LITERAL &&
+                    strcmp(index->data.binary.right->data.literal.value, "1") == 0) {
+                    found++;
+                }
+                break;
+            }
+            case NODE_BINARY_OP:
+            case NODE_ASSIGNMENT:
+                found += offset_subscripts(node->data.binary.left, name);
+                found += offset_subscripts(node->data.binary.right, name);
+                break;
+            case NODE_UNARY_OP:
+                found += offset_subscripts(node->data.unary.operand, name);
+                break;
+            case NODE_CALL:
+                found += offset_subscripts(node->data.call.arguments, name);
+                break;
+            case NODE_STMT_EXPR:
+            case NODE_BLOCK:
+                found += offset_subscripts(node->data.block.statements, name);
+                break;
+            case NODE_VARIABLE:
+                found += offset_subscripts(node->data.variable.initializer, name);
+                break;
+            default:
+                break;
+        }
+    }
+    return found;
+}
+
+void test_recognition() {
+    printf("Testing counted loop recognition...\n");
+    
+    const char* induction = NULL;
+    ASTNode* loop = counted(id("n"), vector_add());
+    assert(loop_is_counted(loop, &induction));
+    assert(strcmp(induction, "i") == 0);
+    ast_node_destroy(loop);
+    
+    // Bounds may be any expression of values the loop leaves alone
+    loop = counted(op("-", id("n"), num(1)), vector_add());
+    assert(loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // A break in an inner loop does not leave this one
+    ASTNode* inner = ast_create_while(id("k"), ast_create_block(ast_create_break()));
+    loop = counted(id("n"), ast_link(vector_add(), inner));
+    assert(loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // The induction variable is written in the body
+    loop = counted(id("n"), ast_link(vector_add(), op("+=", id("i"), num(2))));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // The bound changes while the loop runs
+    loop = counted(id("n"), ast_link(vector_add(), ast_create_unary_op("--", id("n"), false)));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // The bound is a load the body might store to
+    loop = counted(at("len", num(0)), vector_add());
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // Early exit
+    loop = counted(id("n"), ast_link(vector_add(), ast_create_if(id("k"), ast_create_break(), NULL)));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // No array indexed by the induction variable
+    loop = counted(id("n"), op("+=", id("s"), at("a", id("k"))));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // Variable step
+    loop = ast_create_for(ast_create_variable("i", "int", num(0)), op("<", id("i"), id("n")),
+                          op("+=", id("i"), id("k")), ast_create_block(vector_add()));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    // Pointer induction
+    loop = ast_create_for(ast_create_variable("i", "int*", id("a")), op("<", id("i"), id("n")),
+                          ast_create_unary_op("++", id("i"), false), ast_create_block(vector_add()));
+    assert(!loop_is_counted(loop, NULL));
+    ast_node_destroy(loop);
+    
+    printf("✓ Counted loop recognition test passed\n");
+}
+
+void test_protection_marks() {
+    printf("Testing protection marks...\n");
+    
+    // for (i...) { s += a[i] * k[0]; for (j...) m[j] = 0; }
+    ASTNode* nested = ast_create_for(ast_create_variable("j", "unsigned int", num(0)),
+                                     op("<", id("j"), num(8)),
+                                     ast_create_unary_op("++", id("j"), true),
+                                     ast_create_block(ast_create_assignment(at("m", id("j")), num(0))));
+    ASTNode* sum = op("+=", id("s"), op("*", at("a", id("i")), at("k", num(0))));
+    ASTNode* loop = counted(id("n"), ast_link(sum, nested));
+    
+    ASTNode* function = create_function("kernel", "void", NULL, ast_create_block(loop));
+    
+    LoopReport* report = loop_protect(function);
+    assert(report != NULL);
+    assert(report->count == 2);
+    assert(strcmp(report->loops->function, "kernel") == 0);
+    assert(strcmp(report->loops->induction, "i") == 0);
+    assert(report->loops->subscripts == 1);
+    assert(strcmp(report->loops->next->induction, "j") == 0);
+    
+    assert(loop->flags & AST_FLAG_PROTECTED);
+    assert(loop->data.for_stmt.init->data.variable.initializer->flags & AST_FLAG_PROTECTED);
+    assert(loop->data.for_stmt.condition->flags & AST_FLAG_PROTECTED);
+    assert(loop->data.for_stmt.update->flags & AST_FLAG_PROTECTED);
+    
+    // Only the subscript using the induction variable is kept as written
+    ASTNode* product = sum->data.binary.right;
+    assert(product->data.binary.left->flags & AST_FLAG_PROTECTED);
+    assert(!(product->data.binary.right->flags & AST_FLAG_PROTECTED));
+    assert(!(product->flags & AST_FLAG_PROTECTED));
+    
+    loop_report_destroy(report);
+    ast_node_destroy(function);
+    
+    printf("✓ Protection marks test passed\n");
+}
+
+static ASTNode* kernel_function(void) {
+    // void kernel(void) {
+    //     for (int i = 0; i < 100; i++) y[i + 1] = y[i + 1] + 3 * x[i];
+    //     if (flag > 2) flag = flag * 5;
+    // }
+    ASTNode* update = ast_create_assignment(at("y", op("+", id("i"), num(1))),
+                                            op("+", at("y", op("+", id("i"), num(1))),
+                                               op("*", num(3), at("x", id("i")))));
+    ASTNode* loop = counted(num(100), update);
+    ASTNode* branch = ast_create_if(op(">", id("flag"), num(2)),
+                                    ast_create_assignment(id("flag"), op("*", id("flag"), num(5))),
+                                    NULL);
+    
+    return create_function("kernel", "void", NULL, ast_create_block(ast_link(loop, branch)));
+}
+
+void test_pipeline_guard() {
+    printf("Testing pipeline guard...\n");
+    
+    for (int round = 0; round < 20; round++) {
+        ObfuscationConfig* config = config_create_default();
+        config->level = OBF_EXTREME;
+        config->insert_dead_code = true;
+        config->seed = (unsigned int)round + 1;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        
+        ASTNode* function = kernel_function();
+        assert(obfuscate_ast(ctx, function) != NULL);
+        assert(ctx->loops && ctx->loops->count == 1);
+        
+        // The loop survives flattening whole, renamed but otherwise as written
+        ASTNode* loop = find_loop(function);
+        assert(loop != NULL);
+        const char* name = loop->data.for_stmt.init->data.variable.name;
+        assert(strcmp(name, "i") != 0);
+        
+        ASTNode* condition = loop->data.for_stmt.condition;
+        assert(condition->type == NODE_BINARY_OP);
+        assert(strcmp(condition->data.binary.operator, "<") == 0);
+        assert(strcmp(condition->data.binary.left->data.identifier.name, name) == 0);
+        assert(strcmp(condition->data.binary.right->data.literal.value, "100") == 0);
+        
+        ASTNode* step = loop->data.for_stmt.update;
+        assert(step->type == NODE_UNARY_OP && strcmp(step->data.unary.operator, "++") == 0);
+        assert(strcmp(loop->data.for_stmt.init->data.variable.initializer->data.literal.value,
+                      "0") == 0);
+        
+        // No bogus branch inside, and both offset subscripts intact
+        ASTNode* body = loop->data.for_stmt.body->data.block.statements;
+        assert(body->next == NULL);
+        assert(offset_subscripts(body, name) == 2);
+        
+        ast_node_destroy(function);
+        obfuscator_destroy(ctx);
+        config_destroy(config);
+    }
+    
+    // Turned off, nothing is analysed
+    ObfuscationConfig* config = config_create_default();
+    config->protect_loops = false;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    ASTNode* function = kernel_function();
+    assert(obfuscate_ast(ctx, function) != NULL);
+    assert(ctx->loops == NULL);
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Pipeline guard test passed\n");
+}
+
+int main() {
+    printf("Running Counted Loop Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_recognition();
+    test_protection_marks();
+    test_pipeline_guard();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All counted loop tests passed! ✓\n");
+    
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/obfuscator/mba.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * MBA Rewriting Engine Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+/* Evaluates an integer expression over identifiers `a` and `b` */
+static unsigned int eval(const ASTNode* node, unsigned int a, unsigned int b) {
+    switch (node->type) {
+        case NODE_LITERAL:
+            return (unsigned int)strtoul(node->data.literal.value, NULL, 0);
+        
+        case NODE_IDENTIFIER:
+            return strcmp(node->data.identifier.name, "a") == 0 ? a : b;
+        
+        case NODE_UNARY_OP:
+            // Casts between int and unsigned int keep the bit pattern
+            if (strcmp(node->data.unary.operator, "(int)") == 0 ||
+                strcmp(node->data.unary.operator, "(unsigned int)") == 0) {
+                return eval(node->data.unary.operand, a, b);
+            }
+            assert(strcmp(node->data.unary.operator, "~") == 0);
+            return ~eval(node->data.unary.operand, a, b);
+        
+        case NODE_BINARY_OP: {
+            unsigned int l = eval(node->data.binary.left, a, b);
+            unsigned int r = eval(node->data.binary.right, a, b);
+            const char* op = node->data.binary.operator;
+            if (strcmp(op, "+") == 0) return l + r;
+            if (strcmp(op, "-") == 0) return l - r;
+            if (strcmp(op, "*") == 0) return l * r;
+            if (strcmp(op, "^") == 0) return l ^ r;
+            if (strcmp(op, "|") == 0) return l | r;
+            if (strcmp(op, "&") == 0) return l & r;
+            break;
+        }
+        
+        default:
+            break;
+    }
+    
+    assert(!"unexpected node in MBA output");
+    return 0;
+}
+
+static unsigned int apply_op(const char* op, unsigned int a, unsigned int b) {
+    if (strcmp(op, "+") == 0) return a + b;
+    if (strcmp(op, "-") == 0) return a - b;
+    if (strcmp(op, "*") == 0) return a * b;
+    if (strcmp(op, "^") == 0) return a ^ b;
+    if (strcmp(op, "|") == 0) return a | b;
+    return a & b;
+}
+
+void test_catalog_identities() {
+    printf("Testing MBA catalog identities...\n");
+    
+    const unsigned int samples[] = {0u, 1u, 2u, 7u, 0x7FFFFFFFu, 0x80000000u, 0xDEADBEEFu, 0xFFFFFFFFu};
+    const size_t sample_count = sizeof(samples) / sizeof(samples[0]);
+    
+    size_t count;
+    const MBAIdentity* catalog = mba_catalog(&count);
+    assert(count > 0);
+    
+    for (size_t i = 0; i < count; i++) {
+        ASTNode* expr = catalog[i].build(ast_create_identifier("a"), ast_create_identifier("b"));
+        assert(expr != NULL);
+        
+        // Declared growth must match what the builder produces
+        assert((int)ast_count_nodes(expr) - 3 == catalog[i].node_growth);
+        
+        for (size_t x = 0; x < sample_count; x++) {
+            for (size_t y = 0; y < sample_count; y++) {
+                assert(eval(expr, samples[x], samples[y]) ==
+                       apply_op(catalog[i].op, samples[x], samples[y]));
+            }
+        }
+        
+        printf("  %s  ->  %s\n", catalog[i].op, catalog[i].form);
+        ast_node_destroy(expr);
+    }
+    
+    printf("✓ MBA catalog identities test passed\n");
+}
+
+void test_budget_limits_growth() {
+    printf("Testing MBA growth budgets...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // A zero expression budget leaves the expression untouched
+    config->mba_expr_budget = 0;
+    MBAState state = {0};
+    mba_begin_function(&state, config);
+    
+    ASTNode* expr = ast_create_binary_op("+", as_int(ast_create_identifier("a")),
+                                         as_int(ast_create_identifier("b")));
+    assert(!mba_rewrite(ctx, &state, expr));
+    assert(strcmp(expr->data.binary.operator, "+") == 0);
+    
+    // A budget that fits exactly one rewrite allows only one
+    config->mba_expr_budget = 7;
+    mba_begin_expression(&state, config);
+    assert(mba_rewrite(ctx, &state, expr));
+    assert(state.expr_remaining == 0);
+    
+    ASTNode* second = ast_create_binary_op("+", as_int(ast_create_identifier("a")),
+                                           as_int(ast_create_identifier("b")));
+    assert(!mba_rewrite(ctx, &state, second));
+    
+    // The function budget caps the sum over all expressions
+    config->mba_expr_budget = 24;
+    config->mba_function_budget = 7;
+    mba_begin_function(&state, config);
+    assert(mba_rewrite(ctx, &state, second));
+    mba_begin_expression(&state, config);
+    ASTNode* third = ast_create_binary_op("+", as_int(ast_create_identifier("a")),
+                                          as_int(ast_create_identifier("b")));
+    assert(!mba_rewrite(ctx, &state, third));
+    ast_node_destroy(third);
+    
+    ast_node_destroy(expr);
+    ast_node_destroy(second);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ MBA growth budgets test passed\n");
+}
+
+void test_operands_evaluated_once() {
+    printf("Testing MBA operand hoisting...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    MBAState state = {0};
+    mba_begin_function(&state, config);
+    
+    // f(x) + y: the call must appear exactly once after rewriting
+    LexerState* lexer = lexer_create("f(x) + y", "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL && expr->type == NODE_BINARY_OP);
+    ASTNode* call_node = expr->data.binary.left;
+    assert(call_node->type == NODE_CALL);
+    as_int(call_node);
+    as_int(expr->data.binary.right);
+    ASTNode* sibling = ast_create_identifier("z");
+    expr->next = sibling;
+    
+    assert(mba_rewrite(ctx, &state, expr));
+    assert(expr->type == NODE_STMT_EXPR);
+    assert(expr->next == sibling);
+    
+    // The call's replicas were merged into one temporary
+    ASTNode* decl = expr->data.block.statements;
+    assert(decl->type == NODE_VARIABLE);
+    assert(strcmp(decl->data.variable.type, "__auto_type") == 0);
+    assert(decl->data.variable.initializer->type == NODE_CALL);
+    assert(count_calls(expr) == 1);
+    assert(state.hoisted == 1);
+    
+    expr->next = NULL;
+    ast_node_destroy(expr);
+    ast_node_destroy(sibling);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    
+    // Two calls written in the source stay two calls, each bound once
+    lexer = lexer_create("f(x) + f(x)", "test.c");
+    tokens = lexer_tokenize(lexer);
+    parser = parser_create(tokens);
+    expr = parser_parse_expression(parser);
+    as_int(expr->data.binary.left);
+    as_int(expr->data.binary.right);
+    
+    assert(mba_rewrite(ctx, &state, expr));
+    assert(expr->type == NODE_STMT_EXPR);
+    assert(count_calls(expr) == 2);
+    
+    ast_node_destroy(expr);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ MBA operand hoisting test passed\n");
+}
+
+void test_non_integer_operands_skipped() {
+    printf("Testing MBA type guards...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    MBAState state = {0};
+    mba_begin_function(&state, config);
+    
+    ASTNode* fp = ast_create_binary_op("+", ast_create_identifier("a"), ast_create_literal("1.5"));
+    ASTNode* str = ast_create_binary_op("+", ast_create_literal("\"abc\""), ast_create_literal("1"));
+    ASTNode* unknown = ast_create_binary_op("+", ast_create_identifier("a"), ast_create_identifier("b"));
+    
+    assert(!mba_rewrite(ctx, &state, fp));
+    assert(!mba_rewrite(ctx, &state, str));
+    
+    // Identifiers without a declared int type may be pointers or doubles
+    assert(!mba_rewrite(ctx, &state, unknown));
+    
+    ast_node_destroy(fp);
+    ast_node_destroy(str);
+    ast_node_destroy(unknown);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ MBA type guards test passed\n");
+}
+
+/* An identifier or the operator tree the parser built, untouched */
+static bool is_plain_sum(const ASTNode* node) {
+    return node && node->type == NODE_BINARY_OP && strcmp(node->data.binary.operator, "+") == 0 &&
+           node->data.binary.left->type == NODE_IDENTIFIER &&
+           node->data.binary.right->type == NODE_IDENTIFIER;
+}
+
+void test_pragma_region_in_pipeline() {
+    printf("Testing a pragma-capped region through the pipeline...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_INTERMEDIATE;
+    config->simplify_output = false;
+    
+    for (unsigned int seed = 1; seed <= 20; seed++) {
+        config->seed = seed;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        
+        // void f(void) { x = <parsed>; y = a + b; ... } over int globals,
+        // where only the parsed sums sit under the pragma
+        ASTNode* statements = NULL;
+        for (int i = 0; i < 8; i++) {
+            LexerState* lexer = lexer_create("#pragma obfuscate off\na + b", "test.c");
+            ParserState* parser = parser_create(lexer_tokenize(lexer));
+            ASTNode* capped = parser_parse_expression(parser);
+            assert(capped && capped->level_cap == OBF_BASIC);
+            assert(!parser_has_errors(parser));
+            parser_destroy(parser);
+            lexer_destroy(lexer);
+            
+            statements = ast_link(statements, ast_link(ast_create_assignment(id("x"), capped),
+                ast_create_assignment(id("y"), op("+", id("a"), id("b")))));
+        }
+        ASTNode* program = NULL;
+        const char* names[] = { "a", "b", "x", "y" };
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            program = ast_link(program, ast_create_variable(names[i], "int", NULL));
+        }
+        program = ast_link(program, create_function("f", "void", NULL,
+                                                    ast_create_block(statements)));
+        assert(obfuscate_ast(ctx, program) == program);
+        
+        // The region keeps the code as written; its neighbours do not
+        int rewritten = 0;
+        for (ASTNode* stmt = statements; stmt; stmt = stmt->next->next) {
+            assert(is_plain_sum(stmt->data.binary.right));
+            if (!is_plain_sum(stmt->next->data.binary.right)) rewritten++;
+        }
+        assert(rewritten > 0);
+        
+        ast_tree_destroy(program);
+        obfuscator_destroy(ctx);
+    }
+    
+    config_destroy(config);
+    
+    printf("✓ Pragma region pipeline test passed\n");
+}
+
+int main() {
+    printf("Running MBA Engine Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_catalog_identities();
+    test_budget_limits_growth();
+    test_operands_evaluated_once();
+    test_non_integer_operands_skipped();
+    test_pragma_region_in_pipeline();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All MBA tests passed! ✓\n");
+    
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/opaque.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Opaque Predicate Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void test_catalog() {
+    printf("Testing predicate catalog...\n");
+    
+    bool families[3] = { false, false, false };
+    for (int i = 0; i < opaque_predicate_count(); i++) {
+        const OpaquePredicate* p = opaque_predicate_get(i);
+        assert(p != NULL);
+        assert(runtime_helper_name(p->helper) != NULL);
+        assert(p->cost > 0);
+        assert(p->resistance >= 1 && p->resistance <= 10);
+        families[p->family] = true;
+    }
+    assert(families[OPAQUE_FAMILY_NUMBER_THEORY]);
+    assert(families[OPAQUE_FAMILY_ALIASING]);
+    assert(families[OPAQUE_FAMILY_GLOBAL_STATE]);
+    assert(opaque_predicate_get(opaque_predicate_count()) == NULL);
+    
+    // Shared state needs atomics in the emitted prologue
+    char* source = runtime_helpers_emit(1u << RUNTIME_HELPER_OPAQUE_GLOBAL);
+    assert(strstr(source, "#include <stdatomic.h>") != NULL);
+    free(source);
+    
+    source = runtime_helpers_emit(1u << RUNTIME_HELPER_OPAQUE_MOD4);
+    assert(strstr(source, "#include <stdatomic.h>") == NULL);
+    free(source);
+    
+    printf("✓ Predicate catalog test passed\n");
+}
+
+void test_budget_selection() {
+    printf("Testing budgeted selection...\n");
+    
+    assert(opaque_select(NULL, 0) == NULL);
+    
+    // A tight budget only ever yields cheap predicates
+    for (int i = 0; i < 200; i++) {
+        const OpaquePredicate* p = opaque_select(NULL, 5);
+        assert(p != NULL && p->cost <= 5);
+    }
+    
+    // An ample one reaches every predicate
+    bool seen[16] = { false };
+    for (int i = 0; i < 2000; i++) {
+        const OpaquePredicate* p = opaque_select(NULL, 1000);
+        seen[p - opaque_predicate_get(0)] = true;
+    }
+    for (int i = 0; i < opaque_predicate_count(); i++) {
+        assert(seen[i]);
+    }
+    
+    printf("✓ Budgeted selection test passed\n");
+}
+
+void test_hotness_tiers() {
+    printf("Testing hotness tiers...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    ASTNode* cold = ast_create_identifier("cold");
+    ASTNode* loop = ast_create_identifier("loop");
+    ASTNode* hot = ast_create_identifier("hot");
+    cold->hotness = 1.0f;
+    loop->hotness = 8.0f;
+    hot->hotness = 1.0e6f;
+    
+    assert(opaque_budget(ctx, cold) == config->opaque_cost_budget);
+    assert(opaque_budget(ctx, loop) < opaque_budget(ctx, cold));
+    
+    // Cold code gets a flagged call to a helper the prologue will define
+    ASTNode* condition = opaque_false(ctx, cold, NULL);
+    assert(condition != NULL && condition->type == NODE_CALL);
+    assert(condition->flags & AST_FLAG_OPAQUE);
+    assert(ctx->helpers != 0);
+    ast_node_destroy(condition);
+    
+    // Code inside a loop only gets what it can afford
+    for (int i = 0; i < 100; i++) {
+        ASTNode* call = opaque_false(ctx, loop, NULL);
+        const char* name = call->data.call.function->data.identifier.name;
+        assert(strcmp(name, runtime_helper_name(RUNTIME_HELPER_OPAQUE_GLOBAL)) != 0);
+        ast_node_destroy(call);
+    }
+    
+    // Nothing is cheap enough for the hottest code
+    assert(opaque_false(ctx, hot, NULL) == NULL);
+    
+    ast_node_destroy(cold);
+    ast_node_destroy(loop);
+    ast_node_destroy(hot);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Hotness tier test passed\n");
+}
+
+static ASTNode* find_bogus_branch(ASTNode* block) {
+    for (ASTNode* stmt = block->data.block.statements; stmt; stmt = stmt->next) {
+        if (stmt->type == NODE_IF || stmt->type == NODE_WHILE) return stmt;
+    }
+    return NULL;
+}
+
+void test_cold_placement() {
+    printf("Testing cold placement of bogus branches...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // Dead code is random; keep inserting until a bogus branch shows up
+    ASTNode* block = ast_create_block(ast_create_literal("1"));
+    ASTNode* branch = NULL;
+    for (int i = 0; i < 1000 && !branch; i++) {
+        insert_dead_code(ctx, block);
+        branch = find_bogus_branch(block);
+    }
+    assert(branch != NULL);
+    
+    // if (__OBF_UNLIKELY(opaque)) { __obf_cold_path(k); }
+    ASTNode* condition = branch->type == NODE_IF ? branch->data.if_stmt.condition :
+                                                   branch->data.while_stmt.condition;
+    assert(condition->type == NODE_CALL);
+    assert(strcmp(condition->data.call.function->data.identifier.name, "__OBF_UNLIKELY") == 0);
+    assert(condition->data.call.arguments->flags & AST_FLAG_OPAQUE);
+    
+    ASTNode* body = branch->type == NODE_IF ? branch->data.if_stmt.then_stmt :
+                                              branch->data.while_stmt.body;
+    ASTNode* payload = body->data.block.statements;
+    assert(payload->type == NODE_CALL);
+    assert(strcmp(payload->data.call.function->data.identifier.name, "__obf_cold_path") == 0);
+    
+    // The prologue defines the hint and the outlined payload
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    char* macros = strstr(prologue, "#define __OBF_COLD");
+    char* cold = strstr(prologue, "static __OBF_COLD void __obf_cold_path(");
+    assert(macros && cold && macros < cold);
+    free(prologue);
+    
+    ast_node_destroy(block);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Cold placement test passed\n");
+}
+
+static ASTNode* int_parameter(const char* name) {
+    ASTNode* param = ast_create_variable(name, "int", NULL);
+    param->type = NODE_PARAMETER;
+    return param;
+}
+
+void test_live_arguments() {
+    printf("Testing live predicate arguments...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    ASTNode* region = id("region");
+    region->hotness = 1.0f;
+    
+    // void f(int n, double d) { ... }: the predicate reads n
+    ASTNode* params = ast_link(int_parameter("n"), ast_create_variable("d", "double", NULL));
+    params->next->type = NODE_PARAMETER;
+    ASTNode* function = create_function("f", "void", params, ast_create_block(NULL));
+    for (int i = 0; i < 20; i++) {
+        ASTNode* call = opaque_false(ctx, region, function);
+        ASTNode* argument = call->data.call.arguments;
+        assert(argument->type == NODE_IDENTIFIER);
+        assert(strcmp(argument->data.identifier.name, "n") == 0);
+        ast_node_destroy(call);
+    }
+    ast_node_destroy(function);
+    
+    // void g(int n) { { double n; } }: n may be hidden, so a volatile load
+    ASTNode* shadow = ast_create_block(ast_create_variable("n", "double", NULL));
+    function = create_function("g", "void", int_parameter("n"), ast_create_block(shadow));
+    ctx->helpers = 0;
+    ASTNode* call = opaque_false(ctx, region, function);
+    ASTNode* argument = call->data.call.arguments;
+    assert(argument->type == NODE_CALL);
+    assert(strcmp(argument->data.call.function->data.identifier.name, "__obf_opaque_input") == 0);
+    assert(ctx->helpers & (1u << RUNTIME_HELPER_OPAQUE_INPUT));
+    ast_node_destroy(call);
+    ast_node_destroy(function);
+    
+    // Outside any function there are no parameters to read either
+    call = opaque_false(ctx, region, NULL);
+    assert(call->data.call.arguments->type == NODE_CALL);
+    ast_node_destroy(call);
+    
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(strstr(prologue, "static volatile unsigned int __obf_opaque_seed;") != NULL);
+    free(prologue);
+    
+    ast_node_destroy(region);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Live predicate argument test passed\n");
+}
+
+int main() {
+    printf("Running Opaque Predicate Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_catalog();
+    test_budget_selection();
+    test_hotness_tiers();
+    test_cold_placement();
+    test_live_arguments();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All opaque predicate tests passed! ✓\n");
+    
+    return 0;
+}
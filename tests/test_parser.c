@@ -124,6 +124,38 @@ void test_function_calls() {
     printf("✓ Function calls test passed\n");
 }
 
+void test_array_subscripts() {
+    printf("Testing array subscripts...\n");
+    
+    const char* source = "m[i][j + 1] * v[j]";
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    
+    assert(expr != NULL);
+    assert(expr->type == NODE_BINARY_OP);
+    assert(strcmp(expr->data.binary.operator, "*") == 0);
+    
+    // m[i][j + 1] nests left: (m[i])[j + 1]
+    ASTNode* outer = expr->data.binary.left;
+    assert(outer->type == NODE_ARRAY_ACCESS);
+    assert(outer->data.binary.right->type == NODE_BINARY_OP);
+    ASTNode* inner = outer->data.binary.left;
+    assert(inner->type == NODE_ARRAY_ACCESS);
+    assert(strcmp(inner->data.binary.left->data.identifier.name, "m") == 0);
+    assert(strcmp(inner->data.binary.right->data.identifier.name, "i") == 0);
+    
+    assert(expr->data.binary.right->type == NODE_ARRAY_ACCESS);
+    
+    ast_node_destroy(expr);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    
+    printf("✓ Array subscripts test passed\n");
+}
+
 void test_parenthesized_expressions() {
     printf("Testing parenthesized expressions...\n");
     
@@ -238,6 +270,76 @@ void test_complex_expressions() {
     printf("✓ Complex expressions test passed\n");
 }
 
+void test_obfuscation_pragmas() {
+    printf("Testing obfuscation pragmas...\n");
+    
+    const char* source =
+        "#pragma obfuscate push\n"
+        "#pragma obfuscate level(intermediate)\n"
+        "hot(x)\n"
+        "#pragma obfuscate pop\n"
+        "+ cold";
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    
+    assert(expr != NULL);
+    assert(expr->type == NODE_BINARY_OP);
+    assert(expr->level_cap == 0);
+    assert(expr->data.binary.left->type == NODE_CALL);
+    assert(expr->data.binary.left->level_cap == OBF_INTERMEDIATE);
+    assert(expr->data.binary.right->level_cap == 0);
+    assert(!parser_has_errors(parser));
+    
+    ast_node_destroy(expr);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    
+    // Unbalanced pop and annotate("no_obf")
+    source = "#pragma obfuscate pop\n__attribute__((annotate(\"no_obf\"))) f(x)";
+    lexer = lexer_create(source, "test.c");
+    tokens = lexer_tokenize(lexer);
+    
+    parser = parser_create(tokens);
+    expr = parser_parse_expression(parser);
+    
+    assert(expr != NULL);
+    assert(expr->type == NODE_CALL);
+    assert(parser_has_errors(parser));
+    assert(parser->pending_no_obf);
+    
+    // The error names the pragma and where it is
+    Error* error = parser_get_errors(parser);
+    assert(error && !error->next);
+    assert(strstr(error->message, "pop") != NULL);
+    assert(error->location.line == 1);
+    assert(strcmp(error->location.filename, "test.c") == 0);
+    
+    ast_node_destroy(expr);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    
+    // Unknown pragmas are reported too
+    source = "f(x)\n#pragma obfuscate level(maximum)\n+ y";
+    lexer = lexer_create(source, "test.c");
+    tokens = lexer_tokenize(lexer);
+    
+    parser = parser_create(tokens);
+    expr = parser_parse_expression(parser);
+    
+    error = parser_get_errors(parser);
+    assert(error && strstr(error->message, "level(maximum)") != NULL);
+    assert(error->location.line == 2);
+    
+    ast_node_destroy(expr);
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    
+    printf("✓ Obfuscation pragmas test passed\n");
+}
+
 int main() {
     printf("Running Parser Expression Tests...\n");
     printf("═══════════════════════════════════════\n");
@@ -246,10 +348,12 @@ int main() {
     test_binary_expressions();
     test_unary_expressions();
     test_function_calls();
+    test_array_subscripts();
     test_parenthesized_expressions();
     test_operator_precedence();
     test_assignment_expressions();
     test_complex_expressions();
+    test_obfuscation_pragmas();
     
     printf("═══════════════════════════════════════\n");
     printf("All parser expression tests passed! ✓\n");
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/analysis/profile.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Profile-Guided Obfuscation Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void test_text_profile() {
+    printf("Testing function:line:count profiles...\n");
+    
+    Profile* profile = profile_create();
+    assert(profile_parse_text(profile,
+        "# perf script aggregate\n"
+        "kernel:0:1000\n"
+        "kernel:12:500000\n"
+        "setup:0:1\n"));
+    
+    assert(profile->entry_count == 3);
+    assert(profile->max_count == 500000);
+    assert(profile_function_count(profile, "kernel", 10) == 1000);
+    assert(profile_line_count(profile, "kernel", 12) == 500000);
+    assert(profile_line_count(profile, "setup", 12) == 0);
+    
+    // Malformed records are rejected
+    assert(!profile_parse_text(profile, "kernel:twelve:5\n"));
+    
+    profile_destroy(profile);
+    printf("✓ Text profile test passed\n");
+}
+
+void test_gcov_profile() {
+    printf("Testing gcov reports...\n");
+    
+    Profile* profile = profile_create();
+    assert(profile_parse_gcov(profile,
+        "        -:    0:Source:kernel.c\n"
+        "function kernel called 40 returned 100% blocks executed 100%\n"
+        "       40:   10:int kernel(int n) {\n"
+        "   400000:   12:    for (int i = 0; i < n; i++)\n"
+        "    #####:   14:        rare();\n"
+        "        -:   15:}\n"));
+    
+    assert(profile_function_count(profile, "kernel", 10) == 40);
+    assert(profile_line_count(profile, "kernel", 12) == 400000);
+    assert(profile_line_count(profile, "kernel", 14) == 0);
+    assert(profile_line_count(profile, "kernel", 15) == 0);
+    
+    profile_destroy(profile);
+    printf("✓ Gcov report test passed\n");
+}
+
+void test_annotation_caps_hot_code() {
+    printf("Testing hotness annotation...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    Profile* profile = profile_create();
+    profile_add(profile, "kernel", 0, 10);
+    profile_add(profile, "kernel", 12, 100000);
+    profile_add(profile, "kernel", 20, 5000);
+    
+    // int kernel() { while (a) { a + b; } for (;;) { c; } d + e; }
+    ASTNode* hot_expr = ast_create_binary_op("+", ast_create_identifier("a"), ast_create_identifier("b"));
+    ASTNode* hot_loop = ast_create_while(ast_create_identifier("a"), ast_create_block(hot_expr));
+    hot_loop->location.line = 12;
+    ASTNode* warm_loop = ast_create_for(NULL, NULL, NULL, ast_create_block(ast_create_identifier("c")));
+    warm_loop->location.line = 20;
+    ASTNode* cold_expr = ast_create_binary_op("+", ast_create_identifier("d"), ast_create_identifier("e"));
+    ASTNode* function = create_function("kernel", "int", NULL,
+        ast_create_block(ast_link(ast_link(hot_loop, warm_loop), cold_expr)));
+    function->location.line = 10;
+    
+    profile_annotate(profile, config, function);
+    
+    assert(obfuscator_effective_level(ctx, function) == OBF_EXTREME);
+    assert(obfuscator_effective_level(ctx, hot_loop) == OBF_BASIC);
+    assert(obfuscator_effective_level(ctx, hot_expr) == OBF_BASIC);
+    assert(obfuscator_effective_level(ctx, warm_loop) == OBF_INTERMEDIATE);
+    assert(obfuscator_effective_level(ctx, cold_expr) == OBF_EXTREME);
+    
+    // Expressions in the hot loop are never rewritten
+    assert(obfuscate_expressions(ctx, function));
+    assert(hot_expr->type == NODE_BINARY_OP);
+    assert(strcmp(hot_expr->data.binary.operator, "+") == 0);
+    assert(hot_expr->data.binary.left->type == NODE_IDENTIFIER);
+    
+    ast_node_destroy(function);
+    profile_destroy(profile);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Hotness annotation test passed\n");
+}
+
+void test_profile_settings() {
+    printf("Testing profile settings...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->profile_file = strdup("bench.gcov");
+    config->profile_hot_percent = 20;
+    config->profile_warm_percent = 2;
+    
+    const char* path = "test_profile.conf";
+    assert(config_save(config, path));
+    
+    ObfuscationConfig* loaded = config_create_default();
+    assert(config_load(loaded, path));
+    assert(loaded->profile_file && strcmp(loaded->profile_file, "bench.gcov") == 0);
+    assert(loaded->profile_hot_percent == 20);
+    assert(loaded->profile_warm_percent == 2);
+    
+    // An empty value drops the profile; no profile writes no key
+    FILE* file = fopen(path, "w");
+    fprintf(file, "profile_file =\n");
+    fclose(file);
+    assert(config_load(loaded, path));
+    assert(loaded->profile_file == NULL);
+    
+    assert(config_save(loaded, path));
+    file = fopen(path, "r");
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        assert(strncmp(line, "profile_file", 12) != 0);
+    }
+    fclose(file);
+    remove(path);
+    
+    config_destroy(loaded);
+    config_destroy(config);
+    printf("✓ Profile settings test passed\n");
+}
+
+int main() {
+    printf("Running Profile Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_text_profile();
+    test_gcov_profile();
+    test_annotation_caps_hot_code();
+    test_profile_settings();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All profile tests passed! ✓\n");
+    
+    return 0;
+}
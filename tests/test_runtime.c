@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/analysis/typing.h"
+#include "../src/obfuscator/runtime.h"
+#include "../src/parser/parser.h"
+#include "../src/codegen/codegen.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Emitted Runtime (Helpers and String Table) Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void test_literal_decoding() {
+    printf("Testing string literal decoding...\n");
+    
+    unsigned char* bytes = NULL;
+    size_t length = 0;
+    
+    assert(string_literal_decode("\"a\\n\\\"b\\x41\\101\\0z\"", &bytes, &length));
+    assert(length == 8);
+    assert(memcmp(bytes, "a\n\"bAA\0z", 8) == 0);
+    free(bytes);
+    
+    assert(string_literal_decode("\"\"", &bytes, &length));
+    assert(length == 0);
+    free(bytes);
+    
+    // Not a plain literal
+    assert(!string_literal_decode("L\"wide\"", &bytes, &length));
+    assert(!string_literal_decode("\"\\u00e9\"", &bytes, &length));
+    
+    printf("✓ String literal decoding test passed\n");
+}
+
+void test_string_table() {
+    printf("Testing encrypted string table...\n");
+    
+    StringTable* table = string_table_create(NULL);
+    assert(string_table_emit(table, false) == NULL);
+    
+    assert(string_table_add(table, (const unsigned char*)"secret", 6) == 0);
+    assert(string_table_add(table, (const unsigned char*)"", 0) == 1);
+    assert(table->count == 2);
+    assert(table->size == 8);
+    
+    // Ciphertext, including the terminator, decrypts with the slot keystream
+    const StringTableEntry* entry = &table->entries[0];
+    for (size_t i = 0; i <= entry->length; i++) {
+        unsigned char plain = table->data[entry->offset + i] ^
+                              string_keystream(table->key, entry->nonce, i);
+        assert(plain == (unsigned char)"secret"[i]);
+    }
+    assert(table->entries[1].offset == 7);
+    
+    char* prologue = string_table_emit(table, false);
+    assert(prologue != NULL);
+    assert(strstr(prologue, "#include <stdatomic.h>") != NULL);
+    assert(strstr(prologue, "__obf_str_index[2]") != NULL);
+    assert(strstr(prologue, "#define __obf_str(i)") != NULL);
+    assert(strstr(prologue, "__obf_str_key ^ __obf_str_index[i].nonce") != NULL);
+    assert(strstr(prologue, "secret") == NULL);
+    free(prologue);
+    
+    string_table_destroy(table);
+    printf("✓ Encrypted string table test passed\n");
+}
+
+void test_keystream() {
+    printf("Testing string keystream...\n");
+    
+    // Same key and counter give the same byte; nonces separate strings
+    assert(string_keystream(0x1234u, 7, 3) == string_keystream(0x1234u, 7, 3));
+    
+    int same_as_other_nonce = 0;
+    int repeats_within_string = 0;
+    for (size_t i = 0; i < 256; i++) {
+        unsigned char byte = string_keystream(0x1234u, 7, i);
+        if (byte == string_keystream(0x1234u, 8, i)) same_as_other_nonce++;
+        if (byte == string_keystream(0x1234u, 7, i + 1)) repeats_within_string++;
+    }
+    assert(same_as_other_nonce < 16);
+    assert(repeats_within_string < 16);
+    
+    printf("✓ String keystream test passed\n");
+}
+
+void test_string_deduplication() {
+    printf("Testing string deduplication...\n");
+    
+    StringTable* table = string_table_create(NULL);
+    assert(string_table_find(table, (const unsigned char*)"twice", 5) == -1);
+    
+    assert(string_table_add(table, (const unsigned char*)"twice", 5) == 0);
+    assert(string_table_add(table, (const unsigned char*)"other", 5) == 1);
+    assert(string_table_add(table, (const unsigned char*)"twice", 5) == 0);
+    assert(string_table_find(table, (const unsigned char*)"other", 5) == 1);
+    assert(string_table_find(table, (const unsigned char*)"twic", 4) == -1);
+    assert(table->count == 2);
+    assert(table->size == 12);
+    
+    // Enough distinct strings to force the bucket array to grow
+    char name[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "s%d", i);
+        assert(string_table_add(table, (const unsigned char*)name, strlen(name)) == i + 2);
+    }
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "s%d", i);
+        assert(string_table_find(table, (const unsigned char*)name, strlen(name)) == i + 2);
+    }
+    
+    // One-pass mode has a single state word for the whole blob
+    char* prologue = string_table_emit(table, true);
+    assert(prologue != NULL);
+    assert(strstr(prologue, "static atomic_int __obf_str_state;") != NULL);
+    assert(strstr(prologue, "sizeof(__obf_str_data)") != NULL);
+    free(prologue);
+    
+    string_table_destroy(table);
+    printf("✓ String deduplication test passed\n");
+}
+
+void test_helper_catalog() {
+    printf("Testing shared helper catalog...\n");
+    
+    assert(runtime_helpers_emit(0) == NULL);
+    assert(strcmp(runtime_helper_name(RUNTIME_HELPER_OPAQUE_ZERO), "__obf_opaque_zero") == 0);
+    assert(runtime_helper_name(RUNTIME_HELPER_COUNT) == NULL);
+    
+    RuntimeHelperSet helpers = (1u << RUNTIME_HELPER_COMPLEX_ADD) |
+                               (1u << RUNTIME_HELPER_STR_DECRYPT);
+    char* source = runtime_helpers_emit(helpers);
+    assert(source != NULL);
+    
+    // Catalog order, each helper once, unused ones left out
+    char* decrypt = strstr(source, "static __OBF_RARE void __obf_str_decrypt(");
+    char* add = strstr(source, "static inline int __obf_complex_add(");
+    assert(decrypt && add && decrypt < add);
+    assert(strstr(add + 1, "static inline int __obf_complex_add(") == NULL);
+    assert(strstr(source, "__obf_opaque_zero") == NULL);
+    
+    // The decryption helper pulls in the placement macros it uses
+    char* macros = strstr(source, "#define __OBF_RARE");
+    assert(macros && macros < decrypt);
+    free(source);
+    
+    printf("✓ Shared helper catalog test passed\n");
+}
+
+void test_helpers_referenced_from_use_sites() {
+    printf("Testing helper use sites...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // int f(int a, int b, int c, double d, double e)
+    // { int x = a + b; int y = c + 1; double z = d + e; int v = d + 1; int w = 1.5 + 1.5; }
+    ASTNode* x = ast_create_variable("x", "int", ast_create_binary_op("+",
+        ast_create_identifier("a"), ast_create_identifier("b")));
+    ASTNode* y = ast_create_variable("y", "int", ast_create_binary_op("+",
+        ast_create_identifier("c"), ast_create_literal("1")));
+    ASTNode* z = ast_create_variable("z", "double", ast_create_binary_op("+",
+        ast_create_identifier("d"), ast_create_identifier("e")));
+    // Int declarations whose sum is computed in double keep it
+    ASTNode* v = ast_create_variable("v", "int", ast_create_binary_op("+",
+        ast_create_identifier("d"), ast_create_literal("1")));
+    ASTNode* w = ast_create_variable("w", "int", ast_create_binary_op("+",
+        ast_create_literal("1.5"), ast_create_literal("1.5")));
+    
+    ASTNode* function = calloc(1, sizeof(ASTNode));
+    function->type = NODE_FUNCTION;
+    function->data.function.name = strdup("f");
+    function->data.function.body = ast_create_block(ast_link(ast_link(ast_link(ast_link(x, y), z), v), w));
+    
+    const char* names[] = { "a", "b", "c", "d", "e" };
+    for (int i = 0; i < 5; i++) {
+        ASTNode* param = ast_create_variable(names[i], i < 3 ? "int" : "double", NULL);
+        param->type = NODE_PARAMETER;
+        function->data.function.parameters = ast_link(function->data.function.parameters, param);
+    }
+    typing_annotate(function);
+    
+    assert(apply_macro_obfuscation(ctx, function));
+    
+    ASTNode* call = x->data.variable.initializer;
+    assert(call->type == NODE_CALL);
+    assert(strcmp(call->data.call.function->data.identifier.name, "__obf_complex_add") == 0);
+    assert(strcmp(call->data.call.arguments->data.identifier.name, "a") == 0);
+    assert(strcmp(call->data.call.arguments->next->data.identifier.name, "b") == 0);
+    assert(y->data.variable.initializer->type == NODE_CALL);
+    assert(z->data.variable.initializer->type == NODE_BINARY_OP);
+    assert(v->data.variable.initializer->type == NODE_BINARY_OP);
+    assert(w->data.variable.initializer->type == NODE_BINARY_OP);
+    
+    // Two use sites, one definition
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(prologue != NULL);
+    char* definition = strstr(prologue, "static inline int __obf_complex_add(");
+    assert(definition && !strstr(definition + 1, "static inline int __obf_complex_add("));
+    assert(strstr(prologue, "__obf_str_decrypt") == NULL);
+    free(prologue);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Helper use site test passed\n");
+}
+
+void test_literals_replaced_by_lookups() {
+    printf("Testing literal replacement...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_INTERMEDIATE;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // int f() { static char* s = "kept"; puts("hidden", "hidden"); }
+    ASTNode* kept = ast_create_literal("\"kept\"");
+    ASTNode* local = ast_create_variable("s", "char*", kept);
+    local->data.variable.is_static = true;
+    ASTNode* hidden = ast_create_literal("\"hidden\"");
+    ASTNode* again = ast_create_literal("\"hidden\"");
+    ASTNode* call = ast_create_call(ast_create_identifier("puts"), ast_link(hidden, again));
+    
+    ASTNode* function = calloc(1, sizeof(ASTNode));
+    function->type = NODE_FUNCTION;
+    function->data.function.name = strdup("f");
+    function->data.function.body = ast_create_block(ast_link(local, call));
+    
+    assert(obfuscate_strings(ctx, function));
+    
+    assert(kept->type == NODE_LITERAL);
+    assert(hidden->type == NODE_CALL);
+    assert(strcmp(hidden->data.call.function->data.identifier.name, "__obf_str") == 0);
+    assert(strcmp(hidden->data.call.arguments->data.literal.value, "0") == 0);
+    assert(strcmp(again->data.call.arguments->data.literal.value, "0") == 0);
+    assert(ctx->strings->count == 1);
+    
+    // The decryption helper comes before the table that calls it
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(prologue != NULL);
+    char* helper = strstr(prologue, "static __OBF_RARE void __obf_str_decrypt(");
+    assert(helper && helper < strstr(prologue, "__obf_str_index"));
+    free(prologue);
+    
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Literal replacement test passed\n");
+}
+
+void test_emitted_program_compiles() {
+    printf("Testing that the prologue and program compile together...\n");
+    
+    for (unsigned int seed = 1; seed <= 10; seed++) {
+        ObfuscationConfig* config = config_create_default();
+        config->level = seed % 2 ? OBF_EXTREME : OBF_INTERMEDIATE;
+        config->seed = seed;
+        ObfuscationContext* ctx = obfuscator_create(config);
+        
+        // int a; int b = 3; const char* banner = "file scope";
+        // void f(int n) { const char* s = "hidden"; int x = a + b; int y = x * 3 + n;
+        //                 a = s[0] + y; }
+        ASTNode* param = ast_create_variable("n", "int", NULL);
+        param->type = NODE_PARAMETER;
+        ASTNode* statements = ast_create_variable("s", "const char*", ast_create_literal("\"hidden\""));
+        statements = ast_link(statements, ast_create_variable("x", "int", op("+", id("a"), id("b"))));
+        statements = ast_link(statements, ast_create_variable("y", "int",
+                                                              op("+", op("*", id("x"), num(3)), id("n"))));
+        statements = ast_link(statements, ast_create_assignment(id("a"),
+            op("+", ast_create_array_access(id("s"), num(0)), id("y"))));
+        
+        ASTNode* declarations = ast_link(ast_create_variable("a", "int", NULL),
+                                         ast_create_variable("b", "int", num(3)));
+        declarations = ast_link(declarations, ast_create_variable("banner", "const char*",
+                                                                  ast_create_literal("\"file scope\"")));
+        declarations = ast_link(declarations,
+                                create_function("f", "void", param, ast_create_block(statements)));
+        assert(obfuscate_ast(ctx, declarations) == declarations);
+        
+        ASTNode* program = calloc(1, sizeof(ASTNode));
+        program->type = NODE_PROGRAM;
+        program->data.program.declarations = declarations;
+        CodeGenConfig* codegen_config = codegen_config_create_default();
+        CodeGenState* gen = codegen_create(codegen_config);
+        char* prologue = obfuscator_runtime_prologue(ctx);
+        assert(prologue && strstr(prologue, "__obf_str_decrypt") != NULL);
+        codegen_set_prologue(gen, prologue);
+        char* code = generate_code(gen, program);
+        assert(code != NULL);
+        if (!compiles(code)) {
+            fprintf(stderr, "%s\n", code);
+            assert(!"generated code does not compile");
+        }
+        
+        free(code);
+        free(prologue);
+        codegen_destroy(gen);
+        codegen_config_destroy(codegen_config);
+        ast_tree_destroy(declarations);
+        free(program);
+        obfuscator_destroy(ctx);
+        config_destroy(config);
+    }
+    
+    printf("✓ Compiling emitted program test passed\n");
+}
+
+int main() {
+    printf("Running Runtime Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_literal_decoding();
+    test_string_table();
+    test_keystream();
+    test_string_deduplication();
+    test_helper_catalog();
+    test_helpers_referenced_from_use_sites();
+    test_literals_replaced_by_lookups();
+    test_emitted_program_compiles();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All runtime tests passed! ✓\n");
+    
+    return 0;
+}
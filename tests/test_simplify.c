@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/obfuscator/simplify.h"
+#include "../src/parser/parser.h"
+#include "../src/lexer/lexer.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Peephole Simplifier Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parse(const char* source) {
+    LexerState* lexer = lexer_create(source, "test.c");
+    Token* tokens = lexer_tokenize(lexer);
+    ParserState* parser = parser_create(tokens);
+    ASTNode* expr = parser_parse_expression(parser);
+    assert(expr != NULL);
+    
+    parser_destroy(parser);
+    lexer_destroy(lexer);
+    return expr;
+}
+
+static bool is_literal(const ASTNode* node, const char* value) {
+    return node && node->type == NODE_LITERAL && strcmp(node->data.literal.value, value) == 0;
+}
+
+static bool is_identifier(const ASTNode* node, const char* name) {
+    return node && node->type == NODE_IDENTIFIER && strcmp(node->data.identifier.name, name) == 0;
+}
+
+void test_constant_folding() {
+    printf("Testing constant folding...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    SimplifyStats stats = {0};
+    
+    ASTNode* expr = parse("42 * 0 + (3 << 2)");
+    simplify_expression(config, expr, &stats);
+    assert(is_literal(expr, "12"));
+    assert(stats.constants_folded == 3);
+    ast_node_destroy(expr);
+    
+    // Values that would overflow int or need a suffix are left alone
+    expr = parse("2147483647 + 1");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    expr = parse("1.5 * 0");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    config_destroy(config);
+    printf("✓ Constant folding test passed\n");
+}
+
+void test_identities() {
+    printf("Testing identity removal...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    SimplifyStats stats = {0};
+    
+    // Adding zero is the identity only over int: -0.0 + 0 is 0.0
+    ASTNode* expr = parse("(x + 0) * 1");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP && strcmp(expr->data.binary.operator, "+") == 0);
+    expr->data.binary.left->flags |= AST_FLAG_INT;
+    simplify_expression(config, expr, &stats);
+    assert(is_identifier(expr, "x"));
+    ast_node_destroy(expr);
+    
+    expr = parse("0 + x - 0");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    // Reassociating additions changes double rounding
+    expr = parse("(d + 1) + 2");
+    simplify_expression(config, expr, &stats);
+    assert(is_literal(expr->data.binary.right, "2"));
+    expr->data.binary.left->data.binary.left->flags |= AST_FLAG_INT;
+    simplify_expression(config, expr, &stats);
+    assert(is_identifier(expr->data.binary.left, "d"));
+    assert(is_literal(expr->data.binary.right, "3"));
+    ast_node_destroy(expr);
+    
+    // Shift and mask chains collapse into one operation
+    expr = parse("((x << 1) << 1) & 3 & 1");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP && strcmp(expr->data.binary.operator, "&") == 0);
+    assert(is_literal(expr->data.binary.right, "1"));
+    ASTNode* shift = expr->data.binary.left;
+    assert(strcmp(shift->data.binary.operator, "<<") == 0);
+    assert(is_identifier(shift->data.binary.left, "x"));
+    assert(is_literal(shift->data.binary.right, "2"));
+    ast_node_destroy(expr);
+    
+    // x * 0 and x & 0 become int 0 only for an int x; for a double or a
+    // pointer the fold would change the type, or not compile
+    expr = parse("x * 0");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    expr->data.binary.left->flags |= AST_FLAG_INT;
+    simplify_expression(config, expr, &stats);
+    assert(is_literal(expr, "0"));
+    ast_node_destroy(expr);
+    
+    expr = parse("0 & x");
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    // An operand with side effects is never discarded, even an int one
+    expr = parse("f(x) * 0");
+    expr->data.binary.left->flags |= AST_FLAG_INT;
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    ast_node_destroy(expr);
+    
+    config_destroy(config);
+    printf("✓ Identity removal test passed\n");
+}
+
+void test_dead_statements() {
+    printf("Testing dead statement removal...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    SimplifyStats stats = {0};
+    
+    // { while (0) { 0; } if (1 == 0) { 0; } 42 * 0; x = y; }
+    ASTNode* loop = ast_create_while(ast_create_literal("0"),
+                                     ast_create_block(ast_create_literal("0")));
+    ASTNode* branch = ast_create_if(ast_create_binary_op("==", ast_create_literal("1"),
+                                                         ast_create_literal("0")),
+                                    ast_create_block(ast_create_literal("0")), NULL);
+    ASTNode* bare = ast_create_binary_op("*", ast_create_literal("42"), ast_create_literal("0"));
+    ASTNode* assign = ast_create_assignment(ast_create_identifier("x"), ast_create_identifier("y"));
+    
+    ASTNode* block = ast_create_block(ast_link(ast_link(loop, branch), ast_link(bare, assign)));
+    block->data.block.statements = simplify_statements(config, block->data.block.statements, &stats);
+    
+    assert(block->data.block.statements == assign);
+    assert(assign->next == NULL);
+    
+    // The literal statements inside the dropped bodies are counted as well
+    assert(stats.statements_removed == 5);
+    
+    ast_node_destroy(block);
+    config_destroy(config);
+    printf("✓ Dead statement removal test passed\n");
+}
+
+void test_opaque_preserved() {
+    printf("Testing opaque construct preservation...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    SimplifyStats stats = {0};
+    
+    ASTNode* expr = parse("x | 0");
+    expr->flags |= AST_FLAG_OPAQUE;
+    simplify_expression(config, expr, &stats);
+    assert(expr->type == NODE_BINARY_OP);
+    
+    // With preservation off, flagged constructs are simplified too
+    config->simplify_preserve_opaque = false;
+    simplify_expression(config, expr, &stats);
+    assert(is_identifier(expr, "x"));
+    
+    ast_node_destroy(expr);
+    config_destroy(config);
+    printf("✓ Opaque construct preservation test passed\n");
+}
+
+int main() {
+    printf("Running Simplifier Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_constant_folding();
+    test_identities();
+    test_dead_statements();
+    test_opaque_preserved();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All simplifier tests passed! ✓\n");
+    
+    return 0;
+}
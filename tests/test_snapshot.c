@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/snapshot.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * AST Snapshot Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const char* source = "func(a * b + c, (x ^ 12) - y * 3, \"secret\")";
+
+static ObfuscationConfig* create_config(unsigned int seed, AestheticStyle style) {
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    config->aesthetic = style;
+    config->seed = seed;
+    return config;
+}
+
+void test_checkout() {
+    printf("Testing snapshot checkouts...\n");
+    
+    assert(snapshot_parse(NULL, "none.c") == NULL);
+    
+    // A bad pragma fails the parse instead of being dropped
+    assert(snapshot_parse("#pragma obfuscate level(maximum)\nf(x)", "bad.c") == NULL);
+    
+    ASTSnapshot* snapshot = snapshot_parse(source, "input.c");
+    assert(snapshot != NULL);
+    assert(strcmp(snapshot->filename, "input.c") == 0);
+    assert(snapshot->node_count == ast_count_nodes(snapshot->ast));
+    
+    // Each checkout is a private copy of the frozen tree
+    ASTNode* first = snapshot_checkout(snapshot);
+    ASTNode* second = snapshot_checkout(snapshot);
+    assert(first != snapshot->ast && second != snapshot->ast && first != second);
+    assert(ast_equal(first, snapshot->ast));
+    assert(ast_equal(second, snapshot->ast));
+    
+    ASTNode* original = ast_copy(snapshot->ast);
+    ObfuscationConfig* config = create_config(11, AESTHETIC_UNICODE);
+    ObfuscationContext* ctx = obfuscator_create(config);
+    assert(obfuscate_ast(ctx, first) != NULL);
+    
+    // Neither the snapshot nor the other checkout sees the passes
+    assert(!ast_equal(first, original));
+    assert(ast_equal(snapshot->ast, original));
+    assert(ast_equal(second, original));
+    
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    ast_tree_destroy(original);
+    ast_tree_destroy(first);
+    ast_tree_destroy(second);
+    snapshot_destroy(snapshot);
+    printf("✓ Snapshot checkout test passed\n");
+}
+
+void test_variants() {
+    printf("Testing variant rendering...\n");
+    
+    ASTSnapshot* snapshot = snapshot_parse(source, "input.c");
+    ASTNode* original = ast_copy(snapshot->ast);
+    
+    ObfuscationConfig* config = create_config(5, AESTHETIC_CHAOTIC);
+    char* first = snapshot_render(snapshot, config, NULL);
+    char* again = snapshot_render(snapshot, config, NULL);
+    assert(first != NULL && again != NULL);
+    
+    // A seed reproduces its variant byte for byte
+    assert(strcmp(first, again) == 0);
+    assert(ast_equal(snapshot->ast, original));
+    
+    // Other seeds and styles give other variants of the same tree
+    config->seed = 6;
+    char* reseeded = snapshot_render(snapshot, config, NULL);
+    assert(strcmp(first, reseeded) != 0);
+    
+    config->aesthetic = AESTHETIC_HEXADECIMAL;
+    char* restyled = snapshot_render(snapshot, config, NULL);
+    assert(strcmp(reseeded, restyled) != 0);
+    assert(ast_equal(snapshot->ast, original));
+    
+    free(first);
+    free(again);
+    free(reseeded);
+    free(restyled);
+    config_destroy(config);
+    ast_tree_destroy(original);
+    snapshot_destroy(snapshot);
+    printf("✓ Variant rendering test passed\n");
+}
+
+int main() {
+    printf("Running AST Snapshot Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_checkout();
+    test_variants();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All AST snapshot tests passed! ✓\n");
+    
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/analysis/typing.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Int Typing Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static bool is_int(const ASTNode* node) {
+    return (node->flags & AST_FLAG_INT) != 0;
+}
+
+void test_int_type_names() {
+    printf("Testing int type names...\n");
+    
+    assert(typing_is_int_type("int"));
+    assert(typing_is_int_type("const int"));
+    assert(typing_is_int_type("static  signed   int"));
+    assert(typing_is_int_type("unsigned short"));
+    assert(typing_is_int_type("char"));
+    assert(typing_is_int_type("_Bool"));
+    
+    assert(!typing_is_int_type("unsigned int"));
+    assert(!typing_is_int_type("unsigned"));
+    assert(!typing_is_int_type("long"));
+    assert(!typing_is_int_type("int*"));
+    assert(!typing_is_int_type("double"));
+    assert(!typing_is_int_type("__auto_type"));
+    assert(!typing_is_int_type(""));
+    assert(!typing_is_int_type(NULL));
+    
+    printf("✓ Int type names test passed\n");
+}
+
+void test_declared_types() {
+    printf("Testing typing from declarations...\n");
+    
+    ASTNode* sum = op("+", id("x"), num(1));
+    ASTNode* fp = op("+", id("d"), num(1));
+    ASTNode* unsigned_and = op("&", id("u"), num(1));
+    ASTNode* element = ast_create_array_access(id("p"), num(0));
+    ASTNode* int_call = ast_create_call(id("f"), NULL);
+    ASTNode* double_call = ast_create_call(id("g"), NULL);
+    ASTNode* unknown_call = ast_create_call(id("h"), NULL);
+    ASTNode* undeclared = op("+", id("y"), num(1));
+    ASTNode* compare = op("<", id("x"), id("d"));
+    ASTNode* to_int = ast_create_cast("int", id("d"));
+    ASTNode* to_unsigned = ast_create_cast("unsigned int", id("x"));
+    ASTNode* literals = op("+", ast_create_literal("1.5"), ast_create_literal("1.5"));
+    ASTNode* wide = op("+", ast_create_literal("1L"), num(1));
+    ASTNode* character = op("+", ast_create_literal("'a'"), num(1));
+    ASTNode* param_use = op("*", id("n"), id("n"));
+    
+    ASTNode* body = ast_create_block(ast_link(sum, ast_link(fp, ast_link(unsigned_and,
+        ast_link(element, ast_link(int_call, ast_link(double_call, ast_link(unknown_call,
+        ast_link(undeclared, ast_link(compare, ast_link(to_int, ast_link(to_unsigned,
+        ast_link(literals, ast_link(wide, ast_link(character, param_use)))))))))))))));
+    
+    ASTNode* param = ast_create_variable("n", "short", NULL);
+    param->type = NODE_PARAMETER;
+    
+    ASTNode* program = ast_link(ast_create_variable("x", "int", NULL),
+        ast_link(ast_create_variable("d", "double", NULL),
+        ast_link(ast_create_variable("u", "unsigned int", NULL),
+        ast_link(ast_create_variable("p", "int*", NULL),
+        ast_link(create_function("f", "int", NULL, NULL),
+        ast_link(create_function("g", "double", NULL, NULL),
+                 create_function("use", "void", param, body)))))));
+    
+    typing_annotate(program);
+    
+    assert(is_int(sum) && is_int(sum->data.binary.left));
+    assert(!is_int(fp));
+    assert(!is_int(unsigned_and));
+    assert(is_int(element));
+    assert(is_int(int_call));
+    assert(!is_int(double_call));
+    assert(!is_int(unknown_call));
+    assert(!is_int(undeclared) && !is_int(undeclared->data.binary.left));
+    assert(is_int(compare));
+    assert(is_int(to_int));
+    assert(!is_int(to_unsigned));
+    assert(!is_int(literals));
+    assert(!is_int(wide));
+    assert(is_int(character));
+    assert(is_int(param_use));
+    
+    // Operands of unknown type never pass as integers
+    assert(!ast_is_integer_operand(undeclared->data.binary.left));
+    assert(!ast_is_integer_operand(unknown_call));
+    assert(ast_is_integer_operand(sum));
+    
+    ast_tree_destroy(program);
+    
+    printf("✓ Typing from declarations test passed\n");
+}
+
+void test_scopes() {
+    printf("Testing typing scopes...\n");
+    
+    // int x; void f() { { double x; x + 1; } x + 1; __auto_type t = x; t + 1; }
+    ASTNode* shadowed = op("+", id("x"), num(1));
+    ASTNode* outer = op("+", id("x"), num(1));
+    ASTNode* inferred = op("+", id("t"), num(1));
+    
+    ASTNode* inner = ast_create_block(ast_link(ast_create_variable("x", "double", NULL), shadowed));
+    ASTNode* body = ast_create_block(ast_link(inner, ast_link(outer,
+        ast_link(ast_create_variable("t", "__auto_type", id("x")), inferred))));
+    ASTNode* program = ast_link(ast_create_variable("x", "int", NULL),
+                                create_function("f", "void", NULL, body));
+    
+    typing_annotate(program);
+    
+    assert(!is_int(shadowed));
+    assert(is_int(outer));
+    assert(is_int(inferred));
+    
+    // Annotating again after a declaration changes clears stale marks
+    free(program->data.variable.type);
+    program->data.variable.type = strdup("float");
+    typing_annotate(program);
+    assert(!is_int(outer));
+    assert(!is_int(inferred));
+    
+    ast_tree_destroy(program);
+    
+    printf("✓ Typing scopes test passed\n");
+}
+
+int main() {
+    printf("Running Typing Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_int_type_names();
+    test_declared_types();
+    test_scopes();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All typing tests passed! ✓\n");
+    
+    return 0;
+}
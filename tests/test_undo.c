@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/undo.h"
+#include "../src/obfuscator/obfuscator.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/obfuscator/mba.h"
+#include "../src/obfuscator/cse.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Undo Log Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ObfuscationContext* create_context(ObfuscationConfig** config) {
+    *config = config_create_default();
+    (*config)->level = OBF_EXTREME;
+    (*config)->seed = 7;
+    return obfuscator_create(*config);
+}
+
+void test_mba_rollback() {
+    printf("Testing rollback of an MBA rewrite...\n");
+    
+    ObfuscationConfig* config;
+    ObfuscationContext* ctx = create_context(&config);
+    MBAState mba = {0};
+    mba_begin_function(&mba, config);
+    mba.in_function = true;
+    
+    // A non-trivial operand is hoisted into a temporary
+    ASTNode* expr = op("+", as_int(op("*", as_int(id("a")), num(3))), as_int(id("b")));
+    ASTNode* original = ast_copy(expr);
+    ASTNode* left = expr->data.binary.left;
+    
+    size_t mark = undo_checkpoint(ctx->undo);
+    assert(mba_rewrite(ctx, &mba, expr));
+    assert(expr->type == NODE_STMT_EXPR);
+    assert(ctx->undo->count == 1);
+    
+    undo_rollback(ctx->undo, mark);
+    assert(ctx->undo->count == 0);
+    assert(ctx->undo->depth == 0);
+    assert(ast_equal(expr, original));
+    
+    // The operands are the same nodes, not copies
+    assert(expr->data.binary.left == left);
+    
+    // Applied for good outside a checkpoint
+    assert(mba_rewrite(ctx, &mba, expr));
+    assert(ctx->undo->count == 0);
+    assert(!ast_equal(expr, original));
+    
+    ast_node_destroy(original);
+    ast_node_destroy(expr);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    printf("✓ MBA rollback test passed\n");
+}
+
+void test_nested_checkpoints() {
+    printf("Testing nested checkpoints...\n");
+    
+    ObfuscationConfig* config;
+    ObfuscationContext* ctx = create_context(&config);
+    
+    ASTNode* expr = op("-", op("^", id("x"), num(5)), op("&", id("y"), num(9)));
+    ASTNode* left = expr->data.binary.left;
+    ASTNode* right = expr->data.binary.right;
+    
+    size_t outer = undo_checkpoint(ctx->undo);
+    undo_replace(ctx->undo, left->data.binary.right, num(6));
+    
+    size_t inner = undo_checkpoint(ctx->undo);
+    undo_replace_subtree(ctx->undo, right, id("t"));
+    undo_replace(ctx->undo, expr, op("+", expr->data.binary.left, expr->data.binary.right));
+    assert(ctx->undo->count == 3);
+    
+    // Only the inner changes are taken back
+    undo_rollback(ctx->undo, inner);
+    assert(ctx->undo->count == 1);
+    assert(strcmp(expr->data.binary.operator, "-") == 0);
+    assert(right->type == NODE_BINARY_OP);
+    assert(strcmp(right->data.binary.left->data.identifier.name, "y") == 0);
+    assert(strcmp(left->data.binary.right->data.literal.value, "6") == 0);
+    
+    // Committing the outer checkpoint releases the log
+    undo_commit(ctx->undo, outer);
+    assert(ctx->undo->count == 0);
+    assert(ctx->undo->depth == 0);
+    assert(strcmp(left->data.binary.right->data.literal.value, "6") == 0);
+    
+    ast_node_destroy(expr);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    printf("✓ Nested checkpoint test passed\n");
+}
+
+void test_cse_rollback() {
+    printf("Testing rollback of common-subexpression hoisting...\n");
+    
+    ObfuscationConfig* config;
+    ObfuscationContext* ctx = create_context(&config);
+    
+    ASTNode* expr = op("*", op("+", op("*", id("a"), id("b")), num(1)),
+                            op("-", op("*", id("a"), id("b")), num(2)));
+    ASTNode* original = ast_copy(expr);
+    
+    size_t mark = undo_checkpoint(ctx->undo);
+    assert(cse_hoist_expression(ctx, expr) == 1);
+    assert(expr->type == NODE_STMT_EXPR);
+    
+    undo_rollback(ctx->undo, mark);
+    assert(ast_equal(expr, original));
+    
+    // Committed, the hoisted form stays
+    mark = undo_checkpoint(ctx->undo);
+    assert(cse_hoist_expression(ctx, expr) == 1);
+    undo_commit(ctx->undo, mark);
+    assert(expr->type == NODE_STMT_EXPR);
+    
+    ast_node_destroy(original);
+    ast_node_destroy(expr);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    printf("✓ CSE rollback test passed\n");
+}
+
+void test_budget_rollback() {
+    printf("Testing whole-expression rollback under a growth budget...\n");
+    
+    // Hoisting `a + b` costs a node the budget does not have
+    ASTNode* statements = ast_create_assignment(id("x"),
+        op("*", op("+", id("a"), id("b")), op("+", id("a"), id("b"))));
+    ASTNode* function = create_function("square", "void", NULL, ast_create_block(statements));
+    ASTNode* original = ast_copy(statements);
+    
+    ObfuscationConfig* config;
+    ObfuscationContext* ctx = create_context(&config);
+    config->max_nodes = (long)ast_count_nodes(function);
+    ctx->budget = budget_create(config, function);
+    
+    assert(obfuscate_expressions(ctx, function));
+    assert(ast_equal(function->data.function.body->data.block.statements, original));
+    assert(ctx->budget->added == 0);
+    assert(ctx->budget->degraded > 0);
+    assert(ctx->undo->count == 0);
+    
+    // Unlimited, the same expression is hoisted
+    budget_destroy(ctx->budget);
+    ctx->budget = NULL;
+    assert(obfuscate_expressions(ctx, function));
+    assert(!ast_equal(function->data.function.body->data.block.statements, original));
+    
+    ast_node_destroy(original);
+    ast_node_destroy(function);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    printf("✓ Budget rollback test passed\n");
+}
+
+int main() {
+    printf("Running Undo Log Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_mba_rollback();
+    test_nested_checkpoints();
+    test_cse_rollback();
+    test_budget_rollback();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All undo log tests passed! ✓\n");
+    
+    return 0;
+}
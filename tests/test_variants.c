@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include "../src/obfuscator/variants.h"
+#include "../src/obfuscator/obfuscator.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Multi-Variant Emission Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const char* source = "mix(a * b + c, (x ^ 12) - y * 3, \"watermark\")";
+
+static char* read_all(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return NULL;
+    
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char* content = malloc((size_t)size + 1);
+    size_t read = fread(content, 1, (size_t)size, file);
+    content[read] = '\0';
+    fclose(file);
+    return content;
+}
+
+void test_output_names() {
+    printf("Testing variant output names...\n");
+    
+    const char* cases[][2] = {
+        { "out.c", "out.3.c" },
+        { "build/out_obf.c", "build/out_obf.3.c" },
+        { "dir.d/out", "dir.d/out.3" },
+        { ".hidden", ".hidden.3" },
+        { "plain", "plain.3" },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char* name = variant_output_name(cases[i][0], 3);
+        assert(strcmp(name, cases[i][1]) == 0);
+        free(name);
+    }
+    assert(variant_output_name(NULL, 1) == NULL);
+    
+    printf("✓ Output name test passed\n");
+}
+
+void test_seed_derivation() {
+    printf("Testing per-variant seeds...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->seed = 42;
+    
+    VariantSet* first = variant_set_create();
+    assert(variant_set_fill(first, 5));
+    assert(variant_set_prepare(first, config, "out.c"));
+    
+    // An explicit seed only replaces its own variant's draw
+    VariantSet* second = variant_set_create();
+    assert(variant_set_add(second, 0, VARIANT_BASE, VARIANT_BASE));
+    assert(variant_set_add(second, 777, AESTHETIC_HEXADECIMAL, VARIANT_BASE));
+    assert(variant_set_fill(second, 5));
+    assert(second->count == 5);
+    assert(variant_set_prepare(second, config, "out.c"));
+    
+    for (int i = 0; i < 5; i++) {
+        assert(first->variants[i].seed != 0);
+        if (i == 1) {
+            assert(second->variants[i].seed == 777);
+            assert(second->variants[i].aesthetic == AESTHETIC_HEXADECIMAL);
+        } else {
+            assert(second->variants[i].seed == first->variants[i].seed);
+        }
+        for (int j = 0; j < i; j++) {
+            assert(first->variants[i].seed != first->variants[j].seed);
+        }
+    }
+    assert(strcmp(first->variants[4].output_file, "out.5.c") == 0);
+    
+    variant_set_destroy(first);
+    variant_set_destroy(second);
+    config_destroy(config);
+    printf("✓ Seed derivation test passed\n");
+}
+
+static VariantSet* emit_into(const char* directory, const ASTSnapshot* snapshot,
+                             const ObfuscationConfig* config, int jobs) {
+    char output[512];
+    snprintf(output, sizeof(output), "%s/build.c", directory);
+    
+    VariantSet* set = variant_set_create();
+    assert(variant_set_add(set, 0, AESTHETIC_HEXADECIMAL, OBF_BASIC));
+    assert(variant_set_add(set, 99, AESTHETIC_UNICODE, VARIANT_BASE));
+    assert(variant_set_fill(set, 8));
+    assert(variant_set_prepare(set, config, output));
+    assert(variants_emit(set, snapshot, config, jobs) == 0);
+    return set;
+}
+
+void test_parallel_emission() {
+    printf("Testing parallel emission...\n");
+    
+    char serial_dir[] = "/tmp/obf_variants_XXXXXX";
+    char parallel_dir[] = "/tmp/obf_variants_XXXXXX";
+    assert(mkdtemp(serial_dir) && mkdtemp(parallel_dir));
+    
+    ASTSnapshot* snapshot = snapshot_parse(source, "input.c");
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    config->seed = 2024;
+    
+    VariantSet* serial = emit_into(serial_dir, snapshot, config, 1);
+    VariantSet* parallel = emit_into(parallel_dir, snapshot, config, 4);
+    
+    char* outputs[8];
+    for (int i = 0; i < 8; i++) {
+        assert(serial->variants[i].ok && parallel->variants[i].ok);
+        
+        // Scheduling does not change a single byte
+        outputs[i] = read_all(serial->variants[i].output_file);
+        char* threaded = read_all(parallel->variants[i].output_file);
+        assert(outputs[i] && threaded);
+        assert(strlen(outputs[i]) == serial->variants[i].size);
+        assert(strcmp(outputs[i], threaded) == 0);
+        free(threaded);
+        
+        // ... and matches rendering that variant on its own
+        ObfuscationConfig* single = config_clone(config);
+        single->seed = serial->variants[i].seed;
+        if (serial->variants[i].aesthetic != VARIANT_BASE) {
+            config_set_aesthetic(single, (AestheticStyle)serial->variants[i].aesthetic);
+        }
+        if (serial->variants[i].level != VARIANT_BASE) {
+            single->level = (ObfuscationLevel)serial->variants[i].level;
+        }
+        char* alone = snapshot_render(snapshot, single, NULL);
+        assert(strcmp(outputs[i], alone) == 0);
+        free(alone);
+        config_destroy(single);
+        
+        for (int j = 0; j < i; j++) {
+            assert(strcmp(outputs[i], outputs[j]) != 0);
+        }
+    }
+    
+    for (int i = 0; i < 8; i++) {
+        free(outputs[i]);
+        remove(serial->variants[i].output_file);
+        remove(parallel->variants[i].output_file);
+    }
+    rmdir(serial_dir);
+    rmdir(parallel_dir);
+    
+    variant_set_destroy(serial);
+    variant_set_destroy(parallel);
+    config_destroy(config);
+    snapshot_destroy(snapshot);
+    printf("✓ Parallel emission test passed\n");
+}
+
+void test_failures() {
+    printf("Testing failed variants...\n");
+    
+    ASTSnapshot* snapshot = snapshot_parse(source, "input.c");
+    ObfuscationConfig* config = config_create_default();
+    config->seed = 5;
+    
+    VariantSet* set = variant_set_create();
+    assert(variant_set_fill(set, 3));
+    assert(variant_set_prepare(set, config, "/nonexistent/dir/out.c"));
+    assert(variants_emit(set, snapshot, config, 2) == 3);
+    assert(!set->variants[0].ok && set->variants[0].size == 0);
+    
+    variant_set_destroy(set);
+    config_destroy(config);
+    snapshot_destroy(snapshot);
+    printf("✓ Failed variant test passed\n");
+}
+
+int main() {
+    printf("Running Multi-Variant Emission Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    test_output_names();
+    test_seed_derivation();
+    test_parallel_emission();
+    test_failures();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All multi-variant tests passed! ✓\n");
+    
+    return 0;
+}
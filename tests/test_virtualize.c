@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../src/obfuscator/virtualize.h"
+#include "../src/obfuscator/ast_utils.h"
+#include "../src/parser/parser.h"
+#include "test_helpers.h"
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Bytecode Virtualization Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static ASTNode* parameter(const char* name, const char* type) {
+    ASTNode* param = calloc(1, sizeof(ASTNode));
+    param->type = NODE_PARAMETER;
+    param->data.variable.name = strdup(name);
+    param->data.variable.type = strdup(type);
+    return param;
+}
+
+/* check(PARAMETERS) { STATEMENTS }, marked for virtualization */
+static ASTNode* function(const char* return_type, ASTNode* parameters, ASTNode* statements) {
+    ASTNode* fn = create_function("check", return_type, parameters, ast_create_block(statements));
+    fn->flags = AST_FLAG_VIRTUALIZE;
+    return fn;
+}
+
+/* void check(int n, int k) {
+ *     int acc = 1;
+ *     for (int i = 0; i < n; i++) {
+ *         acc = acc * 3 + i;
+ *         if (acc > 500 && k) acc -= 400;
+ *     }
+ *     int m = n > k ? n - k : k - n;
+ *     report(acc, m);
+ *     int r = mix(acc);
+ *     if (r & 1) return;
+ *     report(r, !k || n == 2);
+ * } */
+static ASTNode* sample_function(void) {
+    ASTNode* reduce = ast_create_if(op("&&", op(">", id("acc"), num(500)), id("k")),
+                                    op("-=", id("acc"), num(400)), NULL);
+    ASTNode* step = ast_create_assignment(id("acc"), op("+", op("*", id("acc"), num(3)), id("i")));
+    ASTNode* loop = ast_create_for(ast_create_variable("i", "int", num(0)),
+                                   op("<", id("i"), id("n")),
+                                   ast_create_unary_op("++", id("i"), false),
+                                   ast_create_block(ast_link(step, reduce)));
+    ASTNode* distance = op("?:", op(">", id("n"), id("k")),
+                           ast_link(op("-", id("n"), id("k")), op("-", id("k"), id("n"))));
+    ASTNode* first = ast_create_call(id("report"), ast_link(id("acc"), id("m")));
+    ASTNode* mixed = ast_create_variable("r", "int", as_int(ast_create_call(id("mix"), id("acc"))));
+    ASTNode* early = ast_create_if(op("&", id("r"), num(1)), ast_create_return(), NULL);
+    ASTNode* flag = op("||", ast_create_unary_op("!", id("k"), true), op("==", id("n"), num(2)));
+    ASTNode* second = ast_create_call(id("report"), ast_link(id("r"), flag));
+    
+    ASTNode* statements = ast_link(ast_create_variable("acc", "int", num(1)), loop);
+    statements = ast_link(statements, ast_create_variable("m", "int", distance));
+    statements = ast_link(statements, first);
+    statements = ast_link(statements, mixed);
+    statements = ast_link(statements, early);
+    statements = ast_link(statements, second);
+    
+    return function("void", ast_link(parameter("n", "int"), parameter("k", "int")), statements);
+}
+
+static int mix(int x) { return x ^ 0x55; }
+
+typedef struct {
+    int values[16];
+    int count;
+} Trace;
+
+static void report(Trace* trace, int a, int b) {
+    trace->values[trace->count++] = a;
+    trace->values[trace->count++] = b;
+}
+
+static void native(Trace* trace, int n, int k) {
+    int acc = 1;
+    for (int i = 0; i < n; i++) {
+        acc = acc * 3 + i;
+        if (acc > 500 && k) acc -= 400;
+    }
+    int m = n > k ? n - k : k - n;
+    report(trace, acc, m);
+    int r = mix(acc);
+    if (r & 1) return;
+    report(trace, r, !k || n == 2);
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Reference Interpreter
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+static const ASTNode* find_switch(const ASTNode* node) {
+    for (; node; node = node->next) {
+        if (node->type == NODE_SWITCH) return node;
+        if (node->type == NODE_WHILE) {
+            const ASTNode* inner = find_switch(node->data.while_stmt.body->data.block.statements);
+            if (inner) return inner;
+        }
+    }
+    return NULL;
+}
+
+static int argument(const ASTNode* node, const int* r) {
+    if (node->type == NODE_LITERAL) return atoi(node->data.literal.value);
+    
+    assert(node->type == NODE_CALL);
+    assert(strcmp(node->data.call.function->data.identifier.name, "__obf_vm_reg") == 0);
+    return r[atoi(node->data.call.arguments->next->data.literal.value)];
+}
+
+/* Runs the stub's case for `site` the way the emitted switch would */
+static void call_site(const ASTNode* stub, int site, int* r, Trace* trace) {
+    const ASTNode* dispatch = find_switch(stub);
+    assert(dispatch != NULL);
+    
+    const ASTNode* label = dispatch->data.switch_stmt.cases;
+    while (label && atoi(label->data.case_stmt.value->data.literal.value) != site) {
+        label = label->next;
+    }
+    assert(label != NULL);
+    
+    const ASTNode* call = label->data.case_stmt.statements;
+    int dst = -1;
+    if (strcmp(call->data.call.function->data.identifier.name, "__obf_vm_set") == 0) {
+        dst = atoi(call->data.call.arguments->next->data.literal.value);
+        call = call->data.call.arguments->next->next;
+    }
+    
+    const char* callee = call->data.call.function->data.identifier.name;
+    const ASTNode* args = call->data.call.arguments;
+    if (strcmp(callee, "mix") == 0) {
+        assert(dst >= 0);
+        r[dst] = mix(argument(args, r));
+    } else {
+        assert(strcmp(callee, "report") == 0);
+        report(trace, argument(args, r), argument(args->next, r));
+    }
+}
+
+/* Executes with the program's shuffled encoding, counting each opcode */
+static void interpret(const VMProgram* program, const ASTNode* stub, int entry,
+                      const int* params, int count, Trace* trace, int* executed) {
+    int decode[VM_OP_COUNT];
+    for (int i = 0; i < VM_OP_COUNT; i++) {
+        decode[program->encoding[i]] = i;
+    }
+    
+    int r[VM_REGISTERS] = {0};
+    memcpy(r, params, count * sizeof(int));
+    
+    const int* code = program->code;
+    int ip = entry;
+    for (int steps = 0; steps < 100000; steps++) {
+        int opcode = decode[code[ip]];
+        const int* x = &code[ip + 1];
+        executed[opcode]++;
+        
+        int next = ip + 1 + vm_opcode_operands(opcode, NULL);
+        switch (opcode) {
+            case VM_OP_HALT: return;
+            case VM_OP_CALL: call_site(stub, x[0], r, trace); break;
+            case VM_OP_JMP:  next = x[0]; break;
+            case VM_OP_JZ:   if (!r[x[0]]) next = x[1]; break;
+            case VM_OP_JNZ:  if (r[x[0]]) next = x[1]; break;
+            case VM_OP_JEQ:  if (r[x[0]] == r[x[1]]) next = x[2]; break;
+            case VM_OP_JNE:  if (r[x[0]] != r[x[1]]) next = x[2]; break;
+            case VM_OP_JLT:  if (r[x[0]] < r[x[1]]) next = x[2]; break;
+            case VM_OP_JLE:  if (r[x[0]] <= r[x[1]]) next = x[2]; break;
+            case VM_OP_JGT:  if (r[x[0]] > r[x[1]]) next = x[2]; break;
+            case VM_OP_JGE:  if (r[x[0]] >= r[x[1]]) next = x[2]; break;
+            case VM_OP_MOV:  r[x[0]] = r[x[1]]; break;
+            case VM_OP_LOADI: r[x[0]] = x[1]; break;
+            case VM_OP_ADD:  r[x[0]] = r[x[1]] + r[x[2]]; break;
+            case VM_OP_SUB:  r[x[0]] = r[x[1]] - r[x[2]]; break;
+            case VM_OP_MUL:  r[x[0]] = r[x[1]] * r[x[2]]; break;
+            case VM_OP_DIV:  r[x[0]] = r[x[1]] / r[x[2]]; break;
+            case VM_OP_MOD:  r[x[0]] = r[x[1]] % r[x[2]]; break;
+            case VM_OP_AND:  r[x[0]] = r[x[1]] & r[x[2]]; break;
+            case VM_OP_OR:   r[x[0]] = r[x[1]] | r[x[2]]; break;
+            case VM_OP_XOR:  r[x[0]] = r[x[1]] ^ r[x[2]]; break;
+            case VM_OP_SHL:  r[x[0]] = r[x[1]] << r[x[2]]; break;
+            case VM_OP_SHR:  r[x[0]] = r[x[1]] >> r[x[2]]; break;
+            case VM_OP_EQ:   r[x[0]] = r[x[1]] == r[x[2]]; break;
+            case VM_OP_NE:   r[x[0]] = r[x[1]] != r[x[2]]; break;
+            case VM_OP_LT:   r[x[0]] = r[x[1]] < r[x[2]]; break;
+            case VM_OP_LE:   r[x[0]] = r[x[1]] <= r[x[2]]; break;
+            case VM_OP_GT:   r[x[0]] = r[x[1]] > r[x[2]]; break;
+            case VM_OP_GE:   r[x[0]] = r[x[1]] >= r[x[2]]; break;
+            case VM_OP_ADDI: r[x[0]] = r[x[1]] + x[2]; break;
+            case VM_OP_MULI: r[x[0]] = r[x[1]] * x[2]; break;
+            case VM_OP_ANDI: r[x[0]] = r[x[1]] & x[2]; break;
+            case VM_OP_NEG:  r[x[0]] = -r[x[1]]; break;
+            case VM_OP_NOT:  r[x[0]] = !r[x[1]]; break;
+            case VM_OP_INV:  r[x[0]] = ~r[x[1]]; break;
+            case VM_OP_BOOL: r[x[0]] = r[x[1]] != 0; break;
+            default: assert(!"bad opcode");
+        }
+        assert(next >= 0 && next < program->count);
+        ip = next;
+    }
+    assert(!"program did not halt");
+}
+
+/* ═══════════════════════════════════════════════════════════════════════════
+ * Tests
+ * ═══════════════════════════════════════════════════════════════════════════ */
+
+void test_compiled_semantics() {
+    printf("Testing compiled semantics...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    // A second function first, so the sample's entry is not at zero
+    ASTNode* other = function("void", parameter("x", "int"),
+                              ast_create_call(id("report"), ast_link(id("x"), num(1))));
+    VirtualizeStats stats = {0};
+    assert(virtualize_function(ctx, other, &stats));
+    int entry = ctx->bytecode->count;
+    
+    ASTNode* fn = sample_function();
+    assert(virtualize_function(ctx, fn, &stats));
+    assert(stats.functions == 2);
+    assert(stats.call_sites == 4);
+    assert(stats.words == ctx->bytecode->count);
+    
+    const ASTNode* stub = fn->data.function.body->data.block.statements;
+    assert(stub->type == NODE_VARIABLE);
+    assert(strcmp(stub->data.variable.type, "__obf_vm_frame") == 0);
+    
+    int executed[VM_OP_COUNT] = {0};
+    for (int n = 0; n < 12; n++) {
+        for (int k = 0; k < 4; k++) {
+            Trace expected = {0};
+            Trace actual = {0};
+            int params[2] = { n, k };
+            native(&expected, n, k);
+            interpret(ctx->bytecode, stub, entry, params, 2, &actual, executed);
+            
+            assert(actual.count == expected.count);
+            assert(memcmp(actual.values, expected.values, expected.count * sizeof(int)) == 0);
+        }
+    }
+    
+    // The loop test is a fused compare-and-branch and the induction step
+    // an immediate add; nothing materializes a comparison just to test it
+    assert(executed[VM_OP_JLT] + executed[VM_OP_JGE] > 0);
+    assert(executed[VM_OP_ADDI] > 0);
+    assert(executed[VM_OP_MULI] > 0);
+    assert(executed[VM_OP_LT] == 0 && executed[VM_OP_GT] == 0);
+    
+    ast_node_destroy(other);
+    ast_node_destroy(fn);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Compiled semantics test passed\n");
+}
+
+void test_refusals() {
+    printf("Testing refusals...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    config->level = OBF_EXTREME;
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    ASTNode* hot = sample_function();
+    hot->hotness = 64.0f;
+    ASTNode* capped = sample_function();
+    capped->level_cap = OBF_BASIC;
+    ASTNode* plain = sample_function();
+    plain->flags = 0;
+    ASTNode* valued = function("int", parameter("n", "int"), ast_create_return());
+    ASTNode* pointer = function("void", parameter("p", "int*"), ast_create_return());
+    ASTNode* global = function("void", parameter("n", "int"),
+                               op("+=", id("total"), id("n")));
+    ASTNode* untyped = function("void", parameter("n", "int"),
+                                ast_create_variable("r", "int", ast_create_call(id("scale"), id("n"))));
+    
+    ASTNode* program = calloc(1, sizeof(ASTNode));
+    program->type = NODE_PROGRAM;
+    program->data.program.declarations = ast_link(hot, capped);
+    ast_link(program->data.program.declarations, plain);
+    ast_link(program->data.program.declarations, valued);
+    ast_link(program->data.program.declarations, pointer);
+    ast_link(program->data.program.declarations, global);
+    ast_link(program->data.program.declarations, untyped);
+    
+    int passes = ctx->pass_count;
+    assert(virtualize_functions(ctx, program));
+    assert(ctx->pass_count == passes + 1);
+    assert(ctx->bytecode->count == 0);
+    
+    for (ASTNode* fn = program->data.program.declarations; fn; fn = fn->next) {
+        ASTNode* first = fn->data.function.body->data.block.statements;
+        assert(first->type != NODE_VARIABLE ||
+               strcmp(first->data.variable.type, "__obf_vm_frame") != 0);
+    }
+    
+    // Nothing virtualized, nothing emitted
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(!prologue || strstr(prologue, "__obf_vm_run") == NULL);
+    free(prologue);
+    
+    // The same sample compiles once it is cold and uncapped
+    hot->hotness = 1.0f;
+    assert(virtualize_functions(ctx, program));
+    assert(ctx->bytecode->count > 0);
+    assert(strcmp(hot->data.function.body->data.block.statements->data.variable.type,
+                  "__obf_vm_frame") == 0);
+    
+    // A call whose result is used but whose return type is unknown stays native
+    assert(untyped->data.function.body->data.block.statements->type == NODE_VARIABLE);
+    assert(strcmp(untyped->data.function.body->data.block.statements->data.variable.name, "r") == 0);
+    
+    ast_tree_destroy(program->data.program.declarations);
+    free(program);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Refusal test passed\n");
+}
+
+void test_emitted_interpreter() {
+    printf("Testing emitted interpreter...\n");
+    
+    ObfuscationConfig* config = config_create_default();
+    ObfuscationContext* ctx = obfuscator_create(config);
+    
+    ASTNode* fn = sample_function();
+    assert(virtualize_function(ctx, fn, NULL));
+    
+    char* prologue = obfuscator_runtime_prologue(ctx);
+    assert(prologue != NULL);
+    assert(strstr(prologue, "static __attribute__((noinline)) int __obf_vm_run(") != NULL);
+    assert(strstr(prologue, "&&__obf_vm_") != NULL);
+    assert(strstr(prologue, "goto *ip->op;") != NULL);
+    assert(strstr(prologue, "static const int __obf_vm_code[") != NULL);
+    free(prologue);
+    
+    // Opcode numbers are shuffled per program
+    bool shuffled = false;
+    for (int round = 0; round < 8 && !shuffled; round++) {
+        VMProgram* program = vm_program_create(NULL);
+        for (int i = 0; i < VM_OP_COUNT; i++) {
+            if (program->encoding[i] != i) shuffled = true;
+        }
+        vm_program_destroy(program);
+    }
+    assert(shuffled);
+    
+    ast_node_destroy(fn);
+    obfuscator_destroy(ctx);
+    config_destroy(config);
+    
+    printf("✓ Emitted interpreter test passed\n");
+}
+
+int main() {
+    printf("Running Bytecode Virtualization Tests...\n");
+    printf("═══════════════════════════════════════════════════════════════\n");
+    
+    srand(41);
+    test_compiled_semantics();
+    test_refusals();
+    test_emitted_interpreter();
+    
+    printf("═══════════════════════════════════════════════════════════════\n");
+    printf("All virtualization tests passed! ✓\n");
+    
+    return 0;
+}